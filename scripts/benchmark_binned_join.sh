@@ -0,0 +1,59 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+if [[ $# -lt 2 || $# -gt 3 ]]; then
+    echo "Usage: $0 <query_bed> <target_bed> [threads]" >&2
+    echo "Example: $0 reads.bed exome_targets.bed 4" >&2
+    exit 1
+fi
+
+query_path=$1
+target_path=$2
+threads=${3:-4}
+extension_path=${DUCKHTS_EXTENSION_PATH:-./build/release/duckhts.duckdb_extension}
+
+for path in "$query_path" "$target_path" "$extension_path"; do
+    if [[ ! -f "$path" ]]; then
+        echo "Not found: $path" >&2
+        exit 1
+    fi
+done
+
+read -r -d '' sql_setup <<SQL || true
+LOAD '${extension_path}';
+PRAGMA threads=${threads};
+CREATE TABLE q AS SELECT chrom, start, "end" FROM read_bed('${query_path}');
+CREATE TABLE t AS SELECT chrom, start, "end", name FROM read_bed('${target_path}');
+SQL
+
+# Plain range join: equality on chrom only, so every query interval is
+# compared against every target on its contig.
+read -r -d '' sql_range <<SQL || true
+SELECT count(*) AS pairs
+FROM q JOIN t
+  ON q.chrom = t.chrom AND q.start < t."end" AND t.start < q."end";
+SQL
+
+# Binned join: each target is expanded into every bin it spans, each query
+# interval maps to its single smallest enclosing bin, and the hash join on
+# (chrom, bin) leaves only candidate pairs for the exact overlap filter.
+read -r -d '' sql_binned <<SQL || true
+SELECT count(*) AS pairs
+FROM q JOIN (SELECT *, unnest(hts_reg2bins(start, "end")) AS bin FROM t) tb
+  ON q.chrom = tb.chrom AND hts_reg2bin(q.start, q."end") = tb.bin
+WHERE q.start < tb."end" AND tb.start < q."end";
+SQL
+
+echo "Benchmarking interval overlap joins"
+echo "  query:   $query_path"
+echo "  target:  $target_path"
+echo "  threads: $threads"
+
+for variant in binned range; do
+    sql_var="sql_${variant}"
+    echo "-- ${variant} join"
+    /usr/bin/time -f 'elapsed=%E user=%U sys=%S maxrss_kb=%M' \
+        duckdb -unsigned -c "${sql_setup}
+.timer on
+${!sql_var}"
+done
@@ -0,0 +1,95 @@
+/*
+ * Throughput of the seq_revcomp / seq_canonical / seq_gc_content / fasta_nuc
+ * kernels for every implementation this CPU supports. Built and run by
+ * benchmark_seq_kernels.sh; each kernel is also checked against the scalar
+ * path before it is timed.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../src/include/seq_kernels.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *IMPLS[] = {"scalar", "sse4.2", "avx2", "neon"};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Split buf into reads of read_len bases and run one kernel over all of them. */
+static size_t run_kernel(int kernel, const char *buf, size_t total, size_t read_len, char *out) {
+    size_t acc = 0;
+    for (size_t off = 0; off + read_len <= total; off += read_len) {
+        size_t gc = 0, n = 0;
+        switch (kernel) {
+        case 0:
+            acc += (size_t)seq_revcomp_kernel(buf + off, read_len, out + off);
+            break;
+        case 1:
+        case 2:
+            acc += (size_t)seq_canonical_kernel(buf + off, read_len, out + off);
+            break;
+        case 3:
+            acc += (size_t)seq_gc_count_kernel(buf + off, read_len, &gc, &n) + gc;
+            break;
+        default: {
+            size_t counts[SEQ_BASE_COUNT];
+            seq_base_count_kernel(buf + off, read_len, counts);
+            for (int b = 0; b < SEQ_BASE_COUNT; b++) acc += counts[b] * (size_t)(b + 1);
+            break;
+        }
+        }
+    }
+    return acc;
+}
+
+int main(int argc, char **argv) {
+    size_t total = (size_t)(argc > 1 ? atol(argv[1]) : 64) << 20;
+    size_t read_len = argc > 2 ? (size_t)atol(argv[2]) : 150;
+    int reps = argc > 3 ? atoi(argv[3]) : 10;
+    static const char *KERNELS[] = {"revcomp", "canonical", "canonical_palindrome", "gc_content", "base_count"};
+
+    char *random_seq = malloc(total), *palindrome = malloc(total);
+    char *out = malloc(total), *expect = malloc(total);
+    if (!random_seq || !palindrome || !out || !expect) return 1;
+    srand(42);
+    for (size_t i = 0; i < total; i++) random_seq[i] = "ACGTacgtN"[rand() % 9];
+    /* Reads equal to their own reverse complement force a full comparison. */
+    for (size_t off = 0; off + read_len <= total; off += read_len) {
+        size_t half = read_len / 2;
+        for (size_t i = 0; i < half; i++) palindrome[off + i] = "ACGT"[rand() % 4];
+        seq_kernels_select("scalar");
+        seq_revcomp_kernel(palindrome + off, half, palindrome + off + read_len - half);
+        if (read_len & 1) palindrome[off + half] = 'N';
+    }
+
+    printf("%-8s %-22s %10s\n", "impl", "kernel", "GB/s");
+    for (size_t k = 0; k < sizeof(KERNELS) / sizeof(KERNELS[0]); k++) {
+        const char *input = k == 2 ? palindrome : random_seq;
+        seq_kernels_select("scalar");
+        size_t want = run_kernel((int)k, input, total, read_len, expect);
+        for (size_t m = 0; m < sizeof(IMPLS) / sizeof(IMPLS[0]); m++) {
+            if (seq_kernels_select(IMPLS[m]) != 0) continue;
+            if (run_kernel((int)k, input, total, read_len, out) != want ||
+                (k < 3 && memcmp(out, expect, total - total % read_len) != 0)) {
+                fprintf(stderr, "%s %s: mismatch against scalar\n", IMPLS[m], KERNELS[k]);
+                return 1;
+            }
+            double t0 = now_sec();
+            for (int r = 0; r < reps; r++) run_kernel((int)k, input, total, read_len, out);
+            double secs = now_sec() - t0;
+            printf("%-8s %-22s %10.2f\n", IMPLS[m], KERNELS[k], (double)total * reps / secs / 1e9);
+        }
+    }
+    free(random_seq);
+    free(palindrome);
+    free(out);
+    free(expect);
+    return 0;
+}
@@ -0,0 +1,14 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Usage: scripts/benchmark_seq_kernels.sh [MiB] [read_len] [reps]
+# Compiles the sequence kernels with the host compiler and prints GB/s per
+# kernel for each SIMD implementation the CPU supports.
+
+script_dir=$(cd "$(dirname "$0")" && pwd)
+cc=${CC:-cc}
+bin=$(mktemp -t seq_kernels_bench.XXXXXX)
+trap 'rm -f "$bin"' EXIT
+
+"$cc" -O2 -std=c11 -o "$bin" "$script_dir/benchmark_seq_kernels.c" "$script_dir/../src/seq_kernels.c"
+"$bin" "${1:-64}" "${2:-150}" "${3:-10}"
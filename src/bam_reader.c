@@ -31,6 +31,8 @@ DUCKDB_EXTENSION_EXTERN
 #include <htslib/hts.h>
 #include <htslib/kstring.h>
 
+#include "include/gff_name_index.h"
+
 /* ================================================================
  * Helpers
  * ================================================================ */
@@ -425,6 +427,15 @@ static void bam_read_bind(duckdb_bind_info info) {
         region = duckdb_get_varchar(region_val);
     if (region_val) duckdb_destroy_value(&region_val);
 
+    /* Gene/transcript names (region tokens or genes := [...]) via annotation := */
+    char name_err[512];
+    if (gff_name_index_bind_regions(info, "read_bam", &region, name_err, sizeof(name_err)) != 0) {
+        duckdb_bind_set_error(info, name_err);
+        duckdb_free(file_path);
+        if (region) duckdb_free(region);
+        return;
+    }
+
     /* Parse optional explicit index path */
     char *index_path = NULL;
     duckdb_value index_val = duckdb_bind_get_named_parameter(info, "index_path");
@@ -1050,6 +1061,10 @@ void register_read_bam_function(duckdb_connection connection) {
     duckdb_table_function_add_named_parameter(tf, "region", varchar_type);
     duckdb_table_function_add_named_parameter(tf, "index_path", varchar_type);
     duckdb_table_function_add_named_parameter(tf, "reference", varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "annotation", varchar_type);
+    duckdb_logical_type varchar_list_type = duckdb_create_list_type(varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "genes", varchar_list_type);
+    duckdb_destroy_logical_type(&varchar_list_type);
     duckdb_destroy_logical_type(&varchar_type);
 
     duckdb_logical_type bool_type = duckdb_create_logical_type(DUCKDB_TYPE_BOOLEAN);
@@ -11,6 +11,8 @@
  *   - Nullable fields with validity tracking
  *   - Parallel scan support for indexed files (CSI/TBI)
  *   - Region filtering
+ *   - Variant ID point lookups via a bcf_id_index() sidecar
+ *   - Batched site lookups (sites := ...) with per-cluster seek/stream choice
  *   - Projection pushdown
  *
  * Usage:
@@ -30,8 +32,13 @@ DUCKDB_EXTENSION_EXTERN
 
 #include "include/vcf_types.h"
 #include "include/vep_parser.h"
+#include "include/bcf_id_index.h"
+#include "include/file_cache.h"
+#include "include/file_offset.h"
+#include "include/gff_name_index.h"
 
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
@@ -42,6 +49,8 @@ DUCKDB_EXTENSION_EXTERN
 // htslib headers
 #include <htslib/vcf.h>
 #include <htslib/hts.h>
+#include <htslib/bgzf.h>
+#include <htslib/hts_endian.h>
 #include <htslib/hts_log.h>
 #include <htslib/synced_bcf_reader.h>
 #include <htslib/tbx.h>
@@ -55,6 +64,12 @@ DUCKDB_EXTENSION_EXTERN
 #define VEP_TRANSCRIPT_ALL 0
 #define VEP_TRANSCRIPT_FIRST 1
 
+// Sites closer than this are served by one streaming iterator instead of a
+// seek per site (one CSI/TBI linear-index window at the default min_shift)
+#define BCF_SITES_STREAM_GAP (1 << 14)
+#define BCF_SITES_MATCH_POSITION 0
+#define BCF_SITES_MATCH_ALLELE 1
+
 // Debug/progress tracking
 #define BCF_READER_PROGRESS_INTERVAL 100000  // Print progress every N records
 #define BCF_READER_ENABLE_PROGRESS 0
@@ -85,6 +100,26 @@ typedef struct {
     int duckdb_col_idx;      // Column index in DuckDB result
 } field_meta_t;
 
+// =============================================================================
+// Site Lookup Structures (sites := ...)
+// =============================================================================
+
+typedef struct {
+    int tid;                 // Header contig id
+    int64_t pos;             // 1-based position
+    char* ref;               // Only set for allele matching
+    char* alt;
+    char* key;               // Requesting key as given (owned)
+} bcf_site_t;
+
+typedef struct {
+    int tid;
+    int64_t beg;             // 0-based, inclusive
+    int64_t end;             // 0-based, exclusive
+    int first;               // Sites [first, last) served by this cluster
+    int last;
+} bcf_site_cluster_t;
+
 // =============================================================================
 // Bind Data - stores parameters and schema info
 // =============================================================================
@@ -95,6 +130,23 @@ typedef struct {
     char* region;              // Optional region filter
     char** regions;            // Parsed comma-separated regions
     unsigned int n_regions;
+
+    // Variant ID lookup (ids := / ids_file :=)
+    int id_mode;               // Resolve records through the ID sidecar
+    char** ids;                // Requested IDs, sorted (owned)
+    int n_ids;
+    uint64_t* id_offsets;      // Sorted unique BGZF virtual offsets to visit
+    int n_id_offsets;
+
+    // Batched site lookup (sites := list of keys or path to a sites file)
+    int sites_mode;
+    int sites_match;           // BCF_SITES_MATCH_*
+    bcf_site_t* sites;         // Sorted by (tid, pos)
+    int n_sites;
+    bcf_site_cluster_t* site_clusters;
+    int n_site_clusters;
+    char** site_contigs;       // Contig names by header tid (reference to contig_names)
+    int site_col_idx;          // Column index for SITE (-1 when not in sites mode)
     int include_info;          // Include INFO fields
     int include_format;        // Include FORMAT/sample fields
     int n_samples;             // Number of samples
@@ -137,6 +189,7 @@ typedef struct {
     int n_contigs;                // Total number of contigs
     char** contig_names;          // Contig names (reference to bind data)
     int has_region;               // User specified a region
+    volatile int current_site_cluster;  // Next site cluster to assign (atomic)
 } bcf_global_init_data_t;
 
 // =============================================================================
@@ -170,6 +223,15 @@ typedef struct {
     const char* contig_name;   // Name of assigned contig (reference, don't free)
     int needs_next_contig;     // Flag to request next contig assignment
     unsigned int next_region_idx; // Region cursor for chained region scans
+    int next_id_offset;        // Cursor into bind->id_offsets (ID lookup mode)
+
+    // Site lookup state
+    int site_cursor;           // Next site to merge against within the claimed cluster
+    int site_cluster_end;
+    int* site_hits;            // Sites matched by the buffered record
+    int site_n_hits;
+    int site_hits_cap;
+    int site_hit_next;         // Next hit to emit for the buffered record
     
     // Tidy format state: tracks which sample we're emitting for current record
     int tidy_current_sample;   // Current sample index in tidy mode (-1 = need to read next record)
@@ -242,6 +304,23 @@ static void destroy_bind_data(void* data) {
     if (bind->vep_schema) {
         vep_schema_destroy(bind->vep_schema);
     }
+
+    if (bind->ids) {
+        for (int i = 0; i < bind->n_ids; i++) {
+            if (bind->ids[i]) duckdb_free(bind->ids[i]);
+        }
+        duckdb_free(bind->ids);
+    }
+    if (bind->id_offsets) duckdb_free(bind->id_offsets);
+    if (bind->sites) {
+        for (int i = 0; i < bind->n_sites; i++) {
+            if (bind->sites[i].ref) duckdb_free(bind->sites[i].ref);
+            if (bind->sites[i].alt) duckdb_free(bind->sites[i].alt);
+            if (bind->sites[i].key) duckdb_free(bind->sites[i].key);
+        }
+        duckdb_free(bind->sites);
+    }
+    if (bind->site_clusters) duckdb_free(bind->site_clusters);
     
     duckdb_free(bind);
 }
@@ -265,6 +344,7 @@ static void destroy_init_data(void* data) {
     if (init->hdr) bcf_hdr_destroy(init->hdr);
     if (init->fp) hts_close(init->fp);
     if (init->column_ids) duckdb_free(init->column_ids);
+    if (init->site_hits) duckdb_free(init->site_hits);
     ks_free(&init->kstr);
     ks_free(&init->gt_kstr);
     
@@ -328,6 +408,452 @@ static void parse_regions_duckdb(const char *region_str, char ***out_regions, un
     *out_count = idx;
 }
 
+// =============================================================================
+// Variant ID Lookup Helpers
+// =============================================================================
+
+static int compare_id_strings(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static int push_id(char*** ids, int* n, int* cap, const char* s, size_t len) {
+    while (len > 0 && (s[len - 1] == ' ' || s[len - 1] == '\t' || s[len - 1] == '\r')) len--;
+    while (len > 0 && (*s == ' ' || *s == '\t')) { s++; len--; }
+    if (len == 0) return 0;
+    if (*n == *cap) {
+        int new_cap = *cap ? *cap * 2 : 64;
+        char** tmp = (char**)duckdb_malloc(sizeof(char*) * (size_t)new_cap);
+        if (!tmp) return -1;
+        if (*ids) {
+            memcpy(tmp, *ids, sizeof(char*) * (size_t)(*n));
+            duckdb_free(*ids);
+        }
+        *ids = tmp;
+        *cap = new_cap;
+    }
+    char* copy = (char*)duckdb_malloc(len + 1);
+    if (!copy) return -1;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    (*ids)[(*n)++] = copy;
+    return 0;
+}
+
+// Read one ID per line; blank lines and '#' comments are skipped.
+static int read_ids_file(const char* path, char*** ids, int* n, int* cap) {
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+    char line[4096];
+    while (fgets(line, sizeof(line), f)) {
+        size_t len = strcspn(line, "\n");
+        if (len == 0 || line[0] == '#') continue;
+        if (push_id(ids, n, cap, line, len) != 0) {
+            fclose(f);
+            return -1;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+// Sort and deduplicate requested IDs in place; the sorted array doubles as
+// the bsearch set used to verify records after seeking.
+static void sort_unique_ids(char** ids, int* n) {
+    if (*n <= 1) return;
+    qsort(ids, (size_t)*n, sizeof(char*), compare_id_strings);
+    int out = 1;
+    for (int i = 1; i < *n; i++) {
+        if (strcmp(ids[i], ids[out - 1]) == 0) {
+            duckdb_free(ids[i]);
+        } else {
+            ids[out++] = ids[i];
+        }
+    }
+    *n = out;
+}
+
+/**
+ * Resolve requested IDs to BGZF virtual offsets by binary search over the
+ * on-disk sidecar, so only O(log n) entries are touched per ID. A sidecar
+ * built from an earlier version of file_path is rejected.
+ */
+static int resolve_id_offsets(const char* sidecar, const char* file_path, char** ids, int n_ids,
+                              uint64_t** out_offsets, int* out_n, char* err, size_t err_len) {
+    uint8_t buf[BCF_ID_INDEX_HEADER_LEN];
+    FILE* f = fopen(sidecar, "rb");
+    *out_offsets = NULL;
+    *out_n = 0;
+    if (!f) {
+        snprintf(err, err_len, "read_bcf: ID lookup requires an ID index; run bcf_id_index() first (missing %s)", sidecar);
+        return -1;
+    }
+    if (fread(buf, 1, BCF_ID_INDEX_HEADER_LEN, f) != BCF_ID_INDEX_HEADER_LEN ||
+        memcmp(buf, BCF_ID_INDEX_MAGIC, BCF_ID_INDEX_MAGIC_LEN) != 0) {
+        snprintf(err, err_len, "read_bcf: %s is not a current bcf_id_index sidecar; rerun bcf_id_index()", sidecar);
+        fclose(f);
+        return -1;
+    }
+    uint64_t n_entries = le_to_u64(buf + BCF_ID_INDEX_MAGIC_LEN);
+    int64_t built_mtime = (int64_t)le_to_u64(buf + BCF_ID_INDEX_MAGIC_LEN + 8);
+    int64_t built_size = (int64_t)le_to_u64(buf + BCF_ID_INDEX_MAGIC_LEN + 16);
+    int64_t mtime, size;
+    if (built_mtime >= 0 && file_stamp(file_path, &mtime, &size) == 0 &&
+        (mtime != built_mtime || size != built_size)) {
+        snprintf(err, err_len, "read_bcf: ID index %s is out of date with %s; rerun bcf_id_index()", sidecar, file_path);
+        fclose(f);
+        return -1;
+    }
+
+    int n = 0, cap = 0;
+    uint64_t* offsets = NULL;
+    for (int i = 0; i < n_ids; i++) {
+        uint64_t h = bcf_id_hash(ids[i], strlen(ids[i]));
+        uint64_t lo = 0, hi = n_entries;
+        while (lo < hi) {
+            uint64_t mid = lo + (hi - lo) / 2;
+            if (file_seek64(f, (int64_t)(BCF_ID_INDEX_HEADER_LEN + mid * BCF_ID_INDEX_ENTRY_LEN), SEEK_SET) != 0 ||
+                fread(buf, 1, BCF_ID_INDEX_ENTRY_LEN, f) != BCF_ID_INDEX_ENTRY_LEN) {
+                goto read_error;
+            }
+            if (le_to_u64(buf) < h) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo >= n_entries) continue;
+        if (file_seek64(f, (int64_t)(BCF_ID_INDEX_HEADER_LEN + lo * BCF_ID_INDEX_ENTRY_LEN), SEEK_SET) != 0) {
+            goto read_error;
+        }
+        // Collect every entry with this hash (multi-record IDs and collisions)
+        while (fread(buf, 1, BCF_ID_INDEX_ENTRY_LEN, f) == BCF_ID_INDEX_ENTRY_LEN &&
+               le_to_u64(buf) == h) {
+            if (n == cap) {
+                int new_cap = cap ? cap * 2 : 64;
+                uint64_t* tmp = (uint64_t*)duckdb_malloc(sizeof(uint64_t) * (size_t)new_cap);
+                if (!tmp) goto read_error;
+                if (offsets) {
+                    memcpy(tmp, offsets, sizeof(uint64_t) * (size_t)n);
+                    duckdb_free(offsets);
+                }
+                offsets = tmp;
+                cap = new_cap;
+            }
+            offsets[n++] = le_to_u64(buf + 8);
+        }
+    }
+    fclose(f);
+
+    // Visit records in file order, once each
+    if (n > 1) {
+        qsort(offsets, (size_t)n, sizeof(uint64_t), compare_u64);
+        int out = 1;
+        for (int i = 1; i < n; i++) {
+            if (offsets[i] != offsets[out - 1]) offsets[out++] = offsets[i];
+        }
+        n = out;
+    }
+    *out_offsets = offsets;
+    *out_n = n;
+    return 0;
+
+read_error:
+    snprintf(err, err_len, "read_bcf: failed to read ID index %s", sidecar);
+    if (offsets) duckdb_free(offsets);
+    fclose(f);
+    return -1;
+}
+
+// True if any ';'-separated token of the record ID is in the requested set.
+static int record_matches_ids(const bcf_bind_data_t* bind, const char* id) {
+    char token[1024];
+    if (!id || (id[0] == '.' && id[1] == '\0')) return 0;
+    while (*id) {
+        const char* end = strchr(id, ';');
+        size_t len = end ? (size_t)(end - id) : strlen(id);
+        if (len > 0 && len < sizeof(token)) {
+            const char* key = token;
+            memcpy(token, id, len);
+            token[len] = '\0';
+            if (bsearch(&key, bind->ids, (size_t)bind->n_ids, sizeof(char*), compare_id_strings)) {
+                return 1;
+            }
+        }
+        if (!end) break;
+        id = end + 1;
+    }
+    return 0;
+}
+
+// =============================================================================
+// Site Lookup Helpers
+// =============================================================================
+
+static int is_all_digits(const char* s, size_t len) {
+    if (len == 0) return 0;
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] < '0' || s[i] > '9') return 0;
+    }
+    return 1;
+}
+
+static char* strndup_duckdb(const char* s, size_t len) {
+    char* copy = (char*)duckdb_malloc(len + 1);
+    if (copy) {
+        memcpy(copy, s, len);
+        copy[len] = '\0';
+    }
+    return copy;
+}
+
+/**
+ * Parse "chrom:pos" or "chrom:pos:ref:alt" (chrom may itself contain ':').
+ * Returns 0 on success, 1 if the contig is not in the header, -1 if malformed.
+ */
+static int parse_site_key(const char* key, int match, const bcf_hdr_t* hdr, bcf_site_t* site) {
+    const char* colon[4] = {NULL, NULL, NULL, NULL};
+    int n_colon = 0;
+    size_t key_len = strlen(key);
+    for (const char* p = key + key_len; p > key && n_colon < 4; p--) {
+        if (p[-1] == ':') colon[n_colon++] = p - 1;
+    }
+    memset(site, 0, sizeof(*site));
+
+    // Prefer the chrom:pos:ref:alt reading when the third-from-last field is numeric
+    const char* pos_s = NULL;
+    size_t pos_len = 0;
+    const char* chrom_end = NULL;
+    if (n_colon >= 3 && is_all_digits(colon[2] + 1, (size_t)(colon[1] - colon[2] - 1))) {
+        chrom_end = colon[2];
+        pos_s = colon[2] + 1;
+        pos_len = (size_t)(colon[1] - pos_s);
+        site->ref = strndup_duckdb(colon[1] + 1, (size_t)(colon[0] - colon[1] - 1));
+        site->alt = strndup_duckdb(colon[0] + 1, (size_t)(key + key_len - colon[0] - 1));
+    } else if (n_colon >= 1 && is_all_digits(colon[0] + 1, (size_t)(key + key_len - colon[0] - 1))) {
+        chrom_end = colon[0];
+        pos_s = colon[0] + 1;
+        pos_len = (size_t)(key + key_len - pos_s);
+    }
+    if (!chrom_end || chrom_end == key || pos_len == 0 || pos_len > 18 ||
+        (match == BCF_SITES_MATCH_ALLELE && (!site->ref || !site->alt))) {
+        if (site->ref) duckdb_free(site->ref);
+        if (site->alt) duckdb_free(site->alt);
+        site->ref = site->alt = NULL;
+        return -1;
+    }
+
+    char chrom[1024];
+    size_t chrom_len = (size_t)(chrom_end - key);
+    if (chrom_len >= sizeof(chrom)) chrom_len = sizeof(chrom) - 1;
+    memcpy(chrom, key, chrom_len);
+    chrom[chrom_len] = '\0';
+    site->tid = bcf_hdr_name2id(hdr, chrom);
+    site->pos = strtoll(pos_s, NULL, 10);
+    if (site->tid < 0 || site->pos < 1) {
+        if (site->ref) duckdb_free(site->ref);
+        if (site->alt) duckdb_free(site->alt);
+        site->ref = site->alt = NULL;
+        return site->tid < 0 ? 1 : -1;
+    }
+    site->key = strdup_duckdb(key);
+    return 0;
+}
+
+static int compare_sites(const void* a, const void* b) {
+    const bcf_site_t* x = (const bcf_site_t*)a;
+    const bcf_site_t* y = (const bcf_site_t*)b;
+    if (x->tid != y->tid) return x->tid < y->tid ? -1 : 1;
+    if (x->pos != y->pos) return x->pos < y->pos ? -1 : 1;
+    return strcmp(x->key, y->key);
+}
+
+/**
+ * Sort sites, drop duplicate keys and group neighbouring sites into clusters.
+ * Each cluster becomes one index query: isolated sites turn into a point
+ * seek, dense runs into a single sequential stream.
+ */
+static int build_site_clusters(bcf_bind_data_t* bind) {
+    if (bind->n_sites == 0) return 0;
+    qsort(bind->sites, (size_t)bind->n_sites, sizeof(bcf_site_t), compare_sites);
+
+    int out = 1;
+    for (int i = 1; i < bind->n_sites; i++) {
+        if (compare_sites(&bind->sites[i], &bind->sites[out - 1]) == 0) {
+            if (bind->sites[i].ref) duckdb_free(bind->sites[i].ref);
+            if (bind->sites[i].alt) duckdb_free(bind->sites[i].alt);
+            duckdb_free(bind->sites[i].key);
+        } else {
+            bind->sites[out++] = bind->sites[i];
+        }
+    }
+    bind->n_sites = out;
+
+    bind->site_clusters = (bcf_site_cluster_t*)duckdb_malloc(sizeof(bcf_site_cluster_t) * (size_t)bind->n_sites);
+    if (!bind->site_clusters) return -1;
+    int n = 0;
+    for (int i = 0; i < bind->n_sites; i++) {
+        const bcf_site_t* site = &bind->sites[i];
+        bcf_site_cluster_t* cur = n > 0 ? &bind->site_clusters[n - 1] : NULL;
+        if (cur && cur->tid == site->tid && site->pos - 1 - cur->end < BCF_SITES_STREAM_GAP) {
+            cur->end = site->pos;
+            cur->last = i + 1;
+        } else {
+            cur = &bind->site_clusters[n++];
+            cur->tid = site->tid;
+            cur->beg = site->pos - 1;
+            cur->end = site->pos;
+            cur->first = i;
+            cur->last = i + 1;
+        }
+    }
+    bind->n_site_clusters = n;
+    return 0;
+}
+
+static int push_site_key(bcf_bind_data_t* bind, int* cap, const char* key, const bcf_hdr_t* hdr,
+                         char* err, size_t err_len) {
+    if (bind->n_sites == *cap) {
+        int new_cap = *cap ? *cap * 2 : 256;
+        bcf_site_t* tmp = (bcf_site_t*)duckdb_malloc(sizeof(bcf_site_t) * (size_t)new_cap);
+        if (!tmp) {
+            snprintf(err, err_len, "read_bcf: out of memory reading sites");
+            return -1;
+        }
+        if (bind->sites) {
+            memcpy(tmp, bind->sites, sizeof(bcf_site_t) * (size_t)bind->n_sites);
+            duckdb_free(bind->sites);
+        }
+        bind->sites = tmp;
+        *cap = new_cap;
+    }
+    int rc = parse_site_key(key, bind->sites_match, hdr, &bind->sites[bind->n_sites]);
+    if (rc < 0) {
+        snprintf(err, err_len, bind->sites_match == BCF_SITES_MATCH_ALLELE ?
+                 "read_bcf: malformed site '%s' (expected chrom:pos:ref:alt)" :
+                 "read_bcf: malformed site '%s' (expected chrom:pos[:ref:alt])", key);
+        return -1;
+    }
+    if (rc == 0) bind->n_sites++;  // Sites on contigs absent from the header never match
+    return 0;
+}
+
+// Sites file: one site per line, either chrom:pos[:ref:alt] or
+// tab-separated CHROM POS [REF ALT]; blank lines and '#' comments are skipped.
+static int read_sites_file(bcf_bind_data_t* bind, int* cap, const char* path, const bcf_hdr_t* hdr,
+                           char* err, size_t err_len) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        snprintf(err, err_len, "read_bcf: failed to open sites file %s", path);
+        return -1;
+    }
+    char line[4096];
+    while (fgets(line, sizeof(line), f)) {
+        size_t len = strcspn(line, "\r\n");
+        line[len] = '\0';
+        if (len == 0 || line[0] == '#') continue;
+        for (size_t i = 0; i < len; i++) {
+            if (line[i] == '\t') line[i] = ':';
+        }
+        if (push_site_key(bind, cap, line, hdr, err, err_len) != 0) {
+            fclose(f);
+            return -1;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+static int record_has_alt(const bcf1_t* rec, const char* alt) {
+    for (int a = 1; a < rec->n_allele; a++) {
+        if (strcasecmp(rec->d.allele[a], alt) == 0) return 1;
+    }
+    return 0;
+}
+
+static int push_site_hit(bcf_init_data_t* init, int site_idx) {
+    if (init->site_n_hits == init->site_hits_cap) {
+        int new_cap = init->site_hits_cap ? init->site_hits_cap * 2 : 8;
+        int* tmp = (int*)duckdb_malloc(sizeof(int) * (size_t)new_cap);
+        if (!tmp) return -1;
+        if (init->site_hits) {
+            memcpy(tmp, init->site_hits, sizeof(int) * (size_t)init->site_n_hits);
+            duckdb_free(init->site_hits);
+        }
+        init->site_hits = tmp;
+        init->site_hits_cap = new_cap;
+    }
+    init->site_hits[init->site_n_hits++] = site_idx;
+    return 0;
+}
+
+/**
+ * Advance to the next record that matches at least one requested site,
+ * claiming site clusters from the shared cursor as each one is exhausted.
+ * Records and sites are merge-joined in coordinate order within a cluster.
+ * Returns 0 with init->site_hits filled, or -1 when all clusters are done.
+ */
+static int bcf_sites_next(const bcf_bind_data_t* bind, bcf_global_init_data_t* global, bcf_init_data_t* init) {
+    for (;;) {
+        if (!init->itr) {
+            int c = __sync_fetch_and_add(&global->current_site_cluster, 1);
+            if (c >= bind->n_site_clusters) return -1;
+            const bcf_site_cluster_t* cluster = &bind->site_clusters[c];
+            if (init->idx) {
+                init->itr = bcf_itr_queryi(init->idx, cluster->tid, cluster->beg, cluster->end);
+            } else if (init->tbx) {
+                int tbx_tid = tbx_name2id(init->tbx, bcf_hdr_id2name(init->hdr, cluster->tid));
+                if (tbx_tid >= 0) {
+                    init->itr = tbx_itr_queryi(init->tbx, tbx_tid, cluster->beg, cluster->end);
+                }
+            }
+            if (!init->itr) continue;
+            init->site_cursor = cluster->first;
+            init->site_cluster_end = cluster->last;
+        }
+
+        int ret;
+        if (init->tbx) {
+            ret = tbx_itr_next(init->fp, init->tbx, init->itr, &init->kstr);
+            if (ret >= 0) {
+                ret = vcf_parse1(&init->kstr, init->hdr, init->rec);
+                init->kstr.l = 0;
+            }
+        } else {
+            ret = bcf_itr_next(init->fp, init->itr, init->rec);
+        }
+
+        int64_t pos = init->rec->pos + 1;
+        while (ret >= 0 && init->site_cursor < init->site_cluster_end &&
+               bind->sites[init->site_cursor].pos < pos) {
+            init->site_cursor++;
+        }
+        if (ret < 0 || init->site_cursor >= init->site_cluster_end) {
+            // Cluster exhausted: stop streaming even if the iterator has more
+            hts_itr_destroy(init->itr);
+            init->itr = NULL;
+            continue;
+        }
+
+        init->site_n_hits = 0;
+        init->site_hit_next = 0;
+        if (bind->sites_match == BCF_SITES_MATCH_ALLELE) {
+            bcf_unpack(init->rec, BCF_UN_STR);
+        }
+        for (int j = init->site_cursor; j < init->site_cluster_end && bind->sites[j].pos == pos; j++) {
+            const bcf_site_t* site = &bind->sites[j];
+            if (bind->sites_match == BCF_SITES_MATCH_ALLELE &&
+                (strcasecmp(init->rec->d.allele[0], site->ref) != 0 || !record_has_alt(init->rec, site->alt))) {
+                continue;
+            }
+            if (push_site_hit(init, j) != 0) return -2;
+        }
+        if (init->site_n_hits > 0) return 0;
+    }
+}
+
 static int bcf_projection_unpack_mask(const bcf_bind_data_t* bind, const idx_t* column_ids, idx_t column_count) {
     int mask = 0;
     if (!bind || !column_ids) {
@@ -471,6 +997,15 @@ static void bcf_read_bind(duckdb_bind_info info) {
     }
     if (region_val) duckdb_destroy_value(&region_val);
 
+    // Gene/transcript names (region tokens or genes := [...]) via annotation :=
+    char name_err[512];
+    if (gff_name_index_bind_regions(info, "read_bcf", &region, name_err, sizeof(name_err)) != 0) {
+        duckdb_bind_set_error(info, name_err);
+        duckdb_free(file_path);
+        if (region) duckdb_free(region);
+        return;
+    }
+
     // Optional explicit index path
     char* index_path = NULL;
     duckdb_value idx_val = duckdb_bind_get_named_parameter(info, "index_path");
@@ -479,6 +1014,84 @@ static void bcf_read_bind(duckdb_bind_info info) {
     }
     if (idx_val) duckdb_destroy_value(&idx_val);
     
+    // Optional variant ID lookup: ids := [...] and/or ids_file := 'path'
+    int id_mode = 0;
+    char** ids = NULL;
+    int n_ids = 0, ids_cap = 0;
+    char* id_index_path = NULL;
+    int ids_error = 0;
+    duckdb_value ids_val = duckdb_bind_get_named_parameter(info, "ids");
+    if (ids_val && !duckdb_is_null_value(ids_val)) {
+        id_mode = 1;
+        idx_t n = duckdb_get_list_size(ids_val);
+        for (idx_t i = 0; i < n && !ids_error; i++) {
+            duckdb_value elem = duckdb_get_list_child(ids_val, i);
+            if (elem && !duckdb_is_null_value(elem)) {
+                char* s = duckdb_get_varchar(elem);
+                if (s) {
+                    if (push_id(&ids, &n_ids, &ids_cap, s, strlen(s)) != 0) ids_error = 1;
+                    duckdb_free(s);
+                }
+            }
+            if (elem) duckdb_destroy_value(&elem);
+        }
+    }
+    if (ids_val) duckdb_destroy_value(&ids_val);
+
+    duckdb_value ids_file_val = duckdb_bind_get_named_parameter(info, "ids_file");
+    if (ids_file_val && !duckdb_is_null_value(ids_file_val)) {
+        char* ids_file = duckdb_get_varchar(ids_file_val);
+        id_mode = 1;
+        if (!ids_error && read_ids_file(ids_file, &ids, &n_ids, &ids_cap) != 0) ids_error = 2;
+        if (ids_file) duckdb_free(ids_file);
+    }
+    if (ids_file_val) duckdb_destroy_value(&ids_file_val);
+
+    duckdb_value id_idx_val = duckdb_bind_get_named_parameter(info, "id_index_path");
+    if (id_idx_val && !duckdb_is_null_value(id_idx_val)) {
+        id_index_path = duckdb_get_varchar(id_idx_val);
+    }
+    if (id_idx_val) duckdb_destroy_value(&id_idx_val);
+
+    if (ids_error || (id_mode && region)) {
+        duckdb_bind_set_error(info, ids_error == 2 ? "read_bcf: failed to read ids_file" :
+                              ids_error ? "read_bcf: out of memory reading ids" :
+                              "read_bcf: ids/ids_file cannot be combined with region");
+        for (int i = 0; i < n_ids; i++) duckdb_free(ids[i]);
+        if (ids) duckdb_free(ids);
+        if (id_index_path) duckdb_free(id_index_path);
+        duckdb_free(file_path);
+        if (index_path) duckdb_free(index_path);
+        if (region) duckdb_free(region);
+        return;
+    }
+    sort_unique_ids(ids, &n_ids);
+
+    uint64_t* id_offsets = NULL;
+    int n_id_offsets = 0;
+    if (id_mode && n_ids > 0) {
+        char err[1024];
+        char* sidecar = id_index_path;
+        if (!sidecar) {
+            size_t len = strlen(file_path);
+            sidecar = (char*)duckdb_malloc(len + sizeof(BCF_ID_INDEX_SUFFIX));
+            memcpy(sidecar, file_path, len);
+            memcpy(sidecar + len, BCF_ID_INDEX_SUFFIX, sizeof(BCF_ID_INDEX_SUFFIX));
+        }
+        int rc = resolve_id_offsets(sidecar, file_path, ids, n_ids, &id_offsets, &n_id_offsets, err, sizeof(err));
+        duckdb_free(sidecar);
+        id_index_path = NULL;
+        if (rc != 0) {
+            duckdb_bind_set_error(info, err);
+            for (int i = 0; i < n_ids; i++) duckdb_free(ids[i]);
+            if (ids) duckdb_free(ids);
+            duckdb_free(file_path);
+            if (index_path) duckdb_free(index_path);
+            return;
+        }
+    }
+    if (id_index_path) duckdb_free(id_index_path);
+
     // Get optional tidy_format named parameter (default: false)
     int tidy_format = 0;
     duckdb_value tidy_val = duckdb_bind_get_named_parameter(info, "tidy_format");
@@ -496,6 +1109,9 @@ static void bcf_read_bind(duckdb_bind_info info) {
         duckdb_free(file_path);
         if (index_path) duckdb_free(index_path);
         if (region) duckdb_free(region);
+        for (int i = 0; i < n_ids; i++) duckdb_free(ids[i]);
+        if (ids) duckdb_free(ids);
+        if (id_offsets) duckdb_free(id_offsets);
         return;
     }
     
@@ -506,6 +1122,9 @@ static void bcf_read_bind(duckdb_bind_info info) {
         duckdb_free(file_path);
         if (index_path) duckdb_free(index_path);
         if (region) duckdb_free(region);
+        for (int i = 0; i < n_ids; i++) duckdb_free(ids[i]);
+        if (ids) duckdb_free(ids);
+        if (id_offsets) duckdb_free(id_offsets);
         return;
     }
     
@@ -516,6 +1135,74 @@ static void bcf_read_bind(duckdb_bind_info info) {
     bind->index_path = index_path;
     bind->region = region;
     parse_regions_duckdb(region, &bind->regions, &bind->n_regions);
+    bind->id_mode = id_mode;
+    bind->ids = ids;
+    bind->n_ids = n_ids;
+    bind->id_offsets = id_offsets;
+    bind->n_id_offsets = n_id_offsets;
+    bind->site_col_idx = -1;
+
+    // Optional batched site lookup: sites := ['chrom:pos[:ref:alt]', ...] or a sites file path
+    duckdb_value match_val = duckdb_bind_get_named_parameter(info, "match");
+    if (match_val && !duckdb_is_null_value(match_val)) {
+        char* match = duckdb_get_varchar(match_val);
+        if (match && strcmp(match, "allele") == 0) {
+            bind->sites_match = BCF_SITES_MATCH_ALLELE;
+        } else if (!match || strcmp(match, "position") != 0) {
+            duckdb_bind_set_error(info, "read_bcf: match must be 'position' or 'allele'");
+            if (match) duckdb_free(match);
+            duckdb_destroy_value(&match_val);
+            bcf_hdr_destroy(hdr);
+            hts_close(fp);
+            destroy_bind_data(bind);
+            return;
+        }
+        if (match) duckdb_free(match);
+    }
+    if (match_val) duckdb_destroy_value(&match_val);
+
+    duckdb_value sites_val = duckdb_bind_get_named_parameter(info, "sites");
+    if (sites_val && !duckdb_is_null_value(sites_val)) {
+        char err[1024];
+        int rc = 0, sites_cap = 0;
+        duckdb_logical_type sites_type = duckdb_get_value_type(sites_val);
+        bind->sites_mode = 1;
+        if (duckdb_get_type_id(sites_type) == DUCKDB_TYPE_LIST) {
+            idx_t n = duckdb_get_list_size(sites_val);
+            for (idx_t i = 0; i < n && rc == 0; i++) {
+                duckdb_value elem = duckdb_get_list_child(sites_val, i);
+                if (elem && !duckdb_is_null_value(elem)) {
+                    char* key = duckdb_get_varchar(elem);
+                    if (key) {
+                        rc = push_site_key(bind, &sites_cap, key, hdr, err, sizeof(err));
+                        duckdb_free(key);
+                    }
+                }
+                if (elem) duckdb_destroy_value(&elem);
+            }
+        } else {
+            char* sites_file = duckdb_get_varchar(sites_val);
+            rc = read_sites_file(bind, &sites_cap, sites_file ? sites_file : "", hdr, err, sizeof(err));
+            if (sites_file) duckdb_free(sites_file);
+        }
+        if (rc == 0 && (region || id_mode || tidy_format)) {
+            snprintf(err, sizeof(err), "read_bcf: sites cannot be combined with region, ids or tidy_format");
+            rc = -1;
+        }
+        if (rc == 0 && build_site_clusters(bind) != 0) {
+            snprintf(err, sizeof(err), "read_bcf: out of memory clustering sites");
+            rc = -1;
+        }
+        if (rc != 0) {
+            duckdb_bind_set_error(info, err);
+            duckdb_destroy_value(&sites_val);
+            bcf_hdr_destroy(hdr);
+            hts_close(fp);
+            destroy_bind_data(bind);
+            return;
+        }
+    }
+    if (sites_val) duckdb_destroy_value(&sites_val);
     bind->include_info = 1;
     bind->include_format = 1;
     bind->n_samples = bcf_hdr_nsamples(hdr);
@@ -758,6 +1445,13 @@ static void bcf_read_bind(duckdb_bind_info info) {
     }
     
     bind->total_columns = col_idx;
+
+    // SITE - VARCHAR, the requesting key (sites mode only; kept outside total_columns)
+    if (bind->sites_mode) {
+        bind->site_col_idx = col_idx;
+        duckdb_bind_add_result_column(info, "SITE", varchar_type);
+        col_idx++;
+    }
     
     // -------------------------------------------------------------------------
     // Check for index and extract contig names for parallel scanning
@@ -821,6 +1515,12 @@ static void bcf_read_bind(duckdb_bind_info info) {
     
     bcf_hdr_destroy(hdr);
     hts_close(fp);
+
+    if (bind->sites_mode && !bind->has_index) {
+        duckdb_bind_set_error(info, "read_bcf: sites lookup requires an index file (.tbi or .csi)");
+        destroy_bind_data(bind);
+        return;
+    }
     
     duckdb_bind_set_bind_data(info, bind, destroy_bind_data);
 }
@@ -836,7 +1536,8 @@ static void bcf_read_global_init(duckdb_init_info info) {
     memset(global, 0, sizeof(bcf_global_init_data_t));
     
     global->current_contig = 0;
-    global->has_region = (bind->n_regions > 0);
+    global->has_region = (bind->n_regions > 0 || bind->id_mode || bind->sites_mode);
+    global->current_site_cluster = 0;
     
     // Enable parallel scan if:
     // 1. Index exists
@@ -850,6 +1551,11 @@ static void bcf_read_global_init(duckdb_init_info info) {
         idx_t max_threads = bind->n_contigs;
         if (max_threads > 16) max_threads = 16;
         duckdb_init_set_max_threads(info, max_threads);
+    } else if (bind->sites_mode && bind->n_site_clusters > 1) {
+        // Site clusters are independent index queries; hand them out like contigs
+        idx_t max_threads = bind->n_site_clusters;
+        if (max_threads > 16) max_threads = 16;
+        duckdb_init_set_max_threads(info, max_threads);
     } else {
         // Single-threaded scan (single contig or no index)
         global->n_contigs = 0;
@@ -871,7 +1577,8 @@ static void bcf_read_local_init(duckdb_init_info info) {
     memset(local, 0, sizeof(bcf_init_data_t));
     
     // Check if we're in parallel mode based on bind data
-    int is_parallel = (bind->has_index && bind->n_contigs > 1 && bind->n_regions == 0);
+    int is_parallel = (bind->has_index && bind->n_contigs > 1 && bind->n_regions == 0 &&
+                       !bind->id_mode && !bind->sites_mode);
     
     // Initialize parallel scan state
     local->is_parallel = is_parallel;
@@ -901,7 +1608,7 @@ static void bcf_read_local_init(duckdb_init_info info) {
     
     // Load index for parallel scanning or region queries
     // Use *_load3 with HTS_IDX_SAVE_REMOTE for remote file support
-    if (is_parallel || bind->n_regions > 0) {
+    if (is_parallel || bind->n_regions > 0 || bind->sites_mode) {
         enum htsExactFormat fmt = hts_get_format(local->fp)->format;
         
         if (fmt == bcf) {
@@ -971,6 +1678,12 @@ static void bcf_read_local_init(duckdb_init_info info) {
         local->column_ids[i] = duckdb_init_get_column_index(info, i);
     }
     local->unpack_mask = bcf_projection_unpack_mask(bind, local->column_ids, local->column_count);
+    if (bind->id_mode) {
+        // ID verification after each seek needs the unpacked ID string
+        local->unpack_mask |= BCF_UN_STR;
+        local->next_id_offset = 0;
+        if (bind->n_id_offsets == 0) local->done = 1;
+    }
     local->need_vep = bcf_projection_needs_vep(bind, local->column_ids, local->column_count);
     
     // Store as local init data
@@ -1281,6 +1994,10 @@ static void bcf_read_function(duckdb_function_info info, duckdb_data_chunk outpu
     while (row_count < vector_size) {
         // In tidy mode, only read a new record when we've emitted all samples
         int need_read = 1;
+        if (bind->sites_mode && init->site_hit_next < init->site_n_hits) {
+            // Buffered record still matches further requested sites
+            need_read = 0;
+        }
         if (tidy_mode && init->tidy_record_valid) {
             // We have a buffered record - check if we still have samples to emit
             if (init->tidy_current_sample < bind->n_samples) {
@@ -1292,7 +2009,29 @@ static void bcf_read_function(duckdb_function_info info, duckdb_data_chunk outpu
         if (need_read) {
             int ret;
             
-            if (init->itr) {
+            if (bind->sites_mode) {
+                ret = bcf_sites_next(bind, global, init);
+                if (ret == -2) {
+                    duckdb_function_set_error(info, "read_bcf: out of memory matching sites");
+                    ret = -1;
+                }
+            } else if (bind->id_mode) {
+                // Seek to each candidate record and keep only true ID hits
+                ret = -1;
+                BGZF* bgzfp = hts_get_bgzfp(init->fp);
+                while (bgzfp && init->next_id_offset < bind->n_id_offsets) {
+                    uint64_t voffset = bind->id_offsets[init->next_id_offset++];
+                    if (bgzf_seek(bgzfp, (int64_t)voffset, SEEK_SET) < 0) {
+                        ret = -2;
+                        break;
+                    }
+                    ret = bcf_read(init->fp, init->hdr, init->rec);
+                    if (ret < 0) break;
+                    bcf_unpack(init->rec, BCF_UN_STR);
+                    if (record_matches_ids(bind, init->rec->d.id)) break;
+                    ret = -1;
+                }
+            } else if (init->itr) {
                 if (init->tbx) {
                     // VCF with tabix: read text line then parse
                     ret = tbx_itr_next(init->fp, init->tbx, init->itr, &init->kstr);
@@ -1731,6 +2470,10 @@ static void bcf_read_function(duckdb_function_info info, duckdb_data_chunk outpu
                     }
                 }
             }
+            else if (col_id == (idx_t)bind->site_col_idx) {
+                const bcf_site_t* site = &bind->sites[init->site_hits[init->site_hit_next]];
+                duckdb_vector_assign_string_element(vec, row_count, site->key);
+            }
             else if (tidy_mode && col_id == (idx_t)bind->sample_id_col_idx) {
                 // SAMPLE_ID column in tidy mode
                 duckdb_vector_assign_string_element(vec, row_count, bind->sample_names[current_sample]);
@@ -1987,6 +2730,9 @@ static void bcf_read_function(duckdb_function_info info, duckdb_data_chunk outpu
 
         row_count++;
         init->current_row++;
+        if (bind->sites_mode) {
+            init->site_hit_next++;
+        }
         
         // In tidy mode, advance to next sample (or mark record as consumed)
         if (tidy_mode) {
@@ -2063,6 +2809,17 @@ void register_read_bcf_function(duckdb_connection connection) {
     duckdb_table_function_add_named_parameter(tf, "region", varchar_type);  // optional region
     duckdb_table_function_add_named_parameter(tf, "index_path", varchar_type);  // optional explicit index path
     duckdb_table_function_add_named_parameter(tf, "tidy_format", bool_type);  // optional tidy format
+    duckdb_logical_type varchar_list_type = duckdb_create_list_type(varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "ids", varchar_list_type);  // optional variant ID lookup
+    duckdb_table_function_add_named_parameter(tf, "ids_file", varchar_type);  // optional file of IDs, one per line
+    duckdb_table_function_add_named_parameter(tf, "id_index_path", varchar_type);  // optional explicit ID sidecar path
+    duckdb_table_function_add_named_parameter(tf, "annotation", varchar_type);  // optional GTF/GFF for gene-name regions
+    duckdb_table_function_add_named_parameter(tf, "genes", varchar_list_type);  // optional gene/transcript names
+    duckdb_logical_type any_type = duckdb_create_logical_type(DUCKDB_TYPE_ANY);
+    duckdb_table_function_add_named_parameter(tf, "sites", any_type);  // optional site list or sites file
+    duckdb_table_function_add_named_parameter(tf, "match", varchar_type);  // 'position' (default) or 'allele'
+    duckdb_destroy_logical_type(&any_type);
+    duckdb_destroy_logical_type(&varchar_list_type);
     duckdb_destroy_logical_type(&varchar_type);
     duckdb_destroy_logical_type(&bool_type);
     
@@ -0,0 +1,1610 @@
+/**
+ * DuckHTS one-pass variant QC statistics (bcftools stats equivalent).
+ *
+ * bcf_stats(path, region := NULL, index_path := NULL)
+ *   -> long-format table keyed by section:
+ *        summary       record/variant-type counts, Ts, Tv and the Ts/Tv ratio
+ *        substitution  SNP substitution spectrum (key = 'A>G', ...)
+ *        indel_length  indel length histogram (bin = len(ALT) - len(REF))
+ *        qual          QUAL histogram (bin = floor(QUAL), capped)
+ *        depth         FORMAT/DP per genotype, or INFO/DP per site (key says which)
+ *        sample        per-sample hom_ref / het / hom_alt / missing / singletons
+ *
+ * Work items are contigs (indexed input) or user regions; scan threads claim
+ * them atomically, accumulate into thread-local counters and fold those into
+ * the shared totals when no work is left. The last thread out emits the rows.
+ *
+ * bcf_concordance(query_path, truth_path, regions := NULL, samples := NULL,
+ *                 reference := NULL)
+ *   -> TP/FP/FN with precision/recall/F1, overall, per sample and per
+ *      variant type (snp, indel, other), plus per-sample genotype
+ *      concordance matrices. Records are split per ALT allele and matched
+ *      after trimming; with a reference, indels are also left-aligned.
+ *      Contigs run in parallel like bcf_stats work items.
+ */
+
+#include "duckdb_extension.h"
+DUCKDB_EXTENSION_EXTERN
+
+#include <ctype.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <htslib/hts.h>
+#include <htslib/khash.h>
+#include <htslib/kstring.h>
+#include <htslib/tbx.h>
+#include <htslib/vcf.h>
+
+#include "include/ref_source.h"
+
+#define STATS_MAX_INDEL 60
+#define STATS_MAX_QUAL 999
+#define STATS_MAX_DP 500
+#define STATS_MAX_THREADS 16
+
+enum {
+    STATS_COL_SECTION = 0,
+    STATS_COL_SAMPLE,
+    STATS_COL_KEY,
+    STATS_COL_BIN,
+    STATS_COL_COUNT,
+    STATS_COL_VALUE,
+    STATS_COL_NCOLS
+};
+
+enum {
+    SUM_RECORDS = 0,
+    SUM_NO_ALTS,
+    SUM_SNPS,
+    SUM_MNPS,
+    SUM_INDELS,
+    SUM_OTHERS,
+    SUM_MULTIALLELIC,
+    SUM_MULTIALLELIC_SNPS,
+    SUM_TS,
+    SUM_TV,
+    SUM_COUNT
+};
+
+static const char *SUMMARY_KEYS[SUM_COUNT] = {
+    "records", "no_alts", "snps", "mnps", "indels", "others",
+    "multiallelic_sites", "multiallelic_snp_sites", "ts", "tv"
+};
+
+enum {
+    SMP_HOM_REF = 0,
+    SMP_HET,
+    SMP_HOM_ALT,
+    SMP_MISSING,
+    SMP_SINGLETONS,
+    SMP_COUNT
+};
+
+static const char *SAMPLE_KEYS[SMP_COUNT] = {
+    "hom_ref", "het", "hom_alt", "missing", "singletons"
+};
+
+/* All counters live in one flat int64 array so merging is a single loop. */
+typedef struct {
+    int64_t summary[SUM_COUNT];
+    int64_t subst[4][4];
+    int64_t indel[2 * STATS_MAX_INDEL + 1];
+    int64_t qual[STATS_MAX_QUAL + 1];
+    int64_t depth[STATS_MAX_DP + 1];
+} stats_site_counts_t;
+
+typedef struct {
+    char *file_path;
+    char *index_path;
+    char **items;          /* Regions or contigs to scan; NULL entry = whole file */
+    int n_items;
+    int use_index;
+    int n_samples;
+    char **sample_names;
+    int has_fmt_dp;
+    int has_info_dp;
+} stats_bind_data_t;
+
+typedef struct {
+    volatile int next_item;
+    volatile int active;
+    volatile int emit_claimed;
+    stats_site_counts_t site;
+    int64_t *samples;      /* n_samples * SMP_COUNT */
+} stats_global_data_t;
+
+typedef struct {
+    char section[16];
+    int sample;            /* -1 = not per-sample */
+    char key[32];
+    int has_bin;
+    int64_t bin;
+    int64_t count;
+    int has_value;
+    double value;
+} stats_row_t;
+
+typedef struct {
+    htsFile *fp;
+    bcf_hdr_t *hdr;
+    bcf1_t *rec;
+    hts_idx_t *idx;
+    tbx_t *tbx;
+    kstring_t kstr;
+    stats_site_counts_t site;
+    int64_t *samples;
+    int32_t *gt;
+    int n_gt;
+    int32_t *dp;
+    int n_dp;
+    int *allele_counts;
+    int *allele_carrier;
+    int n_allele_buf;
+    int registered;
+    int finished;
+    int is_emitter;
+    stats_row_t *rows;
+    idx_t n_rows;
+    idx_t row_offset;
+    idx_t *column_ids;
+    idx_t n_projected_cols;
+} stats_local_data_t;
+
+static char *stats_strdup(const char *s) {
+    size_t len;
+    char *copy;
+    if (!s) return NULL;
+    len = strlen(s) + 1;
+    copy = (char *)duckdb_malloc(len);
+    if (copy) memcpy(copy, s, len);
+    return copy;
+}
+
+static void destroy_stats_bind(void *data) {
+    stats_bind_data_t *bind = (stats_bind_data_t *)data;
+    if (!bind) return;
+    if (bind->file_path) duckdb_free(bind->file_path);
+    if (bind->index_path) duckdb_free(bind->index_path);
+    for (int i = 0; i < bind->n_items; i++) {
+        if (bind->items[i]) duckdb_free(bind->items[i]);
+    }
+    if (bind->items) duckdb_free(bind->items);
+    for (int i = 0; i < bind->n_samples; i++) {
+        if (bind->sample_names[i]) duckdb_free(bind->sample_names[i]);
+    }
+    if (bind->sample_names) duckdb_free(bind->sample_names);
+    duckdb_free(bind);
+}
+
+static void destroy_stats_global(void *data) {
+    stats_global_data_t *global = (stats_global_data_t *)data;
+    if (!global) return;
+    if (global->samples) duckdb_free(global->samples);
+    duckdb_free(global);
+}
+
+static void destroy_stats_local(void *data) {
+    stats_local_data_t *local = (stats_local_data_t *)data;
+    if (!local) return;
+    if (local->tbx) tbx_destroy(local->tbx);
+    if (local->idx) hts_idx_destroy(local->idx);
+    if (local->rec) bcf_destroy(local->rec);
+    if (local->hdr) bcf_hdr_destroy(local->hdr);
+    if (local->fp) hts_close(local->fp);
+    ks_free(&local->kstr);
+    free(local->gt);
+    free(local->dp);
+    if (local->samples) duckdb_free(local->samples);
+    if (local->allele_counts) duckdb_free(local->allele_counts);
+    if (local->allele_carrier) duckdb_free(local->allele_carrier);
+    if (local->rows) duckdb_free(local->rows);
+    if (local->column_ids) duckdb_free(local->column_ids);
+    duckdb_free(local);
+}
+
+static void add_items_from_regions(char ***items, int *n_items, const char *region) {
+    int count = 1;
+    for (const char *p = region; *p; p++) {
+        if (*p == ',') count++;
+    }
+    *items = (char **)duckdb_malloc(sizeof(char *) * (size_t)count);
+    *n_items = 0;
+    const char *start = region;
+    for (;;) {
+        const char *end = strchr(start, ',');
+        size_t len = end ? (size_t)(end - start) : strlen(start);
+        while (len > 0 && (*start == ' ' || *start == '\t')) { start++; len--; }
+        while (len > 0 && (start[len - 1] == ' ' || start[len - 1] == '\t')) len--;
+        if (len > 0) {
+            char *item = (char *)duckdb_malloc(len + 1);
+            memcpy(item, start, len);
+            item[len] = '\0';
+            (*items)[(*n_items)++] = item;
+        }
+        if (!end) break;
+        start = end + 1;
+    }
+}
+
+static void stats_bind(duckdb_bind_info info) {
+    duckdb_value val;
+    char *region = NULL;
+    char err[512];
+
+    val = duckdb_bind_get_parameter(info, 0);
+    char *path = duckdb_get_varchar(val);
+    duckdb_destroy_value(&val);
+    if (!path || path[0] == '\0') {
+        duckdb_bind_set_error(info, "bcf_stats requires a file path");
+        if (path) duckdb_free(path);
+        return;
+    }
+
+    stats_bind_data_t *bind = (stats_bind_data_t *)duckdb_malloc(sizeof(stats_bind_data_t));
+    memset(bind, 0, sizeof(stats_bind_data_t));
+    bind->file_path = path;
+
+    val = duckdb_bind_get_named_parameter(info, "region");
+    if (val && !duckdb_is_null_value(val)) region = duckdb_get_varchar(val);
+    if (val) duckdb_destroy_value(&val);
+
+    val = duckdb_bind_get_named_parameter(info, "index_path");
+    if (val && !duckdb_is_null_value(val)) bind->index_path = duckdb_get_varchar(val);
+    if (val) duckdb_destroy_value(&val);
+
+    htsFile *fp = hts_open(path, "r");
+    bcf_hdr_t *hdr = fp ? bcf_hdr_read(fp) : NULL;
+    if (!hdr) {
+        snprintf(err, sizeof(err), "bcf_stats: failed to read VCF/BCF header from %s", path);
+        duckdb_bind_set_error(info, err);
+        if (fp) hts_close(fp);
+        if (region) duckdb_free(region);
+        destroy_stats_bind(bind);
+        return;
+    }
+
+    bind->n_samples = bcf_hdr_nsamples(hdr);
+    if (bind->n_samples > 0) {
+        bind->sample_names = (char **)duckdb_malloc(sizeof(char *) * (size_t)bind->n_samples);
+        for (int i = 0; i < bind->n_samples; i++) {
+            bind->sample_names[i] = stats_strdup(hdr->samples[i]);
+        }
+    }
+    bind->has_fmt_dp = bcf_hdr_idinfo_exists(hdr, BCF_HL_FMT, bcf_hdr_id2int(hdr, BCF_DT_ID, "DP"));
+    bind->has_info_dp = bcf_hdr_idinfo_exists(hdr, BCF_HL_INFO, bcf_hdr_id2int(hdr, BCF_DT_ID, "DP"));
+
+    /* Work items: user regions, else one per contig when an index exists. */
+    enum htsExactFormat fmt = hts_get_format(fp)->format;
+    hts_idx_t *idx = NULL;
+    tbx_t *tbx = NULL;
+    if (fmt == bcf) {
+        idx = bcf_index_load3(path, bind->index_path, HTS_IDX_SILENT_FAIL);
+    } else {
+        tbx = tbx_index_load3(path, bind->index_path, HTS_IDX_SILENT_FAIL);
+        if (!tbx) idx = bcf_index_load3(path, bind->index_path, HTS_IDX_SILENT_FAIL);
+    }
+    bind->use_index = (idx || tbx);
+
+    if (region && region[0] != '\0') {
+        if (!bind->use_index) {
+            duckdb_bind_set_error(info, "bcf_stats: region requires an index file (.tbi or .csi)");
+            if (idx) hts_idx_destroy(idx);
+            if (tbx) tbx_destroy(tbx);
+            bcf_hdr_destroy(hdr);
+            hts_close(fp);
+            duckdb_free(region);
+            destroy_stats_bind(bind);
+            return;
+        }
+        add_items_from_regions(&bind->items, &bind->n_items, region);
+    } else if (bind->use_index && hdr->n[BCF_DT_CTG] > 1) {
+        int n_seqs = hdr->n[BCF_DT_CTG];
+        bind->items = (char **)duckdb_malloc(sizeof(char *) * (size_t)n_seqs);
+        for (int i = 0; i < n_seqs; i++) {
+            bind->items[bind->n_items++] = stats_strdup(hdr->id[BCF_DT_CTG][i].key);
+        }
+    } else {
+        bind->use_index = 0;
+        bind->items = (char **)duckdb_malloc(sizeof(char *));
+        bind->items[0] = NULL;
+        bind->n_items = 1;
+    }
+    if (idx) hts_idx_destroy(idx);
+    if (tbx) tbx_destroy(tbx);
+    bcf_hdr_destroy(hdr);
+    hts_close(fp);
+    if (region) duckdb_free(region);
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_logical_type double_type = duckdb_create_logical_type(DUCKDB_TYPE_DOUBLE);
+    duckdb_bind_add_result_column(info, "section", varchar_type);
+    duckdb_bind_add_result_column(info, "sample", varchar_type);
+    duckdb_bind_add_result_column(info, "key", varchar_type);
+    duckdb_bind_add_result_column(info, "bin", bigint_type);
+    duckdb_bind_add_result_column(info, "count", bigint_type);
+    duckdb_bind_add_result_column(info, "value", double_type);
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_logical_type(&double_type);
+
+    duckdb_bind_set_bind_data(info, bind, destroy_stats_bind);
+}
+
+static void stats_global_init(duckdb_init_info info) {
+    stats_bind_data_t *bind = (stats_bind_data_t *)duckdb_init_get_bind_data(info);
+    stats_global_data_t *global = (stats_global_data_t *)duckdb_malloc(sizeof(stats_global_data_t));
+    memset(global, 0, sizeof(stats_global_data_t));
+    if (bind->n_samples > 0) {
+        size_t n = (size_t)bind->n_samples * SMP_COUNT;
+        global->samples = (int64_t *)duckdb_malloc(n * sizeof(int64_t));
+        memset(global->samples, 0, n * sizeof(int64_t));
+    }
+
+    idx_t max_threads = (idx_t)bind->n_items;
+    if (max_threads > STATS_MAX_THREADS) max_threads = STATS_MAX_THREADS;
+    if (max_threads < 1) max_threads = 1;
+    duckdb_init_set_max_threads(info, max_threads);
+    duckdb_init_set_init_data(info, global, destroy_stats_global);
+}
+
+static void stats_local_init(duckdb_init_info info) {
+    stats_bind_data_t *bind = (stats_bind_data_t *)duckdb_init_get_bind_data(info);
+    stats_local_data_t *local = (stats_local_data_t *)duckdb_malloc(sizeof(stats_local_data_t));
+    memset(local, 0, sizeof(stats_local_data_t));
+
+    local->fp = hts_open(bind->file_path, "r");
+    local->hdr = local->fp ? bcf_hdr_read(local->fp) : NULL;
+    if (!local->hdr) {
+        duckdb_init_set_error(info, "bcf_stats: failed to open VCF/BCF file");
+        destroy_stats_local(local);
+        return;
+    }
+    local->rec = bcf_init();
+    if (bind->use_index) {
+        if (hts_get_format(local->fp)->format == bcf) {
+            local->idx = bcf_index_load3(bind->file_path, bind->index_path, HTS_IDX_SILENT_FAIL);
+        } else {
+            local->tbx = tbx_index_load3(bind->file_path, bind->index_path, HTS_IDX_SILENT_FAIL);
+            if (!local->tbx) {
+                local->idx = bcf_index_load3(bind->file_path, bind->index_path, HTS_IDX_SILENT_FAIL);
+            }
+        }
+    }
+    if (bind->n_samples > 0) {
+        size_t n = (size_t)bind->n_samples * SMP_COUNT;
+        local->samples = (int64_t *)duckdb_malloc(n * sizeof(int64_t));
+        memset(local->samples, 0, n * sizeof(int64_t));
+    }
+
+    local->n_projected_cols = duckdb_init_get_column_count(info);
+    local->column_ids = (idx_t *)duckdb_malloc(sizeof(idx_t) * local->n_projected_cols);
+    for (idx_t i = 0; i < local->n_projected_cols; i++) {
+        local->column_ids[i] = duckdb_init_get_column_index(info, i);
+    }
+    duckdb_init_set_init_data(info, local, destroy_stats_local);
+}
+
+static inline int base_index(char c) {
+    switch (c) {
+        case 'A': case 'a': return 0;
+        case 'C': case 'c': return 1;
+        case 'G': case 'g': return 2;
+        case 'T': case 't': return 3;
+        default: return -1;
+    }
+}
+
+static void accumulate_record(const stats_bind_data_t *bind, stats_local_data_t *local) {
+    bcf1_t *rec = local->rec;
+    stats_site_counts_t *site = &local->site;
+    int n_allele = rec->n_allele;
+    int n_snp_alts = 0;
+
+    bcf_unpack(rec, BCF_UN_ALL);
+    site->summary[SUM_RECORDS]++;
+
+    int types = bcf_get_variant_types(rec);
+    if (types == VCF_REF) site->summary[SUM_NO_ALTS]++;
+    if (types & VCF_SNP) site->summary[SUM_SNPS]++;
+    if (types & VCF_MNP) site->summary[SUM_MNPS]++;
+    if (types & VCF_INDEL) site->summary[SUM_INDELS]++;
+    if (types & (VCF_OTHER | VCF_BND | VCF_OVERLAP)) site->summary[SUM_OTHERS]++;
+    if (n_allele > 2) site->summary[SUM_MULTIALLELIC]++;
+
+    size_t ref_len = strlen(rec->d.allele[0]);
+    for (int a = 1; a < n_allele; a++) {
+        int type = bcf_get_variant_type(rec, a);
+        if (type == VCF_SNP) {
+            int r = base_index(rec->d.allele[0][0]);
+            int b = base_index(rec->d.allele[a][0]);
+            if (r < 0 || b < 0) continue;
+            n_snp_alts++;
+            site->subst[r][b]++;
+            /* A<->G and C<->T are transitions */
+            if ((r ^ b) == 2) site->summary[SUM_TS]++;
+            else site->summary[SUM_TV]++;
+        } else if (type == VCF_INDEL) {
+            int64_t len = (int64_t)strlen(rec->d.allele[a]) - (int64_t)ref_len;
+            if (len < -STATS_MAX_INDEL) len = -STATS_MAX_INDEL;
+            if (len > STATS_MAX_INDEL) len = STATS_MAX_INDEL;
+            site->indel[len + STATS_MAX_INDEL]++;
+        }
+    }
+    if (n_snp_alts > 1) site->summary[SUM_MULTIALLELIC_SNPS]++;
+
+    if (!bcf_float_is_missing(rec->qual) && !isnan(rec->qual)) {
+        int q = rec->qual < 0 ? 0 : (int)rec->qual;
+        if (q > STATS_MAX_QUAL) q = STATS_MAX_QUAL;
+        site->qual[q]++;
+    }
+
+    if (bind->has_fmt_dp && bind->n_samples > 0) {
+        int n = bcf_get_format_int32(local->hdr, rec, "DP", &local->dp, &local->n_dp);
+        for (int i = 0; i < n; i++) {
+            int32_t d = local->dp[i];
+            if (d == bcf_int32_missing || d == bcf_int32_vector_end || d < 0) continue;
+            local->site.depth[d > STATS_MAX_DP ? STATS_MAX_DP : d]++;
+        }
+    } else if (bind->has_info_dp) {
+        int n = bcf_get_info_int32(local->hdr, rec, "DP", &local->dp, &local->n_dp);
+        if (n > 0 && local->dp[0] != bcf_int32_missing && local->dp[0] >= 0) {
+            int32_t d = local->dp[0];
+            local->site.depth[d > STATS_MAX_DP ? STATS_MAX_DP : d]++;
+        }
+    }
+
+    if (bind->n_samples == 0) return;
+    int n_gt = bcf_get_genotypes(local->hdr, rec, &local->gt, &local->n_gt);
+    if (n_gt <= 0) return;
+    int ploidy = n_gt / bind->n_samples;
+
+    if (n_allele > local->n_allele_buf) {
+        if (local->allele_counts) duckdb_free(local->allele_counts);
+        if (local->allele_carrier) duckdb_free(local->allele_carrier);
+        local->allele_counts = (int *)duckdb_malloc(sizeof(int) * (size_t)n_allele);
+        local->allele_carrier = (int *)duckdb_malloc(sizeof(int) * (size_t)n_allele);
+        local->n_allele_buf = n_allele;
+    }
+    memset(local->allele_counts, 0, sizeof(int) * (size_t)n_allele);
+
+    for (int s = 0; s < bind->n_samples; s++) {
+        int32_t *g = local->gt + s * ploidy;
+        int n_called = 0, missing = 0, first = -1, all_same = 1, any_alt = 0;
+        for (int p = 0; p < ploidy; p++) {
+            if (g[p] == bcf_int32_vector_end) break;
+            if (bcf_gt_is_missing(g[p])) {
+                missing = 1;
+                continue;
+            }
+            int allele = bcf_gt_allele(g[p]);
+            if (allele < 0 || allele >= n_allele) continue;
+            if (first < 0) first = allele;
+            else if (allele != first) all_same = 0;
+            if (allele > 0) {
+                any_alt = 1;
+                local->allele_counts[allele]++;
+                local->allele_carrier[allele] = s;
+            }
+            n_called++;
+        }
+        int64_t *counts = local->samples + (size_t)s * SMP_COUNT;
+        if (missing || n_called == 0) counts[SMP_MISSING]++;
+        else if (!all_same) counts[SMP_HET]++;
+        else if (any_alt) counts[SMP_HOM_ALT]++;
+        else counts[SMP_HOM_REF]++;
+    }
+    /* An ALT allele seen exactly once is a singleton for its carrier. */
+    for (int a = 1; a < n_allele; a++) {
+        if (local->allele_counts[a] == 1) {
+            local->samples[(size_t)local->allele_carrier[a] * SMP_COUNT + SMP_SINGLETONS]++;
+        }
+    }
+}
+
+static int stats_read_next(stats_local_data_t *local, hts_itr_t *itr) {
+    int ret;
+    if (!itr) return bcf_read(local->fp, local->hdr, local->rec);
+    if (local->tbx) {
+        ret = tbx_itr_next(local->fp, local->tbx, itr, &local->kstr);
+        if (ret >= 0) {
+            ret = vcf_parse1(&local->kstr, local->hdr, local->rec);
+            local->kstr.l = 0;
+        }
+        return ret;
+    }
+    return bcf_itr_next(local->fp, itr, local->rec);
+}
+
+static int scan_items(const stats_bind_data_t *bind, stats_global_data_t *global, stats_local_data_t *local) {
+    for (;;) {
+        int item = __sync_fetch_and_add(&global->next_item, 1);
+        if (item >= bind->n_items) return 0;
+
+        hts_itr_t *itr = NULL;
+        const char *region = bind->items[item];
+        if (region) {
+            if (local->idx) itr = bcf_itr_querys(local->idx, local->hdr, region);
+            else if (local->tbx) itr = tbx_itr_querys(local->tbx, region);
+            if (!itr) continue;  /* Contig without records or unknown region */
+        }
+        int ret;
+        while ((ret = stats_read_next(local, itr)) >= 0) {
+            accumulate_record(bind, local);
+        }
+        if (itr) hts_itr_destroy(itr);
+        if (ret < -1) return -1;
+    }
+}
+
+static void merge_counts(int64_t *dst, const int64_t *src, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (src[i]) __sync_fetch_and_add(&dst[i], src[i]);
+    }
+}
+
+static stats_row_t *push_row(stats_local_data_t *local, idx_t *cap, const char *section,
+                             int sample, const char *key) {
+    if (local->n_rows == *cap) {
+        idx_t new_cap = *cap ? *cap * 2 : 256;
+        stats_row_t *tmp = (stats_row_t *)duckdb_malloc(sizeof(stats_row_t) * new_cap);
+        if (local->rows) {
+            memcpy(tmp, local->rows, sizeof(stats_row_t) * local->n_rows);
+            duckdb_free(local->rows);
+        }
+        local->rows = tmp;
+        *cap = new_cap;
+    }
+    stats_row_t *row = &local->rows[local->n_rows++];
+    memset(row, 0, sizeof(*row));
+    snprintf(row->section, sizeof(row->section), "%s", section);
+    snprintf(row->key, sizeof(row->key), "%s", key);
+    row->sample = sample;
+    return row;
+}
+
+static void push_histogram(stats_local_data_t *local, idx_t *cap, const char *section, const char *key,
+                           const int64_t *hist, int n, int64_t offset) {
+    for (int i = 0; i < n; i++) {
+        if (!hist[i]) continue;
+        stats_row_t *row = push_row(local, cap, section, -1, key);
+        row->has_bin = 1;
+        row->bin = (int64_t)i + offset;
+        row->count = hist[i];
+    }
+}
+
+static void build_rows(const stats_bind_data_t *bind, const stats_global_data_t *global, stats_local_data_t *local) {
+    static const char BASES[4] = {'A', 'C', 'G', 'T'};
+    const stats_site_counts_t *site = &global->site;
+    idx_t cap = 0;
+
+    for (int i = 0; i < SUM_COUNT; i++) {
+        push_row(local, &cap, "summary", -1, SUMMARY_KEYS[i])->count = site->summary[i];
+    }
+    stats_row_t *ratio = push_row(local, &cap, "summary", -1, "ts_tv");
+    ratio->count = site->summary[SUM_TS] + site->summary[SUM_TV];
+    if (site->summary[SUM_TV] > 0) {
+        ratio->has_value = 1;
+        ratio->value = (double)site->summary[SUM_TS] / (double)site->summary[SUM_TV];
+    }
+
+    for (int r = 0; r < 4; r++) {
+        for (int b = 0; b < 4; b++) {
+            if (r == b) continue;
+            char key[8];
+            snprintf(key, sizeof(key), "%c>%c", BASES[r], BASES[b]);
+            push_row(local, &cap, "substitution", -1, key)->count = site->subst[r][b];
+        }
+    }
+
+    push_histogram(local, &cap, "indel_length", "indel", site->indel, 2 * STATS_MAX_INDEL + 1, -STATS_MAX_INDEL);
+    push_histogram(local, &cap, "qual", "QUAL", site->qual, STATS_MAX_QUAL + 1, 0);
+    if (bind->has_fmt_dp && bind->n_samples > 0) {
+        push_histogram(local, &cap, "depth", "FORMAT/DP", site->depth, STATS_MAX_DP + 1, 0);
+    } else if (bind->has_info_dp) {
+        push_histogram(local, &cap, "depth", "INFO/DP", site->depth, STATS_MAX_DP + 1, 0);
+    }
+
+    for (int s = 0; s < bind->n_samples; s++) {
+        for (int k = 0; k < SMP_COUNT; k++) {
+            push_row(local, &cap, "sample", s, SAMPLE_KEYS[k])->count =
+                global->samples[(size_t)s * SMP_COUNT + k];
+        }
+    }
+}
+
+static void stats_function(duckdb_function_info info, duckdb_data_chunk output) {
+    stats_bind_data_t *bind = (stats_bind_data_t *)duckdb_function_get_bind_data(info);
+    stats_global_data_t *global = (stats_global_data_t *)duckdb_function_get_init_data(info);
+    stats_local_data_t *local = (stats_local_data_t *)duckdb_function_get_local_init_data(info);
+
+    if (!local || local->finished) {
+        duckdb_data_chunk_set_size(output, 0);
+        return;
+    }
+
+    if (!local->registered) {
+        local->registered = 1;
+        __sync_fetch_and_add(&global->active, 1);
+        int rc = scan_items(bind, global, local);
+        merge_counts((int64_t *)&global->site, (const int64_t *)&local->site,
+                     sizeof(stats_site_counts_t) / sizeof(int64_t));
+        if (bind->n_samples > 0) {
+            merge_counts(global->samples, local->samples, (size_t)bind->n_samples * SMP_COUNT);
+        }
+        int remaining = __sync_sub_and_fetch(&global->active, 1);
+        if (rc != 0) {
+            duckdb_function_set_error(info, "bcf_stats: failed to parse VCF/BCF record");
+            local->finished = 1;
+            duckdb_data_chunk_set_size(output, 0);
+            return;
+        }
+        /* All work items are claimed once any thread gets here, so the last
+         * thread to finish sees complete totals. */
+        if (remaining == 0 && __sync_bool_compare_and_swap(&global->emit_claimed, 0, 1)) {
+            local->is_emitter = 1;
+            build_rows(bind, global, local);
+        }
+    }
+
+    if (!local->is_emitter || local->row_offset >= local->n_rows) {
+        local->finished = 1;
+        duckdb_data_chunk_set_size(output, 0);
+        return;
+    }
+
+    idx_t n = local->n_rows - local->row_offset;
+    if (n > duckdb_vector_size()) n = duckdb_vector_size();
+    for (idx_t c = 0; c < local->n_projected_cols; c++) {
+        duckdb_vector vec = duckdb_data_chunk_get_vector(output, c);
+        idx_t col = local->column_ids[c];
+        for (idx_t i = 0; i < n; i++) {
+            const stats_row_t *row = &local->rows[local->row_offset + i];
+            switch (col) {
+                case STATS_COL_SECTION:
+                    duckdb_vector_assign_string_element(vec, i, row->section);
+                    break;
+                case STATS_COL_SAMPLE:
+                    if (row->sample >= 0) {
+                        duckdb_vector_assign_string_element(vec, i, bind->sample_names[row->sample]);
+                    } else {
+                        duckdb_vector_ensure_validity_writable(vec);
+                        duckdb_validity_set_row_invalid(duckdb_vector_get_validity(vec), i);
+                    }
+                    break;
+                case STATS_COL_KEY:
+                    duckdb_vector_assign_string_element(vec, i, row->key);
+                    break;
+                case STATS_COL_BIN:
+                    if (row->has_bin) {
+                        ((int64_t *)duckdb_vector_get_data(vec))[i] = row->bin;
+                    } else {
+                        duckdb_vector_ensure_validity_writable(vec);
+                        duckdb_validity_set_row_invalid(duckdb_vector_get_validity(vec), i);
+                    }
+                    break;
+                case STATS_COL_COUNT:
+                    ((int64_t *)duckdb_vector_get_data(vec))[i] = row->count;
+                    break;
+                case STATS_COL_VALUE:
+                    if (row->has_value) {
+                        ((double *)duckdb_vector_get_data(vec))[i] = row->value;
+                    } else {
+                        duckdb_vector_ensure_validity_writable(vec);
+                        duckdb_validity_set_row_invalid(duckdb_vector_get_validity(vec), i);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    local->row_offset += n;
+    duckdb_data_chunk_set_size(output, n);
+}
+
+void register_bcf_stats_function(duckdb_connection connection) {
+    duckdb_table_function tf = duckdb_create_table_function();
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+
+    duckdb_table_function_set_name(tf, "bcf_stats");
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "region", varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "index_path", varchar_type);
+    duckdb_table_function_set_bind(tf, stats_bind);
+    duckdb_table_function_set_init(tf, stats_global_init);
+    duckdb_table_function_set_local_init(tf, stats_local_init);
+    duckdb_table_function_set_function(tf, stats_function);
+    duckdb_table_function_supports_projection_pushdown(tf, true);
+    duckdb_register_table_function(connection, tf);
+    duckdb_destroy_table_function(&tf);
+
+    duckdb_destroy_logical_type(&varchar_type);
+}
+
+// =============================================================================
+// bcf_concordance
+// =============================================================================
+
+/*
+ * Both files are cut into the same work items (contigs with records in
+ * either index, or the user's regions) and scan threads claim them
+ * atomically, as in bcf_stats. Within an item the two files are read in
+ * position order and every record is split into one atom per ALT allele.
+ * An atom's REF/ALT are trimmed and, when a reference is given, simple
+ * indels are left-aligned (at most CONC_NORM_WINDOW bases, like
+ * bcftools norm's site window). Atoms wait in a buffer until both files
+ * have moved more than CONC_NORM_WINDOW past them. Then they are sorted, and
+ * identical (pos, REF, ALT) atoms from the two files pair up.
+ */
+
+#define CONC_NORM_WINDOW 1000
+#define CONC_FLUSH_MIN 4096
+#define CONC_REF_CHUNK 64
+
+enum {
+    CONC_COL_SECTION = 0,
+    CONC_COL_SAMPLE,
+    CONC_COL_VARIANT_TYPE,
+    CONC_COL_METRIC,
+    CONC_COL_TRUTH_GT,
+    CONC_COL_QUERY_GT,
+    CONC_COL_COUNT,
+    CONC_COL_VALUE,
+    CONC_COL_NCOLS
+};
+
+enum {
+    GT_CLASS_HOM_REF = 0,
+    GT_CLASS_HET,
+    GT_CLASS_HOM_ALT,
+    GT_CLASS_MISSING,
+    GT_CLASS_COUNT
+};
+
+static const char *GT_CLASS_NAMES[GT_CLASS_COUNT] = {"hom_ref", "het", "hom_alt", "missing"};
+
+/* Normalized atoms: same-length single base, any length change, the rest
+ * (MNPs and symbolic alleles). */
+enum {
+    VT_SNP = 0,
+    VT_INDEL,
+    VT_OTHER,
+    VT_COUNT
+};
+
+static const char *VT_NAMES[VT_COUNT] = {"snp", "indel", "other"};
+
+enum {
+    SITE_TP = 0,
+    SITE_FP,
+    SITE_FN,
+    SITE_COUNT
+};
+
+#define CONC_SAMPLE_SITE_LEN (VT_COUNT * SITE_COUNT)
+#define CONC_MATRIX_LEN (VT_COUNT * GT_CLASS_COUNT * GT_CLASS_COUNT)
+
+typedef struct {
+    int64_t site[VT_COUNT][SITE_COUNT];
+    int64_t *sample_site;   /* n_samples * CONC_SAMPLE_SITE_LEN */
+    int64_t *matrix;        /* n_samples * CONC_MATRIX_LEN, [type][truth][query] */
+} conc_counts_t;
+
+typedef struct {
+    char *paths[2];         /* 0 = query, 1 = truth */
+    char *reference;
+    char **items;           /* Contigs or regions */
+    int n_items;
+    int n_samples;          /* Samples compared (present in both files) */
+    char **sample_names;
+    int *sample_idx[2];
+} conc_bind_data_t;
+
+typedef struct {
+    volatile int next_item;
+    volatile int active;
+    volatile int emit_claimed;
+    conc_counts_t counts;
+} conc_global_data_t;
+
+typedef struct {
+    const char *section;
+    int sample;             /* -1 = not per-sample */
+    int variant_type;       /* -1 = all types */
+    const char *metric;
+    int truth_gt;           /* -1 = NULL */
+    int query_gt;
+    int64_t count;
+    int has_value;
+    double value;
+} conc_row_t;
+
+typedef struct {
+    htsFile *fp;
+    bcf_hdr_t *hdr;
+    hts_idx_t *idx;
+    tbx_t *tbx;
+    bcf1_t *rec;
+    kstring_t kstr;
+    hts_itr_t *itr;
+    int has_rec;
+    int32_t *gt;
+    int n_gt;
+} conc_stream_t;
+
+typedef struct {
+    hts_pos_t pos;          /* 0-based, after normalization */
+    char *ref;              /* Upper case; ref, alt and gt share one block */
+    char *alt;
+    uint8_t *gt;            /* GT class per compared sample for this ALT */
+    uint8_t type;
+    uint8_t source;         /* 0 = query, 1 = truth */
+} conc_atom_t;
+
+typedef struct {
+    conc_stream_t streams[2];
+    ref_source_t *ref;
+    int ref_id;             /* Reference sequence of the current item, -1 = none */
+    conc_atom_t *atoms;
+    size_t n_atoms;
+    size_t cap_atoms;
+    size_t flush_at;
+    kstring_t norm[2];
+    conc_counts_t counts;
+    int registered;
+    int finished;
+    int is_emitter;
+    conc_row_t *rows;
+    idx_t n_rows;
+    idx_t row_offset;
+    idx_t *column_ids;
+    idx_t n_projected_cols;
+} conc_local_data_t;
+
+static int64_t *conc_alloc_counts(int n_samples, size_t per_sample) {
+    size_t n = (size_t)(n_samples > 0 ? n_samples : 1) * per_sample;
+    int64_t *counts = (int64_t *)duckdb_malloc(n * sizeof(int64_t));
+    if (counts) memset(counts, 0, n * sizeof(int64_t));
+    return counts;
+}
+
+static void destroy_conc_bind(void *data) {
+    conc_bind_data_t *bind = (conc_bind_data_t *)data;
+    if (!bind) return;
+    for (int f = 0; f < 2; f++) {
+        if (bind->paths[f]) duckdb_free(bind->paths[f]);
+        if (bind->sample_idx[f]) duckdb_free(bind->sample_idx[f]);
+    }
+    if (bind->reference) duckdb_free(bind->reference);
+    for (int i = 0; i < bind->n_items; i++) {
+        if (bind->items[i]) duckdb_free(bind->items[i]);
+    }
+    if (bind->items) duckdb_free(bind->items);
+    for (int i = 0; i < bind->n_samples; i++) {
+        if (bind->sample_names[i]) duckdb_free(bind->sample_names[i]);
+    }
+    if (bind->sample_names) duckdb_free(bind->sample_names);
+    duckdb_free(bind);
+}
+
+static void destroy_conc_global(void *data) {
+    conc_global_data_t *global = (conc_global_data_t *)data;
+    if (!global) return;
+    if (global->counts.sample_site) duckdb_free(global->counts.sample_site);
+    if (global->counts.matrix) duckdb_free(global->counts.matrix);
+    duckdb_free(global);
+}
+
+static void conc_close_stream(conc_stream_t *st) {
+    if (st->itr) hts_itr_destroy(st->itr);
+    if (st->tbx) tbx_destroy(st->tbx);
+    if (st->idx) hts_idx_destroy(st->idx);
+    if (st->rec) bcf_destroy(st->rec);
+    if (st->hdr) bcf_hdr_destroy(st->hdr);
+    if (st->fp) hts_close(st->fp);
+    ks_free(&st->kstr);
+    free(st->gt);
+    memset(st, 0, sizeof(*st));
+}
+
+static void conc_free_atoms(conc_local_data_t *local, size_t from, size_t to) {
+    for (size_t i = from; i < to; i++) free(local->atoms[i].ref);
+}
+
+static void destroy_conc_local(void *data) {
+    conc_local_data_t *local = (conc_local_data_t *)data;
+    if (!local) return;
+    conc_close_stream(&local->streams[0]);
+    conc_close_stream(&local->streams[1]);
+    if (local->ref) ref_source_close(local->ref);
+    conc_free_atoms(local, 0, local->n_atoms);
+    free(local->atoms);
+    ks_free(&local->norm[0]);
+    ks_free(&local->norm[1]);
+    if (local->counts.sample_site) duckdb_free(local->counts.sample_site);
+    if (local->counts.matrix) duckdb_free(local->counts.matrix);
+    if (local->rows) duckdb_free(local->rows);
+    if (local->column_ids) duckdb_free(local->column_ids);
+    duckdb_free(local);
+}
+
+/* Header plus tabix or CSI/BAI-style index; both are required. */
+static int conc_open_stream(conc_stream_t *st, const char *path) {
+    st->fp = hts_open(path, "r");
+    st->hdr = st->fp ? bcf_hdr_read(st->fp) : NULL;
+    if (!st->hdr) return -1;
+    if (hts_get_format(st->fp)->format == bcf) {
+        st->idx = bcf_index_load3(path, NULL, HTS_IDX_SILENT_FAIL);
+    } else {
+        st->tbx = tbx_index_load3(path, NULL, HTS_IDX_SILENT_FAIL);
+        if (!st->tbx) st->idx = bcf_index_load3(path, NULL, HTS_IDX_SILENT_FAIL);
+    }
+    return st->idx || st->tbx ? 0 : -2;
+}
+
+static int conc_add_sample(conc_bind_data_t *bind, const bcf_hdr_t *qhdr, const bcf_hdr_t *thdr, const char *name) {
+    int qi = bcf_hdr_id2int(qhdr, BCF_DT_SAMPLE, name);
+    int ti = bcf_hdr_id2int(thdr, BCF_DT_SAMPLE, name);
+    if (qi < 0 || ti < 0) return -1;
+    bind->sample_names[bind->n_samples] = stats_strdup(name);
+    bind->sample_idx[0][bind->n_samples] = qi;
+    bind->sample_idx[1][bind->n_samples] = ti;
+    bind->n_samples++;
+    return 0;
+}
+
+KHASH_SET_INIT_STR(conc_name)
+
+/* Work items: every contig with records in either index, query order first. */
+static void conc_add_contig_items(conc_bind_data_t *bind, conc_stream_t *streams) {
+    const char **names[2] = {NULL, NULL};
+    int n_names[2] = {0, 0};
+    for (int f = 0; f < 2; f++) {
+        names[f] = streams[f].tbx ? tbx_seqnames(streams[f].tbx, &n_names[f])
+                                  : bcf_index_seqnames(streams[f].idx, streams[f].hdr, &n_names[f]);
+    }
+    bind->items = (char **)duckdb_malloc(sizeof(char *) * (size_t)(n_names[0] + n_names[1] + 1));
+    khash_t(conc_name) *seen = kh_init(conc_name);
+    for (int f = 0; f < 2; f++) {
+        for (int i = 0; i < n_names[f]; i++) {
+            int absent;
+            kh_put(conc_name, seen, names[f][i], &absent);
+            if (absent) bind->items[bind->n_items++] = stats_strdup(names[f][i]);
+        }
+    }
+    /* The keys point into the index name lists, so drop the set first. */
+    kh_destroy(conc_name, seen);
+    free(names[0]);
+    free(names[1]);
+}
+
+static void conc_bind(duckdb_bind_info info) {
+    duckdb_value val;
+    char err[512];
+    conc_stream_t streams[2];
+    memset(streams, 0, sizeof(streams));
+    conc_bind_data_t *bind = (conc_bind_data_t *)duckdb_malloc(sizeof(conc_bind_data_t));
+    memset(bind, 0, sizeof(conc_bind_data_t));
+
+    for (int f = 0; f < 2; f++) {
+        val = duckdb_bind_get_parameter(info, (idx_t)f);
+        bind->paths[f] = duckdb_get_varchar(val);
+        duckdb_destroy_value(&val);
+    }
+    if (!bind->paths[0] || !bind->paths[0][0] || !bind->paths[1] || !bind->paths[1][0]) {
+        duckdb_bind_set_error(info, "bcf_concordance requires query and truth file paths");
+        destroy_conc_bind(bind);
+        return;
+    }
+
+    char *regions = NULL;
+    val = duckdb_bind_get_named_parameter(info, "regions");
+    if (val && !duckdb_is_null_value(val)) regions = duckdb_get_varchar(val);
+    if (val) duckdb_destroy_value(&val);
+    val = duckdb_bind_get_named_parameter(info, "reference");
+    if (val && !duckdb_is_null_value(val)) bind->reference = duckdb_get_varchar(val);
+    if (val) duckdb_destroy_value(&val);
+
+    for (int f = 0; f < 2; f++) {
+        int rc = conc_open_stream(&streams[f], bind->paths[f]);
+        if (rc == -1) {
+            snprintf(err, sizeof(err), "bcf_concordance: failed to read VCF/BCF header from %s", bind->paths[f]);
+            duckdb_bind_set_error(info, err);
+            goto fail;
+        }
+        if (rc == -2) {
+            snprintf(err, sizeof(err), "bcf_concordance: %s has no index (.tbi or .csi)", bind->paths[f]);
+            duckdb_bind_set_error(info, err);
+            goto fail;
+        }
+    }
+    if (bind->reference) {
+        ref_source_t *ref = ref_source_open(bind->reference, NULL, err, sizeof(err));
+        if (!ref) {
+            duckdb_bind_set_error(info, err);
+            goto fail;
+        }
+        ref_source_close(ref);
+    }
+
+    const bcf_hdr_t *qhdr = streams[0].hdr, *thdr = streams[1].hdr;
+    int max_samples = bcf_hdr_nsamples(qhdr);
+    bind->sample_names = (char **)duckdb_malloc(sizeof(char *) * (size_t)(max_samples + 1));
+    bind->sample_idx[0] = (int *)duckdb_malloc(sizeof(int) * (size_t)(max_samples + 1));
+    bind->sample_idx[1] = (int *)duckdb_malloc(sizeof(int) * (size_t)(max_samples + 1));
+
+    val = duckdb_bind_get_named_parameter(info, "samples");
+    if (val && !duckdb_is_null_value(val)) {
+        idx_t n = duckdb_get_list_size(val);
+        for (idx_t i = 0; i < n; i++) {
+            duckdb_value elem = duckdb_get_list_child(val, i);
+            char *name = elem && !duckdb_is_null_value(elem) ? duckdb_get_varchar(elem) : NULL;
+            if (elem) duckdb_destroy_value(&elem);
+            if (!name) continue;
+            int dup = 0;
+            for (int s = 0; s < bind->n_samples; s++) {
+                if (strcmp(bind->sample_names[s], name) == 0) dup = 1;
+            }
+            if (!dup && (bind->n_samples >= max_samples || conc_add_sample(bind, qhdr, thdr, name) != 0)) {
+                snprintf(err, sizeof(err), "bcf_concordance: sample '%s' is not present in both files", name);
+                duckdb_bind_set_error(info, err);
+                duckdb_free(name);
+                duckdb_destroy_value(&val);
+                goto fail;
+            }
+            duckdb_free(name);
+        }
+    } else {
+        for (int i = 0; i < max_samples; i++) {
+            conc_add_sample(bind, qhdr, thdr, qhdr->samples[i]);
+        }
+    }
+    if (val) duckdb_destroy_value(&val);
+
+    if (regions && regions[0] != '\0') {
+        add_items_from_regions(&bind->items, &bind->n_items, regions);
+    } else {
+        conc_add_contig_items(bind, streams);
+    }
+    if (regions) duckdb_free(regions);
+    conc_close_stream(&streams[0]);
+    conc_close_stream(&streams[1]);
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_logical_type double_type = duckdb_create_logical_type(DUCKDB_TYPE_DOUBLE);
+    duckdb_bind_add_result_column(info, "section", varchar_type);
+    duckdb_bind_add_result_column(info, "sample", varchar_type);
+    duckdb_bind_add_result_column(info, "variant_type", varchar_type);
+    duckdb_bind_add_result_column(info, "metric", varchar_type);
+    duckdb_bind_add_result_column(info, "truth_gt", varchar_type);
+    duckdb_bind_add_result_column(info, "query_gt", varchar_type);
+    duckdb_bind_add_result_column(info, "count", bigint_type);
+    duckdb_bind_add_result_column(info, "value", double_type);
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_logical_type(&double_type);
+
+    duckdb_bind_set_bind_data(info, bind, destroy_conc_bind);
+    return;
+
+fail:
+    if (regions) duckdb_free(regions);
+    conc_close_stream(&streams[0]);
+    conc_close_stream(&streams[1]);
+    destroy_conc_bind(bind);
+}
+
+static void conc_global_init(duckdb_init_info info) {
+    conc_bind_data_t *bind = (conc_bind_data_t *)duckdb_init_get_bind_data(info);
+    conc_global_data_t *global = (conc_global_data_t *)duckdb_malloc(sizeof(conc_global_data_t));
+    memset(global, 0, sizeof(conc_global_data_t));
+    global->counts.sample_site = conc_alloc_counts(bind->n_samples, CONC_SAMPLE_SITE_LEN);
+    global->counts.matrix = conc_alloc_counts(bind->n_samples, CONC_MATRIX_LEN);
+
+    idx_t max_threads = (idx_t)bind->n_items;
+    if (max_threads > STATS_MAX_THREADS) max_threads = STATS_MAX_THREADS;
+    if (max_threads < 1) max_threads = 1;
+    duckdb_init_set_max_threads(info, max_threads);
+    duckdb_init_set_init_data(info, global, destroy_conc_global);
+}
+
+static void conc_local_init(duckdb_init_info info) {
+    conc_bind_data_t *bind = (conc_bind_data_t *)duckdb_init_get_bind_data(info);
+    conc_local_data_t *local = (conc_local_data_t *)duckdb_malloc(sizeof(conc_local_data_t));
+    memset(local, 0, sizeof(conc_local_data_t));
+    char err[512];
+
+    for (int f = 0; f < 2; f++) {
+        if (conc_open_stream(&local->streams[f], bind->paths[f]) != 0) {
+            duckdb_init_set_error(info, "bcf_concordance: failed to open indexed VCF/BCF file");
+            destroy_conc_local(local);
+            return;
+        }
+        local->streams[f].rec = bcf_init();
+    }
+    if (bind->reference && !(local->ref = ref_source_open(bind->reference, NULL, err, sizeof(err)))) {
+        duckdb_init_set_error(info, err);
+        destroy_conc_local(local);
+        return;
+    }
+    local->counts.sample_site = conc_alloc_counts(bind->n_samples, CONC_SAMPLE_SITE_LEN);
+    local->counts.matrix = conc_alloc_counts(bind->n_samples, CONC_MATRIX_LEN);
+    local->flush_at = CONC_FLUSH_MIN;
+
+    local->n_projected_cols = duckdb_init_get_column_count(info);
+    local->column_ids = (idx_t *)duckdb_malloc(sizeof(idx_t) * local->n_projected_cols);
+    for (idx_t i = 0; i < local->n_projected_cols; i++) {
+        local->column_ids[i] = duckdb_init_get_column_index(info, i);
+    }
+    duckdb_init_set_init_data(info, local, destroy_conc_local);
+}
+
+/* GT class relative to one ALT allele, as after a multiallelic split: other
+ * ALT alleles count as reference. */
+static int classify_gt(const int32_t *gt, int ploidy, int allele) {
+    int n_called = 0, n_alt = 0;
+    for (int p = 0; p < ploidy; p++) {
+        if (gt[p] == bcf_int32_vector_end) break;
+        if (bcf_gt_is_missing(gt[p])) return GT_CLASS_MISSING;
+        if (bcf_gt_allele(gt[p]) == allele) n_alt++;
+        n_called++;
+    }
+    if (n_called == 0) return GT_CLASS_MISSING;
+    if (n_alt == 0) return GT_CLASS_HOM_REF;
+    return n_alt == n_called ? GT_CLASS_HOM_ALT : GT_CLASS_HET;
+}
+
+static inline int conc_is_base(char c) { return c == 'A' || c == 'C' || c == 'G' || c == 'T'; }
+
+/*
+ * Shift a trimmed, anchored indel left while its last inserted/deleted base
+ * equals the anchor: long[] is the anchor followed by the indel bases and
+ * becomes the reference base before it followed by all but the last one.
+ */
+static void conc_left_align(conc_local_data_t *local, hts_pos_t *pos, char *lng, size_t n, char *shrt) {
+    char *chunk = NULL;
+    hts_pos_t chunk_beg = 0, chunk_len = 0, shifted = 0;
+    while (*pos > 0 && shifted < CONC_NORM_WINDOW && lng[n - 1] == lng[0]) {
+        hts_pos_t want = *pos - 1;
+        if (!chunk || want < chunk_beg) {
+            free(chunk);
+            chunk_beg = want >= CONC_REF_CHUNK ? want + 1 - CONC_REF_CHUNK : 0;
+            chunk = ref_source_fetch(local->ref, local->ref_id, chunk_beg, want + 1, &chunk_len);
+            if (!chunk || chunk_len != want + 1 - chunk_beg) break;
+        }
+        char b = (char)(chunk[want - chunk_beg] & 0xDF);
+        if (!conc_is_base(b)) break;
+        memmove(lng + 1, lng, n - 1);
+        lng[0] = b;
+        shrt[0] = b;
+        (*pos)--;
+        shifted++;
+    }
+    free(chunk);
+}
+
+/* Trim shared suffix then prefix (keeping one base each), classify, and
+ * left-align simple indels. ref/alt are upper-case and NUL-terminated. */
+static int conc_normalize(conc_local_data_t *local, hts_pos_t *pos, char **ref, char **alt) {
+    char *r = *ref, *a = *alt;
+    size_t rl = strlen(r), al = strlen(a);
+    if (a[0] == '<' || strchr(a, '[') || strchr(a, ']')) return VT_OTHER;
+    while (rl > 1 && al > 1 && r[rl - 1] == a[al - 1]) {
+        r[--rl] = '\0';
+        a[--al] = '\0';
+    }
+    while (rl > 1 && al > 1 && r[0] == a[0]) {
+        r++;
+        a++;
+        rl--;
+        al--;
+        (*pos)++;
+    }
+    *ref = r;
+    *alt = a;
+    if (rl == al) return rl == 1 ? VT_SNP : VT_OTHER;
+    if ((rl == 1 || al == 1) && r[0] == a[0] && local->ref && local->ref_id >= 0) {
+        if (rl > al) conc_left_align(local, pos, r, rl, a);
+        else conc_left_align(local, pos, a, al, r);
+    }
+    return VT_INDEL;
+}
+
+static int conc_push_atom(const conc_bind_data_t *bind, conc_local_data_t *local, int source, hts_pos_t pos,
+                          const char *ref, const char *alt, int type, const int32_t *gt, int ploidy, int allele) {
+    if (local->n_atoms == local->cap_atoms) {
+        size_t cap = local->cap_atoms ? local->cap_atoms * 2 : 256;
+        conc_atom_t *tmp = (conc_atom_t *)realloc(local->atoms, cap * sizeof(conc_atom_t));
+        if (!tmp) return -1;
+        local->atoms = tmp;
+        local->cap_atoms = cap;
+    }
+    size_t rl = strlen(ref) + 1, al = strlen(alt) + 1;
+    char *block = (char *)malloc(rl + al + (size_t)bind->n_samples);
+    if (!block) return -1;
+    conc_atom_t *atom = &local->atoms[local->n_atoms++];
+    atom->pos = pos;
+    atom->ref = block;
+    atom->alt = block + rl;
+    atom->gt = (uint8_t *)block + rl + al;
+    atom->type = (uint8_t)type;
+    atom->source = (uint8_t)source;
+    memcpy(atom->ref, ref, rl);
+    memcpy(atom->alt, alt, al);
+    for (int s = 0; s < bind->n_samples; s++) {
+        atom->gt[s] = (uint8_t)(ploidy > 0 ? classify_gt(gt + bind->sample_idx[source][s] * ploidy, ploidy, allele)
+                                           : GT_CLASS_MISSING);
+    }
+    return 0;
+}
+
+/* Split the current record of one stream into normalized atoms. */
+static int conc_add_record(const conc_bind_data_t *bind, conc_local_data_t *local, int source) {
+    conc_stream_t *st = &local->streams[source];
+    bcf1_t *rec = st->rec;
+    if (rec->n_allele < 2) return 0;   /* REF-only records are not calls */
+    if (bcf_unpack(rec, BCF_UN_STR) < 0) return -1;
+
+    int ploidy = 0;
+    if (bind->n_samples > 0) {
+        int n = bcf_get_genotypes(st->hdr, rec, &st->gt, &st->n_gt);
+        ploidy = n > 0 ? n / bcf_hdr_nsamples(st->hdr) : 0;
+    }
+    for (int a = 1; a < rec->n_allele; a++) {
+        const char *alt = rec->d.allele[a];
+        /* Spanning deletions and gVCF reference blocks stand for no allele. */
+        if (strcmp(alt, "*") == 0 || strcmp(alt, "<*>") == 0 || strcmp(alt, "<NON_REF>") == 0) continue;
+        kstring_t *kr = &local->norm[0], *ka = &local->norm[1];
+        kr->l = ka->l = 0;
+        if (kputs(rec->d.allele[0], kr) < 0 || kputs(alt, ka) < 0) return -1;
+        for (size_t i = 0; i < kr->l; i++) kr->s[i] = (char)toupper((unsigned char)kr->s[i]);
+        for (size_t i = 0; i < ka->l; i++) ka->s[i] = (char)toupper((unsigned char)ka->s[i]);
+        if (strcmp(kr->s, ka->s) == 0) continue;
+        hts_pos_t pos = rec->pos;
+        char *r = kr->s, *al = ka->s;
+        int type = conc_normalize(local, &pos, &r, &al);
+        if (conc_push_atom(bind, local, source, pos, r, al, type, st->gt, ploidy, a) < 0) return -1;
+    }
+    return 0;
+}
+
+static int compare_atoms(const void *pa, const void *pb) {
+    const conc_atom_t *a = (const conc_atom_t *)pa, *b = (const conc_atom_t *)pb;
+    if (a->pos != b->pos) return a->pos < b->pos ? -1 : 1;
+    int c = strcmp(a->ref, b->ref);
+    if (c) return c;
+    c = strcmp(a->alt, b->alt);
+    if (c) return c;
+    return (int)a->source - (int)b->source;
+}
+
+static inline int conc_carries(int gt_class) { return gt_class == GT_CLASS_HET || gt_class == GT_CLASS_HOM_ALT; }
+
+/* Count one paired (q and t), query-only or truth-only atom. */
+static void conc_count(const conc_bind_data_t *bind, conc_counts_t *counts, const conc_atom_t *q,
+                       const conc_atom_t *t) {
+    int type = (q ? q : t)->type;
+    counts->site[type][q && t ? SITE_TP : q ? SITE_FP : SITE_FN]++;
+    for (int s = 0; s < bind->n_samples; s++) {
+        int qc = q ? q->gt[s] : GT_CLASS_HOM_REF, tc = t ? t->gt[s] : GT_CLASS_HOM_REF;
+        int qcarry = conc_carries(qc), tcarry = conc_carries(tc);
+        if (qcarry || tcarry) {
+            int kind = qcarry && tcarry ? SITE_TP : qcarry ? SITE_FP : SITE_FN;
+            counts->sample_site[(size_t)s * CONC_SAMPLE_SITE_LEN + type * SITE_COUNT + kind]++;
+        }
+        if (q && t) {
+            counts->matrix[(size_t)s * CONC_MATRIX_LEN + (type * GT_CLASS_COUNT + tc) * GT_CLASS_COUNT + qc]++;
+        }
+    }
+}
+
+/* Match and count buffered atoms that start before frontier; no later
+ * record can normalize to a position before it. */
+static void conc_flush(const conc_bind_data_t *bind, conc_local_data_t *local, hts_pos_t frontier) {
+    if (local->n_atoms == 0) return;
+    qsort(local->atoms, local->n_atoms, sizeof(conc_atom_t), compare_atoms);
+    size_t done = 0;
+    while (done < local->n_atoms && local->atoms[done].pos < frontier) done++;
+
+    for (size_t i = 0; i < done;) {
+        /* Equal atoms sort query copies first: [i, split) query, [split, j) truth. */
+        size_t j = i + 1, split;
+        while (j < done && local->atoms[j].pos == local->atoms[i].pos &&
+               strcmp(local->atoms[j].ref, local->atoms[i].ref) == 0 &&
+               strcmp(local->atoms[j].alt, local->atoms[i].alt) == 0) {
+            j++;
+        }
+        for (split = i; split < j && local->atoms[split].source == 0; split++) {
+        }
+        size_t nq = split - i, nt = j - split;
+        for (size_t k = 0; k < nq || k < nt; k++) {
+            conc_count(bind, &local->counts, k < nq ? &local->atoms[i + k] : NULL,
+                       k < nt ? &local->atoms[split + k] : NULL);
+        }
+        i = j;
+    }
+    conc_free_atoms(local, 0, done);
+    memmove(local->atoms, local->atoms + done, (local->n_atoms - done) * sizeof(conc_atom_t));
+    local->n_atoms -= done;
+    local->flush_at = 2 * local->n_atoms + CONC_FLUSH_MIN;
+}
+
+static int conc_stream_next(conc_stream_t *st) {
+    int ret;
+    st->has_rec = 0;
+    if (!st->itr) return 0;
+    if (st->tbx) {
+        ret = tbx_itr_next(st->fp, st->tbx, st->itr, &st->kstr);
+        if (ret >= 0) {
+            ret = vcf_parse1(&st->kstr, st->hdr, st->rec);
+            st->kstr.l = 0;
+        }
+    } else {
+        ret = bcf_itr_next(st->fp, st->itr, st->rec);
+    }
+    if (ret >= 0) st->has_rec = 1;
+    return ret < -1 ? -1 : 0;
+}
+
+static int conc_scan_item(const conc_bind_data_t *bind, conc_local_data_t *local, const char *region) {
+    for (int f = 0; f < 2; f++) {
+        conc_stream_t *st = &local->streams[f];
+        if (st->itr) hts_itr_destroy(st->itr);
+        /* NULL when this file has no records on the contig */
+        st->itr = st->tbx ? tbx_itr_querys(st->tbx, region) : bcf_itr_querys(st->idx, st->hdr, region);
+        if (conc_stream_next(st) < 0) return -1;
+    }
+    local->ref_id = -1;
+    if (local->ref) {
+        const conc_stream_t *st = &local->streams[local->streams[0].has_rec ? 0 : 1];
+        if (st->has_rec) local->ref_id = ref_source_name2id(local->ref, bcf_hdr_id2name(st->hdr, st->rec->rid));
+    }
+
+    for (;;) {
+        conc_stream_t *q = &local->streams[0], *t = &local->streams[1];
+        if (!q->has_rec && !t->has_rec) break;
+        int source = !q->has_rec || (t->has_rec && t->rec->pos < q->rec->pos) ? 1 : 0;
+        if (conc_add_record(bind, local, source) < 0) return -1;
+        if (conc_stream_next(&local->streams[source]) < 0) return -1;
+        if (local->n_atoms >= local->flush_at) {
+            hts_pos_t next = q->has_rec ? q->rec->pos : HTS_POS_MAX;
+            if (t->has_rec && t->rec->pos < next) next = t->rec->pos;
+            if (next != HTS_POS_MAX) conc_flush(bind, local, next - CONC_NORM_WINDOW);
+        }
+    }
+    conc_flush(bind, local, HTS_POS_MAX);
+    return 0;
+}
+
+static int conc_scan_items(const conc_bind_data_t *bind, conc_global_data_t *global, conc_local_data_t *local) {
+    for (;;) {
+        int item = __sync_fetch_and_add(&global->next_item, 1);
+        if (item >= bind->n_items) return 0;
+        if (conc_scan_item(bind, local, bind->items[item]) < 0) return -1;
+    }
+}
+
+static conc_row_t *push_conc_row(conc_local_data_t *local, idx_t *cap, const char *section, int sample,
+                                 int variant_type, const char *metric) {
+    if (local->n_rows == *cap) {
+        idx_t new_cap = *cap ? *cap * 2 : 64;
+        conc_row_t *tmp = (conc_row_t *)duckdb_malloc(sizeof(conc_row_t) * new_cap);
+        if (local->rows) {
+            memcpy(tmp, local->rows, sizeof(conc_row_t) * local->n_rows);
+            duckdb_free(local->rows);
+        }
+        local->rows = tmp;
+        *cap = new_cap;
+    }
+    conc_row_t *row = &local->rows[local->n_rows++];
+    memset(row, 0, sizeof(*row));
+    row->section = section;
+    row->sample = sample;
+    row->variant_type = variant_type;
+    row->metric = metric;
+    row->truth_gt = -1;
+    row->query_gt = -1;
+    return row;
+}
+
+static void push_conc_ratio(conc_local_data_t *local, idx_t *cap, const char *section, int sample,
+                            int variant_type, const char *metric, int64_t num, int64_t den) {
+    conc_row_t *row = push_conc_row(local, cap, section, sample, variant_type, metric);
+    row->count = den;
+    if (den > 0) {
+        row->has_value = 1;
+        row->value = (double)num / (double)den;
+    }
+}
+
+/* TP/FP/FN with precision, recall and F1; site[] is indexed by SITE_*. */
+static void push_site_rows(conc_local_data_t *local, idx_t *cap, int sample, int variant_type, const int64_t *site) {
+    int64_t tp = site[SITE_TP], fp = site[SITE_FP], fn = site[SITE_FN];
+    push_conc_row(local, cap, "sites", sample, variant_type, "TP")->count = tp;
+    push_conc_row(local, cap, "sites", sample, variant_type, "FP")->count = fp;
+    push_conc_row(local, cap, "sites", sample, variant_type, "FN")->count = fn;
+    push_conc_ratio(local, cap, "sites", sample, variant_type, "precision", tp, tp + fp);
+    push_conc_ratio(local, cap, "sites", sample, variant_type, "recall", tp, tp + fn);
+    conc_row_t *f1 = push_conc_row(local, cap, "sites", sample, variant_type, "f1");
+    f1->count = tp;
+    if (2 * tp + fp + fn > 0) {
+        f1->has_value = 1;
+        f1->value = (double)(2 * tp) / (double)(2 * tp + fp + fn);
+    }
+}
+
+/* Site rows for all types (variant_type NULL) followed by one set per type. */
+static void push_site_groups(conc_local_data_t *local, idx_t *cap, int sample, const int64_t *by_type) {
+    int64_t total[SITE_COUNT] = {0, 0, 0};
+    for (int v = 0; v < VT_COUNT; v++) {
+        for (int k = 0; k < SITE_COUNT; k++) total[k] += by_type[v * SITE_COUNT + k];
+    }
+    push_site_rows(local, cap, sample, -1, total);
+    for (int v = 0; v < VT_COUNT; v++) push_site_rows(local, cap, sample, v, by_type + v * SITE_COUNT);
+}
+
+static void push_genotype_rows(conc_local_data_t *local, idx_t *cap, int sample, int variant_type, const int64_t *m) {
+    int64_t called = 0, agree = 0, nr_called = 0, nr_agree = 0;
+    for (int t = 0; t < GT_CLASS_COUNT; t++) {
+        for (int q = 0; q < GT_CLASS_COUNT; q++) {
+            int64_t c = m[t * GT_CLASS_COUNT + q];
+            conc_row_t *row = push_conc_row(local, cap, "genotype", sample, variant_type, "matrix");
+            row->truth_gt = t;
+            row->query_gt = q;
+            row->count = c;
+            if (t == GT_CLASS_MISSING || q == GT_CLASS_MISSING) continue;
+            called += c;
+            if (t == q) agree += c;
+            /* Non-reference concordance ignores hom_ref/hom_ref agreement */
+            if (!(t == GT_CLASS_HOM_REF && q == GT_CLASS_HOM_REF)) {
+                nr_called += c;
+                if (t == q) nr_agree += c;
+            }
+        }
+    }
+    push_conc_ratio(local, cap, "genotype", sample, variant_type, "concordance", agree, called);
+    push_conc_ratio(local, cap, "genotype", sample, variant_type, "non_ref_concordance", nr_agree, nr_called);
+}
+
+static void build_conc_rows(const conc_bind_data_t *bind, const conc_global_data_t *global, conc_local_data_t *local) {
+    const conc_counts_t *counts = &global->counts;
+    idx_t cap = 0;
+
+    push_site_groups(local, &cap, -1, &counts->site[0][0]);
+    for (int s = 0; s < bind->n_samples; s++) {
+        push_site_groups(local, &cap, s, counts->sample_site + (size_t)s * CONC_SAMPLE_SITE_LEN);
+    }
+    for (int s = 0; s < bind->n_samples; s++) {
+        const int64_t *m = counts->matrix + (size_t)s * CONC_MATRIX_LEN;
+        int64_t total[GT_CLASS_COUNT * GT_CLASS_COUNT];
+        memset(total, 0, sizeof(total));
+        for (int v = 0; v < VT_COUNT; v++) {
+            for (int k = 0; k < GT_CLASS_COUNT * GT_CLASS_COUNT; k++) total[k] += m[v * GT_CLASS_COUNT * GT_CLASS_COUNT + k];
+        }
+        push_genotype_rows(local, &cap, s, -1, total);
+        for (int v = 0; v < VT_COUNT; v++) {
+            push_genotype_rows(local, &cap, s, v, m + v * GT_CLASS_COUNT * GT_CLASS_COUNT);
+        }
+    }
+}
+
+static void conc_function(duckdb_function_info info, duckdb_data_chunk output) {
+    conc_bind_data_t *bind = (conc_bind_data_t *)duckdb_function_get_bind_data(info);
+    conc_global_data_t *global = (conc_global_data_t *)duckdb_function_get_init_data(info);
+    conc_local_data_t *local = (conc_local_data_t *)duckdb_function_get_local_init_data(info);
+
+    if (!local || local->finished) {
+        duckdb_data_chunk_set_size(output, 0);
+        return;
+    }
+
+    if (!local->registered) {
+        local->registered = 1;
+        __sync_fetch_and_add(&global->active, 1);
+        int rc = conc_scan_items(bind, global, local);
+        merge_counts(&global->counts.site[0][0], &local->counts.site[0][0], VT_COUNT * SITE_COUNT);
+        if (bind->n_samples > 0) {
+            merge_counts(global->counts.sample_site, local->counts.sample_site,
+                         (size_t)bind->n_samples * CONC_SAMPLE_SITE_LEN);
+            merge_counts(global->counts.matrix, local->counts.matrix, (size_t)bind->n_samples * CONC_MATRIX_LEN);
+        }
+        int remaining = __sync_sub_and_fetch(&global->active, 1);
+        if (rc != 0) {
+            duckdb_function_set_error(info, "bcf_concordance: failed to read VCF/BCF record");
+            local->finished = 1;
+            duckdb_data_chunk_set_size(output, 0);
+            return;
+        }
+        /* As in bcf_stats, the last thread out sees complete totals. */
+        if (remaining == 0 && __sync_bool_compare_and_swap(&global->emit_claimed, 0, 1)) {
+            local->is_emitter = 1;
+            build_conc_rows(bind, global, local);
+        }
+    }
+
+    if (!local->is_emitter || local->row_offset >= local->n_rows) {
+        local->finished = 1;
+        duckdb_data_chunk_set_size(output, 0);
+        return;
+    }
+
+    idx_t n = local->n_rows - local->row_offset;
+    if (n > duckdb_vector_size()) n = duckdb_vector_size();
+    for (idx_t c = 0; c < local->n_projected_cols; c++) {
+        duckdb_vector vec = duckdb_data_chunk_get_vector(output, c);
+        idx_t col = local->column_ids[c];
+        for (idx_t i = 0; i < n; i++) {
+            const conc_row_t *row = &local->rows[local->row_offset + i];
+            const char *str = NULL;
+            int is_null = 0;
+            switch (col) {
+                case CONC_COL_SECTION: str = row->section; break;
+                case CONC_COL_METRIC: str = row->metric; break;
+                case CONC_COL_SAMPLE:
+                    if (row->sample >= 0) str = bind->sample_names[row->sample];
+                    else is_null = 1;
+                    break;
+                case CONC_COL_VARIANT_TYPE:
+                    if (row->variant_type >= 0) str = VT_NAMES[row->variant_type];
+                    else is_null = 1;
+                    break;
+                case CONC_COL_TRUTH_GT:
+                    if (row->truth_gt >= 0) str = GT_CLASS_NAMES[row->truth_gt];
+                    else is_null = 1;
+                    break;
+                case CONC_COL_QUERY_GT:
+                    if (row->query_gt >= 0) str = GT_CLASS_NAMES[row->query_gt];
+                    else is_null = 1;
+                    break;
+                case CONC_COL_COUNT:
+                    ((int64_t *)duckdb_vector_get_data(vec))[i] = row->count;
+                    break;
+                case CONC_COL_VALUE:
+                    if (row->has_value) ((double *)duckdb_vector_get_data(vec))[i] = row->value;
+                    else is_null = 1;
+                    break;
+                default:
+                    break;
+            }
+            if (is_null) {
+                duckdb_vector_ensure_validity_writable(vec);
+                duckdb_validity_set_row_invalid(duckdb_vector_get_validity(vec), i);
+            } else if (str) {
+                duckdb_vector_assign_string_element(vec, i, str);
+            }
+        }
+    }
+    local->row_offset += n;
+    duckdb_data_chunk_set_size(output, n);
+}
+
+void register_bcf_concordance_function(duckdb_connection connection) {
+    duckdb_table_function tf = duckdb_create_table_function();
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type list_type = duckdb_create_list_type(varchar_type);
+
+    duckdb_table_function_set_name(tf, "bcf_concordance");
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "regions", varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "samples", list_type);
+    duckdb_table_function_add_named_parameter(tf, "reference", varchar_type);
+    duckdb_table_function_set_bind(tf, conc_bind);
+    duckdb_table_function_set_init(tf, conc_global_init);
+    duckdb_table_function_set_local_init(tf, conc_local_init);
+    duckdb_table_function_set_function(tf, conc_function);
+    duckdb_table_function_supports_projection_pushdown(tf, true);
+    duckdb_register_table_function(connection, tf);
+    duckdb_destroy_table_function(&tf);
+
+    duckdb_destroy_logical_type(&list_type);
+    duckdb_destroy_logical_type(&varchar_type);
+}
@@ -12,12 +12,16 @@ DUCKDB_EXTENSION_EXTERN
 
 /* bcf_reader.c */
 extern void register_read_bcf_function(duckdb_connection connection);
+/* bcf_stats.c */
+extern void register_bcf_stats_function(duckdb_connection connection);
+extern void register_bcf_concordance_function(duckdb_connection connection);
 /* bam_reader.c */
 extern void register_read_bam_function(duckdb_connection connection);
 /* seq_reader.c */
 extern void register_read_fasta_function(duckdb_connection connection);
 extern void register_read_fastq_function(duckdb_connection connection);
 extern void register_fasta_index_function(duckdb_connection connection);
+extern void register_fasta_to_2bit_function(duckdb_connection connection);
 /* interval_udf.c */
 extern void register_read_bed_function(duckdb_connection connection);
 extern void register_fasta_nuc_function(duckdb_connection connection);
@@ -28,12 +32,30 @@ extern void register_bgunzip_function(duckdb_connection connection);
 extern void register_bam_index_function(duckdb_connection connection);
 extern void register_bcf_index_function(duckdb_connection connection);
 extern void register_tabix_index_function(duckdb_connection connection);
+extern void register_bcf_id_index_function(duckdb_connection connection);
+extern void register_gff_name_index_function(duckdb_connection connection);
+/* interval_overlap.c */
+extern void register_interval_overlap_function(duckdb_connection connection);
+extern void register_interval_membership_functions(duckdb_connection connection);
+extern void register_interval_set_functions(duckdb_connection connection);
+extern void register_hts_bin_functions(duckdb_connection connection);
+extern void register_liftover_functions(duckdb_connection connection);
+/* fasta_fetch.c */
+extern void register_fasta_fetch_functions(duckdb_connection connection);
 /* kmer_udf.c */
 extern void register_kmer_udf_functions(duckdb_connection connection);
+/* kmer_count.c */
+extern void register_kmer_count_functions(duckdb_connection connection);
+/* minhash.c */
+extern void register_minhash_functions(duckdb_connection connection);
+/* minimizer.c */
+extern void register_minimizer_functions(duckdb_connection connection);
 /* tabix_reader.c */
 extern void register_read_tabix_function(duckdb_connection connection);
 extern void register_read_gtf_function(duckdb_connection connection);
 extern void register_read_gff_function(duckdb_connection connection);
+extern void register_gff_models_function(duckdb_connection connection);
+extern void register_annotate_consequence_function(duckdb_connection connection);
 /* hts_meta_reader.c */
 extern void register_read_hts_header_function(duckdb_connection connection);
 extern void register_read_hts_index_function(duckdb_connection connection);
@@ -52,21 +74,37 @@ DUCKDB_EXTENSION_ENTRYPOINT(duckdb_connection connection,
     (void)access;
 
     register_read_bcf_function(connection);
+    register_bcf_stats_function(connection);
+    register_bcf_concordance_function(connection);
     register_read_bam_function(connection);
     register_read_fasta_function(connection);
     register_read_fastq_function(connection);
     register_fasta_index_function(connection);
+    register_fasta_to_2bit_function(connection);
     register_read_bed_function(connection);
     register_fasta_nuc_function(connection);
+    register_interval_overlap_function(connection);
+    register_interval_membership_functions(connection);
+    register_interval_set_functions(connection);
+    register_hts_bin_functions(connection);
+    register_liftover_functions(connection);
+    register_fasta_fetch_functions(connection);
     register_bgzip_function(connection);
     register_bgunzip_function(connection);
     register_bam_index_function(connection);
     register_bcf_index_function(connection);
     register_tabix_index_function(connection);
+    register_bcf_id_index_function(connection);
+    register_gff_name_index_function(connection);
     register_kmer_udf_functions(connection);
+    register_kmer_count_functions(connection);
+    register_minhash_functions(connection);
+    register_minimizer_functions(connection);
     register_read_tabix_function(connection);
     register_read_gtf_function(connection);
     register_read_gff_function(connection);
+    register_gff_models_function(connection);
+    register_annotate_consequence_function(connection);
     register_read_hts_header_function(connection);
     register_read_hts_index_function(connection);
     run_sql_no_fail(connection,
@@ -0,0 +1,330 @@
+/**
+ * DuckHTS random-access reference lookups.
+ *
+ * fasta_fetch(chrom, start, end, path) -> VARCHAR
+ *   Reference bases in the 0-based, half-open interval [start, end), clamped
+ *   to the contig as faidx does; NULL for contigs missing from the FASTA.
+ * fasta_base(chrom, pos, path) -> VARCHAR
+ *   The single base at 1-based pos (as POS from read_bcf/read_bam); NULL
+ *   outside the contig.
+ *
+ * Bases are returned as stored, so soft-masking is preserved. path may be an
+ * indexed FASTA or a .2bit file.
+ *
+ * Scalar functions have no per-thread state in the C API, so reference handles
+ * are kept in a process-wide pool keyed by path (and re-validated against
+ * the file's mtime/size). A vector borrows one handle for its whole run and
+ * hands it back afterwards; the pool keeps a bounded number of idle handles
+ * per path and overall, closing the rest. Each handle carries a decoded window of the last
+ * contig segment it fetched, so position-sorted inputs are served from
+ * memory and only touch the file once per window. The window grows while
+ * lookups keep landing in it and shrinks back when they do not, so random
+ * access does not pay for decoding bases it never uses. .2bit handles skip
+ * the window and decode each lookup straight from the shared mapping.
+ */
+
+#include "duckdb_extension.h"
+DUCKDB_EXTENSION_EXTERN
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <htslib/kstring.h>
+
+#include "include/file_cache.h"
+#include "include/ref_source.h"
+#include "include/vector_access.h"
+
+#define FASTA_FETCH_MIN_WINDOW 64
+#define FASTA_FETCH_MAX_WINDOW (1 << 16)
+#define FASTA_FETCH_POOL_PER_PATH 16    /* idle handles kept per reference */
+#define FASTA_FETCH_POOL_MAX 64         /* idle handles kept in total */
+
+typedef struct fasta_handle_s {
+    char *path;
+    int64_t mtime;
+    int64_t size;
+    ref_source_t *ref;
+    bool twobit;
+
+    /* Decoded window of the last fetch (FASTA), or lookup scratch (.2bit) */
+    int win_id;
+    char *win;
+    size_t win_cap;
+    hts_pos_t win_beg;
+    hts_pos_t win_len;
+    hts_pos_t win_size;     /* bases to decode on the next miss */
+    int64_t win_hits;       /* lookups served by the current window */
+
+    struct fasta_handle_s *next;
+} fasta_handle_t;
+
+/* Idle handles; borrowed handles are owned by the executing vector. */
+static fasta_handle_t *fasta_handle_pool = NULL;
+static volatile int fasta_handle_lock = 0;
+
+static void fasta_pool_lock(void) {
+    file_cache_spin_lock(&fasta_handle_lock);
+}
+
+static void fasta_pool_unlock(void) {
+    file_cache_spin_unlock(&fasta_handle_lock);
+}
+
+static void fasta_handle_free(fasta_handle_t *h) {
+    if (!h) return;
+    ref_source_close(h->ref);
+    free(h->win);
+    free(h->path);
+    free(h);
+}
+
+/* Borrow an idle handle for path, dropping pooled handles whose file has
+ * changed, or open a new one. */
+static fasta_handle_t *fasta_handle_acquire(const char *fname, const char *path, char *err, size_t err_len) {
+    int64_t mtime, size;
+    file_stamp(path, &mtime, &size);
+
+    fasta_handle_t *found = NULL, *stale = NULL;
+    fasta_pool_lock();
+    fasta_handle_t **link = &fasta_handle_pool;
+    while (*link) {
+        fasta_handle_t *h = *link;
+        bool match = strcmp(h->path, path) == 0;
+        if (match && (h->mtime != mtime || h->size != size)) {
+            *link = h->next;
+            h->next = stale;
+            stale = h;
+        } else if (match && !found) {
+            *link = h->next;
+            found = h;
+        } else {
+            link = &h->next;
+        }
+    }
+    fasta_pool_unlock();
+    while (stale) {
+        fasta_handle_t *next = stale->next;
+        fasta_handle_free(stale);
+        stale = next;
+    }
+    if (found) {
+        found->next = NULL;
+        return found;
+    }
+
+    fasta_handle_t *h = (fasta_handle_t *)calloc(1, sizeof(fasta_handle_t));
+    if (!h) {
+        snprintf(err, err_len, "%s: out of memory", fname);
+        return NULL;
+    }
+    char open_err[512] = {0};
+    h->ref = ref_source_open(path, NULL, open_err, sizeof(open_err));
+    if (!h->ref) {
+        snprintf(err, err_len, "%s: %s", fname, open_err);
+        free(h);
+        return NULL;
+    }
+    h->twobit = ref_source_is_2bit(path);
+    h->win_id = -1;
+    h->path = strdup(path);
+    h->win_size = FASTA_FETCH_MAX_WINDOW;
+    h->mtime = mtime;
+    h->size = size;
+    return h;
+}
+
+/* Return a handle to the pool. Past FASTA_FETCH_POOL_PER_PATH idle handles
+ * for its path the handle is closed; past FASTA_FETCH_POOL_MAX in total the
+ * oldest idle handle is closed to make room. */
+static void fasta_handle_release(fasta_handle_t *h) {
+    if (!h) return;
+    fasta_handle_t *dead = NULL;
+    int same = 0, total = 0;
+    fasta_pool_lock();
+    fasta_handle_t **tail = &fasta_handle_pool;
+    for (fasta_handle_t **link = &fasta_handle_pool; *link; link = &(*link)->next) {
+        if (strcmp((*link)->path, h->path) == 0) same++;
+        total++;
+        tail = link;
+    }
+    if (same >= FASTA_FETCH_POOL_PER_PATH) {
+        dead = h;
+    } else {
+        if (total >= FASTA_FETCH_POOL_MAX) {
+            dead = *tail;
+            *tail = NULL;
+        }
+        h->next = fasta_handle_pool;
+        fasta_handle_pool = h;
+    }
+    fasta_pool_unlock();
+    fasta_handle_free(dead);
+}
+
+/* Bases [beg, end) of sequence id (already clamped to its length), served
+ * from the handle's window and refetched when not covered. NULL on a fetch
+ * error. */
+static const char *fasta_handle_get(fasta_handle_t *h, int id, hts_pos_t contig_len, hts_pos_t beg, hts_pos_t end) {
+    if (end <= beg) return "";
+    if (h->twobit) {
+        if ((size_t)(end - beg) > h->win_cap) {
+            char *grown = (char *)realloc(h->win, (size_t)(end - beg));
+            if (!grown) return NULL;
+            h->win = grown;
+            h->win_cap = (size_t)(end - beg);
+        }
+        if (ref_source_fetch_into(h->ref, id, beg, end, h->win) != 0) return NULL;
+        return h->win;
+    }
+    if (h->win && h->win_id == id && beg >= h->win_beg && end <= h->win_beg + h->win_len) {
+        h->win_hits++;
+        return h->win + (beg - h->win_beg);
+    }
+    if (h->win && h->win_hits > 1) {
+        h->win_size = h->win_size * 2 < FASTA_FETCH_MAX_WINDOW ? h->win_size * 2 : FASTA_FETCH_MAX_WINDOW;
+    } else {
+        h->win_size = h->win_size / 2 > FASTA_FETCH_MIN_WINDOW ? h->win_size / 2 : FASTA_FETCH_MIN_WINDOW;
+    }
+    h->win_hits = 1;
+    hts_pos_t fetch_end = end - beg < h->win_size ? beg + h->win_size : end;
+    if (fetch_end > contig_len) fetch_end = contig_len;
+    free(h->win);
+    hts_pos_t len = 0;
+    h->win = ref_source_fetch(h->ref, id, beg, fetch_end, &len);
+    if (!h->win || len < end - beg) {
+        free(h->win);
+        h->win = NULL;
+        h->win_id = -1;
+        return NULL;
+    }
+    h->win_id = id;
+    h->win_beg = beg;
+    h->win_len = len;
+    return h->win;
+}
+
+static inline void fetch_set_null(duckdb_vector vec, idx_t row) {
+    duckdb_vector_ensure_validity_writable(vec);
+    duckdb_validity_set_row_invalid(duckdb_vector_get_validity(vec), row);
+}
+
+/* Shared body of fasta_fetch and fasta_base. The contig is resolved once per
+ * run of equal chroms and the handle once per run of equal paths. */
+static void fasta_fetch_execute(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output,
+                                const char *fname, bool single_base) {
+    idx_t n_rows = duckdb_data_chunk_get_size(input);
+    duckdb_vector chrom_vec = duckdb_data_chunk_get_vector(input, 0);
+    duckdb_vector start_vec = duckdb_data_chunk_get_vector(input, 1);
+    duckdb_vector end_vec = single_base ? NULL : duckdb_data_chunk_get_vector(input, 2);
+    duckdb_vector path_vec = duckdb_data_chunk_get_vector(input, single_base ? 2 : 3);
+    const int64_t *starts = (const int64_t *)duckdb_vector_get_data(start_vec);
+    const int64_t *ends = end_vec ? (const int64_t *)duckdb_vector_get_data(end_vec) : NULL;
+
+    fasta_handle_t *h = NULL;
+    kstring_t path = {0, 0, NULL};
+    kstring_t chrom = {0, 0, NULL};
+    bool have_chrom = false;
+    int contig_id = -1;
+    hts_pos_t contig_len = -1;
+    char err[512];
+
+    for (idx_t row = 0; row < n_rows; row++) {
+        if (!row_is_valid(chrom_vec, row) || !row_is_valid(start_vec, row) ||
+            (end_vec && !row_is_valid(end_vec, row)) || !row_is_valid(path_vec, row)) {
+            fetch_set_null(output, row);
+            continue;
+        }
+
+        idx_t len;
+        const char *s = get_string_at(path_vec, row, &len);
+        if (!h || path.l != len || memcmp(path.s, s, len) != 0) {
+            fasta_handle_release(h);
+            path.l = 0;
+            kputsn(s, len, &path);
+            h = fasta_handle_acquire(fname, path.s, err, sizeof(err));
+            if (!h) {
+                duckdb_scalar_function_set_error(info, err);
+                break;
+            }
+            have_chrom = false;
+        }
+
+        s = get_string_at(chrom_vec, row, &len);
+        if (!have_chrom || chrom.l != len || memcmp(chrom.s, s, len) != 0) {
+            chrom.l = 0;
+            kputsn(s, len, &chrom);
+            contig_id = ref_source_name2id(h->ref, chrom.s);
+            contig_len = contig_id >= 0 ? ref_source_seq_len(h->ref, contig_id) : -1;
+            have_chrom = true;
+        }
+        if (contig_len < 0) {
+            fetch_set_null(output, row);
+            continue;
+        }
+
+        hts_pos_t beg, end;
+        if (single_base) {
+            if (starts[row] < 1 || starts[row] > contig_len) {
+                fetch_set_null(output, row);
+                continue;
+            }
+            beg = starts[row] - 1;
+            end = starts[row];
+        } else {
+            beg = starts[row] < 0 ? 0 : starts[row] > contig_len ? contig_len : starts[row];
+            end = ends[row] > contig_len ? contig_len : ends[row];
+            if (end < beg) end = beg;
+        }
+
+        const char *seq = fasta_handle_get(h, contig_id, contig_len, beg, end);
+        if (!seq) {
+            snprintf(err, sizeof(err), "%s: failed to fetch %s:%lld-%lld from %s", fname, chrom.s,
+                     (long long)beg + 1, (long long)end, path.s);
+            duckdb_scalar_function_set_error(info, err);
+            break;
+        }
+        duckdb_vector_assign_string_element_len(output, row, seq, (idx_t)(end - beg));
+    }
+
+    fasta_handle_release(h);
+    free(path.s);
+    free(chrom.s);
+}
+
+static void fasta_fetch_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output) {
+    fasta_fetch_execute(info, input, output, "fasta_fetch", false);
+}
+
+static void fasta_base_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output) {
+    fasta_fetch_execute(info, input, output, "fasta_base", true);
+}
+
+static void register_fasta_lookup_function(duckdb_connection connection, const char *name, bool single_base,
+                                           duckdb_scalar_function_t fn_ptr) {
+    duckdb_scalar_function fn = duckdb_create_scalar_function();
+    duckdb_scalar_function_set_name(fn, name);
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_scalar_function_add_parameter(fn, varchar_type);
+    duckdb_scalar_function_add_parameter(fn, bigint_type);
+    if (!single_base) duckdb_scalar_function_add_parameter(fn, bigint_type);
+    duckdb_scalar_function_add_parameter(fn, varchar_type);
+    duckdb_scalar_function_set_return_type(fn, varchar_type);
+    duckdb_scalar_function_set_function(fn, fn_ptr);
+
+    duckdb_register_scalar_function(connection, fn);
+
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_scalar_function(&fn);
+}
+
+void register_fasta_fetch_functions(duckdb_connection connection) {
+    register_fasta_lookup_function(connection, "fasta_fetch", false, fasta_fetch_scalar);
+    register_fasta_lookup_function(connection, "fasta_base", true, fasta_base_scalar);
+}
@@ -5,13 +5,24 @@
 #include "duckdb_extension.h"
 DUCKDB_EXTENSION_EXTERN
 
+#include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include <htslib/bgzf.h>
+#include <htslib/hts_endian.h>
 #include <htslib/sam.h>
 #include <htslib/tbx.h>
 #include <htslib/vcf.h>
+#include <htslib/kstring.h>
+#include <htslib/khash.h>
+
+#include "include/bcf_id_index.h"
+#include "include/file_cache.h"
+#include "include/file_offset.h"
+#include "include/gff_name_index.h"
 
 typedef struct {
     char *index_path;
@@ -211,6 +222,161 @@ static void bind_bcf_index(duckdb_bind_info info) {
     duckdb_free(path);
 }
 
+typedef struct {
+    uint64_t hash;
+    uint64_t voffset;
+} id_index_entry_t;
+
+static int compare_id_index_entry(const void *a, const void *b) {
+    const id_index_entry_t *x = (const id_index_entry_t *)a;
+    const id_index_entry_t *y = (const id_index_entry_t *)b;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    if (x->voffset != y->voffset) return x->voffset < y->voffset ? -1 : 1;
+    return 0;
+}
+
+static int write_id_index(const char *out_path, int64_t src_mtime, int64_t src_size, id_index_entry_t *entries,
+                          size_t n) {
+    uint8_t buf[BCF_ID_INDEX_HEADER_LEN];
+    FILE *out = fopen(out_path, "wb");
+    if (!out) return -1;
+
+    memcpy(buf, BCF_ID_INDEX_MAGIC, BCF_ID_INDEX_MAGIC_LEN);
+    u64_to_le((uint64_t)n, buf + BCF_ID_INDEX_MAGIC_LEN);
+    u64_to_le((uint64_t)src_mtime, buf + BCF_ID_INDEX_MAGIC_LEN + 8);
+    u64_to_le((uint64_t)src_size, buf + BCF_ID_INDEX_MAGIC_LEN + 16);
+    if (fwrite(buf, 1, BCF_ID_INDEX_HEADER_LEN, out) != BCF_ID_INDEX_HEADER_LEN) {
+        fclose(out);
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        u64_to_le(entries[i].hash, buf);
+        u64_to_le(entries[i].voffset, buf + 8);
+        if (fwrite(buf, 1, BCF_ID_INDEX_ENTRY_LEN, out) != BCF_ID_INDEX_ENTRY_LEN) {
+            fclose(out);
+            return -1;
+        }
+    }
+    return fclose(out) == 0 ? 0 : -1;
+}
+
+/* Scan every record once, hashing each ';'-separated ID against the BGZF
+ * virtual offset of the record start. */
+static int build_id_index(const char *path, const char *out_path, int64_t *n_out, char *err, size_t err_len) {
+    htsFile *fp = hts_open(path, "r");
+    bcf_hdr_t *hdr = NULL;
+    bcf1_t *rec = NULL;
+    BGZF *bgzfp;
+    id_index_entry_t *entries = NULL;
+    size_t n = 0, cap = 0;
+    int64_t src_mtime, src_size;
+    int ret = -1;
+
+    if (!fp) {
+        snprintf(err, err_len, "bcf_id_index: failed to open %s", path);
+        return -1;
+    }
+    file_stamp(path, &src_mtime, &src_size);
+    bgzfp = hts_get_bgzfp(fp);
+    if (!bgzfp || fp->format.compression != bgzf) {
+        snprintf(err, err_len, "bcf_id_index: %s must be BGZF-compressed (VCF.gz or BCF)", path);
+        goto cleanup;
+    }
+    hdr = bcf_hdr_read(fp);
+    if (!hdr) {
+        snprintf(err, err_len, "bcf_id_index: failed to read header of %s", path);
+        goto cleanup;
+    }
+    rec = bcf_init();
+
+    for (;;) {
+        uint64_t voffset = (uint64_t)bgzf_tell(bgzfp);
+        int r = bcf_read(fp, hdr, rec);
+        if (r < -1) {
+            snprintf(err, err_len, "bcf_id_index: failed to parse record in %s", path);
+            goto cleanup;
+        }
+        if (r < 0) break;
+        bcf_unpack(rec, BCF_UN_STR);
+
+        const char *id = rec->d.id;
+        if (!id || (id[0] == '.' && id[1] == '\0')) continue;
+        while (*id) {
+            const char *end = strchr(id, ';');
+            size_t len = end ? (size_t)(end - id) : strlen(id);
+            if (len > 0) {
+                if (n == cap) {
+                    size_t new_cap = cap ? cap * 2 : 4096;
+                    id_index_entry_t *tmp = (id_index_entry_t *)realloc(entries, new_cap * sizeof(*entries));
+                    if (!tmp) {
+                        snprintf(err, err_len, "bcf_id_index: out of memory");
+                        goto cleanup;
+                    }
+                    entries = tmp;
+                    cap = new_cap;
+                }
+                entries[n].hash = bcf_id_hash(id, len);
+                entries[n].voffset = voffset;
+                n++;
+            }
+            if (!end) break;
+            id = end + 1;
+        }
+    }
+
+    if (n > 0) qsort(entries, n, sizeof(*entries), compare_id_index_entry);
+    if (write_id_index(out_path, src_mtime, src_size, entries, n) != 0) {
+        snprintf(err, err_len, "bcf_id_index: failed to write %s", out_path);
+        goto cleanup;
+    }
+    *n_out = (int64_t)n;
+    ret = 0;
+
+cleanup:
+    free(entries);
+    if (rec) bcf_destroy(rec);
+    if (hdr) bcf_hdr_destroy(hdr);
+    hts_close(fp);
+    return ret;
+}
+
+static void bind_bcf_id_index(duckdb_bind_info info) {
+    duckdb_value path_val = duckdb_bind_get_parameter(info, 0);
+    char *path = duckdb_get_varchar(path_val);
+    char *index_path = NULL;
+    duckdb_value val;
+    int64_t n_ids = 0;
+    char err[512];
+
+    duckdb_destroy_value(&path_val);
+    if (!path || path[0] == '\0') {
+        duckdb_bind_set_error(info, "bcf_id_index requires a file path");
+        if (path) duckdb_free(path);
+        return;
+    }
+
+    val = duckdb_bind_get_named_parameter(info, "index_path");
+    if (val && !duckdb_is_null_value(val)) index_path = duckdb_get_varchar(val);
+    if (val) duckdb_destroy_value(&val);
+
+    if (!index_path) index_path = append_suffix(path, BCF_ID_INDEX_SUFFIX);
+
+    if (build_id_index(path, index_path, &n_ids, err, sizeof(err)) != 0) {
+        duckdb_bind_set_error(info, err);
+        duckdb_free(path);
+        duckdb_free(index_path);
+        return;
+    }
+
+    add_result_columns(info);
+    index_build_bind_t *bind = (index_build_bind_t *)duckdb_malloc(sizeof(index_build_bind_t));
+    bind->index_path = index_path;
+    bind->index_format = dup_string("IDS");
+    bind->emitted = 0;
+    duckdb_bind_set_bind_data(info, bind, destroy_index_build_bind);
+    duckdb_free(path);
+}
+
 static int parse_tbx_preset(const char *preset, tbx_conf_t *conf) {
     if (!preset || strcmp(preset, "vcf") == 0) {
         *conf = tbx_conf_vcf;
@@ -323,6 +489,445 @@ static void bind_tabix_index(duckdb_bind_info info) {
     if (preset) duckdb_free(preset);
 }
 
+/* ---- gff_name_index: annotation names -> regions ---- */
+
+KHASH_MAP_INIT_STR(name_span, size_t)
+
+typedef struct {
+    char *key;              /* name '\t' contig (owned) */
+    size_t name_len;
+    uint64_t start, end;    /* 0-based, half-open union */
+} name_span_t;
+
+static int compare_name_span(const void *a, const void *b) {
+    const name_span_t *x = (const name_span_t *)a;
+    const name_span_t *y = (const name_span_t *)b;
+    uint64_t hx = gff_name_hash(x->key, x->name_len), hy = gff_name_hash(y->key, y->name_len);
+    if (hx != hy) return hx < hy ? -1 : 1;
+    return strcmp(x->key, y->key);
+}
+
+static int is_name_key(const char *key, int len) {
+    static const char *const keys[] = {"ID", "Name", "gene", "gene_id", "gene_name", "transcript_id", "transcript_name"};
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        if ((int)strlen(keys[i]) == len && memcmp(key, keys[i], (size_t)len) == 0) return 1;
+    }
+    return 0;
+}
+
+/* Next attribute of a GTF (key "value";) or GFF3 (key=value;) column 9. */
+static int next_name_attr(const char **pp, const char *end, const char **key, int *key_len,
+                          const char **val, int *val_len) {
+    const char *p = *pp;
+    while (p < end && (*p == ' ' || *p == ';')) p++;
+    if (p >= end) return 0;
+    *key = p;
+    while (p < end && *p != ' ' && *p != '=' && *p != ';') p++;
+    *key_len = (int)(p - *key);
+    if (p < end && *p == '=') p++;
+    while (p < end && *p == ' ') p++;
+    if (p < end && *p == '"') {
+        *val = ++p;
+        while (p < end && *p != '"') p++;
+        *val_len = (int)(p - *val);
+    } else {
+        *val = p;
+        while (p < end && *p != ';') p++;
+        *val_len = (int)(p - *val);
+        while (*val_len > 0 && (*val)[*val_len - 1] == ' ') (*val_len)--;
+    }
+    while (p < end && *p != ';') p++;
+    *pp = p;
+    return 1;
+}
+
+static int add_name_span(khash_t(name_span) *h, name_span_t **spans, size_t *n, size_t *cap, kstring_t *key,
+                         size_t name_len, uint64_t start, uint64_t end) {
+    khint_t k = kh_get(name_span, h, key->s);
+    if (k != kh_end(h)) {
+        name_span_t *sp = &(*spans)[kh_val(h, k)];
+        if (start < sp->start) sp->start = start;
+        if (end > sp->end) sp->end = end;
+        return 0;
+    }
+    if (*n == *cap) {
+        size_t new_cap = *cap ? *cap * 2 : 4096;
+        name_span_t *tmp = (name_span_t *)realloc(*spans, new_cap * sizeof(name_span_t));
+        if (!tmp) return -1;
+        *spans = tmp;
+        *cap = new_cap;
+    }
+    name_span_t *sp = &(*spans)[*n];
+    sp->key = strdup(key->s);
+    if (!sp->key) return -1;
+    sp->name_len = name_len;
+    sp->start = start;
+    sp->end = end;
+    int absent = 0;
+    k = kh_put(name_span, h, sp->key, &absent);
+    kh_val(h, k) = (*n)++;
+    return 0;
+}
+
+static int write_name_index(const char *out_path, const char *src_path, int64_t src_mtime, int64_t src_size,
+                            const name_span_t *spans, size_t n) {
+    /* Pool: annotation path, then names per entry and contigs once each */
+    khash_t(name_span) *contigs = kh_init(name_span);
+    kstring_t pool = {0, 0, NULL};
+    uint64_t *name_off = (uint64_t *)malloc(sizeof(uint64_t) * (n ? n : 1));
+    uint64_t *contig_off = (uint64_t *)malloc(sizeof(uint64_t) * (n ? n : 1));
+    uint8_t buf[GFF_NAME_INDEX_ENTRY_LEN];
+    FILE *out = NULL;
+    int ret = -1;
+
+    if (!contigs || !name_off || !contig_off) goto cleanup;
+    kputs(src_path, &pool);
+    kputc('\0', &pool);
+    for (size_t i = 0; i < n; i++) {
+        const char *contig = spans[i].key + spans[i].name_len + 1;
+        name_off[i] = pool.l;
+        kputsn(spans[i].key, spans[i].name_len, &pool);
+        kputc('\0', &pool);
+        int absent = 0;
+        khint_t k = kh_put(name_span, contigs, contig, &absent);
+        if (absent) {
+            kh_val(contigs, k) = pool.l;
+            kputs(contig, &pool);
+            kputc('\0', &pool);
+        }
+        contig_off[i] = kh_val(contigs, k);
+    }
+
+    out = fopen(out_path, "wb");
+    if (!out) goto cleanup;
+    memcpy(buf, GFF_NAME_INDEX_MAGIC, GFF_NAME_INDEX_MAGIC_LEN);
+    u64_to_le((uint64_t)n, buf + GFF_NAME_INDEX_MAGIC_LEN);
+    u64_to_le((uint64_t)pool.l, buf + GFF_NAME_INDEX_MAGIC_LEN + 8);
+    u64_to_le((uint64_t)src_mtime, buf + GFF_NAME_INDEX_MAGIC_LEN + 16);
+    u64_to_le((uint64_t)src_size, buf + GFF_NAME_INDEX_MAGIC_LEN + 24);
+    if (fwrite(buf, 1, GFF_NAME_INDEX_HEADER_LEN, out) != GFF_NAME_INDEX_HEADER_LEN) goto cleanup;
+    for (size_t i = 0; i < n; i++) {
+        u64_to_le(gff_name_hash(spans[i].key, spans[i].name_len), buf);
+        u64_to_le(name_off[i], buf + 8);
+        u64_to_le(contig_off[i], buf + 16);
+        u64_to_le(spans[i].start, buf + 24);
+        u64_to_le(spans[i].end, buf + 32);
+        if (fwrite(buf, 1, GFF_NAME_INDEX_ENTRY_LEN, out) != GFF_NAME_INDEX_ENTRY_LEN) goto cleanup;
+    }
+    if (pool.l > 0 && fwrite(pool.s, 1, pool.l, out) != pool.l) goto cleanup;
+    ret = 0;
+
+cleanup:
+    if (out && fclose(out) != 0) ret = -1;
+    if (contigs) kh_destroy(name_span, contigs);
+    free(pool.s);
+    free(name_off);
+    free(contig_off);
+    return ret;
+}
+
+/* One pass over a GTF/GFF3 (plain or BGZF), unioning feature extents per
+ * (name, contig) for every name-like attribute value. */
+static int build_name_index(const char *path, const char *out_path, int64_t *n_out, char *err, size_t err_len) {
+    htsFile *fp = hts_open(path, "r");
+    kstring_t line = {0, 0, NULL}, key = {0, 0, NULL};
+    khash_t(name_span) *h = NULL;
+    name_span_t *spans = NULL;
+    size_t n = 0, cap = 0;
+    int64_t src_mtime, src_size;
+    int ret = -1, r;
+
+    if (!fp) {
+        snprintf(err, err_len, "gff_name_index: failed to open %s", path);
+        return -1;
+    }
+    /* Stamp before reading, so an edit during the build reads as stale */
+    file_stamp(path, &src_mtime, &src_size);
+    h = kh_init(name_span);
+    while ((r = hts_getline(fp, '\n', &line)) >= 0) {
+        if (line.l == 0 || line.s[0] == '#') {
+            if (strncmp(line.s, "##FASTA", 7) == 0) break;
+            continue;
+        }
+        const char *field[9];
+        int n_fields = 0;
+        field[n_fields++] = line.s;
+        for (char *p = line.s; *p && n_fields < 9; p++) {
+            if (*p == '\t') {
+                *p = '\0';
+                field[n_fields++] = p + 1;
+            }
+        }
+        if (n_fields < 9) continue;
+        char *endp = NULL;
+        long long start = strtoll(field[3], &endp, 10);
+        long long end = endp && *endp == '\0' ? strtoll(field[4], &endp, 10) : 0;
+        if (!endp || *endp != '\0' || start < 1 || end < start) continue;
+
+        const char *p = field[8], *attr_end = field[8] + strlen(field[8]);
+        const char *k, *v;
+        int k_len, v_len;
+        while (next_name_attr(&p, attr_end, &k, &k_len, &v, &v_len)) {
+            if (v_len == 0 || !is_name_key(k, k_len)) continue;
+            key.l = 0;
+            kputsn(v, (size_t)v_len, &key);
+            kputc('\t', &key);
+            kputs(field[0], &key);
+            if (add_name_span(h, &spans, &n, &cap, &key, (size_t)v_len, (uint64_t)(start - 1), (uint64_t)end) != 0) {
+                snprintf(err, err_len, "gff_name_index: out of memory");
+                goto cleanup;
+            }
+        }
+    }
+    if (r < -1) {
+        snprintf(err, err_len, "gff_name_index: failed to read %s", path);
+        goto cleanup;
+    }
+
+    if (n > 0) qsort(spans, n, sizeof(name_span_t), compare_name_span);
+    if (write_name_index(out_path, path, src_mtime, src_size, spans, n) != 0) {
+        snprintf(err, err_len, "gff_name_index: failed to write %s", out_path);
+        goto cleanup;
+    }
+    *n_out = (int64_t)n;
+    ret = 0;
+
+cleanup:
+    for (size_t i = 0; i < n; i++) free(spans[i].key);
+    free(spans);
+    if (h) kh_destroy(name_span, h);
+    free(line.s);
+    free(key.s);
+    hts_close(fp);
+    return ret;
+}
+
+static void bind_gff_name_index(duckdb_bind_info info) {
+    duckdb_value path_val = duckdb_bind_get_parameter(info, 0);
+    char *path = duckdb_get_varchar(path_val);
+    char *index_path = NULL;
+    duckdb_value val;
+    int64_t n_names = 0;
+    char err[512];
+
+    duckdb_destroy_value(&path_val);
+    if (!path || path[0] == '\0') {
+        duckdb_bind_set_error(info, "gff_name_index requires a file path");
+        if (path) duckdb_free(path);
+        return;
+    }
+
+    val = duckdb_bind_get_named_parameter(info, "index_path");
+    if (val && !duckdb_is_null_value(val)) index_path = duckdb_get_varchar(val);
+    if (val) duckdb_destroy_value(&val);
+
+    if (!index_path) index_path = append_suffix(path, GFF_NAME_INDEX_SUFFIX);
+
+    if (build_name_index(path, index_path, &n_names, err, sizeof(err)) != 0) {
+        duckdb_bind_set_error(info, err);
+        duckdb_free(path);
+        duckdb_free(index_path);
+        return;
+    }
+
+    add_result_columns(info);
+    index_build_bind_t *bind = (index_build_bind_t *)duckdb_malloc(sizeof(index_build_bind_t));
+    bind->index_path = index_path;
+    bind->index_format = dup_string("NAMES");
+    bind->emitted = 0;
+    duckdb_bind_set_bind_data(info, bind, destroy_index_build_bind);
+    duckdb_free(path);
+}
+
+/* Append "contig:start-end" for every entry called name, bracing contigs
+ * that contain ':'. Returns the number of matches, or -1 on a read error. */
+static int lookup_name(FILE *f, uint64_t n_entries, uint64_t pool_len, const char *name, kstring_t *out) {
+    uint8_t buf[GFF_NAME_INDEX_ENTRY_LEN];
+    uint64_t pool_base = GFF_NAME_INDEX_HEADER_LEN + n_entries * GFF_NAME_INDEX_ENTRY_LEN;
+    size_t name_len = strlen(name);
+    uint64_t h = gff_name_hash(name, name_len);
+    uint64_t lo = 0, hi = n_entries;
+    char *cmp = (char *)malloc(name_len + 1);
+    kstring_t contig = {0, 0, NULL};
+    int n = 0;
+
+    if (!cmp) return -1;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (file_seek64(f, (int64_t)(GFF_NAME_INDEX_HEADER_LEN + mid * GFF_NAME_INDEX_ENTRY_LEN), SEEK_SET) != 0 ||
+            fread(buf, 1, GFF_NAME_INDEX_ENTRY_LEN, f) != GFF_NAME_INDEX_ENTRY_LEN) {
+            goto read_error;
+        }
+        if (le_to_u64(buf) < h) lo = mid + 1;
+        else hi = mid;
+    }
+    for (uint64_t i = lo; i < n_entries; i++) {
+        if (file_seek64(f, (int64_t)(GFF_NAME_INDEX_HEADER_LEN + i * GFF_NAME_INDEX_ENTRY_LEN), SEEK_SET) != 0 ||
+            fread(buf, 1, GFF_NAME_INDEX_ENTRY_LEN, f) != GFF_NAME_INDEX_ENTRY_LEN) {
+            goto read_error;
+        }
+        if (le_to_u64(buf) != h) break;
+        /* Same hash: compare the pooled name (collisions). A colliding name
+         * too short to hold ours may end the pool, so never read past it. */
+        uint64_t name_off = le_to_u64(buf + 8);
+        if (name_off > pool_len || pool_len - name_off < name_len + 1) continue;
+        if (file_seek64(f, (int64_t)(pool_base + name_off), SEEK_SET) != 0 ||
+            fread(cmp, 1, name_len + 1, f) != name_len + 1) {
+            goto read_error;
+        }
+        if (memcmp(cmp, name, name_len + 1) != 0) continue;
+        if (file_seek64(f, (int64_t)(pool_base + le_to_u64(buf + 16)), SEEK_SET) != 0) goto read_error;
+        contig.l = 0;
+        int c;
+        while ((c = fgetc(f)) != EOF && c != '\0') kputc(c, &contig);
+        if (out->l > 0) kputc(',', out);
+        if (contig.l > 0 && strchr(contig.s, ':')) ksprintf(out, "{%s}", contig.s);
+        else kputs(contig.l > 0 ? contig.s : "", out);
+        ksprintf(out, ":%" PRIu64 "-%" PRIu64, le_to_u64(buf + 24) + 1, le_to_u64(buf + 32));
+        n++;
+    }
+    free(cmp);
+    free(contig.s);
+    return n;
+
+read_error:
+    free(cmp);
+    free(contig.s);
+    return -1;
+}
+
+/* Reject a sidecar whose annotation changed since it was built. The
+ * annotation is the one given, or else the path recorded in the sidecar;
+ * one that can no longer be stat'ed (moved, remote) is not checked. */
+static int check_name_index_source(FILE *f, const uint8_t *header, uint64_t n_entries, const char *annotation,
+                                   const char *fname, const char *sidecar, char *err, size_t err_len) {
+    int64_t built_mtime = (int64_t)le_to_u64(header + GFF_NAME_INDEX_MAGIC_LEN + 16);
+    int64_t built_size = (int64_t)le_to_u64(header + GFF_NAME_INDEX_MAGIC_LEN + 24);
+    kstring_t src = {0, 0, NULL};
+    int64_t mtime, size;
+    int ret = 0;
+
+    if (built_mtime < 0) return 0;
+    if (!ends_with(annotation, GFF_NAME_INDEX_SUFFIX)) {
+        kputs(annotation, &src);
+    } else if (file_seek64(f, (int64_t)(GFF_NAME_INDEX_HEADER_LEN + n_entries * GFF_NAME_INDEX_ENTRY_LEN), SEEK_SET) == 0) {
+        int c;
+        while ((c = fgetc(f)) != EOF && c != '\0') kputc(c, &src);
+    }
+    if (src.l > 0 && file_stamp(src.s, &mtime, &size) == 0 && (mtime != built_mtime || size != built_size)) {
+        snprintf(err, err_len, "%s: name index %s is out of date with %s; rerun gff_name_index()", fname, sidecar,
+                 src.s);
+        ret = -1;
+    }
+    free(src.s);
+    return ret;
+}
+
+int gff_name_index_bind_regions(duckdb_bind_info info, const char *fname, char **region,
+                                char *err, size_t err_len) {
+    char *annotation = NULL;
+    char *sidecar = NULL;
+    char **genes = NULL;
+    idx_t n_genes = 0;
+    kstring_t out = {0, 0, NULL};
+    FILE *f = NULL;
+    uint8_t buf[GFF_NAME_INDEX_HEADER_LEN];
+    int ret = -1;
+
+    duckdb_value val = duckdb_bind_get_named_parameter(info, "annotation");
+    if (val && !duckdb_is_null_value(val)) annotation = duckdb_get_varchar(val);
+    if (val) duckdb_destroy_value(&val);
+
+    val = duckdb_bind_get_named_parameter(info, "genes");
+    if (val && !duckdb_is_null_value(val)) {
+        idx_t n = duckdb_get_list_size(val);
+        genes = (char **)calloc(n ? n : 1, sizeof(char *));
+        for (idx_t i = 0; genes && i < n; i++) {
+            duckdb_value elem = duckdb_get_list_child(val, i);
+            if (elem && !duckdb_is_null_value(elem)) genes[n_genes++] = duckdb_get_varchar(elem);
+            if (elem) duckdb_destroy_value(&elem);
+        }
+    }
+    if (val) duckdb_destroy_value(&val);
+
+    if (!annotation) {
+        if (n_genes == 0) {
+            ret = 0;
+        } else {
+            snprintf(err, err_len, "%s: genes requires annotation := <annotation file or .names index>", fname);
+        }
+        goto cleanup;
+    }
+    sidecar = ends_with(annotation, GFF_NAME_INDEX_SUFFIX) ? dup_string(annotation)
+                                                          : append_suffix(annotation, GFF_NAME_INDEX_SUFFIX);
+    f = fopen(sidecar, "rb");
+    if (!f) {
+        snprintf(err, err_len, "%s: gene names require a name index; run gff_name_index() first (missing %s)",
+                 fname, sidecar);
+        goto cleanup;
+    }
+    if (fread(buf, 1, GFF_NAME_INDEX_HEADER_LEN, f) != GFF_NAME_INDEX_HEADER_LEN ||
+        memcmp(buf, GFF_NAME_INDEX_MAGIC, GFF_NAME_INDEX_MAGIC_LEN) != 0) {
+        snprintf(err, err_len, "%s: %s is not a current gff_name_index sidecar; rerun gff_name_index()", fname,
+                 sidecar);
+        goto cleanup;
+    }
+    uint64_t n_entries = le_to_u64(buf + GFF_NAME_INDEX_MAGIC_LEN);
+    uint64_t pool_len = le_to_u64(buf + GFF_NAME_INDEX_MAGIC_LEN + 8);
+    if (check_name_index_source(f, buf, n_entries, annotation, fname, sidecar, err, err_len) != 0) goto cleanup;
+
+    /* Region tokens that name a feature are replaced; others pass through */
+    if (*region) {
+        const char *p = *region;
+        while (*p) {
+            const char *comma = strchr(p, ',');
+            size_t len = comma ? (size_t)(comma - p) : strlen(p);
+            if (len > 0) {
+                char *token = (char *)malloc(len + 1);
+                if (!token) goto cleanup;
+                memcpy(token, p, len);
+                token[len] = '\0';
+                int n = lookup_name(f, n_entries, pool_len, token, &out);
+                if (n == 0) {
+                    if (out.l > 0) kputc(',', &out);
+                    kputs(token, &out);
+                }
+                free(token);
+                if (n < 0) {
+                    snprintf(err, err_len, "%s: failed to read name index %s", fname, sidecar);
+                    goto cleanup;
+                }
+            }
+            if (!comma) break;
+            p = comma + 1;
+        }
+    }
+    for (idx_t i = 0; i < n_genes; i++) {
+        int n = lookup_name(f, n_entries, pool_len, genes[i], &out);
+        if (n < 0) {
+            snprintf(err, err_len, "%s: failed to read name index %s", fname, sidecar);
+            goto cleanup;
+        }
+        if (n == 0) {
+            snprintf(err, err_len, "%s: '%s' not found in name index %s", fname, genes[i], sidecar);
+            goto cleanup;
+        }
+    }
+
+    if (*region) duckdb_free(*region);
+    *region = out.l > 0 ? dup_string(out.s) : NULL;
+    ret = 0;
+
+cleanup:
+    if (f) fclose(f);
+    free(out.s);
+    for (idx_t i = 0; i < n_genes; i++) duckdb_free(genes[i]);
+    free(genes);
+    if (sidecar) duckdb_free(sidecar);
+    if (annotation) duckdb_free(annotation);
+    return ret;
+}
+
 void register_bam_index_function(duckdb_connection connection) {
     duckdb_table_function tf = duckdb_create_table_function();
     duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
@@ -388,3 +993,35 @@ void register_tabix_index_function(duckdb_connection connection) {
     duckdb_destroy_logical_type(&varchar_type);
     duckdb_destroy_logical_type(&int_type);
 }
+
+void register_bcf_id_index_function(duckdb_connection connection) {
+    duckdb_table_function tf = duckdb_create_table_function();
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+
+    duckdb_table_function_set_name(tf, "bcf_id_index");
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "index_path", varchar_type);
+    duckdb_table_function_set_bind(tf, bind_bcf_id_index);
+    duckdb_table_function_set_init(tf, init_index_build);
+    duckdb_table_function_set_function(tf, scan_index_build);
+    duckdb_register_table_function(connection, tf);
+    duckdb_destroy_table_function(&tf);
+
+    duckdb_destroy_logical_type(&varchar_type);
+}
+
+void register_gff_name_index_function(duckdb_connection connection) {
+    duckdb_table_function tf = duckdb_create_table_function();
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+
+    duckdb_table_function_set_name(tf, "gff_name_index");
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "index_path", varchar_type);
+    duckdb_table_function_set_bind(tf, bind_gff_name_index);
+    duckdb_table_function_set_init(tf, init_index_build);
+    duckdb_table_function_set_function(tf, scan_index_build);
+    duckdb_register_table_function(connection, tf);
+    duckdb_destroy_table_function(&tf);
+
+    duckdb_destroy_logical_type(&varchar_type);
+}
@@ -0,0 +1,39 @@
+/**
+ * Variant ID sidecar index shared by bcf_id_index() and read_bcf(ids := ...).
+ *
+ * File layout (all integers little-endian):
+ *   magic[8]      "DHTSIDX\2"
+ *   n_entries     uint64
+ *   src_mtime     int64, -1 when the VCF/BCF could not be stat'ed
+ *   src_size      int64, likewise
+ *   entries[n]    { uint64 id_hash, uint64 bgzf_voffset }, sorted by
+ *                 (id_hash, voffset)
+ *
+ * IDs are hashed with 64-bit FNV-1a; records with several IDs separated by
+ * ';' get one entry per ID. Hash collisions are resolved by the reader, which
+ * re-checks the ID of every record it seeks to, and rejects a sidecar whose
+ * src_mtime/src_size no longer match the file.
+ */
+
+#ifndef BCF_ID_INDEX_H
+#define BCF_ID_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BCF_ID_INDEX_MAGIC "DHTSIDX\2"
+#define BCF_ID_INDEX_MAGIC_LEN 8
+#define BCF_ID_INDEX_HEADER_LEN 32
+#define BCF_ID_INDEX_ENTRY_LEN 16
+#define BCF_ID_INDEX_SUFFIX ".ids"
+
+static inline uint64_t bcf_id_hash(const char *s, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)s[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+#endif /* BCF_ID_INDEX_H */
@@ -0,0 +1,126 @@
+/**
+ * Process-wide cache of immutable objects loaded from files, for scalar
+ * functions that index a file once and share it across threads.
+ *
+ * An object embeds file_cache_entry_t as its first member and is keyed by
+ * path. It is reloaded when the file's mtime or size changes; an object
+ * replaced in the cache stays alive until its last reference is released.
+ * Loading runs outside the lock, so parsing a large file never stalls
+ * callers of other entries. When two callers load the same path at once,
+ * the first to publish wins and the other copy is freed.
+ *
+ * The spin lock and file_stamp() are also used by pools that hand out
+ * exclusive, per-caller handles (the FASTA fetch handles).
+ */
+
+#ifndef FILE_CACHE_H
+#define FILE_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+
+typedef struct file_cache_entry_s {
+    char *path;         /* set by the loader; freed by free_entry */
+    int64_t mtime;
+    int64_t size;
+    int refs;
+    int stale;          /* replaced in the cache; freed with its last reference */
+    struct file_cache_entry_s *next;
+} file_cache_entry_t;
+
+/* Load path into a new calloc'd object, or NULL with err filled in. */
+typedef file_cache_entry_t *(*file_cache_load_fn)(const char *path, void *arg, char *err, size_t err_len);
+typedef void (*file_cache_free_fn)(file_cache_entry_t *entry);
+
+typedef struct {
+    volatile int lock;
+    file_cache_entry_t *head;
+    file_cache_free_fn free_entry;
+} file_cache_t;
+
+#define FILE_CACHE_INIT(free_fn) {0, NULL, (free_fn)}
+
+static inline void file_cache_spin_lock(volatile int *lock) {
+    while (__sync_lock_test_and_set(lock, 1)) {
+    }
+}
+
+static inline void file_cache_spin_unlock(volatile int *lock) {
+    __sync_lock_release(lock);
+}
+
+/* mtime and size of path. Returns 0, or -1 with both set to -1 when the
+ * path cannot be stat'ed (remote URLs), which then caches by name only. */
+static inline int file_stamp(const char *path, int64_t *mtime, int64_t *size) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        *mtime = -1;
+        *size = -1;
+        return -1;
+    }
+    *mtime = (int64_t)st.st_mtime;
+    *size = (int64_t)st.st_size;
+    return 0;
+}
+
+static inline file_cache_entry_t **file_cache_link(file_cache_t *cache, const char *path) {
+    file_cache_entry_t **link = &cache->head;
+    while (*link && strcmp((*link)->path, path) != 0) link = &(*link)->next;
+    return link;
+}
+
+/* Take a reference to the cached object for path, loading it with
+ * load(path, arg) when it is new or its file changed. */
+static inline file_cache_entry_t *file_cache_acquire(file_cache_t *cache, const char *path, file_cache_load_fn load,
+                                                     void *arg, char *err, size_t err_len) {
+    int64_t mtime, size;
+    file_stamp(path, &mtime, &size);
+
+    file_cache_spin_lock(&cache->lock);
+    file_cache_entry_t *e = *file_cache_link(cache, path);
+    if (e && e->mtime == mtime && e->size == size) {
+        e->refs++;
+        file_cache_spin_unlock(&cache->lock);
+        return e;
+    }
+    file_cache_spin_unlock(&cache->lock);
+
+    file_cache_entry_t *fresh = load(path, arg, err, err_len);
+    if (!fresh) return NULL;
+    fresh->mtime = mtime;
+    fresh->size = size;
+    fresh->refs = 1;
+
+    file_cache_entry_t *dead = NULL;
+    file_cache_spin_lock(&cache->lock);
+    file_cache_entry_t **link = file_cache_link(cache, path);
+    e = *link;
+    if (e && e->mtime == mtime && e->size == size) {
+        e->refs++;
+        file_cache_spin_unlock(&cache->lock);
+        cache->free_entry(fresh);
+        return e;
+    }
+    if (e) {
+        *link = e->next;
+        e->stale = 1;
+        if (e->refs == 0) dead = e;
+    }
+    fresh->next = cache->head;
+    cache->head = fresh;
+    file_cache_spin_unlock(&cache->lock);
+    if (dead) cache->free_entry(dead);
+    return fresh;
+}
+
+static inline void file_cache_release(file_cache_t *cache, file_cache_entry_t *e) {
+    if (!e) return;
+    file_cache_spin_lock(&cache->lock);
+    int dead = --e->refs == 0 && e->stale;
+    file_cache_spin_unlock(&cache->lock);
+    if (dead) cache->free_entry(e);
+}
+
+#endif /* FILE_CACHE_H */
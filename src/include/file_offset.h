@@ -0,0 +1,36 @@
+/**
+ * 64-bit stdio offsets for sidecar indexes and .2bit files, which can pass
+ * 2 GiB. long is 32 bits on Windows, so plain fseek/ftell truncate there;
+ * elsewhere off_t is 64 bits with _FILE_OFFSET_BITS=64 (set by every build),
+ * and an offset that does not fit fails with EOVERFLOW rather than wrapping.
+ */
+
+#ifndef FILE_OFFSET_H
+#define FILE_OFFSET_H
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+static inline int file_seek64(FILE *f, int64_t off, int whence) {
+#ifdef _WIN32
+    return _fseeki64(f, off, whence);
+#else
+    if ((int64_t)(off_t)off != off) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    return fseeko(f, (off_t)off, whence);
+#endif
+}
+
+static inline int64_t file_tell64(FILE *f) {
+#ifdef _WIN32
+    return (int64_t)_ftelli64(f);
+#else
+    return (int64_t)ftello(f);
+#endif
+}
+
+#endif /* FILE_OFFSET_H */
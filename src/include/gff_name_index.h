@@ -0,0 +1,55 @@
+/**
+ * Annotation name sidecar index shared by gff_name_index() and the region
+ * parameters of read_bam(), read_bcf() and read_tabix()/read_gtf()/read_gff().
+ *
+ * File layout (all integers little-endian):
+ *   magic[8]      "DHTSGNX\2"
+ *   n_entries     uint64
+ *   pool_len      uint64
+ *   src_mtime     int64, -1 when the annotation could not be stat'ed
+ *   src_size      int64, likewise
+ *   entries[n]    { uint64 name_hash, uint64 name_off, uint64 contig_off,
+ *                   uint64 start, uint64 end }, sorted by name_hash
+ *   pool          NUL-terminated annotation path (at offset 0), then names
+ *                 and contig names
+ *
+ * Readers compare src_mtime/src_size with the annotation and reject a
+ * sidecar built from an older version of it.
+ * One entry per (name, contig): the 0-based, half-open union of every feature
+ * carrying the name in its ID, Name, gene, gene_id, gene_name, transcript_id
+ * or transcript_name attribute. Names are hashed with 64-bit FNV-1a; the
+ * reader compares the pooled name to resolve collisions.
+ *
+ * Include after duckdb_extension.h.
+ */
+
+#ifndef GFF_NAME_INDEX_H
+#define GFF_NAME_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define GFF_NAME_INDEX_MAGIC "DHTSGNX\2"
+#define GFF_NAME_INDEX_MAGIC_LEN 8
+#define GFF_NAME_INDEX_HEADER_LEN 40
+#define GFF_NAME_INDEX_ENTRY_LEN 40
+#define GFF_NAME_INDEX_SUFFIX ".names"
+
+static inline uint64_t gff_name_hash(const char *s, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)s[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/* Read the annotation := and genes := named parameters of a reader bind and
+ * rewrite *region (duckdb_malloc'd or NULL) in place: comma-separated tokens
+ * found in the name index become chrom:start-end, and every listed gene is
+ * appended. Returns 0 (also when annotation is not given), or -1 with err
+ * filled when the sidecar is missing or stale or a listed gene is unknown. */
+int gff_name_index_bind_regions(duckdb_bind_info info, const char *fname, char **region,
+                                char *err, size_t err_len);
+
+#endif /* GFF_NAME_INDEX_H */
@@ -0,0 +1,60 @@
+/**
+ * Reference sequence sources shared by fasta_nuc, fasta_fetch/fasta_base and
+ * read_fasta.
+ *
+ * A ref_source_t is either an indexed FASTA (faidx; one handle per thread,
+ * since faidx reads are stateful) or a UCSC .2bit file. .2bit files are
+ * memory-mapped once per process and shared read-only between every
+ * ref_source_t opened on the same path, so a packed genome stays resident at
+ * 2 bits per base and fetches decode straight from the mapping.
+ *
+ * .2bit layout (UCSC, little- or big-endian by signature):
+ *   header    signature 0x1A412743, version (0: 32-bit offsets,
+ *             1: 64-bit offsets), sequence count, reserved
+ *   index     per sequence: name length (1 byte), name, record offset
+ *   record    dna size, N block count/starts/sizes, mask block
+ *             count/starts/sizes, reserved, packed bases (T=0 C=1 A=2 G=3,
+ *             first base in the high bits)
+ */
+
+#ifndef REF_SOURCE_H
+#define REF_SOURCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <htslib/hts.h>
+
+typedef struct ref_source_s ref_source_t;
+
+/* True when path names a .2bit file (by suffix). */
+int ref_source_is_2bit(const char *path);
+
+/* Open path as a reference. index_path only applies to FASTA. Returns NULL
+ * and fills err on failure. */
+ref_source_t *ref_source_open(const char *path, const char *index_path, char *err, size_t err_len);
+void ref_source_close(ref_source_t *ref);
+
+int ref_source_nseq(const ref_source_t *ref);
+const char *ref_source_iseq(const ref_source_t *ref, int id);
+/* Sequence id for name, or -1 when the reference does not contain it. */
+int ref_source_name2id(const ref_source_t *ref, const char *name);
+hts_pos_t ref_source_seq_len(const ref_source_t *ref, int id);
+
+/* Parse "chr", "chr:beg" or "chr:beg-end" (1-based, inclusive) into a
+ * sequence id and a clamped 0-based, half-open range. Returns 0 or -1. */
+int ref_source_parse_region(const ref_source_t *ref, const char *region, int *id, hts_pos_t *beg, hts_pos_t *end);
+
+/* Bases [beg, end) of sequence id, clamped to the sequence, as a malloc'd
+ * NUL-terminated string; NULL on error. */
+char *ref_source_fetch(ref_source_t *ref, int id, hts_pos_t beg, hts_pos_t end, hts_pos_t *len);
+
+/* Decode [beg, end) (already within the sequence) of a .2bit source into out
+ * without allocating. Returns -1 for FASTA sources. */
+int ref_source_fetch_into(const ref_source_t *ref, int id, hts_pos_t beg, hts_pos_t end, char *out);
+
+/* Convert an indexed FASTA to .2bit. Returns 0, or -1 with err filled. */
+int twobit_write_from_fasta(const char *fasta_path, const char *index_path, const char *out_path,
+                            int64_t *n_seqs, int64_t *n_bases, char *err, size_t err_len);
+
+#endif /* REF_SOURCE_H */
@@ -0,0 +1,145 @@
+/**
+ * Nucleotide string kernels behind seq_revcomp, seq_canonical,
+ * seq_gc_content and the fasta_nuc base counts.
+ *
+ * Every kernel accepts A/C/G/T/N in either case and reports any other byte
+ * as invalid. Implementations are chosen once at load time: AVX2 or
+ * SSE4.2 (x86, checked at runtime), NEON (aarch64), else 256-entry lookup
+ * tables. Complement and validation share one 16-entry shuffle table indexed
+ * by the low nibble, which is distinct for A, C, G, T and N in both cases.
+ *
+ * Also holds the rolling 2-bit k-mer encoder (k <= 64) shared by seq_kmers,
+ * the k-mer aggregates and the MinHash sketches.
+ */
+
+#ifndef SEQ_KERNELS_H
+#define SEQ_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Pick the fastest supported implementation; safe to call repeatedly. */
+void seq_kernels_init(void);
+
+/* Force an implementation by name ("avx2", "sse4.2", "neon", "scalar").
+ * Returns 0, or -1 when it is not available on this CPU/build. */
+int seq_kernels_select(const char *name);
+
+/* Name of the implementation in use. */
+const char *seq_kernels_name(void);
+
+/* Upper-case reverse complement of seq into out (len bytes, no NUL).
+ * Returns 0, or -1 when seq holds an invalid base. */
+int seq_revcomp_kernel(const char *seq, size_t len, char *out);
+
+/* Upper-case copy of whichever of seq and its reverse complement sorts
+ * first; the strands are compared from both ends and stop at the first
+ * differing base. Returns 0, or -1 on an invalid base. */
+int seq_canonical_kernel(const char *seq, size_t len, char *out);
+
+/* Count G/C and N bases. Returns 0, or -1 on an invalid base. */
+int seq_gc_count_kernel(const char *seq, size_t len, size_t *gc, size_t *n);
+
+enum {
+    SEQ_BASE_OTHER = 0,  /* IUPAC ambiguity codes, gaps and anything else */
+    SEQ_BASE_A,
+    SEQ_BASE_C,
+    SEQ_BASE_G,
+    SEQ_BASE_T,
+    SEQ_BASE_N,
+    SEQ_BASE_COUNT
+};
+
+/* Histogram of A/C/G/T/N (either case) and other bytes; never fails. */
+void seq_base_count_kernel(const char *seq, size_t len, size_t counts[SEQ_BASE_COUNT]);
+
+/* 2-bit base codes, A=0 C=1 G=2 T=3 in either case, 4 for anything else.
+ * The first base of a k-mer lands in the most significant bits, matching
+ * seq_hash_2bit(). */
+extern const uint8_t SEQ_2BIT_CODE[256];
+
+#define SEQ_KMER_MAX_K 64
+
+typedef struct {
+    uint64_t hi;
+    uint64_t lo;
+} seq_kmer128_t;
+
+/* Forward and reverse-complement codes of the last k bases, updated in O(1)
+ * per base. Any non-ACGT byte clears the run, so no k-mer spanning it is
+ * reported complete. */
+typedef struct {
+    unsigned k;
+    unsigned run;
+    unsigned top_shift;
+    int top_in_hi;
+    uint64_t mask_hi;
+    uint64_t mask_lo;
+    seq_kmer128_t fwd;
+    seq_kmer128_t rev;
+} seq_kmer_roller_t;
+
+/* k must be in 1..SEQ_KMER_MAX_K. */
+static inline void seq_kmer_roller_init(seq_kmer_roller_t *r, unsigned k) {
+    unsigned bits = 2 * k;
+    r->k = k;
+    r->run = 0;
+    r->top_shift = (2 * (k - 1)) & 63;
+    r->top_in_hi = 2 * (k - 1) >= 64;
+    r->mask_lo = bits >= 64 ? ~(uint64_t)0 : (((uint64_t)1 << bits) - 1);
+    r->mask_hi = bits <= 64 ? 0 : bits >= 128 ? ~(uint64_t)0 : (((uint64_t)1 << (bits - 64)) - 1);
+    r->fwd.hi = r->fwd.lo = r->rev.hi = r->rev.lo = 0;
+}
+
+/* Feed one base; returns 1 when the last k bases form a complete k-mer. */
+static inline int seq_kmer_roller_push(seq_kmer_roller_t *r, unsigned char c) {
+    uint64_t code = SEQ_2BIT_CODE[c];
+    if (code > 3) {
+        r->run = 0;
+        r->fwd.hi = r->fwd.lo = r->rev.hi = r->rev.lo = 0;
+        return 0;
+    }
+    r->fwd.hi = ((r->fwd.hi << 2) | (r->fwd.lo >> 62)) & r->mask_hi;
+    r->fwd.lo = ((r->fwd.lo << 2) | code) & r->mask_lo;
+    r->rev.lo = (r->rev.lo >> 2) | (r->rev.hi << 62);
+    r->rev.hi >>= 2;
+    if (r->top_in_hi) {
+        r->rev.hi |= (3 - code) << r->top_shift;
+    } else {
+        r->rev.lo |= (3 - code) << r->top_shift;
+    }
+    r->rev.lo &= r->mask_lo;
+    if (r->run < r->k) {
+        r->run++;
+    }
+    return r->run >= r->k;
+}
+
+/* Nonzero when the reverse complement sorts before the forward k-mer; the
+ * 2-bit order matches upper-case lexicographic order. */
+static inline int seq_kmer_roller_rev_first(const seq_kmer_roller_t *r) {
+    return r->rev.hi < r->fwd.hi || (r->rev.hi == r->fwd.hi && r->rev.lo < r->fwd.lo);
+}
+
+/* splitmix64 finaliser: a bijection that spreads 2-bit codes, whose low
+ * bits are far from uniform, over all 64 bits. Used for hash tables and
+ * MinHash sketches. */
+static inline uint64_t seq_kmer_mix64(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+/* Write the k upper-case bases of code into out. */
+static inline void seq_kmer_decode(seq_kmer128_t code, unsigned k, char *out) {
+    for (unsigned i = 0; i < k; i++) {
+        unsigned shift = 2 * (k - 1 - i);
+        uint64_t word = shift >= 64 ? code.hi >> (shift - 64) : code.lo >> shift;
+        out[i] = "ACGT"[word & 3];
+    }
+}
+
+#endif /* SEQ_KERNELS_H */
@@ -0,0 +1,28 @@
+/**
+ * Row accessors for DuckDB vectors shared by the scalar functions and
+ * aggregates. Include after DUCKDB_EXTENSION_EXTERN, since these call
+ * through the extension API table.
+ */
+
+#ifndef VECTOR_ACCESS_H
+#define VECTOR_ACCESS_H
+
+#include <stdbool.h>
+
+#include "duckdb_extension.h"
+
+/* True unless row is NULL. A vector without a validity mask has no NULLs. */
+static inline bool row_is_valid(duckdb_vector vector, idx_t row) {
+    uint64_t *validity = duckdb_vector_get_validity(vector);
+    return !validity || duckdb_validity_row_is_valid(validity, row);
+}
+
+/* Bytes and length of a VARCHAR/BLOB row; not NUL-terminated. */
+static inline const char *get_string_at(duckdb_vector vector, idx_t row, idx_t *len) {
+    duckdb_string_t *data = (duckdb_string_t *)duckdb_vector_get_data(vector);
+    duckdb_string_t *val = &data[row];
+    *len = duckdb_string_t_length(*val);
+    return duckdb_string_t_data(val);
+}
+
+#endif /* VECTOR_ACCESS_H */
@@ -0,0 +1,1667 @@
+/**
+ * DuckHTS interval overlap join backed by cgranges.
+ *
+ * interval_overlap(left_path, right_path, mode := 'any')
+ *   -> overlapping interval pairs between two files. Each side may be BED
+ *      (plain or bgzipped), VCF/BCF or SAM/BAM/CRAM; intervals are 0-based,
+ *      half-open as in read_bed (VCF records span POS..POS+rlen, alignments
+ *      their reference span, unmapped reads are skipped).
+ *
+ * One side is loaded into a cgranges index (an implicit interval tree sorted
+ * per contig) and the other is streamed through it. Streaming is split into
+ * per-contig work items when the streamed file is indexed, so scan threads
+ * query the shared read-only index in parallel.
+ *
+ * Modes (the left side drives the rows):
+ *   any      every overlapping pair; the smaller file is indexed
+ *   first    the overlapping right interval with the lowest start
+ *   count    one row per left interval with its number of right overlaps
+ *   nearest  the first overlapping right interval, else the closest one on
+ *            the same contig, with bedtools closest -d style distance
+ */
+
+#include "duckdb_extension.h"
+DUCKDB_EXTENSION_EXTERN
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <htslib/hts.h>
+#include <htslib/khash.h>
+#include <htslib/kstring.h>
+#include <htslib/sam.h>
+#include <htslib/tbx.h>
+#include <htslib/vcf.h>
+
+#include "cgranges.h"
+#include "include/file_cache.h"
+#include "include/vector_access.h"
+
+#define OVERLAP_MAX_THREADS 16
+
+typedef enum {
+    OVERLAP_MODE_ANY = 0,
+    OVERLAP_MODE_FIRST,
+    OVERLAP_MODE_COUNT,
+    OVERLAP_MODE_NEAREST
+} overlap_mode_t;
+
+/* Logical output columns; each mode exposes a subset in this order. */
+enum {
+    OVL_COL_CHROM = 0,
+    OVL_COL_LEFT_START,
+    OVL_COL_LEFT_END,
+    OVL_COL_LEFT_NAME,
+    OVL_COL_RIGHT_START,
+    OVL_COL_RIGHT_END,
+    OVL_COL_RIGHT_NAME,
+    OVL_COL_OVERLAP,
+    OVL_COL_DISTANCE,
+    OVL_COL_N_OVERLAPS,
+    OVL_NCOLS
+};
+
+typedef enum {
+    IVL_KIND_BED = 0,
+    IVL_KIND_VCF,
+    IVL_KIND_SAM
+} ivl_kind_t;
+
+/* Interval source over one file, optionally restricted to one contig. */
+typedef struct {
+    htsFile *fp;
+    ivl_kind_t kind;
+    bcf_hdr_t *vhdr;
+    sam_hdr_t *shdr;
+    tbx_t *tbx;
+    hts_idx_t *idx;
+    hts_itr_t *itr;
+    bcf1_t *vrec;
+    bam1_t *brec;
+    kstring_t line;
+    kstring_t chrom;
+    kstring_t name;
+    int64_t start;
+    int64_t end;
+    int has_name;
+} ivl_reader_t;
+
+typedef struct {
+    char *left_path;
+    char *right_path;
+    overlap_mode_t mode;
+    int index_left;         /* 1 = left side loaded into cgranges (mode any only) */
+    int n_cols;
+    int cols[OVL_NCOLS];    /* bind column -> logical column */
+    char **items;           /* contigs of the streamed file; NULL entry = whole file */
+    int n_items;
+} overlap_bind_data_t;
+
+typedef struct {
+    cgranges_t *cr;
+    int64_t *name_off;      /* per label offset into names, -1 = no name */
+    kstring_t names;
+    int64_t *prefix_max;    /* nearest: index of max end within [ctg off, i] */
+    volatile int next_item;
+} overlap_global_data_t;
+
+typedef struct {
+    ivl_reader_t reader;
+    int has_reader;
+    int have_record;
+    int64_t *hits;
+    int64_t m_hits;
+    int64_t n_hits;
+    int64_t hit_pos;
+    int finished;
+    idx_t *column_ids;
+    idx_t n_projected_cols;
+} overlap_local_data_t;
+
+/* ================================================================
+ * Interval sources
+ * ================================================================ */
+
+static void ivl_reader_close(ivl_reader_t *r) {
+    if (r->itr) hts_itr_destroy(r->itr);
+    if (r->tbx) tbx_destroy(r->tbx);
+    if (r->idx) hts_idx_destroy(r->idx);
+    if (r->vrec) bcf_destroy(r->vrec);
+    if (r->brec) bam_destroy1(r->brec);
+    if (r->vhdr) bcf_hdr_destroy(r->vhdr);
+    if (r->shdr) sam_hdr_destroy(r->shdr);
+    if (r->fp) hts_close(r->fp);
+    free(r->line.s);
+    free(r->chrom.s);
+    free(r->name.s);
+    memset(r, 0, sizeof(*r));
+}
+
+/* Open path and read its header. With load_index, also load the matching
+ * index if one exists (r->tbx or r->idx stay NULL otherwise). */
+static int ivl_reader_open(ivl_reader_t *r, const char *fname, const char *path, int load_index,
+                           char *err, size_t err_len) {
+    memset(r, 0, sizeof(*r));
+    r->fp = hts_open(path, "r");
+    if (!r->fp) {
+        snprintf(err, err_len, "%s: failed to open file: %s", fname, path);
+        return -1;
+    }
+    const htsFormat *fmt = hts_get_format(r->fp);
+    if (fmt->format == vcf || fmt->format == bcf) {
+        r->kind = IVL_KIND_VCF;
+        r->vhdr = bcf_hdr_read(r->fp);
+        r->vrec = bcf_init();
+        if (!r->vhdr) {
+            snprintf(err, err_len, "%s: failed to read VCF/BCF header: %s", fname, path);
+            ivl_reader_close(r);
+            return -1;
+        }
+        if (load_index) {
+            if (fmt->format == vcf) r->tbx = tbx_index_load3(path, NULL, HTS_IDX_SILENT_FAIL);
+            else r->idx = bcf_index_load3(path, NULL, HTS_IDX_SILENT_FAIL);
+        }
+    } else if (fmt->format == sam || fmt->format == bam || fmt->format == cram) {
+        r->kind = IVL_KIND_SAM;
+        r->shdr = sam_hdr_read(r->fp);
+        r->brec = bam_init1();
+        if (!r->shdr) {
+            snprintf(err, err_len, "%s: failed to read SAM/BAM/CRAM header: %s", fname, path);
+            ivl_reader_close(r);
+            return -1;
+        }
+        if (load_index && fmt->format != sam) {
+            r->idx = sam_index_load3(r->fp, path, NULL, HTS_IDX_SILENT_FAIL);
+        }
+    } else {
+        r->kind = IVL_KIND_BED;
+        if (load_index) r->tbx = tbx_index_load3(path, NULL, HTS_IDX_SILENT_FAIL);
+    }
+    return 0;
+}
+
+static int ivl_reader_indexed(const ivl_reader_t *r) {
+    return r->tbx != NULL || r->idx != NULL;
+}
+
+/* Contig names of an indexed reader; caller frees the array, not the names. */
+static const char **ivl_reader_seqnames(const ivl_reader_t *r, int *n) {
+    *n = 0;
+    if (r->tbx) return tbx_seqnames(r->tbx, n);
+    if (r->kind == IVL_KIND_VCF && r->idx) return bcf_index_seqnames(r->idx, r->vhdr, n);
+    if (r->kind == IVL_KIND_SAM && r->idx) {
+        int n_targets = sam_hdr_nref(r->shdr);
+        const char **names = (const char **)malloc(sizeof(char *) * (size_t)(n_targets > 0 ? n_targets : 1));
+        if (!names) return NULL;
+        for (int i = 0; i < n_targets; i++) names[i] = sam_hdr_tid2name(r->shdr, i);
+        *n = n_targets;
+        return names;
+    }
+    return NULL;
+}
+
+/* Restrict the reader to one contig. Returns 0, or 1 if the contig is unknown. */
+static int ivl_reader_query(ivl_reader_t *r, const char *contig) {
+    if (r->itr) {
+        hts_itr_destroy(r->itr);
+        r->itr = NULL;
+    }
+    if (r->tbx) {
+        int tid = tbx_name2id(r->tbx, contig);
+        if (tid >= 0) r->itr = tbx_itr_queryi(r->tbx, tid, 0, HTS_POS_MAX);
+    } else if (r->kind == IVL_KIND_VCF) {
+        int tid = bcf_hdr_name2id(r->vhdr, contig);
+        if (tid >= 0) r->itr = bcf_itr_queryi(r->idx, tid, 0, HTS_POS_MAX);
+    } else {
+        int tid = sam_hdr_name2tid(r->shdr, contig);
+        if (tid >= 0) r->itr = sam_itr_queryi(r->idx, tid, 0, HTS_POS_MAX);
+    }
+    return r->itr ? 0 : 1;
+}
+
+static int parse_coord(const char *s, int len, int64_t *out) {
+    char buf[32];
+    if (len <= 0 || len >= (int)sizeof(buf)) return 0;
+    memcpy(buf, s, (size_t)len);
+    buf[len] = '\0';
+    char *end = NULL;
+    long long v = strtoll(buf, &end, 10);
+    if (!end || *end != '\0') return 0;
+    *out = (int64_t)v;
+    return 1;
+}
+
+/* Parse chrom/start/end/name from the BED line in r->line. */
+static int ivl_parse_bed(ivl_reader_t *r) {
+    const char *s = r->line.s;
+    const char *end = s + r->line.l;
+    const char *field[4] = {NULL, NULL, NULL, NULL};
+    int len[4] = {0, 0, 0, 0};
+    const char *p = s;
+    int n = 0;
+    while (n < 4 && p <= end) {
+        const char *tab = (const char *)memchr(p, '\t', (size_t)(end - p));
+        field[n] = p;
+        len[n++] = (int)((tab ? tab : end) - p);
+        if (!tab) break;
+        p = tab + 1;
+    }
+    if (n < 3 || !parse_coord(field[1], len[1], &r->start) || !parse_coord(field[2], len[2], &r->end)) {
+        return -1;
+    }
+    r->chrom.l = 0;
+    kputsn(field[0], (size_t)len[0], &r->chrom);
+    r->has_name = n > 3 && len[3] > 0 && !(len[3] == 1 && field[3][0] == '.');
+    if (r->has_name) {
+        r->name.l = 0;
+        kputsn(field[3], (size_t)len[3], &r->name);
+    }
+    return 0;
+}
+
+/* Advance to the next interval. Returns 1 on a record, 0 at the end, -1 on error. */
+static int ivl_reader_next(ivl_reader_t *r) {
+    for (;;) {
+        if (r->kind == IVL_KIND_BED) {
+            int ret = r->itr ? tbx_itr_next(r->fp, r->tbx, r->itr, &r->line)
+                             : hts_getline(r->fp, '\n', &r->line);
+            if (ret < -1) return -1;
+            if (ret < 0) return 0;
+            if (r->line.l == 0 || r->line.s[0] == '#' ||
+                strncmp(r->line.s, "track", 5) == 0 || strncmp(r->line.s, "browser", 7) == 0) {
+                continue;
+            }
+            return ivl_parse_bed(r) == 0 ? 1 : -1;
+        }
+        if (r->kind == IVL_KIND_VCF) {
+            int ret;
+            if (r->itr && r->tbx) {
+                /* tabix-indexed VCF: the iterator yields text lines */
+                ret = tbx_itr_next(r->fp, r->tbx, r->itr, &r->line);
+                if (ret >= 0 && vcf_parse1(&r->line, r->vhdr, r->vrec) < 0) return -1;
+            } else {
+                ret = r->itr ? bcf_itr_next(r->fp, r->itr, r->vrec) : bcf_read(r->fp, r->vhdr, r->vrec);
+            }
+            if (ret < -1) return -1;
+            if (ret < 0) return 0;
+            bcf_unpack(r->vrec, BCF_UN_STR);
+            r->chrom.l = 0;
+            kputs(bcf_seqname_safe(r->vhdr, r->vrec), &r->chrom);
+            r->start = r->vrec->pos;
+            r->end = r->vrec->pos + r->vrec->rlen;
+            const char *id = r->vrec->d.id;
+            r->has_name = id && !(id[0] == '.' && id[1] == '\0');
+            if (r->has_name) {
+                r->name.l = 0;
+                kputs(id, &r->name);
+            }
+            return 1;
+        }
+        int ret = r->itr ? sam_itr_next(r->fp, r->itr, r->brec) : sam_read1(r->fp, r->shdr, r->brec);
+        if (ret < -1) return -1;
+        if (ret < 0) return 0;
+        if (r->brec->core.tid < 0 || (r->brec->core.flag & BAM_FUNMAP)) continue;
+        r->chrom.l = 0;
+        kputs(sam_hdr_tid2name(r->shdr, r->brec->core.tid), &r->chrom);
+        r->start = r->brec->core.pos;
+        r->end = bam_endpos(r->brec);
+        r->has_name = 1;
+        r->name.l = 0;
+        kputs(bam_get_qname(r->brec), &r->name);
+        return 1;
+    }
+}
+
+/* ================================================================
+ * Bind / init
+ * ================================================================ */
+
+static void destroy_overlap_bind(void *data) {
+    overlap_bind_data_t *bind = (overlap_bind_data_t *)data;
+    if (!bind) return;
+    free(bind->left_path);
+    free(bind->right_path);
+    for (int i = 0; i < bind->n_items; i++) free(bind->items[i]);
+    free(bind->items);
+    free(bind);
+}
+
+static void destroy_overlap_global(void *data) {
+    overlap_global_data_t *global = (overlap_global_data_t *)data;
+    if (!global) return;
+    if (global->cr) cr_destroy(global->cr);
+    free(global->name_off);
+    free(global->names.s);
+    free(global->prefix_max);
+    free(global);
+}
+
+static void destroy_overlap_local(void *data) {
+    overlap_local_data_t *local = (overlap_local_data_t *)data;
+    if (!local) return;
+    if (local->has_reader) ivl_reader_close(&local->reader);
+    free(local->hits);
+    free(local->column_ids);
+    free(local);
+}
+
+static int64_t file_size(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (int64_t)st.st_size : -1;
+}
+
+static char *get_string_param(duckdb_bind_info info, int idx) {
+    duckdb_value val = duckdb_bind_get_parameter(info, idx);
+    char *s = duckdb_is_null_value(val) ? NULL : duckdb_get_varchar(val);
+    duckdb_destroy_value(&val);
+    char *out = (s && s[0]) ? strdup(s) : NULL;
+    if (s) duckdb_free(s);
+    return out;
+}
+
+static void overlap_bind(duckdb_bind_info info) {
+    char err[512];
+    overlap_bind_data_t *bind = (overlap_bind_data_t *)calloc(1, sizeof(overlap_bind_data_t));
+    if (!bind) {
+        duckdb_bind_set_error(info, "Out of memory");
+        return;
+    }
+    bind->left_path = get_string_param(info, 0);
+    bind->right_path = get_string_param(info, 1);
+    if (!bind->left_path || !bind->right_path) {
+        duckdb_bind_set_error(info, "interval_overlap requires left and right file paths");
+        destroy_overlap_bind(bind);
+        return;
+    }
+
+    duckdb_value val = duckdb_bind_get_named_parameter(info, "mode");
+    if (val && !duckdb_is_null_value(val)) {
+        char *mode = duckdb_get_varchar(val);
+        if (strcmp(mode, "any") == 0) bind->mode = OVERLAP_MODE_ANY;
+        else if (strcmp(mode, "first") == 0) bind->mode = OVERLAP_MODE_FIRST;
+        else if (strcmp(mode, "count") == 0) bind->mode = OVERLAP_MODE_COUNT;
+        else if (strcmp(mode, "nearest") == 0) bind->mode = OVERLAP_MODE_NEAREST;
+        else {
+            snprintf(err, sizeof(err), "interval_overlap: unknown mode '%s' (expected any, first, count or nearest)", mode);
+            duckdb_bind_set_error(info, err);
+            duckdb_free(mode);
+            duckdb_destroy_value(&val);
+            destroy_overlap_bind(bind);
+            return;
+        }
+        duckdb_free(mode);
+    }
+    if (val) duckdb_destroy_value(&val);
+
+    /* Only the symmetric 'any' join may index whichever side is smaller. */
+    if (bind->mode == OVERLAP_MODE_ANY) {
+        int64_t left_size = file_size(bind->left_path);
+        int64_t right_size = file_size(bind->right_path);
+        bind->index_left = left_size >= 0 && right_size >= 0 && left_size < right_size;
+    }
+
+    /* Validate both inputs and plan work items over the streamed side. */
+    ivl_reader_t reader;
+    const char *stream_path = bind->index_left ? bind->right_path : bind->left_path;
+    const char *index_path = bind->index_left ? bind->left_path : bind->right_path;
+    if (ivl_reader_open(&reader, "interval_overlap", index_path, 0, err, sizeof(err)) != 0) {
+        duckdb_bind_set_error(info, err);
+        destroy_overlap_bind(bind);
+        return;
+    }
+    ivl_reader_close(&reader);
+    if (ivl_reader_open(&reader, "interval_overlap", stream_path, 1, err, sizeof(err)) != 0) {
+        duckdb_bind_set_error(info, err);
+        destroy_overlap_bind(bind);
+        return;
+    }
+    int n_names = 0;
+    const char **names = ivl_reader_indexed(&reader) ? ivl_reader_seqnames(&reader, &n_names) : NULL;
+    if (names && n_names > 0) {
+        bind->items = (char **)malloc(sizeof(char *) * (size_t)n_names);
+        for (int i = 0; i < n_names; i++) bind->items[i] = strdup(names[i]);
+        bind->n_items = n_names;
+    } else {
+        bind->items = (char **)malloc(sizeof(char *));
+        bind->items[0] = NULL;
+        bind->n_items = 1;
+    }
+    free(names);
+    ivl_reader_close(&reader);
+
+    static const char *col_names[OVL_NCOLS] = {
+        "chrom", "left_start", "left_end", "left_name", "right_start", "right_end",
+        "right_name", "overlap", "distance", "count"
+    };
+    for (int c = OVL_COL_CHROM; c <= OVL_COL_LEFT_NAME; c++) bind->cols[bind->n_cols++] = c;
+    if (bind->mode == OVERLAP_MODE_COUNT) {
+        bind->cols[bind->n_cols++] = OVL_COL_N_OVERLAPS;
+    } else {
+        for (int c = OVL_COL_RIGHT_START; c <= OVL_COL_OVERLAP; c++) bind->cols[bind->n_cols++] = c;
+        if (bind->mode == OVERLAP_MODE_NEAREST) bind->cols[bind->n_cols++] = OVL_COL_DISTANCE;
+    }
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    for (int i = 0; i < bind->n_cols; i++) {
+        int c = bind->cols[i];
+        int is_text = c == OVL_COL_CHROM || c == OVL_COL_LEFT_NAME || c == OVL_COL_RIGHT_NAME;
+        duckdb_bind_add_result_column(info, col_names[c], is_text ? varchar_type : bigint_type);
+    }
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+
+    duckdb_bind_set_bind_data(info, bind, destroy_overlap_bind);
+}
+
+/* Load the indexed side into cgranges, keeping names in a side arena. */
+static int build_overlap_index(const overlap_bind_data_t *bind, overlap_global_data_t *global,
+                               char *err, size_t err_len) {
+    const char *path = bind->index_left ? bind->left_path : bind->right_path;
+    ivl_reader_t reader;
+    if (ivl_reader_open(&reader, "interval_overlap", path, 0, err, err_len) != 0) return -1;
+
+    global->cr = cr_init();
+    int64_t m_names = 0;
+    int ret;
+    while ((ret = ivl_reader_next(&reader)) > 0) {
+        if (reader.start < 0 || reader.end > INT32_MAX || reader.end < reader.start) {
+            snprintf(err, err_len, "interval_overlap: interval %s:%lld-%lld is out of range",
+                     reader.chrom.s, (long long)reader.start, (long long)reader.end);
+            ivl_reader_close(&reader);
+            return -1;
+        }
+        int64_t label = global->cr->n_r;
+        if (label >= INT32_MAX) {
+            snprintf(err, err_len, "interval_overlap: too many intervals in %s", path);
+            ivl_reader_close(&reader);
+            return -1;
+        }
+        if (label == m_names) {
+            m_names = m_names ? m_names * 2 : 1024;
+            global->name_off = (int64_t *)realloc(global->name_off, sizeof(int64_t) * (size_t)m_names);
+        }
+        if (reader.has_name) {
+            global->name_off[label] = (int64_t)global->names.l;
+            kputsn(reader.name.s, reader.name.l, &global->names);
+            kputc('\0', &global->names);
+        } else {
+            global->name_off[label] = -1;
+        }
+        cr_add(global->cr, reader.chrom.s, (int32_t)reader.start, (int32_t)reader.end, (int32_t)label);
+    }
+    ivl_reader_close(&reader);
+    if (ret < 0) {
+        snprintf(err, err_len, "interval_overlap: failed to parse intervals from %s", path);
+        return -1;
+    }
+    cr_index(global->cr);
+
+    if (bind->mode == OVERLAP_MODE_NEAREST && global->cr->n_r > 0) {
+        global->prefix_max = (int64_t *)malloc(sizeof(int64_t) * (size_t)global->cr->n_r);
+        for (int32_t k = 0; k < global->cr->n_ctg; k++) {
+            int64_t off = global->cr->ctg[k].off;
+            int64_t n = global->cr->ctg[k].n;
+            for (int64_t i = off; i < off + n; i++) {
+                int64_t best = i == off ? i : global->prefix_max[i - 1];
+                global->prefix_max[i] = cr_end(global->cr, i) > cr_end(global->cr, best) ? i : best;
+            }
+        }
+    }
+    return 0;
+}
+
+static void overlap_global_init(duckdb_init_info info) {
+    overlap_bind_data_t *bind = (overlap_bind_data_t *)duckdb_init_get_bind_data(info);
+    overlap_global_data_t *global = (overlap_global_data_t *)calloc(1, sizeof(overlap_global_data_t));
+    char err[512];
+    if (!global) {
+        duckdb_init_set_error(info, "Out of memory");
+        return;
+    }
+    if (build_overlap_index(bind, global, err, sizeof(err)) != 0) {
+        duckdb_init_set_error(info, err);
+        destroy_overlap_global(global);
+        return;
+    }
+    idx_t max_threads = (idx_t)bind->n_items;
+    if (max_threads > OVERLAP_MAX_THREADS) max_threads = OVERLAP_MAX_THREADS;
+    if (max_threads < 1) max_threads = 1;
+    duckdb_init_set_max_threads(info, max_threads);
+    duckdb_init_set_init_data(info, global, destroy_overlap_global);
+}
+
+static void overlap_local_init(duckdb_init_info info) {
+    overlap_bind_data_t *bind = (overlap_bind_data_t *)duckdb_init_get_bind_data(info);
+    overlap_local_data_t *local = (overlap_local_data_t *)calloc(1, sizeof(overlap_local_data_t));
+    if (!local) {
+        duckdb_init_set_error(info, "Out of memory");
+        return;
+    }
+    local->n_projected_cols = duckdb_init_get_column_count(info);
+    local->column_ids = (idx_t *)malloc(sizeof(idx_t) * (local->n_projected_cols ? local->n_projected_cols : 1));
+    for (idx_t i = 0; i < local->n_projected_cols; i++) {
+        local->column_ids[i] = (idx_t)bind->cols[duckdb_init_get_column_index(info, i)];
+    }
+    duckdb_init_set_init_data(info, local, destroy_overlap_local);
+}
+
+/* ================================================================
+ * Scan
+ * ================================================================ */
+
+/* Claim work items until the local reader holds the next streamed record. */
+static int overlap_next_record(const overlap_bind_data_t *bind, overlap_global_data_t *global,
+                               overlap_local_data_t *local, char *err, size_t err_len) {
+    for (;;) {
+        if (local->has_reader) {
+            int ret = ivl_reader_next(&local->reader);
+            if (ret > 0) return 1;
+            if (ret < 0) {
+                snprintf(err, err_len, "interval_overlap: failed to parse intervals from %s",
+                         bind->index_left ? bind->right_path : bind->left_path);
+                return -1;
+            }
+            ivl_reader_close(&local->reader);
+            local->has_reader = 0;
+        }
+        int item = __sync_fetch_and_add(&global->next_item, 1);
+        if (item >= bind->n_items) return 0;
+        const char *path = bind->index_left ? bind->right_path : bind->left_path;
+        if (ivl_reader_open(&local->reader, "interval_overlap", path, bind->items[item] != NULL,
+                            err, err_len) != 0) {
+            return -1;
+        }
+        local->has_reader = 1;
+        if (bind->items[item] && ivl_reader_query(&local->reader, bind->items[item]) != 0) {
+            ivl_reader_close(&local->reader);
+            local->has_reader = 0;
+        }
+    }
+}
+
+static int64_t lower_bound_start(const cgranges_t *cr, int64_t lo, int64_t hi, int64_t pos) {
+    while (lo < hi) {
+        int64_t mid = lo + (hi - lo) / 2;
+        if (cr_start(cr, mid) < pos) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/* Closest non-overlapping interval on the query's contig, or -1. */
+static int64_t nearest_interval(const overlap_global_data_t *global, const char *chrom,
+                                int64_t start, int64_t end, int64_t *distance) {
+    const cgranges_t *cr = global->cr;
+    int32_t k = cr_get_ctg(cr, chrom);
+    if (k < 0 || cr->ctg[k].n == 0) return -1;
+    int64_t off = cr->ctg[k].off;
+    int64_t lim = off + cr->ctg[k].n;
+    int64_t best = -1;
+
+    int64_t up = lower_bound_start(cr, off, lim, start) - 1;
+    if (up >= off) {
+        best = global->prefix_max[up];
+        *distance = start - cr_end(cr, best) + 1;
+    }
+    int64_t down = lower_bound_start(cr, off, lim, end);
+    if (down < lim) {
+        int64_t d = cr_start(cr, down) - end + 1;
+        if (best < 0 || d < *distance) {
+            best = down;
+            *distance = d;
+        }
+    }
+    return best;
+}
+
+static void write_name(duckdb_vector vec, idx_t row, const overlap_global_data_t *global, int64_t label) {
+    if (label < 0 || global->name_off[label] < 0) {
+        duckdb_vector_ensure_validity_writable(vec);
+        duckdb_validity_set_row_invalid(duckdb_vector_get_validity(vec), row);
+        return;
+    }
+    duckdb_vector_assign_string_element(vec, row, global->names.s + global->name_off[label]);
+}
+
+static void set_row_null(duckdb_vector vec, idx_t row) {
+    duckdb_vector_ensure_validity_writable(vec);
+    duckdb_validity_set_row_invalid(duckdb_vector_get_validity(vec), row);
+}
+
+/* Write one output row. hit is a cgranges index (-1 = no right interval). */
+static void emit_overlap_row(const overlap_bind_data_t *bind, const overlap_global_data_t *global,
+                             overlap_local_data_t *local, duckdb_data_chunk output, idx_t row,
+                             int64_t hit, int64_t n_overlaps, int64_t distance) {
+    const ivl_reader_t *r = &local->reader;
+    const cgranges_t *cr = global->cr;
+    int64_t hit_start = hit >= 0 ? cr_start(cr, hit) : 0;
+    int64_t hit_end = hit >= 0 ? cr_end(cr, hit) : 0;
+    int64_t hit_label = hit >= 0 ? cr_label(cr, hit) : -1;
+    int swapped = bind->index_left;
+
+    for (idx_t c = 0; c < local->n_projected_cols; c++) {
+        duckdb_vector vec = duckdb_data_chunk_get_vector(output, c);
+        int64_t *data = (int64_t *)duckdb_vector_get_data(vec);
+        int col = (int)local->column_ids[c];
+        /* When the left side is indexed, left columns come from the hit. */
+        if (swapped && col >= OVL_COL_LEFT_START && col <= OVL_COL_RIGHT_NAME) {
+            col = col <= OVL_COL_LEFT_NAME ? col + 3 : col - 3;
+        }
+        switch (col) {
+            case OVL_COL_CHROM:
+                duckdb_vector_assign_string_element_len(vec, row, r->chrom.s, r->chrom.l);
+                break;
+            case OVL_COL_LEFT_START: data[row] = r->start; break;
+            case OVL_COL_LEFT_END: data[row] = r->end; break;
+            case OVL_COL_LEFT_NAME:
+                if (r->has_name) duckdb_vector_assign_string_element_len(vec, row, r->name.s, r->name.l);
+                else set_row_null(vec, row);
+                break;
+            case OVL_COL_RIGHT_START:
+                if (hit >= 0) data[row] = hit_start;
+                else set_row_null(vec, row);
+                break;
+            case OVL_COL_RIGHT_END:
+                if (hit >= 0) data[row] = hit_end;
+                else set_row_null(vec, row);
+                break;
+            case OVL_COL_RIGHT_NAME:
+                write_name(vec, row, global, hit_label);
+                break;
+            case OVL_COL_OVERLAP: {
+                if (hit < 0) {
+                    set_row_null(vec, row);
+                    break;
+                }
+                int64_t lo = r->start > hit_start ? r->start : hit_start;
+                int64_t hi = r->end < hit_end ? r->end : hit_end;
+                data[row] = hi > lo ? hi - lo : 0;
+                break;
+            }
+            case OVL_COL_DISTANCE:
+                if (hit >= 0) data[row] = distance;
+                else set_row_null(vec, row);
+                break;
+            case OVL_COL_N_OVERLAPS: data[row] = n_overlaps; break;
+            default: break;
+        }
+    }
+}
+
+static void overlap_scan(duckdb_function_info info, duckdb_data_chunk output) {
+    overlap_bind_data_t *bind = (overlap_bind_data_t *)duckdb_function_get_bind_data(info);
+    overlap_global_data_t *global = (overlap_global_data_t *)duckdb_function_get_init_data(info);
+    overlap_local_data_t *local = (overlap_local_data_t *)duckdb_function_get_local_init_data(info);
+    idx_t capacity = duckdb_vector_size();
+    idx_t row = 0;
+    char err[512];
+
+    while (row < capacity && !local->finished) {
+        /* Drain pending pairs of the current record (mode any) */
+        if (local->have_record && local->hit_pos < local->n_hits) {
+            emit_overlap_row(bind, global, local, output, row++, local->hits[local->hit_pos++], 0, 0);
+            continue;
+        }
+        local->have_record = 0;
+
+        int ret = overlap_next_record(bind, global, local, err, sizeof(err));
+        if (ret < 0) {
+            duckdb_function_set_error(info, err);
+            local->finished = 1;
+            break;
+        }
+        if (ret == 0) {
+            local->finished = 1;
+            break;
+        }
+
+        const ivl_reader_t *r = &local->reader;
+        int64_t qs = r->start < 0 ? 0 : r->start;
+        int64_t qe = r->end > INT32_MAX ? INT32_MAX : r->end;
+        local->n_hits = cr_overlap(global->cr, r->chrom.s, (int32_t)qs, (int32_t)qe,
+                                   &local->hits, &local->m_hits);
+        local->hit_pos = 0;
+
+        switch (bind->mode) {
+            case OVERLAP_MODE_ANY:
+                local->have_record = 1;
+                break;
+            case OVERLAP_MODE_COUNT:
+                emit_overlap_row(bind, global, local, output, row++, -1, local->n_hits, 0);
+                break;
+            case OVERLAP_MODE_FIRST:
+            case OVERLAP_MODE_NEAREST: {
+                int64_t hit = -1;
+                int64_t distance = 0;
+                for (int64_t i = 0; i < local->n_hits; i++) {
+                    /* cgranges indices follow start order within a contig */
+                    if (hit < 0 || local->hits[i] < hit) hit = local->hits[i];
+                }
+                if (hit < 0 && bind->mode == OVERLAP_MODE_FIRST) break;
+                if (hit < 0) hit = nearest_interval(global, r->chrom.s, r->start, r->end, &distance);
+                emit_overlap_row(bind, global, local, output, row++, hit, 0, distance);
+                break;
+            }
+        }
+    }
+    duckdb_data_chunk_set_size(output, row);
+}
+
+void register_interval_overlap_function(duckdb_connection connection) {
+    duckdb_table_function tf = duckdb_create_table_function();
+    duckdb_table_function_set_name(tf, "interval_overlap");
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "mode", varchar_type);
+    duckdb_destroy_logical_type(&varchar_type);
+
+    duckdb_table_function_set_bind(tf, overlap_bind);
+    duckdb_table_function_set_init(tf, overlap_global_init);
+    duckdb_table_function_set_local_init(tf, overlap_local_init);
+    duckdb_table_function_set_function(tf, overlap_scan);
+    duckdb_table_function_supports_projection_pushdown(tf, true);
+    duckdb_register_table_function(connection, tf);
+    duckdb_destroy_table_function(&tf);
+}
+
+/* ================================================================
+ * interval_contains / interval_overlaps
+ * ================================================================ */
+
+/* Immutable interval index shared by all scalar calls on the same file. */
+typedef struct {
+    file_cache_entry_t base;
+    cgranges_t *cr;
+    int32_t *max_end;   /* running max of interval ends within each contig */
+} ivm_index_t;
+
+static void ivm_index_free(file_cache_entry_t *entry) {
+    ivm_index_t *idx = (ivm_index_t *)entry;
+    if (idx->cr) cr_destroy(idx->cr);
+    free(idx->max_end);
+    free(idx->base.path);
+    free(idx);
+}
+
+static file_cache_t ivm_cache = FILE_CACHE_INIT(ivm_index_free);
+
+/* Cache loader; arg is the calling function's name for messages. */
+static file_cache_entry_t *ivm_index_load(const char *path, void *arg, char *err, size_t err_len) {
+    const char *fname = (const char *)arg;
+    ivl_reader_t reader;
+    if (ivl_reader_open(&reader, fname, path, 0, err, err_len) != 0) return NULL;
+
+    ivm_index_t *idx = (ivm_index_t *)calloc(1, sizeof(ivm_index_t));
+    idx->base.path = strdup(path);
+    idx->cr = cr_init();
+    int ret;
+    while ((ret = ivl_reader_next(&reader)) > 0) {
+        if (reader.start < 0 || reader.end > INT32_MAX || reader.end < reader.start) {
+            snprintf(err, err_len, "%s: interval %s:%lld-%lld is out of range", fname,
+                     reader.chrom.s, (long long)reader.start, (long long)reader.end);
+            ivl_reader_close(&reader);
+            ivm_index_free(&idx->base);
+            return NULL;
+        }
+        cr_add(idx->cr, reader.chrom.s, (int32_t)reader.start, (int32_t)reader.end, 0);
+    }
+    ivl_reader_close(&reader);
+    if (ret < 0) {
+        snprintf(err, err_len, "%s: failed to parse intervals from %s", fname, path);
+        ivm_index_free(&idx->base);
+        return NULL;
+    }
+    cr_index(idx->cr);
+
+    idx->max_end = (int32_t *)malloc(sizeof(int32_t) * (size_t)(idx->cr->n_r > 0 ? idx->cr->n_r : 1));
+    for (int32_t k = 0; k < idx->cr->n_ctg; k++) {
+        int64_t off = idx->cr->ctg[k].off;
+        int64_t n = idx->cr->ctg[k].n;
+        for (int64_t i = off; i < off + n; i++) {
+            int32_t e = cr_end(idx->cr, i);
+            idx->max_end[i] = i > off && idx->max_end[i - 1] > e ? idx->max_end[i - 1] : e;
+        }
+    }
+    return &idx->base;
+}
+
+/* Take a reference to the cached index for path, (re)loading it when the
+ * file is new or its mtime/size changed. */
+static ivm_index_t *ivm_acquire(const char *fname, const char *path, char *err, size_t err_len) {
+    return (ivm_index_t *)file_cache_acquire(&ivm_cache, path, ivm_index_load, (void *)fname, err, err_len);
+}
+
+static void ivm_release(ivm_index_t *idx) {
+    if (idx) file_cache_release(&ivm_cache, &idx->base);
+}
+
+/* Does any interval in cr->r[off, off + n) overlap [st, en)? Intervals are
+ * sorted by start, so binary search for the last one starting before en and
+ * check the running max of ends up to it. */
+static bool ivm_any_overlap(const ivm_index_t *idx, int64_t off, int64_t n, int64_t st, int64_t en) {
+    int64_t lo = off, hi = off + n;
+    while (lo < hi) {
+        int64_t mid = lo + (hi - lo) / 2;
+        if ((int64_t)cr_start(idx->cr, mid) < en) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo > off && (int64_t)idx->max_end[lo - 1] > st;
+}
+
+/* Shared body of both functions. Rows are matched against the index of the
+ * current path, and the contig is looked up once per run of equal chroms. */
+static void interval_membership_execute(duckdb_function_info info, duckdb_data_chunk input,
+                                        duckdb_vector output, const char *fname, int has_end) {
+    idx_t n_rows = duckdb_data_chunk_get_size(input);
+    duckdb_vector chrom_vec = duckdb_data_chunk_get_vector(input, 0);
+    duckdb_vector start_vec = duckdb_data_chunk_get_vector(input, 1);
+    duckdb_vector end_vec = has_end ? duckdb_data_chunk_get_vector(input, 2) : NULL;
+    duckdb_vector path_vec = duckdb_data_chunk_get_vector(input, has_end ? 3 : 2);
+    const int64_t *starts = (const int64_t *)duckdb_vector_get_data(start_vec);
+    const int64_t *ends = end_vec ? (const int64_t *)duckdb_vector_get_data(end_vec) : NULL;
+    bool *out = (bool *)duckdb_vector_get_data(output);
+
+    ivm_index_t *idx = NULL;
+    kstring_t path = {0, 0, NULL};
+    kstring_t chrom = {0, 0, NULL};
+    int have_chrom = 0;
+    int64_t ctg_off = 0, ctg_n = 0;
+    char err[512];
+
+    for (idx_t row = 0; row < n_rows; row++) {
+        if (!row_is_valid(chrom_vec, row) || !row_is_valid(start_vec, row) ||
+            (end_vec && !row_is_valid(end_vec, row)) || !row_is_valid(path_vec, row)) {
+            duckdb_vector_ensure_validity_writable(output);
+            duckdb_validity_set_row_invalid(duckdb_vector_get_validity(output), row);
+            continue;
+        }
+
+        idx_t len;
+        const char *s = get_string_at(path_vec, row, &len);
+        if (!idx || path.l != len || memcmp(path.s, s, len) != 0) {
+            ivm_release(idx);
+            path.l = 0;
+            kputsn(s, len, &path);
+            idx = ivm_acquire(fname, path.s, err, sizeof(err));
+            if (!idx) {
+                duckdb_scalar_function_set_error(info, err);
+                break;
+            }
+            have_chrom = 0;
+        }
+
+        s = get_string_at(chrom_vec, row, &len);
+        if (!have_chrom || chrom.l != len || memcmp(chrom.s, s, len) != 0) {
+            chrom.l = 0;
+            kputsn(s, len, &chrom);
+            int32_t k = cr_get_ctg(idx->cr, chrom.s);
+            ctg_off = k >= 0 ? idx->cr->ctg[k].off : 0;
+            ctg_n = k >= 0 ? idx->cr->ctg[k].n : 0;
+            have_chrom = 1;
+        }
+
+        int64_t st = has_end ? starts[row] : starts[row] - 1;
+        int64_t en = has_end ? ends[row] : starts[row];
+        out[row] = ctg_n > 0 && ivm_any_overlap(idx, ctg_off, ctg_n, st, en);
+    }
+
+    ivm_release(idx);
+    free(path.s);
+    free(chrom.s);
+}
+
+static void interval_contains_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output) {
+    interval_membership_execute(info, input, output, "interval_contains", 0);
+}
+
+static void interval_overlaps_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output) {
+    interval_membership_execute(info, input, output, "interval_overlaps", 1);
+}
+
+static void register_interval_membership_function(duckdb_connection connection, const char *name,
+                                                  int has_end, duckdb_scalar_function_t fn_ptr) {
+    duckdb_scalar_function fn = duckdb_create_scalar_function();
+    duckdb_scalar_function_set_name(fn, name);
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_logical_type bool_type = duckdb_create_logical_type(DUCKDB_TYPE_BOOLEAN);
+    duckdb_scalar_function_add_parameter(fn, varchar_type);
+    duckdb_scalar_function_add_parameter(fn, bigint_type);
+    if (has_end) duckdb_scalar_function_add_parameter(fn, bigint_type);
+    duckdb_scalar_function_add_parameter(fn, varchar_type);
+    duckdb_scalar_function_set_return_type(fn, bool_type);
+    duckdb_scalar_function_set_function(fn, fn_ptr);
+
+    duckdb_register_scalar_function(connection, fn);
+
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_logical_type(&bool_type);
+    duckdb_destroy_scalar_function(&fn);
+}
+
+void register_interval_membership_functions(duckdb_connection connection) {
+    register_interval_membership_function(connection, "interval_contains", 0, interval_contains_scalar);
+    register_interval_membership_function(connection, "interval_overlaps", 1, interval_overlaps_scalar);
+}
+
+/* ================================================================
+ * interval_merge / interval_complement / interval_subtract /
+ * interval_cluster
+ * ================================================================ */
+
+#define IVS_MAX_THREADS 16
+
+typedef enum {
+    IVS_OP_MERGE = 0,
+    IVS_OP_COMPLEMENT,
+    IVS_OP_SUBTRACT,
+    IVS_OP_CLUSTER
+} ivs_op_t;
+
+enum {
+    IVS_COL_CHROM = 0,
+    IVS_COL_START,
+    IVS_COL_END,
+    IVS_COL_NAME,
+    IVS_COL_N_INTERVALS,
+    IVS_COL_CLUSTER,
+    IVS_NCOLS
+};
+
+typedef struct {
+    int64_t start;
+    int64_t end;
+    int64_t name;       /* offset into names, -1 = no name */
+} ivs_interval_t;
+
+typedef struct {
+    ivs_interval_t *iv;
+    int64_t n;
+    int64_t m;
+} ivs_list_t;
+
+typedef struct {
+    char *name;
+    int64_t len;        /* genome length (complement), -1 = not in the genome */
+    ivs_list_t a;       /* input intervals */
+    ivs_list_t b;       /* intervals to subtract */
+} ivs_contig_t;
+
+typedef struct {
+    int64_t start;
+    int64_t end;
+    int64_t name;
+    int64_t count;      /* n_intervals (merge) or cluster id (cluster) */
+} ivs_row_t;
+
+KHASH_MAP_INIT_STR(ivs_ctg, int)
+
+typedef struct {
+    ivs_op_t op;
+    const char *fname;
+    char *path;
+    char *other_path;   /* subtract: intervals to remove; complement: genome file */
+    int64_t distance;
+    int n_cols;
+    int cols[IVS_NCOLS];
+} ivs_bind_data_t;
+
+typedef struct {
+    ivs_contig_t *contigs;
+    int n_contigs;
+    int m_contigs;
+    khash_t(ivs_ctg) *ids;
+    kstring_t names;
+    volatile int next_contig;
+} ivs_global_data_t;
+
+typedef struct {
+    ivs_row_t *rows;
+    int64_t n_rows;
+    int64_t m_rows;
+    int64_t pos;
+    int contig;
+    int finished;
+    idx_t *column_ids;
+    idx_t n_projected_cols;
+} ivs_local_data_t;
+
+static void destroy_ivs_bind(void *data) {
+    ivs_bind_data_t *bind = (ivs_bind_data_t *)data;
+    if (!bind) return;
+    free(bind->path);
+    free(bind->other_path);
+    free(bind);
+}
+
+static void destroy_ivs_global(void *data) {
+    ivs_global_data_t *global = (ivs_global_data_t *)data;
+    if (!global) return;
+    for (int i = 0; i < global->n_contigs; i++) {
+        free(global->contigs[i].name);
+        free(global->contigs[i].a.iv);
+        free(global->contigs[i].b.iv);
+    }
+    free(global->contigs);
+    if (global->ids) kh_destroy(ivs_ctg, global->ids);
+    free(global->names.s);
+    free(global);
+}
+
+static void destroy_ivs_local(void *data) {
+    ivs_local_data_t *local = (ivs_local_data_t *)data;
+    if (!local) return;
+    free(local->rows);
+    free(local->column_ids);
+    free(local);
+}
+
+/* Contig id for name, adding it when create is set; -1 if absent. */
+static int ivs_contig_id(ivs_global_data_t *global, const char *name, int create) {
+    khint_t k = kh_get(ivs_ctg, global->ids, name);
+    if (k != kh_end(global->ids)) return kh_value(global->ids, k);
+    if (!create) return -1;
+    if (global->n_contigs == global->m_contigs) {
+        global->m_contigs = global->m_contigs ? global->m_contigs * 2 : 64;
+        global->contigs = (ivs_contig_t *)realloc(global->contigs, sizeof(ivs_contig_t) * (size_t)global->m_contigs);
+    }
+    ivs_contig_t *ctg = &global->contigs[global->n_contigs];
+    memset(ctg, 0, sizeof(*ctg));
+    ctg->name = strdup(name);
+    ctg->len = -1;
+    int absent;
+    k = kh_put(ivs_ctg, global->ids, ctg->name, &absent);
+    kh_value(global->ids, k) = global->n_contigs;
+    return global->n_contigs++;
+}
+
+static void ivs_list_push(ivs_list_t *list, int64_t start, int64_t end, int64_t name) {
+    if (list->n == list->m) {
+        list->m = list->m ? list->m * 2 : 256;
+        list->iv = (ivs_interval_t *)realloc(list->iv, sizeof(ivs_interval_t) * (size_t)list->m);
+    }
+    list->iv[list->n].start = start;
+    list->iv[list->n].end = end;
+    list->iv[list->n].name = name;
+    list->n++;
+}
+
+/* Read every interval of path into list a or b of its contig. Contigs not
+ * yet known are added unless known_only is set (complement), in which case
+ * their intervals are dropped. */
+static int ivs_load(const ivs_bind_data_t *bind, ivs_global_data_t *global, const char *path, int into_b,
+                    int known_only, char *err, size_t err_len) {
+    ivl_reader_t reader;
+    if (ivl_reader_open(&reader, bind->fname, path, 0, err, err_len) != 0) return -1;
+    int keep_names = !into_b && (bind->op == IVS_OP_SUBTRACT || bind->op == IVS_OP_CLUSTER);
+    int contig = -1;
+    int ret;
+    while ((ret = ivl_reader_next(&reader)) > 0) {
+        if (reader.end < reader.start) {
+            snprintf(err, err_len, "%s: interval %s:%lld-%lld ends before it starts", bind->fname, reader.chrom.s,
+                     (long long)reader.start, (long long)reader.end);
+            ivl_reader_close(&reader);
+            return -1;
+        }
+        /* Inputs are usually grouped by contig, so reuse the last lookup. */
+        if (contig < 0 || strcmp(global->contigs[contig].name, reader.chrom.s) != 0) {
+            contig = ivs_contig_id(global, reader.chrom.s, !known_only);
+            if (contig < 0) continue;
+        }
+        int64_t name = -1;
+        if (keep_names && reader.has_name) {
+            name = (int64_t)global->names.l;
+            kputsn(reader.name.s, reader.name.l, &global->names);
+            kputc('\0', &global->names);
+        }
+        ivs_contig_t *ctg = &global->contigs[contig];
+        ivs_list_push(into_b ? &ctg->b : &ctg->a, reader.start, reader.end, name);
+    }
+    ivl_reader_close(&reader);
+    if (ret < 0) {
+        snprintf(err, err_len, "%s: failed to parse intervals from %s", bind->fname, path);
+        return -1;
+    }
+    return 0;
+}
+
+/* Contig lengths from a genome file: a .fai or any name<TAB>length table.
+ * Read with stdio, since htslib's format detection claims .fai files. */
+static int ivs_load_genome(const ivs_bind_data_t *bind, ivs_global_data_t *global, char *err, size_t err_len) {
+    FILE *fp = fopen(bind->other_path, "r");
+    if (!fp) {
+        snprintf(err, err_len, "%s: failed to open genome file: %s", bind->fname, bind->other_path);
+        return -1;
+    }
+    char line[4096];
+    while (fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+        char *tab = strchr(line, '\t');
+        int64_t len = 0;
+        if (!tab || !parse_coord(tab + 1, (int)strcspn(tab + 1, "\t"), &len) || len < 0) {
+            snprintf(err, err_len, "%s: malformed genome line in %s: %.200s", bind->fname, bind->other_path, line);
+            fclose(fp);
+            return -1;
+        }
+        *tab = '\0';
+        int contig = ivs_contig_id(global, line, 1);
+        global->contigs[contig].len = len;
+    }
+    fclose(fp);
+    return 0;
+}
+
+static char *ivs_named_string(duckdb_bind_info info, const char *name) {
+    duckdb_value val = duckdb_bind_get_named_parameter(info, name);
+    char *s = (val && !duckdb_is_null_value(val)) ? duckdb_get_varchar(val) : NULL;
+    if (val) duckdb_destroy_value(&val);
+    char *out = (s && s[0]) ? strdup(s) : NULL;
+    if (s) duckdb_free(s);
+    return out;
+}
+
+static void ivs_bind(duckdb_bind_info info, ivs_op_t op, const char *fname) {
+    char err[512];
+    ivs_bind_data_t *bind = (ivs_bind_data_t *)calloc(1, sizeof(ivs_bind_data_t));
+    if (!bind) {
+        duckdb_bind_set_error(info, "Out of memory");
+        return;
+    }
+    bind->op = op;
+    bind->fname = fname;
+    bind->path = get_string_param(info, 0);
+    if (op == IVS_OP_SUBTRACT) bind->other_path = get_string_param(info, 1);
+    if (op == IVS_OP_COMPLEMENT) bind->other_path = ivs_named_string(info, "genome");
+    if (!bind->path || ((op == IVS_OP_SUBTRACT || op == IVS_OP_COMPLEMENT) && !bind->other_path)) {
+        snprintf(err, sizeof(err), "%s requires %s", fname,
+                 op == IVS_OP_SUBTRACT ? "an interval file and a file of intervals to subtract"
+                 : op == IVS_OP_COMPLEMENT ? "an interval file and genome := '<genome file or .fai>'"
+                 : "an interval file path");
+        duckdb_bind_set_error(info, err);
+        destroy_ivs_bind(bind);
+        return;
+    }
+
+    if (op == IVS_OP_MERGE || op == IVS_OP_CLUSTER) {
+        duckdb_value val = duckdb_bind_get_named_parameter(info, "distance");
+        if (val && !duckdb_is_null_value(val)) bind->distance = duckdb_get_int64(val);
+        if (val) duckdb_destroy_value(&val);
+        if (bind->distance < 0) {
+            snprintf(err, sizeof(err), "%s: distance must be >= 0", fname);
+            duckdb_bind_set_error(info, err);
+            destroy_ivs_bind(bind);
+            return;
+        }
+    }
+
+    ivl_reader_t reader;
+    if (ivl_reader_open(&reader, fname, bind->path, 0, err, sizeof(err)) != 0) {
+        duckdb_bind_set_error(info, err);
+        destroy_ivs_bind(bind);
+        return;
+    }
+    ivl_reader_close(&reader);
+    if (op == IVS_OP_SUBTRACT && ivl_reader_open(&reader, fname, bind->other_path, 0, err, sizeof(err)) != 0) {
+        duckdb_bind_set_error(info, err);
+        destroy_ivs_bind(bind);
+        return;
+    }
+    if (op == IVS_OP_SUBTRACT) ivl_reader_close(&reader);
+
+    static const char *col_names[IVS_NCOLS] = {"chrom", "start", "end", "name", "n_intervals", "cluster_id"};
+    for (int c = IVS_COL_CHROM; c <= IVS_COL_END; c++) bind->cols[bind->n_cols++] = c;
+    if (op == IVS_OP_MERGE) bind->cols[bind->n_cols++] = IVS_COL_N_INTERVALS;
+    if (op == IVS_OP_SUBTRACT || op == IVS_OP_CLUSTER) bind->cols[bind->n_cols++] = IVS_COL_NAME;
+    if (op == IVS_OP_CLUSTER) bind->cols[bind->n_cols++] = IVS_COL_CLUSTER;
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    for (int i = 0; i < bind->n_cols; i++) {
+        int c = bind->cols[i];
+        int is_text = c == IVS_COL_CHROM || c == IVS_COL_NAME;
+        duckdb_bind_add_result_column(info, col_names[c], is_text ? varchar_type : bigint_type);
+    }
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+
+    duckdb_bind_set_bind_data(info, bind, destroy_ivs_bind);
+}
+
+static void interval_merge_bind(duckdb_bind_info info) { ivs_bind(info, IVS_OP_MERGE, "interval_merge"); }
+static void interval_complement_bind(duckdb_bind_info info) {
+    ivs_bind(info, IVS_OP_COMPLEMENT, "interval_complement");
+}
+static void interval_subtract_bind(duckdb_bind_info info) { ivs_bind(info, IVS_OP_SUBTRACT, "interval_subtract"); }
+static void interval_cluster_bind(duckdb_bind_info info) { ivs_bind(info, IVS_OP_CLUSTER, "interval_cluster"); }
+
+/* Read all inputs, grouped by contig; sorting and sweeping happen per
+ * contig in the scan threads. */
+static void ivs_global_init(duckdb_init_info info) {
+    ivs_bind_data_t *bind = (ivs_bind_data_t *)duckdb_init_get_bind_data(info);
+    ivs_global_data_t *global = (ivs_global_data_t *)calloc(1, sizeof(ivs_global_data_t));
+    char err[512];
+    if (!global) {
+        duckdb_init_set_error(info, "Out of memory");
+        return;
+    }
+    global->ids = kh_init(ivs_ctg);
+    int ok = 1;
+    if (bind->op == IVS_OP_COMPLEMENT) {
+        /* Genome order drives the output; intervals off the genome are dropped */
+        ok = ivs_load_genome(bind, global, err, sizeof(err)) == 0 &&
+             ivs_load(bind, global, bind->path, 0, 1, err, sizeof(err)) == 0;
+    } else {
+        ok = ivs_load(bind, global, bind->path, 0, 0, err, sizeof(err)) == 0;
+        /* Intervals to subtract only matter on contigs that have input */
+        if (ok && bind->op == IVS_OP_SUBTRACT) ok = ivs_load(bind, global, bind->other_path, 1, 1, err, sizeof(err)) == 0;
+    }
+    if (!ok) {
+        duckdb_init_set_error(info, err);
+        destroy_ivs_global(global);
+        return;
+    }
+    idx_t max_threads = (idx_t)global->n_contigs;
+    if (max_threads > IVS_MAX_THREADS) max_threads = IVS_MAX_THREADS;
+    if (max_threads < 1) max_threads = 1;
+    duckdb_init_set_max_threads(info, max_threads);
+    duckdb_init_set_init_data(info, global, destroy_ivs_global);
+}
+
+static void ivs_local_init(duckdb_init_info info) {
+    ivs_bind_data_t *bind = (ivs_bind_data_t *)duckdb_init_get_bind_data(info);
+    ivs_local_data_t *local = (ivs_local_data_t *)calloc(1, sizeof(ivs_local_data_t));
+    if (!local) {
+        duckdb_init_set_error(info, "Out of memory");
+        return;
+    }
+    local->contig = -1;
+    local->n_projected_cols = duckdb_init_get_column_count(info);
+    local->column_ids = (idx_t *)malloc(sizeof(idx_t) * (local->n_projected_cols ? local->n_projected_cols : 1));
+    for (idx_t i = 0; i < local->n_projected_cols; i++) {
+        local->column_ids[i] = (idx_t)bind->cols[duckdb_init_get_column_index(info, i)];
+    }
+    duckdb_init_set_init_data(info, local, destroy_ivs_local);
+}
+
+static int ivs_interval_cmp(const void *pa, const void *pb) {
+    const ivs_interval_t *a = (const ivs_interval_t *)pa;
+    const ivs_interval_t *b = (const ivs_interval_t *)pb;
+    if (a->start != b->start) return a->start < b->start ? -1 : 1;
+    if (a->end != b->end) return a->end < b->end ? -1 : 1;
+    return 0;
+}
+
+/* Sort by start unless the input already is (the common case for BED,
+ * VCF and BAM files), which a single pass verifies. */
+static void ivs_sort(ivs_list_t *list) {
+    for (int64_t i = 1; i < list->n; i++) {
+        if (ivs_interval_cmp(&list->iv[i - 1], &list->iv[i]) > 0) {
+            qsort(list->iv, (size_t)list->n, sizeof(ivs_interval_t), ivs_interval_cmp);
+            return;
+        }
+    }
+}
+
+static void ivs_push_row(ivs_local_data_t *local, int64_t start, int64_t end, int64_t name, int64_t count) {
+    if (local->n_rows == local->m_rows) {
+        local->m_rows = local->m_rows ? local->m_rows * 2 : 1024;
+        local->rows = (ivs_row_t *)realloc(local->rows, sizeof(ivs_row_t) * (size_t)local->m_rows);
+    }
+    ivs_row_t *row = &local->rows[local->n_rows++];
+    row->start = start;
+    row->end = end;
+    row->name = name;
+    row->count = count;
+}
+
+/* One linear sweep over a sorted contig, filling local->rows. */
+static void ivs_sweep(const ivs_bind_data_t *bind, ivs_contig_t *ctg, ivs_local_data_t *local) {
+    local->n_rows = 0;
+    local->pos = 0;
+    ivs_sort(&ctg->a);
+    const ivs_interval_t *iv = ctg->a.iv;
+    int64_t n = ctg->a.n;
+
+    switch (bind->op) {
+        case IVS_OP_MERGE:
+        case IVS_OP_CLUSTER: {
+            int64_t cluster = 0, first = 0, start = 0, end = 0;
+            for (int64_t i = 0; i <= n; i++) {
+                if (i < n && i > 0 && iv[i].start <= end + bind->distance) {
+                    if (iv[i].end > end) end = iv[i].end;
+                    if (bind->op == IVS_OP_CLUSTER) ivs_push_row(local, iv[i].start, iv[i].end, iv[i].name, cluster);
+                    continue;
+                }
+                if (i > 0 && bind->op == IVS_OP_MERGE) ivs_push_row(local, start, end, -1, i - first);
+                if (i == n) break;
+                cluster++;
+                first = i;
+                start = iv[i].start;
+                end = iv[i].end;
+                if (bind->op == IVS_OP_CLUSTER) ivs_push_row(local, iv[i].start, iv[i].end, iv[i].name, cluster);
+            }
+            break;
+        }
+        case IVS_OP_COMPLEMENT: {
+            int64_t pos = 0;
+            for (int64_t i = 0; i < n && pos < ctg->len; i++) {
+                int64_t gap_end = iv[i].start < ctg->len ? iv[i].start : ctg->len;
+                if (gap_end > pos) ivs_push_row(local, pos, gap_end, -1, 0);
+                if (iv[i].end > pos) pos = iv[i].end;
+            }
+            if (pos < ctg->len) ivs_push_row(local, pos, ctg->len, -1, 0);
+            break;
+        }
+        case IVS_OP_SUBTRACT: {
+            /* Merge the removed intervals so each input interval walks a
+             * disjoint, sorted list from where the previous one began. */
+            ivs_sort(&ctg->b);
+            int64_t nb = 0;
+            for (int64_t k = 0; k < ctg->b.n; k++) {
+                ivs_interval_t *cur = &ctg->b.iv[k];
+                if (nb > 0 && cur->start <= ctg->b.iv[nb - 1].end) {
+                    if (cur->end > ctg->b.iv[nb - 1].end) ctg->b.iv[nb - 1].end = cur->end;
+                } else {
+                    ctg->b.iv[nb++] = *cur;
+                }
+            }
+            ctg->b.n = nb;
+            const ivs_interval_t *rm = ctg->b.iv;
+            int64_t j = 0;
+            for (int64_t i = 0; i < n; i++) {
+                while (j < nb && rm[j].end <= iv[i].start) j++;
+                int64_t pos = iv[i].start;
+                for (int64_t k = j; k < nb && rm[k].start < iv[i].end; k++) {
+                    if (rm[k].start > pos) ivs_push_row(local, pos, rm[k].start, iv[i].name, 0);
+                    if (rm[k].end > pos) pos = rm[k].end;
+                }
+                /* Zero-length intervals survive unless strictly inside a removed one */
+                if (pos < iv[i].end || (iv[i].start == iv[i].end && pos == iv[i].start)) {
+                    ivs_push_row(local, pos, iv[i].end, iv[i].name, 0);
+                }
+            }
+            break;
+        }
+    }
+}
+
+static void ivs_scan(duckdb_function_info info, duckdb_data_chunk output) {
+    ivs_bind_data_t *bind = (ivs_bind_data_t *)duckdb_function_get_bind_data(info);
+    ivs_global_data_t *global = (ivs_global_data_t *)duckdb_function_get_init_data(info);
+    ivs_local_data_t *local = (ivs_local_data_t *)duckdb_function_get_local_init_data(info);
+    idx_t capacity = duckdb_vector_size();
+    idx_t row = 0;
+
+    while (row < capacity && !local->finished) {
+        if (local->contig < 0 || local->pos >= local->n_rows) {
+            int contig = __sync_fetch_and_add(&global->next_contig, 1);
+            if (contig >= global->n_contigs) {
+                local->finished = 1;
+                break;
+            }
+            ivs_contig_t *ctg = &global->contigs[contig];
+            if (bind->op == IVS_OP_COMPLEMENT && ctg->len < 0) continue;
+            local->contig = contig;
+            ivs_sweep(bind, ctg, local);
+            continue;
+        }
+
+        const ivs_contig_t *ctg = &global->contigs[local->contig];
+        const ivs_row_t *r = &local->rows[local->pos++];
+        for (idx_t c = 0; c < local->n_projected_cols; c++) {
+            duckdb_vector vec = duckdb_data_chunk_get_vector(output, c);
+            int64_t *data = (int64_t *)duckdb_vector_get_data(vec);
+            switch ((int)local->column_ids[c]) {
+                case IVS_COL_CHROM: duckdb_vector_assign_string_element(vec, row, ctg->name); break;
+                case IVS_COL_START: data[row] = r->start; break;
+                case IVS_COL_END: data[row] = r->end; break;
+                case IVS_COL_NAME:
+                    if (r->name >= 0) duckdb_vector_assign_string_element(vec, row, global->names.s + r->name);
+                    else set_row_null(vec, row);
+                    break;
+                case IVS_COL_N_INTERVALS:
+                case IVS_COL_CLUSTER: data[row] = r->count; break;
+                default: break;
+            }
+        }
+        row++;
+    }
+    duckdb_data_chunk_set_size(output, row);
+}
+
+static void register_interval_set_function(duckdb_connection connection, const char *name, ivs_op_t op,
+                                           duckdb_table_function_bind_t bind_fn) {
+    duckdb_table_function tf = duckdb_create_table_function();
+    duckdb_table_function_set_name(tf, name);
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    if (op == IVS_OP_SUBTRACT) duckdb_table_function_add_parameter(tf, varchar_type);
+    if (op == IVS_OP_COMPLEMENT) duckdb_table_function_add_named_parameter(tf, "genome", varchar_type);
+    if (op == IVS_OP_MERGE || op == IVS_OP_CLUSTER) duckdb_table_function_add_named_parameter(tf, "distance", bigint_type);
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+
+    duckdb_table_function_set_bind(tf, bind_fn);
+    duckdb_table_function_set_init(tf, ivs_global_init);
+    duckdb_table_function_set_local_init(tf, ivs_local_init);
+    duckdb_table_function_set_function(tf, ivs_scan);
+    duckdb_table_function_supports_projection_pushdown(tf, true);
+    duckdb_register_table_function(connection, tf);
+    duckdb_destroy_table_function(&tf);
+}
+
+void register_interval_set_functions(duckdb_connection connection) {
+    register_interval_set_function(connection, "interval_merge", IVS_OP_MERGE, interval_merge_bind);
+    register_interval_set_function(connection, "interval_complement", IVS_OP_COMPLEMENT, interval_complement_bind);
+    register_interval_set_function(connection, "interval_subtract", IVS_OP_SUBTRACT, interval_subtract_bind);
+    register_interval_set_function(connection, "interval_cluster", IVS_OP_CLUSTER, interval_cluster_bind);
+}
+
+/* ================================================================
+ * hts_reg2bin / hts_reg2bins
+ *
+ * The hierarchical binning scheme of BAI/TBI/CSI indexes (and UCSC bins):
+ * level l splits [0, 2^(min_shift + 3 * n_lvls)) into 8^l bins. An interval
+ * belongs to the smallest bin containing it, and two intervals can only
+ * overlap when the bin of one is among the bins spanned by the other. So an
+ * overlap join becomes an equi-join on (chrom, bin) followed by an exact
+ * overlap filter:
+ *
+ *   FROM reads r
+ *   JOIN (SELECT *, unnest(hts_reg2bins(start, "end")) AS bin FROM targets) t
+ *     ON r.chrom = t.chrom AND hts_reg2bin(r.start, r."end") = t.bin
+ *   WHERE r.start < t."end" AND t.start < r."end"
+ *
+ * Without min_shift/n_lvls the BAI scheme (14, 5) is used. Intervals are
+ * 0-based, half-open; an empty interval is treated as the single base at
+ * start, as htslib does for zero-length records.
+ * ================================================================ */
+
+#define HTS_BIN_DEFAULT_MIN_SHIFT 14
+#define HTS_BIN_DEFAULT_N_LVLS 5
+/* Bin numbers of deeper schemes no longer fit in an INTEGER. */
+#define HTS_BIN_MAX_N_LVLS 9
+
+typedef struct {
+    int min_shift;
+    int n_lvls;
+    int64_t max_pos;
+} hts_bin_scheme_t;
+
+/* Resolve the scheme of one row, reusing the previous row's when unchanged. */
+static int hts_bin_scheme(duckdb_function_info info, const char *fname, hts_bin_scheme_t *scheme,
+                          int min_shift, int n_lvls) {
+    if (scheme->max_pos > 0 && scheme->min_shift == min_shift && scheme->n_lvls == n_lvls) return 0;
+    if (min_shift < 0 || n_lvls < 0 || n_lvls > HTS_BIN_MAX_N_LVLS || min_shift + 3 * n_lvls > 62) {
+        char err[256];
+        snprintf(err, sizeof(err),
+                 "%s: invalid bin scheme min_shift=%d n_lvls=%d (n_lvls must be 0-%d and min_shift + 3 * n_lvls <= 62)",
+                 fname, min_shift, n_lvls, HTS_BIN_MAX_N_LVLS);
+        duckdb_scalar_function_set_error(info, err);
+        return -1;
+    }
+    scheme->min_shift = min_shift;
+    scheme->n_lvls = n_lvls;
+    scheme->max_pos = hts_bin_maxpos(min_shift, n_lvls);
+    return 0;
+}
+
+/* Normalise [*beg, *end) for binning; errors on negative or out-of-range
+ * coordinates, since their bins would alias other positions. */
+static int hts_bin_range(duckdb_function_info info, const char *fname, const hts_bin_scheme_t *scheme,
+                         int64_t *beg, int64_t *end) {
+    if (*end <= *beg) *end = *beg + 1;
+    if (*beg < 0 || *end > scheme->max_pos) {
+        char err[256];
+        snprintf(err, sizeof(err), "%s: interval [%" PRId64 ", %" PRId64 ") is outside the bin scheme range [0, %" PRId64 ")",
+                 fname, *beg, *end, scheme->max_pos);
+        duckdb_scalar_function_set_error(info, err);
+        return -1;
+    }
+    return 0;
+}
+
+static void hts_bin_set_null(duckdb_vector output, idx_t row) {
+    duckdb_vector_ensure_validity_writable(output);
+    duckdb_validity_set_row_invalid(duckdb_vector_get_validity(output), row);
+}
+
+static void hts_reg2bin_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output) {
+    idx_t n_rows = duckdb_data_chunk_get_size(input);
+    idx_t n_cols = duckdb_data_chunk_get_column_count(input);
+    duckdb_vector vecs[4] = {NULL, NULL, NULL, NULL};
+    for (idx_t c = 0; c < n_cols; c++) vecs[c] = duckdb_data_chunk_get_vector(input, c);
+    const int64_t *starts = (const int64_t *)duckdb_vector_get_data(vecs[0]);
+    const int64_t *ends = (const int64_t *)duckdb_vector_get_data(vecs[1]);
+    const int32_t *shifts = n_cols > 2 ? (const int32_t *)duckdb_vector_get_data(vecs[2]) : NULL;
+    const int32_t *lvls = n_cols > 2 ? (const int32_t *)duckdb_vector_get_data(vecs[3]) : NULL;
+    int32_t *out = (int32_t *)duckdb_vector_get_data(output);
+    hts_bin_scheme_t scheme = {0, 0, 0};
+
+    for (idx_t row = 0; row < n_rows; row++) {
+        bool valid = true;
+        for (idx_t c = 0; c < n_cols; c++) valid = valid && row_is_valid(vecs[c], row);
+        if (!valid) {
+            hts_bin_set_null(output, row);
+            continue;
+        }
+        if (hts_bin_scheme(info, "hts_reg2bin", &scheme,
+                           shifts ? shifts[row] : HTS_BIN_DEFAULT_MIN_SHIFT,
+                           lvls ? lvls[row] : HTS_BIN_DEFAULT_N_LVLS) < 0) return;
+        int64_t beg = starts[row], end = ends[row];
+        if (hts_bin_range(info, "hts_reg2bin", &scheme, &beg, &end) < 0) return;
+        out[row] = hts_reg2bin(beg, end, scheme.min_shift, scheme.n_lvls);
+    }
+}
+
+/* Every bin overlapping [beg, end): one contiguous run per level, from the
+ * root down (the same enumeration htslib uses for index queries). */
+static idx_t hts_reg2bins_count(int64_t beg, int64_t end, const hts_bin_scheme_t *scheme) {
+    idx_t n = 0;
+    int s = scheme->min_shift + 3 * scheme->n_lvls;
+    for (int l = 0; l <= scheme->n_lvls; l++, s -= 3)
+        n += (idx_t)(((end - 1) >> s) - (beg >> s) + 1);
+    return n;
+}
+
+static void hts_reg2bins_fill(int64_t beg, int64_t end, const hts_bin_scheme_t *scheme, int32_t *out) {
+    int s = scheme->min_shift + 3 * scheme->n_lvls;
+    int32_t t = 0;
+    for (int l = 0; l <= scheme->n_lvls; l++, s -= 3) {
+        int32_t b = t + (int32_t)(beg >> s), e = t + (int32_t)((end - 1) >> s);
+        for (int32_t i = b; i <= e; i++) *out++ = i;
+        t += 1 << (3 * l);
+    }
+}
+
+static void hts_reg2bins_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output) {
+    idx_t n_rows = duckdb_data_chunk_get_size(input);
+    idx_t n_cols = duckdb_data_chunk_get_column_count(input);
+    duckdb_vector vecs[4] = {NULL, NULL, NULL, NULL};
+    for (idx_t c = 0; c < n_cols; c++) vecs[c] = duckdb_data_chunk_get_vector(input, c);
+    const int64_t *starts = (const int64_t *)duckdb_vector_get_data(vecs[0]);
+    const int64_t *ends = (const int64_t *)duckdb_vector_get_data(vecs[1]);
+    const int32_t *shifts = n_cols > 2 ? (const int32_t *)duckdb_vector_get_data(vecs[2]) : NULL;
+    const int32_t *lvls = n_cols > 2 ? (const int32_t *)duckdb_vector_get_data(vecs[3]) : NULL;
+    duckdb_list_entry *entries = (duckdb_list_entry *)duckdb_vector_get_data(output);
+    duckdb_vector child = duckdb_list_vector_get_child(output);
+    idx_t child_off = duckdb_list_vector_get_size(output);
+    hts_bin_scheme_t scheme = {0, 0, 0};
+
+    for (idx_t row = 0; row < n_rows; row++) {
+        entries[row].offset = child_off;
+        entries[row].length = 0;
+        bool valid = true;
+        for (idx_t c = 0; c < n_cols; c++) valid = valid && row_is_valid(vecs[c], row);
+        if (!valid) {
+            hts_bin_set_null(output, row);
+            continue;
+        }
+        if (hts_bin_scheme(info, "hts_reg2bins", &scheme,
+                           shifts ? shifts[row] : HTS_BIN_DEFAULT_MIN_SHIFT,
+                           lvls ? lvls[row] : HTS_BIN_DEFAULT_N_LVLS) < 0) return;
+        int64_t beg = starts[row], end = ends[row];
+        if (hts_bin_range(info, "hts_reg2bins", &scheme, &beg, &end) < 0) return;
+
+        idx_t n = hts_reg2bins_count(beg, end, &scheme);
+        if (duckdb_list_vector_reserve(output, child_off + n) != DuckDBSuccess ||
+            duckdb_list_vector_set_size(output, child_off + n) != DuckDBSuccess) {
+            duckdb_scalar_function_set_error(info, "hts_reg2bins: failed to grow list storage");
+            return;
+        }
+        /* Reserving may move the child buffer; fetch it after growing. */
+        int32_t *bins = (int32_t *)duckdb_vector_get_data(child);
+        hts_reg2bins_fill(beg, end, &scheme, bins + child_off);
+        entries[row].length = n;
+        child_off += n;
+    }
+}
+
+/* Both functions take (start, end) with the BAI scheme, or
+ * (start, end, min_shift, n_lvls) for CSI-style schemes. */
+static void register_hts_bin_function(duckdb_connection connection, const char *name, int returns_list,
+                                      duckdb_scalar_function_t fn_ptr) {
+    duckdb_scalar_function_set set = duckdb_create_scalar_function_set(name);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_logical_type int_type = duckdb_create_logical_type(DUCKDB_TYPE_INTEGER);
+    duckdb_logical_type ret_type = returns_list ? duckdb_create_list_type(int_type) : int_type;
+
+    for (int with_scheme = 0; with_scheme <= 1; with_scheme++) {
+        duckdb_scalar_function fn = duckdb_create_scalar_function();
+        duckdb_scalar_function_set_name(fn, name);
+        duckdb_scalar_function_add_parameter(fn, bigint_type);
+        duckdb_scalar_function_add_parameter(fn, bigint_type);
+        if (with_scheme) {
+            duckdb_scalar_function_add_parameter(fn, int_type);
+            duckdb_scalar_function_add_parameter(fn, int_type);
+        }
+        duckdb_scalar_function_set_return_type(fn, ret_type);
+        duckdb_scalar_function_set_function(fn, fn_ptr);
+        duckdb_add_scalar_function_to_set(set, fn);
+        duckdb_destroy_scalar_function(&fn);
+    }
+    duckdb_register_scalar_function_set(connection, set);
+
+    if (returns_list) duckdb_destroy_logical_type(&ret_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_logical_type(&int_type);
+    duckdb_destroy_scalar_function_set(&set);
+}
+
+void register_hts_bin_functions(duckdb_connection connection) {
+    register_hts_bin_function(connection, "hts_reg2bin", 0, hts_reg2bin_scalar);
+    register_hts_bin_function(connection, "hts_reg2bins", 1, hts_reg2bins_scalar);
+}
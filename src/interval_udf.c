@@ -5,27 +5,39 @@
  *   -> BED3-BED12 reader with canonical typed columns and trailing extras.
  *
  * fasta_nuc(fasta_path, bed_path := NULL, bin_width := NULL, region := NULL,
- *           index_path := NULL, bed_index_path := NULL, include_seq := FALSE)
+ *           index_path := NULL, bed_index_path := NULL, include_seq := FALSE,
+ *           metrics := NULL)
  *   -> bedtools nuc-style interval composition metrics over either supplied
- *      BED intervals or generated fixed-width bins.
+ *      BED intervals or generated fixed-width bins. Bins are planned as
+ *      per-contig splits and BED intervals as runs on one contig; scan threads
+ *      claim these work items and slide over one fetched reference window
+ *      each rather than fetching every row separately. Opt-in metric groups
+ *      (cpg, masked, homopolymer, gaps, dinuc) add sequence-context
+ *      covariates computed in the same pass over each interval; runs and
+ *      dinucleotides do not extend past the interval bounds.
  */
 
 #include "duckdb_extension.h"
 DUCKDB_EXTENSION_EXTERN
 
-#include <ctype.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#include <htslib/faidx.h>
 #include <htslib/hts.h>
 #include <htslib/kstring.h>
 #include <htslib/tbx.h>
 
+#include "include/ref_source.h"
+#include "include/seq_kernels.h"
+
 #define INTERVAL_BATCH_SIZE 2048
+#define FASTA_NUC_MAX_THREADS 16
+#define FASTA_NUC_SPLIT_BASES (4 << 20)     /* bases per bins-mode work item */
+#define FASTA_NUC_WINDOW_BASES (1 << 20)    /* minimum reference fetch in BED mode */
+#define FASTA_NUC_BED_ITEM 4096             /* BED intervals per work item */
 
 enum {
     BED_COL_CHROM = 0,
@@ -58,7 +70,24 @@ enum {
     NUC_COL_NUM_OTHER,
     NUC_COL_SEQ_LEN,
     NUC_COL_SEQ,
-    NUC_COL_COUNT
+    NUC_COL_NUM_CPG,
+    NUC_COL_CPG_OBS_EXP,
+    NUC_COL_NUM_MASKED,
+    NUC_COL_PCT_MASKED,
+    NUC_COL_MAX_HOMOPOLYMER,
+    NUC_COL_NUM_GAPS,
+    NUC_COL_MAX_GAP,
+    NUC_COL_NUM_DINUC,      /* 16 columns num_aa .. num_tt */
+    NUC_COL_COUNT = NUC_COL_NUM_DINUC + 16
+};
+
+/* Opt-in fasta_nuc metric groups */
+enum {
+    NUC_METRIC_CPG = 1 << 0,
+    NUC_METRIC_MASKED = 1 << 1,
+    NUC_METRIC_HOMOPOLYMER = 1 << 2,
+    NUC_METRIC_GAPS = 1 << 3,
+    NUC_METRIC_DINUC = 1 << 4
 };
 
 typedef struct {
@@ -90,34 +119,58 @@ typedef struct {
     char *region;
     int64_t bin_width;
     bool include_seq;
+    int metrics;                /* NUC_METRIC_* flags */
+    int col_map[NUC_COL_COUNT]; /* result column -> NUC_COL_* */
+    int n_cols;
     fasta_nuc_mode_t mode;
 } fasta_nuc_bind_data_t;
 
+/* One BED interval, or the contig a run of BED lines / bins refers to. */
+typedef struct {
+    int64_t start;
+    int64_t end;
+    int contig;
+} fasta_nuc_interval_t;
+
+typedef struct {
+    char *name;
+    int id;             /* sequence id in the reference */
+    hts_pos_t len;      /* -1 when the contig is not in the FASTA */
+} fasta_nuc_contig_t;
+
+/* A unit of parallel work: a split of one contig in bins mode, or a run of
+ * consecutive BED intervals [beg, end) on one contig in BED mode. */
+typedef struct {
+    int contig;
+    int64_t beg;
+    int64_t end;
+} fasta_nuc_item_t;
+
 typedef struct {
-    faidx_t *fai;
-    fasta_nuc_bind_data_t *bind;
-
-    htsFile *bed_fp;
-    tbx_t *bed_tbx;
-    hts_itr_t *bed_itr;
-    kstring_t bed_line;
-    bool bed_finished;
-
-    int region_tid;
-    hts_pos_t region_beg;
-    hts_pos_t region_end;
-    const char *region_seq;
-    bool has_region;
-
-    int current_tid;
-    hts_pos_t next_bin_start;
-    hts_pos_t current_seq_end_exclusive;
-    bool done;
+    fasta_nuc_contig_t *contigs;
+    int n_contigs;
+    fasta_nuc_interval_t *intervals;
+    int64_t n_intervals;
+    fasta_nuc_item_t *items;
+    int n_items;
+    volatile int next_item;
 
     idx_t *column_ids;
     idx_t n_projected_cols;
 } fasta_nuc_init_data_t;
 
+typedef struct {
+    ref_source_t *ref;
+    int item;           /* claimed work item, -1 when none */
+    int64_t cursor;     /* next bin start or next interval index */
+
+    /* Most recently fetched reference window */
+    char *win;
+    int win_contig;
+    hts_pos_t win_beg;
+    hts_pos_t win_len;
+} fasta_nuc_local_data_t;
+
 static inline void set_null(duckdb_vector vec, idx_t row) {
     duckdb_vector_ensure_validity_writable(vec);
     uint64_t *v = duckdb_vector_get_validity(vec);
@@ -439,39 +492,106 @@ static void destroy_fasta_nuc_bind(void *data) {
 static void destroy_fasta_nuc_init(void *data) {
     fasta_nuc_init_data_t *init = (fasta_nuc_init_data_t *)data;
     if (!init) return;
-    if (init->fai) fai_destroy(init->fai);
-    if (init->bed_itr) hts_itr_destroy(init->bed_itr);
-    if (init->bed_tbx) tbx_destroy(init->bed_tbx);
-    if (init->bed_fp) hts_close(init->bed_fp);
-    free(init->bed_line.s);
+    for (int i = 0; i < init->n_contigs; i++) free(init->contigs[i].name);
+    free(init->contigs);
+    free(init->intervals);
+    free(init->items);
     if (init->column_ids) duckdb_free(init->column_ids);
     duckdb_free(init);
 }
 
-static void add_fasta_nuc_columns(duckdb_bind_info info, bool include_seq) {
+static void destroy_fasta_nuc_local(void *data) {
+    fasta_nuc_local_data_t *local = (fasta_nuc_local_data_t *)data;
+    if (!local) return;
+    ref_source_close(local->ref);
+    free(local->win);
+    duckdb_free(local);
+}
+
+static const char *NUC_DINUC_NAMES[16] = {
+    "num_aa", "num_ac", "num_ag", "num_at", "num_ca", "num_cc", "num_cg", "num_ct",
+    "num_ga", "num_gc", "num_gg", "num_gt", "num_ta", "num_tc", "num_tg", "num_tt"
+};
+
+static void add_fasta_nuc_column(duckdb_bind_info info, fasta_nuc_bind_data_t *bind, const char *name,
+                                 duckdb_logical_type type, int logical_col) {
+    duckdb_bind_add_result_column(info, name, type);
+    bind->col_map[bind->n_cols++] = logical_col;
+}
+
+static void add_fasta_nuc_columns(duckdb_bind_info info, fasta_nuc_bind_data_t *bind) {
     duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
     duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
     duckdb_logical_type double_type = duckdb_create_logical_type(DUCKDB_TYPE_DOUBLE);
-    duckdb_bind_add_result_column(info, "chrom", varchar_type);
-    duckdb_bind_add_result_column(info, "start", bigint_type);
-    duckdb_bind_add_result_column(info, "end", bigint_type);
-    duckdb_bind_add_result_column(info, "pct_at", double_type);
-    duckdb_bind_add_result_column(info, "pct_gc", double_type);
-    duckdb_bind_add_result_column(info, "num_a", bigint_type);
-    duckdb_bind_add_result_column(info, "num_c", bigint_type);
-    duckdb_bind_add_result_column(info, "num_g", bigint_type);
-    duckdb_bind_add_result_column(info, "num_t", bigint_type);
-    duckdb_bind_add_result_column(info, "num_n", bigint_type);
-    duckdb_bind_add_result_column(info, "num_other", bigint_type);
-    duckdb_bind_add_result_column(info, "seq_len", bigint_type);
-    if (include_seq) {
-        duckdb_bind_add_result_column(info, "seq", varchar_type);
+    add_fasta_nuc_column(info, bind, "chrom", varchar_type, NUC_COL_CHROM);
+    add_fasta_nuc_column(info, bind, "start", bigint_type, NUC_COL_START);
+    add_fasta_nuc_column(info, bind, "end", bigint_type, NUC_COL_END);
+    add_fasta_nuc_column(info, bind, "pct_at", double_type, NUC_COL_PCT_AT);
+    add_fasta_nuc_column(info, bind, "pct_gc", double_type, NUC_COL_PCT_GC);
+    add_fasta_nuc_column(info, bind, "num_a", bigint_type, NUC_COL_NUM_A);
+    add_fasta_nuc_column(info, bind, "num_c", bigint_type, NUC_COL_NUM_C);
+    add_fasta_nuc_column(info, bind, "num_g", bigint_type, NUC_COL_NUM_G);
+    add_fasta_nuc_column(info, bind, "num_t", bigint_type, NUC_COL_NUM_T);
+    add_fasta_nuc_column(info, bind, "num_n", bigint_type, NUC_COL_NUM_N);
+    add_fasta_nuc_column(info, bind, "num_other", bigint_type, NUC_COL_NUM_OTHER);
+    add_fasta_nuc_column(info, bind, "seq_len", bigint_type, NUC_COL_SEQ_LEN);
+    if (bind->metrics & NUC_METRIC_CPG) {
+        add_fasta_nuc_column(info, bind, "num_cpg", bigint_type, NUC_COL_NUM_CPG);
+        add_fasta_nuc_column(info, bind, "cpg_obs_exp", double_type, NUC_COL_CPG_OBS_EXP);
+    }
+    if (bind->metrics & NUC_METRIC_MASKED) {
+        add_fasta_nuc_column(info, bind, "num_masked", bigint_type, NUC_COL_NUM_MASKED);
+        add_fasta_nuc_column(info, bind, "pct_masked", double_type, NUC_COL_PCT_MASKED);
+    }
+    if (bind->metrics & NUC_METRIC_HOMOPOLYMER) {
+        add_fasta_nuc_column(info, bind, "max_homopolymer", bigint_type, NUC_COL_MAX_HOMOPOLYMER);
+    }
+    if (bind->metrics & NUC_METRIC_GAPS) {
+        add_fasta_nuc_column(info, bind, "num_gaps", bigint_type, NUC_COL_NUM_GAPS);
+        add_fasta_nuc_column(info, bind, "max_gap", bigint_type, NUC_COL_MAX_GAP);
+    }
+    if (bind->metrics & NUC_METRIC_DINUC) {
+        for (int i = 0; i < 16; i++) {
+            add_fasta_nuc_column(info, bind, NUC_DINUC_NAMES[i], bigint_type, NUC_COL_NUM_DINUC + i);
+        }
+    }
+    if (bind->include_seq) {
+        add_fasta_nuc_column(info, bind, "seq", varchar_type, NUC_COL_SEQ);
     }
     duckdb_destroy_logical_type(&varchar_type);
     duckdb_destroy_logical_type(&bigint_type);
     duckdb_destroy_logical_type(&double_type);
 }
 
+/* Parse metrics := [...] into NUC_METRIC_* flags; -1 on an unknown name. */
+static int parse_fasta_nuc_metrics(duckdb_bind_info info, char *err, size_t err_len) {
+    duckdb_value val = duckdb_bind_get_named_parameter(info, "metrics");
+    if (!val) return 0;
+    int metrics = 0;
+    if (!duckdb_is_null_value(val)) {
+        idx_t size = duckdb_get_list_size(val);
+        for (idx_t i = 0; i < size && metrics >= 0; i++) {
+            duckdb_value elem = duckdb_get_list_child(val, i);
+            char *name = duckdb_is_null_value(elem) ? NULL : duckdb_get_varchar(elem);
+            duckdb_destroy_value(&elem);
+            if (!name) continue;
+            if (strcmp(name, "cpg") == 0) metrics |= NUC_METRIC_CPG;
+            else if (strcmp(name, "masked") == 0) metrics |= NUC_METRIC_MASKED;
+            else if (strcmp(name, "homopolymer") == 0) metrics |= NUC_METRIC_HOMOPOLYMER;
+            else if (strcmp(name, "gaps") == 0) metrics |= NUC_METRIC_GAPS;
+            else if (strcmp(name, "dinuc") == 0) metrics |= NUC_METRIC_DINUC;
+            else {
+                snprintf(err, err_len,
+                         "fasta_nuc: unknown metric '%s' (expected cpg, masked, homopolymer, gaps or dinuc)", name);
+                metrics = -1;
+            }
+            duckdb_free(name);
+        }
+    }
+    duckdb_destroy_value(&val);
+    return metrics;
+}
+
 static void fasta_nuc_bind(duckdb_bind_info info) {
     duckdb_value fasta_val = duckdb_bind_get_parameter(info, 0);
     char *fasta_path = duckdb_get_varchar(fasta_val);
@@ -529,9 +649,16 @@ static void fasta_nuc_bind(duckdb_bind_info info) {
     if (include_seq_val && !duckdb_is_null_value(include_seq_val)) include_seq = duckdb_get_bool(include_seq_val);
     if (include_seq_val) duckdb_destroy_value(&include_seq_val);
 
-    faidx_t *fai = fai_load3_format(fasta_path, index_path, NULL, 0, FAI_FASTA);
-    if (!fai) {
-        duckdb_bind_set_error(info, "fasta_nuc: failed to open FASTA index");
+    char err[512];
+    int metrics = parse_fasta_nuc_metrics(info, err, sizeof(err));
+    ref_source_t *ref = NULL;
+    if (metrics >= 0) {
+        char open_err[256] = {0};
+        ref = ref_source_open(fasta_path, index_path, open_err, sizeof(open_err));
+        if (!ref) snprintf(err, sizeof(err), "fasta_nuc: %s", open_err);
+    }
+    if (!ref) {
+        duckdb_bind_set_error(info, err);
         duckdb_free(fasta_path);
         if (bed_path) duckdb_free(bed_path);
         if (region) duckdb_free(region);
@@ -539,11 +666,10 @@ static void fasta_nuc_bind(duckdb_bind_info info) {
         if (bed_index_path) duckdb_free(bed_index_path);
         return;
     }
-    fai_destroy(fai);
-
-    add_fasta_nuc_columns(info, include_seq);
+    ref_source_close(ref);
 
     fasta_nuc_bind_data_t *bind = (fasta_nuc_bind_data_t *)duckdb_malloc(sizeof(fasta_nuc_bind_data_t));
+    memset(bind, 0, sizeof(*bind));
     bind->fasta_path = fasta_path;
     bind->index_path = index_path;
     bind->bed_path = bed_path;
@@ -551,186 +677,314 @@ static void fasta_nuc_bind(duckdb_bind_info info) {
     bind->region = region;
     bind->bin_width = bin_width;
     bind->include_seq = include_seq;
+    bind->metrics = metrics;
     bind->mode = bed_path ? FASTA_NUC_MODE_BED : FASTA_NUC_MODE_BINS;
+    add_fasta_nuc_columns(info, bind);
     duckdb_bind_set_bind_data(info, bind, destroy_fasta_nuc_bind);
 }
 
-static bool init_fasta_region(fasta_nuc_init_data_t *init, const char *region) {
-    if (!region || !*region) return true;
-    int tid = -1;
-    hts_pos_t beg = 0, end = 0;
-    const char *remaining = fai_parse_region(init->fai, region, &tid, &beg, &end, 0);
-    if (!remaining || *remaining != '\0') return false;
-    if (fai_adjust_region(init->fai, tid, &beg, &end) != 0) return false;
-    init->region_tid = tid;
-    init->region_beg = beg;
-    init->region_end = end;
-    init->region_seq = faidx_iseq(init->fai, tid);
-    init->has_region = true;
-    return true;
+static int add_fasta_nuc_contig(fasta_nuc_init_data_t *init, int *m_contigs, const ref_source_t *ref,
+                                const char *name, int name_len) {
+    if (init->n_contigs == *m_contigs) {
+        *m_contigs = *m_contigs ? *m_contigs * 2 : 16;
+        init->contigs = (fasta_nuc_contig_t *)realloc(init->contigs, sizeof(fasta_nuc_contig_t) * (size_t)*m_contigs);
+    }
+    fasta_nuc_contig_t *contig = &init->contigs[init->n_contigs];
+    contig->name = (char *)malloc((size_t)name_len + 1);
+    memcpy(contig->name, name, (size_t)name_len);
+    contig->name[name_len] = '\0';
+    contig->id = ref_source_name2id(ref, contig->name);
+    contig->len = contig->id >= 0 ? ref_source_seq_len(ref, contig->id) : -1;
+    return init->n_contigs++;
+}
+
+static void add_fasta_nuc_item(fasta_nuc_init_data_t *init, int *m_items, int contig, int64_t beg, int64_t end) {
+    if (init->n_items == *m_items) {
+        *m_items = *m_items ? *m_items * 2 : 16;
+        init->items = (fasta_nuc_item_t *)realloc(init->items, sizeof(fasta_nuc_item_t) * (size_t)*m_items);
+    }
+    init->items[init->n_items].contig = contig;
+    init->items[init->n_items].beg = beg;
+    init->items[init->n_items].end = end;
+    init->n_items++;
+}
+
+/* Split each contig (or the region) into bin-aligned work items. */
+static void plan_fasta_nuc_bins(fasta_nuc_init_data_t *init, const fasta_nuc_bind_data_t *bind, const ref_source_t *ref,
+                                int region_tid, hts_pos_t region_beg, hts_pos_t region_end) {
+    int m_contigs = 0, m_items = 0;
+    int64_t split = FASTA_NUC_SPLIT_BASES / bind->bin_width * bind->bin_width;
+    if (split < bind->bin_width) split = bind->bin_width;
+    int nseq = ref_source_nseq(ref);
+    for (int tid = 0; tid < nseq; tid++) {
+        if (region_tid >= 0 && tid != region_tid) continue;
+        const char *name = ref_source_iseq(ref, tid);
+        int contig = add_fasta_nuc_contig(init, &m_contigs, ref, name, (int)strlen(name));
+        hts_pos_t beg = region_tid >= 0 ? region_beg : 0;
+        hts_pos_t end = region_tid >= 0 ? region_end : init->contigs[contig].len;
+        for (int64_t s = beg; s < end; s += split) {
+            add_fasta_nuc_item(init, &m_items, contig, s, s + split < end ? s + split : end);
+        }
+    }
+}
+
+/* Read the BED intervals up front, interning consecutive chromosome names,
+ * and cut them into runs of adjacent intervals on the same contig. */
+static int plan_fasta_nuc_bed(fasta_nuc_init_data_t *init, const fasta_nuc_bind_data_t *bind, const ref_source_t *ref,
+                              const char *region_seq, hts_pos_t region_beg, hts_pos_t region_end,
+                              char *err, size_t err_len) {
+    htsFile *fp = hts_open(bind->bed_path, "r");
+    if (!fp) {
+        snprintf(err, err_len, "fasta_nuc: failed to open BED file");
+        return -1;
+    }
+    tbx_t *tbx = NULL;
+    hts_itr_t *itr = NULL;
+    if (bind->region) {
+        tbx = tbx_index_load3(bind->bed_path, bind->bed_index_path, HTS_IDX_SILENT_FAIL);
+        if (tbx) {
+            itr = tbx_itr_querys(tbx, bind->region);
+            if (!itr) {
+                snprintf(err, err_len, "fasta_nuc: failed to create BED region iterator");
+                tbx_destroy(tbx);
+                hts_close(fp);
+                return -1;
+            }
+        }
+    }
+
+    kstring_t line = {0, 0, NULL};
+    int m_contigs = 0, m_items = 0;
+    int64_t m_intervals = 0;
+    int contig = -1;
+    while ((itr ? tbx_itr_next(fp, tbx, itr, &line) : hts_getline(fp, '\n', &line)) >= 0) {
+        if (line.l == 0 || is_meta_bed_line(line.s)) continue;
+        int len0 = 0, len1 = 0, len2 = 0;
+        const char *f0 = get_field_span(line.s, 0, &len0);
+        const char *f1 = get_field_span(line.s, 1, &len1);
+        const char *f2 = get_field_span(line.s, 2, &len2);
+        int64_t s = 0, e = 0;
+        if (!f0 || !f1 || !f2 || !parse_int64_span_local(f1, len1, &s) || !parse_int64_span_local(f2, len2, &e)) {
+            continue;
+        }
+        if (contig < 0 || strncmp(init->contigs[contig].name, f0, (size_t)len0) != 0 ||
+            init->contigs[contig].name[len0] != '\0') {
+            contig = add_fasta_nuc_contig(init, &m_contigs, ref, f0, len0);
+        }
+        if (region_seq && (strcmp(init->contigs[contig].name, region_seq) != 0 ||
+                           e <= (int64_t)region_beg || s >= (int64_t)region_end)) {
+            continue;
+        }
+        /* Intervals with sequence on a contig missing from the FASTA cannot be fetched. */
+        if (init->contigs[contig].len < 0 && e > s) continue;
+
+        if (init->n_intervals == m_intervals) {
+            m_intervals = m_intervals ? m_intervals * 2 : 1024;
+            init->intervals = (fasta_nuc_interval_t *)realloc(init->intervals,
+                                                              sizeof(fasta_nuc_interval_t) * (size_t)m_intervals);
+        }
+        fasta_nuc_interval_t *iv = &init->intervals[init->n_intervals];
+        iv->start = s;
+        iv->end = e;
+        iv->contig = contig;
+
+        fasta_nuc_item_t *last = init->n_items > 0 ? &init->items[init->n_items - 1] : NULL;
+        if (last && last->contig == contig && last->end == init->n_intervals &&
+            last->end - last->beg < FASTA_NUC_BED_ITEM) {
+            last->end++;
+        } else {
+            add_fasta_nuc_item(init, &m_items, contig, init->n_intervals, init->n_intervals + 1);
+        }
+        init->n_intervals++;
+    }
+    free(line.s);
+    if (itr) hts_itr_destroy(itr);
+    if (tbx) tbx_destroy(tbx);
+    hts_close(fp);
+    return 0;
 }
 
 static void fasta_nuc_init(duckdb_init_info info) {
     fasta_nuc_bind_data_t *bind = (fasta_nuc_bind_data_t *)duckdb_init_get_bind_data(info);
     fasta_nuc_init_data_t *init = (fasta_nuc_init_data_t *)duckdb_malloc(sizeof(fasta_nuc_init_data_t));
     memset(init, 0, sizeof(*init));
-    init->bind = bind;
-    init->fai = fai_load3_format(bind->fasta_path, bind->index_path, NULL, 0, FAI_FASTA);
-    if (!init->fai) {
+    char err[512];
+    ref_source_t *ref = ref_source_open(bind->fasta_path, bind->index_path, err, sizeof(err));
+    if (!ref) {
         duckdb_init_set_error(info, "fasta_nuc: failed to load FASTA index");
         destroy_fasta_nuc_init(init);
         return;
     }
-    if (!init_fasta_region(init, bind->region)) {
-        duckdb_init_set_error(info, "fasta_nuc: invalid FASTA region");
-        destroy_fasta_nuc_init(init);
-        return;
+
+    int region_tid = -1;
+    hts_pos_t region_beg = 0, region_end = 0;
+    if (bind->region && *bind->region) {
+        if (ref_source_parse_region(ref, bind->region, &region_tid, &region_beg, &region_end) != 0) {
+            duckdb_init_set_error(info, "fasta_nuc: invalid FASTA region");
+            ref_source_close(ref);
+            destroy_fasta_nuc_init(init);
+            return;
+        }
     }
 
     if (bind->mode == FASTA_NUC_MODE_BED) {
-        init->bed_fp = hts_open(bind->bed_path, "r");
-        if (!init->bed_fp) {
-            duckdb_init_set_error(info, "fasta_nuc: failed to open BED file");
+        const char *region_seq = region_tid >= 0 ? ref_source_iseq(ref, region_tid) : NULL;
+        if (plan_fasta_nuc_bed(init, bind, ref, region_seq, region_beg, region_end, err, sizeof(err)) != 0) {
+            duckdb_init_set_error(info, err);
+            ref_source_close(ref);
             destroy_fasta_nuc_init(init);
             return;
         }
-        if (bind->region) {
-            init->bed_tbx = tbx_index_load3(bind->bed_path, bind->bed_index_path, HTS_IDX_SILENT_FAIL);
-            if (init->bed_tbx) {
-                init->bed_itr = tbx_itr_querys(init->bed_tbx, bind->region);
-                if (!init->bed_itr) {
-                    duckdb_init_set_error(info, "fasta_nuc: failed to create BED region iterator");
-                    destroy_fasta_nuc_init(init);
-                    return;
-                }
-            }
-        }
     } else {
-        if (init->has_region) {
-            init->current_tid = init->region_tid;
-            init->next_bin_start = init->region_beg;
-            init->current_seq_end_exclusive = init->region_end;
-        } else {
-            init->current_tid = 0;
-            init->next_bin_start = 0;
-            const char *seqname = faidx_iseq(init->fai, 0);
-            init->current_seq_end_exclusive = faidx_seq_len64(init->fai, seqname);
-        }
+        plan_fasta_nuc_bins(init, bind, ref, region_tid, region_beg, region_end);
     }
+    ref_source_close(ref);
 
     init->n_projected_cols = duckdb_init_get_column_count(info);
     init->column_ids = (idx_t *)duckdb_malloc(sizeof(idx_t) * init->n_projected_cols);
     for (idx_t i = 0; i < init->n_projected_cols; i++) {
-        init->column_ids[i] = duckdb_init_get_column_index(info, i);
+        init->column_ids[i] = (idx_t)bind->col_map[duckdb_init_get_column_index(info, i)];
     }
+    int max_threads = init->n_items < FASTA_NUC_MAX_THREADS ? init->n_items : FASTA_NUC_MAX_THREADS;
+    duckdb_init_set_max_threads(info, max_threads > 0 ? (idx_t)max_threads : 1);
     duckdb_init_set_init_data(info, init, destroy_fasta_nuc_init);
 }
 
-static void count_nucleotides(const char *seq, hts_pos_t len,
-                              int64_t *a, int64_t *c, int64_t *g, int64_t *t,
-                              int64_t *n, int64_t *other) {
-    *a = *c = *g = *t = *n = *other = 0;
-    for (hts_pos_t i = 0; i < len; i++) {
-        switch (toupper((unsigned char)seq[i])) {
-            case 'A': (*a)++; break;
-            case 'C': (*c)++; break;
-            case 'G': (*g)++; break;
-            case 'T': (*t)++; break;
-            case 'N': (*n)++; break;
-            default: (*other)++; break;
-        }
+static void fasta_nuc_local_init(duckdb_init_info info) {
+    fasta_nuc_bind_data_t *bind = (fasta_nuc_bind_data_t *)duckdb_init_get_bind_data(info);
+    fasta_nuc_local_data_t *local = (fasta_nuc_local_data_t *)duckdb_malloc(sizeof(fasta_nuc_local_data_t));
+    memset(local, 0, sizeof(*local));
+    local->item = -1;
+    local->win_contig = -1;
+    char err[512];
+    local->ref = ref_source_open(bind->fasta_path, bind->index_path, err, sizeof(err));
+    if (!local->ref) {
+        duckdb_init_set_error(info, "fasta_nuc: failed to load FASTA index");
+        destroy_fasta_nuc_local(local);
+        return;
     }
+    duckdb_init_set_init_data(info, local, destroy_fasta_nuc_local);
 }
 
-static bool bed_overlap_region(const fasta_nuc_init_data_t *init, const char *chrom, int64_t start, int64_t end) {
-    if (!init->has_region) return true;
-    if (!chrom || strcmp(chrom, init->region_seq) != 0) return false;
-    return end > (int64_t)init->region_beg && start < (int64_t)init->region_end;
+enum {
+    NUC_BASE_OTHER = SEQ_BASE_OTHER,
+    NUC_BASE_A = SEQ_BASE_A,
+    NUC_BASE_C = SEQ_BASE_C,
+    NUC_BASE_G = SEQ_BASE_G,
+    NUC_BASE_T = SEQ_BASE_T,
+    NUC_BASE_N = SEQ_BASE_N,
+    NUC_BASE_COUNT = SEQ_BASE_COUNT
+};
+
+static const uint8_t NUC_BASE_CLASS[256] = {
+    ['A'] = NUC_BASE_A, ['a'] = NUC_BASE_A,
+    ['C'] = NUC_BASE_C, ['c'] = NUC_BASE_C,
+    ['G'] = NUC_BASE_G, ['g'] = NUC_BASE_G,
+    ['T'] = NUC_BASE_T, ['t'] = NUC_BASE_T,
+    ['N'] = NUC_BASE_N, ['n'] = NUC_BASE_N
+};
+
+/* Base histogram through the dispatched seq_kernels counter (AVX2, SSE4.2
+ * or NEON when the CPU has them, else a lookup table). */
+static void count_nucleotides(const char *seq, hts_pos_t len, int64_t counts[NUC_BASE_COUNT]) {
+    size_t n[SEQ_BASE_COUNT];
+    seq_base_count_kernel(seq, (size_t)len, n);
+    for (int b = 0; b < NUC_BASE_COUNT; b++) counts[b] = (int64_t)n[b];
 }
 
-static int next_fasta_nuc_bed_interval(fasta_nuc_init_data_t *init, const char **chrom, int64_t *start, int64_t *end) {
-    while (!init->bed_finished) {
-        int ret = init->bed_itr ? tbx_itr_next(init->bed_fp, init->bed_tbx, init->bed_itr, &init->bed_line)
-                                : hts_getline(init->bed_fp, '\n', &init->bed_line);
-        if (ret < 0) {
-            init->bed_finished = true;
-            return 0;
-        }
-        if (init->bed_line.l == 0 || is_meta_bed_line(init->bed_line.s)) continue;
-        int len0 = 0, len1 = 0, len2 = 0;
-        const char *f0 = get_field_span(init->bed_line.s, 0, &len0);
-        const char *f1 = get_field_span(init->bed_line.s, 1, &len1);
-        const char *f2 = get_field_span(init->bed_line.s, 2, &len2);
-        int64_t s = 0, e = 0;
-        if (!f0 || !f1 || !f2 || !parse_int64_span_local(f1, len1, &s) || !parse_int64_span_local(f2, len2, &e)) {
-            continue;
-        }
-        char *chrom_buf = (char *)malloc((size_t)len0 + 1);
-        if (!chrom_buf) return 0;
-        memcpy(chrom_buf, f0, (size_t)len0);
-        chrom_buf[len0] = '\0';
-        if (!bed_overlap_region(init, chrom_buf, s, e)) {
-            free(chrom_buf);
-            continue;
-        }
-        *chrom = chrom_buf;
-        *start = s;
-        *end = e;
-        return 1;
+/* 1-based ACGT code, 0 for anything else */
+static const uint8_t NUC_BASE_CODE[256] = {
+    ['A'] = 1, ['a'] = 1,
+    ['C'] = 2, ['c'] = 2,
+    ['G'] = 3, ['g'] = 3,
+    ['T'] = 4, ['t'] = 4
+};
+
+typedef struct {
+    int64_t counts[NUC_BASE_COUNT];
+    int64_t dinuc[25];          /* indexed by code(prev) * 5 + code(cur) */
+    int64_t masked;
+    int64_t max_homopolymer;
+    int64_t n_gaps;
+    int64_t max_gap;
+} fasta_nuc_context_t;
+
+/* One pass over an interval for the extended metric groups, also producing
+ * the base histogram. Every per-base update is a table lookup or a
+ * comparison folded into arithmetic, so the loop has no data-dependent
+ * branches. */
+static void count_sequence_context(const char *seq, hts_pos_t len, fasta_nuc_context_t *ctx) {
+    /* Accumulate in locals: stores through ctx could alias the byte input
+     * and would force the compiler to keep every counter in memory. */
+    int64_t counts[NUC_BASE_COUNT] = {0};
+    int64_t dinuc[25] = {0};
+    int64_t masked = 0, max_run = 0, n_gaps = 0, max_gap = 0;
+    int64_t prev_n = 0, run = 0, gap = 0;
+    unsigned prev_code = 0;
+    const uint8_t *s = (const uint8_t *)seq;
+    for (hts_pos_t i = 0; i < len; i++) {
+        uint8_t c = s[i];
+        uint8_t cls = NUC_BASE_CLASS[c];
+        unsigned code = NUC_BASE_CODE[c];
+        int64_t is_n = cls == NUC_BASE_N;
+        counts[cls]++;
+        masked += (uint8_t)(c - 'a') < 26;
+        /* the first base lands in the never-reported "other" row */
+        dinuc[prev_code * 5 + code]++;
+        run = (run * (code == prev_code) + 1) * (code != 0);
+        max_run = run > max_run ? run : max_run;
+        n_gaps += is_n & !prev_n;
+        gap = (gap + 1) * is_n;
+        max_gap = gap > max_gap ? gap : max_gap;
+        prev_code = code;
+        prev_n = is_n;
     }
-    return 0;
+    memcpy(ctx->counts, counts, sizeof(counts));
+    memcpy(ctx->dinuc, dinuc, sizeof(dinuc));
+    ctx->masked = masked;
+    ctx->max_homopolymer = max_run;
+    ctx->n_gaps = n_gaps;
+    ctx->max_gap = max_gap;
 }
 
-static int next_fasta_nuc_bin_interval(fasta_nuc_init_data_t *init, const char **chrom, int64_t *start, int64_t *end) {
-    int nseq = faidx_nseq(init->fai);
-    while (!init->done) {
-        if (init->current_tid >= nseq) {
-            init->done = true;
-            return 0;
-        }
-        const char *seqname = faidx_iseq(init->fai, init->current_tid);
-        if (!seqname) {
-            init->done = true;
-            return 0;
-        }
-        hts_pos_t seq_len = init->has_region && init->current_tid == init->region_tid
-            ? init->current_seq_end_exclusive
-            : faidx_seq_len64(init->fai, seqname);
-        if (seq_len < 0) {
-            init->done = true;
-            return 0;
-        }
-        if (init->next_bin_start >= seq_len) {
-            if (init->has_region) {
-                init->done = true;
-                return 0;
-            }
-            init->current_tid++;
-            if (init->current_tid >= nseq) {
-                init->done = true;
-                return 0;
-            }
-            init->next_bin_start = 0;
-            init->current_seq_end_exclusive = faidx_seq_len64(init->fai, faidx_iseq(init->fai, init->current_tid));
-            continue;
-        }
-        hts_pos_t bin_end = init->next_bin_start + init->bind->bin_width;
-        if (bin_end > seq_len) bin_end = seq_len;
-        *chrom = seqname;
-        *start = init->next_bin_start;
-        *end = bin_end;
-        init->next_bin_start = bin_end;
-        return 1;
+/* Return [beg, end) of a contig, clamped to its length as faidx does, from
+ * the local window, refetching at most up to limit when it is not covered.
+ * Returns NULL on a fetch error. */
+static const char *fasta_nuc_window(const fasta_nuc_init_data_t *init, fasta_nuc_local_data_t *local, int contig,
+                                    int64_t beg, int64_t end, int64_t limit, hts_pos_t *len) {
+    hts_pos_t contig_len = init->contigs[contig].len;
+    hts_pos_t b = beg < 0 ? 0 : beg > contig_len ? contig_len : beg;
+    hts_pos_t e = end > contig_len ? contig_len : end;
+    if (e < b) e = b;
+    *len = e - b;
+    if (*len == 0) return "";
+    if (local->win && local->win_contig == contig && b >= local->win_beg &&
+        e <= local->win_beg + local->win_len) {
+        return local->win + (b - local->win_beg);
     }
-    return 0;
+
+    hts_pos_t fetch_end = b + FASTA_NUC_WINDOW_BASES > e ? b + FASTA_NUC_WINDOW_BASES : e;
+    if (fetch_end > limit && limit >= e) fetch_end = limit;
+    if (fetch_end > contig_len) fetch_end = contig_len;
+    free(local->win);
+    hts_pos_t fetched = 0;
+    local->win = ref_source_fetch(local->ref, init->contigs[contig].id, b, fetch_end, &fetched);
+    if (!local->win || fetched < e - b) {
+        free(local->win);
+        local->win = NULL;
+        local->win_contig = -1;
+        return NULL;
+    }
+    local->win_contig = contig;
+    local->win_beg = b;
+    local->win_len = fetched;
+    return local->win;
 }
 
 static void fasta_nuc_scan(duckdb_function_info info, duckdb_data_chunk output) {
+    fasta_nuc_bind_data_t *bind = (fasta_nuc_bind_data_t *)duckdb_function_get_bind_data(info);
     fasta_nuc_init_data_t *init = (fasta_nuc_init_data_t *)duckdb_function_get_init_data(info);
-    if (!init || init->done) {
-        duckdb_data_chunk_set_size(output, 0);
-        return;
-    }
+    fasta_nuc_local_data_t *local = (fasta_nuc_local_data_t *)duckdb_function_get_local_init_data(info);
 
     idx_t row_count = 0;
     idx_t col_count = duckdb_data_chunk_get_column_count(output);
@@ -740,31 +994,49 @@ static void fasta_nuc_scan(duckdb_function_info info, duckdb_data_chunk output)
     }
 
     while (row_count < INTERVAL_BATCH_SIZE) {
-        const char *chrom = NULL;
-        int64_t start = 0, end = 0;
-        int have_interval = init->bind->mode == FASTA_NUC_MODE_BED
-            ? next_fasta_nuc_bed_interval(init, &chrom, &start, &end)
-            : next_fasta_nuc_bin_interval(init, &chrom, &start, &end);
-        if (!have_interval) break;
+        if (local->item < 0) {
+            int item = __sync_fetch_and_add(&init->next_item, 1);
+            if (item >= init->n_items) break;
+            local->item = item;
+            local->cursor = init->items[item].beg;
+        }
+        const fasta_nuc_item_t *item = &init->items[local->item];
+        if (local->cursor >= item->end) {
+            local->item = -1;
+            continue;
+        }
+
+        int64_t start, end, limit;
+        if (bind->mode == FASTA_NUC_MODE_BED) {
+            const fasta_nuc_interval_t *iv = &init->intervals[local->cursor++];
+            start = iv->start;
+            end = iv->end;
+            limit = HTS_POS_MAX;
+        } else {
+            start = local->cursor;
+            end = start + bind->bin_width < item->end ? start + bind->bin_width : item->end;
+            limit = item->end;
+            local->cursor = end;
+        }
 
         hts_pos_t seq_len = (hts_pos_t)(end - start);
-        char *seq = NULL;
-        hts_pos_t fetch_len = 0;
-        int64_t num_a = 0, num_c = 0, num_g = 0, num_t = 0, num_n = 0, num_other = 0;
+        const char *seq = NULL;
+        fasta_nuc_context_t ctx;
+        int64_t *counts = ctx.counts;
         double pct_at = 0.0, pct_gc = 0.0;
+        memset(&ctx, 0, sizeof(ctx));
 
         if (seq_len > 0) {
-            seq = faidx_fetch_seq64(init->fai, chrom, (hts_pos_t)start, (hts_pos_t)end - 1, &fetch_len);
-            if (!seq || fetch_len < 0) {
-                if (init->bind->mode == FASTA_NUC_MODE_BED) free((void *)chrom);
-                free(seq);
-                continue;
+            seq = fasta_nuc_window(init, local, item->contig, start, end, limit, &seq_len);
+            if (!seq) {
+                duckdb_function_set_error(info, "fasta_nuc: failed to fetch FASTA sequence");
+                return;
             }
-            seq_len = fetch_len;
-            count_nucleotides(seq, seq_len, &num_a, &num_c, &num_g, &num_t, &num_n, &num_other);
+            if (bind->metrics) count_sequence_context(seq, seq_len, &ctx);
+            else count_nucleotides(seq, seq_len, counts);
             if (seq_len > 0) {
-                pct_at = (double)(num_a + num_t) / (double)seq_len;
-                pct_gc = (double)(num_c + num_g) / (double)seq_len;
+                pct_at = (double)(counts[NUC_BASE_A] + counts[NUC_BASE_T]) / (double)seq_len;
+                pct_gc = (double)(counts[NUC_BASE_C] + counts[NUC_BASE_G]) / (double)seq_len;
             }
         }
 
@@ -772,7 +1044,7 @@ static void fasta_nuc_scan(duckdb_function_info info, duckdb_data_chunk output)
             int logical_col = (int)init->column_ids[c];
             switch (logical_col) {
                 case NUC_COL_CHROM:
-                    duckdb_vector_assign_string_element(vectors[c], row_count, chrom);
+                    duckdb_vector_assign_string_element(vectors[c], row_count, init->contigs[item->contig].name);
                     break;
                 case NUC_COL_START: {
                     int64_t *data = (int64_t *)duckdb_vector_get_data(vectors[c]);
@@ -803,35 +1075,66 @@ static void fasta_nuc_scan(duckdb_function_info info, duckdb_data_chunk output)
                 case NUC_COL_SEQ_LEN: {
                     int64_t *data = (int64_t *)duckdb_vector_get_data(vectors[c]);
                     data[row_count] =
-                        logical_col == NUC_COL_NUM_A ? num_a :
-                        logical_col == NUC_COL_NUM_C ? num_c :
-                        logical_col == NUC_COL_NUM_G ? num_g :
-                        logical_col == NUC_COL_NUM_T ? num_t :
-                        logical_col == NUC_COL_NUM_N ? num_n :
-                        logical_col == NUC_COL_NUM_OTHER ? num_other :
+                        logical_col == NUC_COL_NUM_A ? counts[NUC_BASE_A] :
+                        logical_col == NUC_COL_NUM_C ? counts[NUC_BASE_C] :
+                        logical_col == NUC_COL_NUM_G ? counts[NUC_BASE_G] :
+                        logical_col == NUC_COL_NUM_T ? counts[NUC_BASE_T] :
+                        logical_col == NUC_COL_NUM_N ? counts[NUC_BASE_N] :
+                        logical_col == NUC_COL_NUM_OTHER ? counts[NUC_BASE_OTHER] :
                         (int64_t)seq_len;
                     break;
                 }
+                case NUC_COL_NUM_CPG:
+                case NUC_COL_NUM_MASKED:
+                case NUC_COL_MAX_HOMOPOLYMER:
+                case NUC_COL_NUM_GAPS:
+                case NUC_COL_MAX_GAP: {
+                    int64_t *data = (int64_t *)duckdb_vector_get_data(vectors[c]);
+                    data[row_count] =
+                        logical_col == NUC_COL_NUM_CPG ? ctx.dinuc[2 * 5 + 3] :
+                        logical_col == NUC_COL_NUM_MASKED ? ctx.masked :
+                        logical_col == NUC_COL_MAX_HOMOPOLYMER ? ctx.max_homopolymer :
+                        logical_col == NUC_COL_NUM_GAPS ? ctx.n_gaps :
+                        ctx.max_gap;
+                    break;
+                }
+                case NUC_COL_CPG_OBS_EXP: {
+                    /* Gardiner-Garden & Frommer: CpG * length / (C * G) */
+                    int64_t cg = counts[NUC_BASE_C] * counts[NUC_BASE_G];
+                    if (cg > 0) {
+                        double *data = (double *)duckdb_vector_get_data(vectors[c]);
+                        data[row_count] = (double)ctx.dinuc[2 * 5 + 3] * (double)seq_len / (double)cg;
+                    } else {
+                        set_null(vectors[c], row_count);
+                    }
+                    break;
+                }
+                case NUC_COL_PCT_MASKED: {
+                    double *data = (double *)duckdb_vector_get_data(vectors[c]);
+                    data[row_count] = seq_len > 0 ? (double)ctx.masked / (double)seq_len : 0.0;
+                    break;
+                }
                 case NUC_COL_SEQ:
-                    if (init->bind->include_seq && seq) {
+                    if (bind->include_seq && seq) {
                         duckdb_vector_assign_string_element_len(vectors[c], row_count, seq, (idx_t)seq_len);
                     } else {
                         set_null(vectors[c], row_count);
                     }
                     break;
                 default:
-                    set_null(vectors[c], row_count);
+                    if (logical_col >= NUC_COL_NUM_DINUC && logical_col < NUC_COL_COUNT) {
+                        int pair = logical_col - NUC_COL_NUM_DINUC;
+                        int64_t *data = (int64_t *)duckdb_vector_get_data(vectors[c]);
+                        data[row_count] = ctx.dinuc[(pair / 4 + 1) * 5 + pair % 4 + 1];
+                    } else {
+                        set_null(vectors[c], row_count);
+                    }
                     break;
             }
         }
-
-        if (init->bind->mode == FASTA_NUC_MODE_BED) free((void *)chrom);
-        free(seq);
         row_count++;
     }
 
-    if (row_count == 0 && init->bind->mode == FASTA_NUC_MODE_BINS) init->done = true;
-    if (row_count == 0 && init->bind->mode == FASTA_NUC_MODE_BED && init->bed_finished) init->done = true;
     duckdb_data_chunk_set_size(output, row_count);
 }
 
@@ -864,11 +1167,15 @@ void register_fasta_nuc_function(duckdb_connection connection) {
     duckdb_table_function_add_named_parameter(tf, "index_path", varchar_type);
     duckdb_table_function_add_named_parameter(tf, "bed_index_path", varchar_type);
     duckdb_table_function_add_named_parameter(tf, "include_seq", bool_type);
+    duckdb_logical_type metrics_type = duckdb_create_list_type(varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "metrics", metrics_type);
+    duckdb_destroy_logical_type(&metrics_type);
     duckdb_destroy_logical_type(&varchar_type);
     duckdb_destroy_logical_type(&bigint_type);
     duckdb_destroy_logical_type(&bool_type);
     duckdb_table_function_set_bind(tf, fasta_nuc_bind);
     duckdb_table_function_set_init(tf, fasta_nuc_init);
+    duckdb_table_function_set_local_init(tf, fasta_nuc_local_init);
     duckdb_table_function_set_function(tf, fasta_nuc_scan);
     duckdb_table_function_supports_projection_pushdown(tf, true);
     duckdb_register_table_function(connection, tf);
@@ -0,0 +1,371 @@
+/**
+ * DuckHTS k-mer counting aggregates.
+ *
+ * kmer_count(seq[, k[, canonical[, min_count]]])
+ *   -> STRUCT(kmer UBIGINT, count UBIGINT)[] sorted by kmer, keeping k-mers
+ *      seen at least min_count times (default 1).
+ *
+ * kmer_spectrum(seq[, k[, canonical]])
+ *   -> STRUCT(count UBIGINT, n_kmers UBIGINT)[] sorted by count: how many
+ *      distinct k-mers occur exactly `count` times (the k-mer histogram used
+ *      for genome-size and heterozygosity estimates).
+ *
+ * k defaults to 21 (at most 32) and canonical to TRUE. Each sequence is fed
+ * through the rolling 2-bit encoder in seq_kernels.h and every complete
+ * k-mer goes straight into the group's hash table, so no per-k-mer rows are
+ * materialised. DuckDB keeps one state per group per thread; combine adds
+ * the source table into the target and leaves the source untouched, since
+ * window frames combine one source into many targets. k, canonical and
+ * min_count must be constant within a group.
+ */
+
+#include "duckdb_extension.h"
+DUCKDB_EXTENSION_EXTERN
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "include/seq_kernels.h"
+#include "include/vector_access.h"
+
+#define KMER_COUNT_DEFAULT_K 21
+#define KMER_COUNT_MAX_K 32
+
+/* Open-addressing table with linear probing. Keys and counts share a slot,
+ * so a probe touches one cache line; count 0 marks an empty slot. */
+typedef struct {
+    uint64_t key;
+    uint64_t count;
+} kmer_slot_t;
+
+typedef struct {
+    kmer_slot_t *slots;
+    uint64_t mask;
+    uint64_t n;
+} kmer_table_t;
+
+#define KMER_TABLE_MIN_CAP 1024
+#define KMER_BATCH 256
+
+static inline void kmer_table_add_hashed(kmer_table_t *t, uint64_t key, uint64_t h, uint64_t n) {
+    for (uint64_t i = h & t->mask;; i = (i + 1) & t->mask) {
+        kmer_slot_t *slot = &t->slots[i];
+        if (slot->count == 0) {
+            slot->key = key;
+            slot->count = n;
+            t->n++;
+            return;
+        }
+        if (slot->key == key) {
+            slot->count += n;
+            return;
+        }
+    }
+}
+
+static void kmer_table_free(kmer_table_t *t) {
+    if (!t) return;
+    free(t->slots);
+    free(t);
+}
+
+/* Make room for `extra` more keys at a load factor of at most 1/2. */
+static int kmer_table_reserve(kmer_table_t *t, uint64_t extra) {
+    uint64_t cap = t->slots ? t->mask + 1 : 0;
+    if ((t->n + extra) * 2 <= cap) return 0;
+    uint64_t new_cap = cap ? cap : KMER_TABLE_MIN_CAP;
+    while ((t->n + extra) * 2 > new_cap) new_cap *= 2;
+    kmer_slot_t *old = t->slots;
+    t->slots = (kmer_slot_t *)calloc((size_t)new_cap, sizeof(kmer_slot_t));
+    if (!t->slots) {
+        t->slots = old;
+        return -1;
+    }
+    t->mask = new_cap - 1;
+    t->n = 0;
+    for (uint64_t i = 0; i < cap; i++) {
+        if (old[i].count) kmer_table_add_hashed(t, old[i].key, seq_kmer_mix64(old[i].key), old[i].count);
+    }
+    free(old);
+    return 0;
+}
+
+/* Insert a batch of keys, prefetching the home slot a fixed distance ahead
+ * so the cache misses of successive probes overlap. */
+#define KMER_PREFETCH_DIST 16
+
+static int kmer_table_add_batch(kmer_table_t *t, const uint64_t *keys, int n) {
+    uint64_t hashes[KMER_BATCH];
+    if (kmer_table_reserve(t, (uint64_t)n) < 0) return -1;
+    for (int i = 0; i < n; i++) hashes[i] = seq_kmer_mix64(keys[i]);
+    for (int i = 0; i < n; i++) {
+#if defined(__GNUC__)
+        if (i + KMER_PREFETCH_DIST < n) __builtin_prefetch(&t->slots[hashes[i + KMER_PREFETCH_DIST] & t->mask], 1);
+#endif
+        kmer_table_add_hashed(t, keys[i], hashes[i], 1);
+    }
+    return 0;
+}
+
+typedef struct {
+    kmer_table_t *table;
+    int32_t k; /* 0 until the first row is seen */
+    int32_t canonical;
+    uint64_t min_count;
+} kmer_count_state_t;
+
+typedef struct {
+    uint64_t key;
+    uint64_t value;
+} kmer_count_pair_t;
+
+/* Extra info shared by every callback of one aggregate. */
+typedef struct {
+    const char *name;
+    int spectrum;
+} kmer_aggregate_kind_t;
+
+static const kmer_aggregate_kind_t KMER_COUNT_KIND = {"kmer_count", 0};
+static const kmer_aggregate_kind_t KMER_SPECTRUM_KIND = {"kmer_spectrum", 1};
+
+static idx_t kmer_count_state_size(duckdb_function_info info) {
+    (void)info;
+    return sizeof(kmer_count_state_t);
+}
+
+static void kmer_count_state_init(duckdb_function_info info, duckdb_aggregate_state state) {
+    (void)info;
+    memset(state, 0, sizeof(kmer_count_state_t));
+}
+
+static void kmer_count_state_destroy(duckdb_aggregate_state *states, idx_t count) {
+    for (idx_t i = 0; i < count; i++) {
+        kmer_count_state_t *s = (kmer_count_state_t *)states[i];
+        kmer_table_free(s->table);
+        s->table = NULL;
+    }
+}
+
+/* Adopt the group's parameters on first use; later rows must match. */
+static int kmer_count_configure(duckdb_function_info info, kmer_count_state_t *s, const char *fname, int64_t k,
+                                int canonical, uint64_t min_count) {
+    char err[128];
+    if (k < 1 || k > KMER_COUNT_MAX_K) {
+        snprintf(err, sizeof(err), "%s: k must be between 1 and %d", fname, KMER_COUNT_MAX_K);
+        duckdb_aggregate_function_set_error(info, err);
+        return -1;
+    }
+    if (s->k == 0) {
+        s->k = (int32_t)k;
+        s->canonical = canonical;
+        s->min_count = min_count;
+        return 0;
+    }
+    if (s->k != (int32_t)k || s->canonical != canonical || s->min_count != min_count) {
+        snprintf(err, sizeof(err), "%s: k, canonical and min_count must be constant within a group", fname);
+        duckdb_aggregate_function_set_error(info, err);
+        return -1;
+    }
+    return 0;
+}
+
+static void kmer_count_update(duckdb_function_info info, duckdb_data_chunk input, duckdb_aggregate_state *states) {
+    const char *fname = ((const kmer_aggregate_kind_t *)duckdb_aggregate_function_get_extra_info(info))->name;
+    idx_t n_rows = duckdb_data_chunk_get_size(input);
+    idx_t n_cols = duckdb_data_chunk_get_column_count(input);
+    duckdb_vector seq_vec = duckdb_data_chunk_get_vector(input, 0);
+    duckdb_vector k_vec = n_cols > 1 ? duckdb_data_chunk_get_vector(input, 1) : NULL;
+    duckdb_vector canonical_vec = n_cols > 2 ? duckdb_data_chunk_get_vector(input, 2) : NULL;
+    duckdb_vector min_vec = n_cols > 3 ? duckdb_data_chunk_get_vector(input, 3) : NULL;
+    duckdb_string_t *seqs = (duckdb_string_t *)duckdb_vector_get_data(seq_vec);
+    const int64_t *ks = k_vec ? (const int64_t *)duckdb_vector_get_data(k_vec) : NULL;
+    const bool *canonicals = canonical_vec ? (const bool *)duckdb_vector_get_data(canonical_vec) : NULL;
+    const int64_t *mins = min_vec ? (const int64_t *)duckdb_vector_get_data(min_vec) : NULL;
+    uint64_t keys[KMER_BATCH];
+    char err[128];
+
+    for (idx_t row = 0; row < n_rows; row++) {
+        if (!row_is_valid(seq_vec, row) || (k_vec && !row_is_valid(k_vec, row)) ||
+            (canonical_vec && !row_is_valid(canonical_vec, row)) || (min_vec && !row_is_valid(min_vec, row))) {
+            continue;
+        }
+        kmer_count_state_t *s = (kmer_count_state_t *)states[row];
+        int64_t min_count = mins ? mins[row] : 1;
+        if (kmer_count_configure(info, s, fname, ks ? ks[row] : KMER_COUNT_DEFAULT_K,
+                                 canonicals ? (canonicals[row] ? 1 : 0) : 1,
+                                 min_count < 1 ? 1 : (uint64_t)min_count) < 0) {
+            return;
+        }
+        if (!s->table && !(s->table = (kmer_table_t *)calloc(1, sizeof(kmer_table_t)))) goto oom;
+
+        uint32_t len = duckdb_string_t_length(seqs[row]);
+        const unsigned char *seq = (const unsigned char *)duckdb_string_t_data(&seqs[row]);
+        seq_kmer_roller_t roller;
+        seq_kmer_roller_init(&roller, (unsigned)s->k);
+        int n_keys = 0;
+        for (uint32_t i = 0; i < len; i++) {
+            if (!seq_kmer_roller_push(&roller, seq[i])) continue;
+            keys[n_keys++] = s->canonical && seq_kmer_roller_rev_first(&roller) ? roller.rev.lo : roller.fwd.lo;
+            if (n_keys == KMER_BATCH) {
+                if (kmer_table_add_batch(s->table, keys, n_keys) < 0) goto oom;
+                n_keys = 0;
+            }
+        }
+        if (n_keys > 0 && kmer_table_add_batch(s->table, keys, n_keys) < 0) goto oom;
+    }
+    return;
+
+oom:
+    snprintf(err, sizeof(err), "%s: out of memory", fname);
+    duckdb_aggregate_function_set_error(info, err);
+}
+
+static void kmer_count_combine(duckdb_function_info info, duckdb_aggregate_state *source,
+                               duckdb_aggregate_state *target, idx_t count) {
+    const char *fname = ((const kmer_aggregate_kind_t *)duckdb_aggregate_function_get_extra_info(info))->name;
+    char err[128];
+    for (idx_t i = 0; i < count; i++) {
+        kmer_count_state_t *src = (kmer_count_state_t *)source[i];
+        kmer_count_state_t *dst = (kmer_count_state_t *)target[i];
+        if (src->k == 0) continue;
+        if (kmer_count_configure(info, dst, fname, src->k, src->canonical, src->min_count) < 0) return;
+        if (!src->table || src->table->n == 0) continue;
+        /* Window frames combine the same source into several targets, so
+         * the source must stay intact: copy its slots, never steal them. */
+        if ((!dst->table && !(dst->table = (kmer_table_t *)calloc(1, sizeof(kmer_table_t)))) ||
+            kmer_table_reserve(dst->table, src->table->n) < 0) {
+            snprintf(err, sizeof(err), "%s: out of memory", fname);
+            duckdb_aggregate_function_set_error(info, err);
+            return;
+        }
+        for (uint64_t j = 0; src->table->slots && j <= src->table->mask; j++) {
+            kmer_slot_t *slot = &src->table->slots[j];
+            if (slot->count) kmer_table_add_hashed(dst->table, slot->key, seq_kmer_mix64(slot->key), slot->count);
+        }
+    }
+}
+
+static int compare_pair_key(const void *a, const void *b) {
+    uint64_t x = ((const kmer_count_pair_t *)a)->key, y = ((const kmer_count_pair_t *)b)->key;
+    return (x > y) - (x < y);
+}
+
+/* Append pairs as STRUCT(<key>, <value>) list entries at result row. */
+static int kmer_count_write_list(duckdb_vector result, idx_t row, const kmer_count_pair_t *pairs, idx_t n) {
+    duckdb_list_entry *entries = (duckdb_list_entry *)duckdb_vector_get_data(result);
+    idx_t off = duckdb_list_vector_get_size(result);
+    if (duckdb_list_vector_reserve(result, off + n) != DuckDBSuccess ||
+        duckdb_list_vector_set_size(result, off + n) != DuckDBSuccess) {
+        return -1;
+    }
+    /* Reserving may move the child buffers; fetch them after growing. */
+    duckdb_vector child = duckdb_list_vector_get_child(result);
+    uint64_t *keys = (uint64_t *)duckdb_vector_get_data(duckdb_struct_vector_get_child(child, 0));
+    uint64_t *values = (uint64_t *)duckdb_vector_get_data(duckdb_struct_vector_get_child(child, 1));
+    for (idx_t i = 0; i < n; i++) {
+        keys[off + i] = pairs[i].key;
+        values[off + i] = pairs[i].value;
+    }
+    entries[row].offset = off;
+    entries[row].length = n;
+    return 0;
+}
+
+static void kmer_count_finalize(duckdb_function_info info, duckdb_aggregate_state *source, duckdb_vector result,
+                                idx_t count, idx_t offset) {
+    const kmer_aggregate_kind_t *kind = (const kmer_aggregate_kind_t *)duckdb_aggregate_function_get_extra_info(info);
+    const char *fname = kind->name;
+    int spectrum = kind->spectrum;
+    char err[128];
+    for (idx_t i = 0; i < count; i++) {
+        kmer_count_state_t *s = (kmer_count_state_t *)source[i];
+        idx_t n = s->table ? (idx_t)s->table->n : 0;
+        kmer_count_pair_t *pairs = NULL;
+        if (n > 0 && !(pairs = (kmer_count_pair_t *)malloc(n * sizeof(*pairs)))) goto oom;
+
+        idx_t m = 0;
+        for (uint64_t j = 0; n > 0 && j <= s->table->mask; j++) {
+            uint64_t c = s->table->slots[j].count;
+            if (!c) continue;
+            if (spectrum) {
+                /* Sort the multiplicities, then run-length them below. */
+                pairs[m].key = c;
+                pairs[m].value = 1;
+                m++;
+            } else if (c >= s->min_count) {
+                pairs[m].key = s->table->slots[j].key;
+                pairs[m].value = c;
+                m++;
+            }
+        }
+        if (m > 1) qsort(pairs, (size_t)m, sizeof(*pairs), compare_pair_key);
+        if (spectrum && m > 0) {
+            idx_t runs = 0;
+            for (idx_t j = 0; j < m; j++) {
+                if (runs > 0 && pairs[runs - 1].key == pairs[j].key) {
+                    pairs[runs - 1].value++;
+                } else {
+                    pairs[runs++] = pairs[j];
+                }
+            }
+            m = runs;
+        }
+
+        int rc = kmer_count_write_list(result, offset + i, pairs, m);
+        free(pairs);
+        if (rc < 0) goto oom;
+    }
+    return;
+
+oom:
+    snprintf(err, sizeof(err), "%s: out of memory", fname);
+    duckdb_aggregate_function_set_error(info, err);
+}
+
+/* Overloads (seq), (seq, k), (seq, k, canonical) and, when max_args is 4,
+ * (seq, k, canonical, min_count). */
+static void register_kmer_aggregate(duckdb_connection connection, const kmer_aggregate_kind_t *kind,
+                                    const char *key_name, const char *value_name, int max_args) {
+    duckdb_aggregate_function_set set = duckdb_create_aggregate_function_set(kind->name);
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_logical_type bool_type = duckdb_create_logical_type(DUCKDB_TYPE_BOOLEAN);
+    duckdb_logical_type ubigint_type = duckdb_create_logical_type(DUCKDB_TYPE_UBIGINT);
+    duckdb_logical_type members[2] = {ubigint_type, ubigint_type};
+    const char *names[2] = {key_name, value_name};
+    duckdb_logical_type struct_type = duckdb_create_struct_type(members, names, 2);
+    duckdb_logical_type list_type = duckdb_create_list_type(struct_type);
+
+    for (int n_args = 1; n_args <= max_args; n_args++) {
+        duckdb_aggregate_function fn = duckdb_create_aggregate_function();
+        duckdb_aggregate_function_set_name(fn, kind->name);
+        duckdb_aggregate_function_add_parameter(fn, varchar_type);
+        if (n_args > 1) duckdb_aggregate_function_add_parameter(fn, bigint_type);
+        if (n_args > 2) duckdb_aggregate_function_add_parameter(fn, bool_type);
+        if (n_args > 3) duckdb_aggregate_function_add_parameter(fn, bigint_type);
+        duckdb_aggregate_function_set_return_type(fn, list_type);
+        duckdb_aggregate_function_set_functions(fn, kmer_count_state_size, kmer_count_state_init, kmer_count_update,
+                                                kmer_count_combine, kmer_count_finalize);
+        duckdb_aggregate_function_set_destructor(fn, kmer_count_state_destroy);
+        duckdb_aggregate_function_set_extra_info(fn, (void *)kind, NULL);
+        duckdb_add_aggregate_function_to_set(set, fn);
+        duckdb_destroy_aggregate_function(&fn);
+    }
+    duckdb_register_aggregate_function_set(connection, set);
+
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_logical_type(&bool_type);
+    duckdb_destroy_logical_type(&ubigint_type);
+    duckdb_destroy_logical_type(&struct_type);
+    duckdb_destroy_logical_type(&list_type);
+    duckdb_destroy_aggregate_function_set(&set);
+}
+
+void register_kmer_count_functions(duckdb_connection connection) {
+    seq_kernels_init();
+    register_kmer_aggregate(connection, &KMER_COUNT_KIND, "kmer", "count", 4);
+    register_kmer_aggregate(connection, &KMER_SPECTRUM_KIND, "count", "n_kmers", 3);
+}
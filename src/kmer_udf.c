@@ -1,8 +1,12 @@
 #include "duckdb_extension.h"
 DUCKDB_EXTENSION_EXTERN
 
+#include "include/seq_kernels.h"
+#include "include/vector_access.h"
+
 #include <ctype.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 
 #define SAM_FLAG_PAIRED 0x1
@@ -77,14 +81,6 @@ static inline void set_null_at(duckdb_vector vector, idx_t row) {
     duckdb_validity_set_row_invalid(validity, row);
 }
 
-static inline int row_is_valid(duckdb_vector vector, idx_t row) {
-    uint64_t *validity = duckdb_vector_get_validity(vector);
-    if (!validity) {
-        return 1;
-    }
-    return duckdb_validity_row_is_valid(validity, row);
-}
-
 static inline char dna_complement(char c) {
     switch ((unsigned char)toupper((unsigned char)c)) {
     case 'A': return 'T';
@@ -148,13 +144,6 @@ static inline char bit4_to_iupac(uint8_t code) {
     }
 }
 
-static inline const char *get_string_at(duckdb_vector vector, idx_t row, idx_t *len) {
-    duckdb_string_t *data = (duckdb_string_t *)duckdb_vector_get_data(vector);
-    duckdb_string_t *val = &data[row];
-    *len = duckdb_string_t_length(*val);
-    return duckdb_string_t_data(val);
-}
-
 static inline int64_t get_int64_at(duckdb_vector vector, idx_t row) {
     duckdb_logical_type logical_type = duckdb_vector_get_column_type(vector);
     duckdb_type type = duckdb_get_type_id(logical_type);
@@ -294,10 +283,32 @@ static int cigar_has_operator_text(const char *cigar, idx_t cigar_len, char op)
     return 0;
 }
 
+/* Grow a per-chunk scratch buffer; returns NULL on allocation failure. */
+static char *seq_scratch_reserve(char **buf, size_t *cap, size_t len) {
+    if (len <= *cap && *buf) {
+        return *buf;
+    }
+    size_t new_cap = *cap ? *cap : 256;
+    while (new_cap < len) {
+        new_cap *= 2;
+    }
+    char *grown = (char *)duckdb_malloc(new_cap);
+    if (!grown) {
+        return NULL;
+    }
+    if (*buf) {
+        duckdb_free(*buf);
+    }
+    *buf = grown;
+    *cap = new_cap;
+    return grown;
+}
+
 static void seq_revcomp_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output) {
-    (void)info;
     duckdb_vector seq_vec = duckdb_data_chunk_get_vector(input, 0);
     idx_t row_count = duckdb_data_chunk_get_size(input);
+    char *buf = NULL;
+    size_t cap = 0;
 
     for (idx_t row = 0; row < row_count; row++) {
         if (!row_is_valid(seq_vec, row)) {
@@ -307,38 +318,28 @@ static void seq_revcomp_scalar(duckdb_function_info info, duckdb_data_chunk inpu
 
         idx_t len = 0;
         const char *seq = get_string_at(seq_vec, row, &len);
-        char *out = (char *)duckdb_malloc((size_t)len + 1);
+        char *out = seq_scratch_reserve(&buf, &cap, (size_t)len);
         if (!out) {
             duckdb_scalar_function_set_error(info, "seq_revcomp: out of memory");
-            return;
-        }
-
-        int valid = 1;
-        for (idx_t i = 0; i < len; i++) {
-            char rc = dna_complement(seq[len - 1 - i]);
-            if (!rc) {
-                valid = 0;
-                break;
-            }
-            out[i] = rc;
+            break;
         }
 
-        if (!valid) {
+        if (seq_revcomp_kernel(seq, (size_t)len, out) != 0) {
             set_null_at(output, row);
-            duckdb_free(out);
             continue;
         }
-
-        out[len] = '\0';
         duckdb_vector_assign_string_element_len(output, row, out, len);
-        duckdb_free(out);
+    }
+    if (buf) {
+        duckdb_free(buf);
     }
 }
 
 static void seq_canonical_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output) {
-    (void)info;
     duckdb_vector seq_vec = duckdb_data_chunk_get_vector(input, 0);
     idx_t row_count = duckdb_data_chunk_get_size(input);
+    char *buf = NULL;
+    size_t cap = 0;
 
     for (idx_t row = 0; row < row_count; row++) {
         if (!row_is_valid(seq_vec, row)) {
@@ -348,42 +349,20 @@ static void seq_canonical_scalar(duckdb_function_info info, duckdb_data_chunk in
 
         idx_t len = 0;
         const char *seq = get_string_at(seq_vec, row, &len);
-
-        char *fwd = (char *)duckdb_malloc((size_t)len + 1);
-        char *rev = (char *)duckdb_malloc((size_t)len + 1);
-        if (!fwd || !rev) {
-            if (fwd) duckdb_free(fwd);
-            if (rev) duckdb_free(rev);
+        char *out = seq_scratch_reserve(&buf, &cap, (size_t)len);
+        if (!out) {
             duckdb_scalar_function_set_error(info, "seq_canonical: out of memory");
-            return;
-        }
-
-        int valid = 1;
-        for (idx_t i = 0; i < len; i++) {
-            unsigned char c = (unsigned char)toupper((unsigned char)seq[i]);
-            char rc = dna_complement(seq[len - 1 - i]);
-            if (!rc || (c != 'A' && c != 'C' && c != 'G' && c != 'T' && c != 'N')) {
-                valid = 0;
-                break;
-            }
-            fwd[i] = (char)c;
-            rev[i] = rc;
+            break;
         }
 
-        if (!valid) {
+        if (seq_canonical_kernel(seq, (size_t)len, out) != 0) {
             set_null_at(output, row);
-            duckdb_free(fwd);
-            duckdb_free(rev);
             continue;
         }
-
-        fwd[len] = '\0';
-        rev[len] = '\0';
-
-        const char *chosen = (memcmp(fwd, rev, (size_t)len) <= 0) ? fwd : rev;
-        duckdb_vector_assign_string_element_len(output, row, chosen, len);
-        duckdb_free(fwd);
-        duckdb_free(rev);
+        duckdb_vector_assign_string_element_len(output, row, out, len);
+    }
+    if (buf) {
+        duckdb_free(buf);
     }
 }
 
@@ -541,42 +520,13 @@ static void seq_gc_content_scalar(duckdb_function_info info, duckdb_data_chunk i
 
         idx_t len = 0;
         const char *seq = get_string_at(seq_vec, row, &len);
-        if (len == 0) {
-            set_null_at(output, row);
-            continue;
-        }
-
-        idx_t gc = 0;
-        idx_t called = 0;
-        int valid = 1;
-        for (idx_t i = 0; i < len; i++) {
-            unsigned char c = (unsigned char)toupper((unsigned char)seq[i]);
-            switch (c) {
-            case 'G':
-            case 'C':
-                gc++;
-                called++;
-                break;
-            case 'A':
-            case 'T':
-                called++;
-                break;
-            case 'N':
-                break;
-            default:
-                valid = 0;
-                break;
-            }
-            if (!valid) {
-                break;
-            }
-        }
-
-        if (!valid || called == 0) {
+        size_t gc = 0;
+        size_t n = 0;
+        if (len == 0 || seq_gc_count_kernel(seq, (size_t)len, &gc, &n) != 0 || n == (size_t)len) {
             set_null_at(output, row);
             continue;
         }
-        out_data[row] = (double)gc / (double)called;
+        out_data[row] = (double)gc / (double)((size_t)len - n);
     }
 }
 
@@ -789,15 +739,22 @@ static void cigar_has_op_scalar(duckdb_function_info info, duckdb_data_chunk inp
     }
 }
 
+typedef enum {
+    SEQ_KMERS_OUTPUT_KMER = 0,
+    SEQ_KMERS_OUTPUT_HASH = 1
+} seq_kmers_output_t;
+
 typedef struct {
     char *sequence;
     idx_t seq_len;
     idx_t k;
     int canonical;
+    seq_kmers_output_t output;
 } seq_kmers_bind_t;
 
 typedef struct {
     idx_t next_pos;
+    char *scratch;
 } seq_kmers_init_t;
 
 static void destroy_seq_kmers_bind(void *data) {
@@ -812,21 +769,28 @@ static void destroy_seq_kmers_bind(void *data) {
 }
 
 static void destroy_seq_kmers_init(void *data) {
-    if (data) {
-        duckdb_free(data);
+    seq_kmers_init_t *init = (seq_kmers_init_t *)data;
+    if (!init) {
+        return;
     }
+    if (init->scratch) {
+        duckdb_free(init->scratch);
+    }
+    duckdb_free(init);
 }
 
 static void seq_kmers_bind(duckdb_bind_info info) {
     duckdb_value seq_val = duckdb_bind_get_parameter(info, 0);
     duckdb_value k_val = duckdb_bind_get_parameter(info, 1);
     duckdb_value canonical_val = duckdb_bind_get_named_parameter(info, "canonical");
+    duckdb_value output_val = duckdb_bind_get_named_parameter(info, "output");
 
     if (!seq_val || duckdb_is_null_value(seq_val)) {
         duckdb_bind_set_error(info, "seq_kmers: sequence must not be NULL");
         if (seq_val) duckdb_destroy_value(&seq_val);
         if (k_val) duckdb_destroy_value(&k_val);
         if (canonical_val) duckdb_destroy_value(&canonical_val);
+        if (output_val) duckdb_destroy_value(&output_val);
         return;
     }
 
@@ -835,20 +799,33 @@ static void seq_kmers_bind(duckdb_bind_info info) {
         if (seq_val) duckdb_destroy_value(&seq_val);
         if (k_val) duckdb_destroy_value(&k_val);
         if (canonical_val) duckdb_destroy_value(&canonical_val);
+        if (output_val) duckdb_destroy_value(&output_val);
         return;
     }
 
     char *sequence = duckdb_get_varchar(seq_val);
     int64_t k = duckdb_get_int64(k_val);
-    int canonical = 0;
+    int canonical = -1;
+    seq_kmers_output_t output = SEQ_KMERS_OUTPUT_KMER;
+    int bad_output = 0;
 
     if (canonical_val && !duckdb_is_null_value(canonical_val)) {
         canonical = duckdb_get_bool(canonical_val) ? 1 : 0;
     }
+    if (output_val && !duckdb_is_null_value(output_val)) {
+        char *mode = duckdb_get_varchar(output_val);
+        if (mode && strcmp(mode, "hash") == 0) {
+            output = SEQ_KMERS_OUTPUT_HASH;
+        } else if (!mode || strcmp(mode, "kmer") != 0) {
+            bad_output = 1;
+        }
+        if (mode) duckdb_free(mode);
+    }
 
     if (seq_val) duckdb_destroy_value(&seq_val);
     if (k_val) duckdb_destroy_value(&k_val);
     if (canonical_val) duckdb_destroy_value(&canonical_val);
+    if (output_val) duckdb_destroy_value(&output_val);
 
     if (!sequence) {
         duckdb_bind_set_error(info, "seq_kmers: failed to read sequence");
@@ -859,6 +836,16 @@ static void seq_kmers_bind(duckdb_bind_info info) {
         duckdb_free(sequence);
         return;
     }
+    if (bad_output) {
+        duckdb_bind_set_error(info, "seq_kmers: output must be 'kmer' or 'hash'");
+        duckdb_free(sequence);
+        return;
+    }
+    if (output == SEQ_KMERS_OUTPUT_HASH && k > SEQ_KMER_MAX_K) {
+        duckdb_bind_set_error(info, "seq_kmers: output := 'hash' requires k <= 64");
+        duckdb_free(sequence);
+        return;
+    }
 
     seq_kmers_bind_t *bind = (seq_kmers_bind_t *)duckdb_malloc(sizeof(seq_kmers_bind_t));
     if (!bind) {
@@ -870,14 +857,17 @@ static void seq_kmers_bind(duckdb_bind_info info) {
     bind->sequence = sequence;
     bind->seq_len = (idx_t)strlen(sequence);
     bind->k = (idx_t)k;
-    bind->canonical = canonical;
+    /* Hashes are canonical unless asked otherwise; strings stay as written. */
+    bind->canonical = canonical >= 0 ? canonical : (output == SEQ_KMERS_OUTPUT_HASH);
+    bind->output = output;
 
     duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
-    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type kmer_type = duckdb_create_logical_type(
+        output == SEQ_KMERS_OUTPUT_KMER ? DUCKDB_TYPE_VARCHAR : k <= 32 ? DUCKDB_TYPE_UBIGINT : DUCKDB_TYPE_UHUGEINT);
     duckdb_bind_add_result_column(info, "pos", bigint_type);
-    duckdb_bind_add_result_column(info, "kmer", varchar_type);
+    duckdb_bind_add_result_column(info, "kmer", kmer_type);
     duckdb_destroy_logical_type(&bigint_type);
-    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&kmer_type);
 
     idx_t n_kmers = 0;
     if (bind->seq_len >= bind->k) {
@@ -888,16 +878,101 @@ static void seq_kmers_bind(duckdb_bind_info info) {
 }
 
 static void seq_kmers_init(duckdb_init_info info) {
+    seq_kmers_bind_t *bind = (seq_kmers_bind_t *)duckdb_init_get_bind_data(info);
     seq_kmers_init_t *init = (seq_kmers_init_t *)duckdb_malloc(sizeof(seq_kmers_init_t));
     if (!init) {
         duckdb_init_set_error(info, "seq_kmers: out of memory");
         return;
     }
     init->next_pos = 0;
+    init->scratch = (char *)duckdb_malloc((size_t)bind->k);
+    if (!init->scratch) {
+        duckdb_free(init);
+        duckdb_init_set_error(info, "seq_kmers: out of memory");
+        return;
+    }
     duckdb_init_set_max_threads(info, 1);
     duckdb_init_set_init_data(info, init, destroy_seq_kmers_init);
 }
 
+/* Emit the k-mers starting at seq[first .. first + count) into rows
+ * [row, row + count) of pos_data (if given) and kmer_vec, using a k-byte
+ * scratch for strings. One roller pass covers the range: the k - 1 bases
+ * before the first k-mer only prime it. */
+static void seq_kmers_emit(const char *seq, idx_t k, int canonical, seq_kmers_output_t output, idx_t first,
+                           idx_t count, int64_t *pos_data, duckdb_vector kmer_vec, idx_t row, char *scratch) {
+    if (pos_data) {
+        for (idx_t i = 0; i < count; i++) {
+            pos_data[row + i] = (int64_t)(first + i) + 1;
+        }
+    }
+
+    if (output == SEQ_KMERS_OUTPUT_KMER && !canonical) {
+        for (idx_t i = 0; i < count; i++) {
+            duckdb_vector_assign_string_element_len(kmer_vec, row + i, seq + first + i, k);
+        }
+        return;
+    }
+
+    if (k > SEQ_KMER_MAX_K) {
+        /* Too long to pack; only canonical strings get here. */
+        for (idx_t i = 0; i < count; i++) {
+            if (seq_canonical_kernel(seq + first + i, (size_t)k, scratch) != 0) {
+                set_null_at(kmer_vec, row + i);
+            } else {
+                duckdb_vector_assign_string_element_len(kmer_vec, row + i, scratch, k);
+            }
+        }
+        return;
+    }
+
+    seq_kmer_roller_t roller;
+    seq_kmer_roller_init(&roller, (unsigned)k);
+    for (idx_t j = first; j + 1 < first + k; j++) {
+        seq_kmer_roller_push(&roller, (unsigned char)seq[j]);
+    }
+
+    uint64_t *u64_data = NULL;
+    duckdb_uhugeint *u128_data = NULL;
+    if (output == SEQ_KMERS_OUTPUT_HASH) {
+        if (k <= 32) {
+            u64_data = (uint64_t *)duckdb_vector_get_data(kmer_vec);
+        } else {
+            u128_data = (duckdb_uhugeint *)duckdb_vector_get_data(kmer_vec);
+        }
+    }
+
+    for (idx_t i = 0; i < count; i++) {
+        int complete = seq_kmer_roller_push(&roller, (unsigned char)seq[first + i + k - 1]);
+        seq_kmer128_t code = roller.fwd;
+        if (complete && canonical && seq_kmer_roller_rev_first(&roller)) {
+            code = roller.rev;
+        }
+
+        if (output == SEQ_KMERS_OUTPUT_HASH) {
+            if (!complete) {
+                set_null_at(kmer_vec, row + i);
+            } else if (u64_data) {
+                u64_data[row + i] = code.lo;
+            } else {
+                u128_data[row + i].lower = code.lo;
+                u128_data[row + i].upper = code.hi;
+            }
+            continue;
+        }
+
+        /* Canonical string: the codes decide the strand unless the k-mer
+         * holds an N, which the string form keeps. */
+        if (complete) {
+            seq_kmer_decode(code, (unsigned)k, scratch);
+        } else if (seq_canonical_kernel(seq + first + i, (size_t)k, scratch) != 0) {
+            set_null_at(kmer_vec, row + i);
+            continue;
+        }
+        duckdb_vector_assign_string_element_len(kmer_vec, row + i, scratch, k);
+    }
+}
+
 static void seq_kmers_function(duckdb_function_info info, duckdb_data_chunk output) {
     seq_kmers_bind_t *bind = (seq_kmers_bind_t *)duckdb_function_get_bind_data(info);
     seq_kmers_init_t *init = (seq_kmers_init_t *)duckdb_function_get_init_data(info);
@@ -921,56 +996,86 @@ static void seq_kmers_function(duckdb_function_info info, duckdb_data_chunk outp
     duckdb_vector kmer_vec = duckdb_data_chunk_get_vector(output, 1);
     int64_t *pos_data = (int64_t *)duckdb_vector_get_data(pos_vec);
 
-    char *fwd = NULL;
-    char *rev = NULL;
-    if (bind->canonical) {
-        fwd = (char *)duckdb_malloc((size_t)bind->k + 1);
-        rev = (char *)duckdb_malloc((size_t)bind->k + 1);
-        if (!fwd || !rev) {
-            if (fwd) duckdb_free(fwd);
-            if (rev) duckdb_free(rev);
-            duckdb_function_set_error(info, "seq_kmers: out of memory");
-            return;
-        }
-        fwd[bind->k] = '\0';
-        rev[bind->k] = '\0';
-    }
+    seq_kmers_emit(bind->sequence, bind->k, bind->canonical, bind->output, init->next_pos, emit, pos_data, kmer_vec,
+                   0, init->scratch);
 
-    for (idx_t i = 0; i < emit; i++) {
-        idx_t start = init->next_pos + i;
-        pos_data[i] = (int64_t)start + 1;
+    init->next_pos += emit;
+    duckdb_data_chunk_set_size(output, emit);
+}
+
+/* Row-wise k-mer lists for sequence columns: (seq, k[, canonical]). They
+ * run as ordinary scalars, so DuckDB spreads them over all threads and the
+ * caller keeps any key column next to unnest(). */
+static void seq_kmers_list_common(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output,
+                                  seq_kmers_output_t mode, const char *fname) {
+    idx_t row_count = duckdb_data_chunk_get_size(input);
+    idx_t n_cols = duckdb_data_chunk_get_column_count(input);
+    duckdb_vector seq_vec = duckdb_data_chunk_get_vector(input, 0);
+    duckdb_vector k_vec = duckdb_data_chunk_get_vector(input, 1);
+    duckdb_vector canonical_vec = n_cols > 2 ? duckdb_data_chunk_get_vector(input, 2) : NULL;
+    const int64_t *k_data = (const int64_t *)duckdb_vector_get_data(k_vec);
+    const bool *canonical_data = canonical_vec ? (const bool *)duckdb_vector_get_data(canonical_vec) : NULL;
+    duckdb_list_entry *entries = (duckdb_list_entry *)duckdb_vector_get_data(output);
+    duckdb_vector child = duckdb_list_vector_get_child(output);
+    idx_t child_off = duckdb_list_vector_get_size(output);
+    char *buf = NULL;
+    size_t cap = 0;
+    char err[128];
 
-        if (!bind->canonical) {
-            duckdb_vector_assign_string_element_len(kmer_vec, i, bind->sequence + start, bind->k);
+    for (idx_t row = 0; row < row_count; row++) {
+        entries[row].offset = child_off;
+        entries[row].length = 0;
+        if (!row_is_valid(seq_vec, row) || !row_is_valid(k_vec, row) ||
+            (canonical_vec && !row_is_valid(canonical_vec, row))) {
+            set_null_at(output, row);
             continue;
         }
 
-        int valid = 1;
-        for (idx_t j = 0; j < bind->k; j++) {
-            unsigned char b = (unsigned char)toupper((unsigned char)bind->sequence[start + j]);
-            char rc = dna_complement(bind->sequence[start + bind->k - 1 - j]);
-            if (!rc || (b != 'A' && b != 'C' && b != 'G' && b != 'T' && b != 'N')) {
-                valid = 0;
-                break;
-            }
-            fwd[j] = (char)b;
-            rev[j] = rc;
+        int64_t k = k_data[row];
+        int64_t max_k = mode == SEQ_KMERS_OUTPUT_HASH ? 32 : INT64_MAX;
+        if (k <= 0 || k > max_k) {
+            snprintf(err, sizeof(err), "%s: %s", fname,
+                     mode == SEQ_KMERS_OUTPUT_HASH ? "k must be between 1 and 32" : "k must be > 0");
+            duckdb_scalar_function_set_error(info, err);
+            break;
         }
+        /* Hash lists default to canonical, string lists to as-written. */
+        int canonical = canonical_data ? canonical_data[row] : (mode == SEQ_KMERS_OUTPUT_HASH);
 
-        if (!valid) {
-            set_null_at(kmer_vec, i);
-            continue;
+        idx_t len = 0;
+        const char *seq = get_string_at(seq_vec, row, &len);
+        idx_t n = len >= (idx_t)k ? len - (idx_t)k + 1 : 0;
+        char *scratch = seq_scratch_reserve(&buf, &cap, (size_t)k);
+        if (!scratch || duckdb_list_vector_reserve(output, child_off + n) != DuckDBSuccess ||
+            duckdb_list_vector_set_size(output, child_off + n) != DuckDBSuccess) {
+            snprintf(err, sizeof(err), "%s: failed to grow list storage", fname);
+            duckdb_scalar_function_set_error(info, err);
+            break;
         }
 
-        const char *chosen = (memcmp(fwd, rev, (size_t)bind->k) <= 0) ? fwd : rev;
-        duckdb_vector_assign_string_element_len(kmer_vec, i, chosen, bind->k);
+        /* Reserving may move the child buffers; fetch them after growing. */
+        if (mode == SEQ_KMERS_OUTPUT_HASH) {
+            seq_kmers_emit(seq, (idx_t)k, canonical, mode, 0, n, NULL, child, child_off, scratch);
+        } else {
+            duckdb_vector pos_vec = duckdb_struct_vector_get_child(child, 0);
+            duckdb_vector kmer_vec = duckdb_struct_vector_get_child(child, 1);
+            seq_kmers_emit(seq, (idx_t)k, canonical, mode, 0, n, (int64_t *)duckdb_vector_get_data(pos_vec),
+                           kmer_vec, child_off, scratch);
+        }
+        entries[row].length = n;
+        child_off += n;
+    }
+    if (buf) {
+        duckdb_free(buf);
     }
+}
 
-    if (fwd) duckdb_free(fwd);
-    if (rev) duckdb_free(rev);
+static void seq_kmers_list_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output) {
+    seq_kmers_list_common(info, input, output, SEQ_KMERS_OUTPUT_KMER, "seq_kmers_list");
+}
 
-    init->next_pos += emit;
-    duckdb_data_chunk_set_size(output, emit);
+static void seq_kmer_hashes_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output) {
+    seq_kmers_list_common(info, input, output, SEQ_KMERS_OUTPUT_HASH, "seq_kmer_hashes");
 }
 
 static void register_seq_revcomp_function(duckdb_connection connection) {
@@ -1075,6 +1180,55 @@ static void register_seq_gc_content_function(duckdb_connection connection) {
     duckdb_destroy_scalar_function(&fn);
 }
 
+static void register_seq_kmers_list_function(duckdb_connection connection, const char *name,
+                                             duckdb_logical_type ret_type, duckdb_scalar_function_t fn_ptr) {
+    duckdb_scalar_function_set set = duckdb_create_scalar_function_set(name);
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_logical_type bool_type = duckdb_create_logical_type(DUCKDB_TYPE_BOOLEAN);
+
+    for (int with_canonical = 0; with_canonical <= 1; with_canonical++) {
+        duckdb_scalar_function fn = duckdb_create_scalar_function();
+        duckdb_scalar_function_set_name(fn, name);
+        duckdb_scalar_function_add_parameter(fn, varchar_type);
+        duckdb_scalar_function_add_parameter(fn, bigint_type);
+        if (with_canonical) {
+            duckdb_scalar_function_add_parameter(fn, bool_type);
+        }
+        duckdb_scalar_function_set_return_type(fn, ret_type);
+        duckdb_scalar_function_set_function(fn, fn_ptr);
+        duckdb_add_scalar_function_to_set(set, fn);
+        duckdb_destroy_scalar_function(&fn);
+    }
+    duckdb_register_scalar_function_set(connection, set);
+
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_logical_type(&bool_type);
+    duckdb_destroy_scalar_function_set(&set);
+}
+
+static void register_seq_kmers_list_functions(duckdb_connection connection) {
+    duckdb_logical_type members[2];
+    members[0] = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    members[1] = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    const char *names[2] = {"pos", "kmer"};
+    duckdb_logical_type struct_type = duckdb_create_struct_type(members, names, 2);
+    duckdb_logical_type kmer_list_type = duckdb_create_list_type(struct_type);
+    duckdb_logical_type ubigint_type = duckdb_create_logical_type(DUCKDB_TYPE_UBIGINT);
+    duckdb_logical_type hash_list_type = duckdb_create_list_type(ubigint_type);
+
+    register_seq_kmers_list_function(connection, "seq_kmers_list", kmer_list_type, seq_kmers_list_scalar);
+    register_seq_kmers_list_function(connection, "seq_kmer_hashes", hash_list_type, seq_kmer_hashes_scalar);
+
+    duckdb_destroy_logical_type(&members[0]);
+    duckdb_destroy_logical_type(&members[1]);
+    duckdb_destroy_logical_type(&struct_type);
+    duckdb_destroy_logical_type(&kmer_list_type);
+    duckdb_destroy_logical_type(&ubigint_type);
+    duckdb_destroy_logical_type(&hash_list_type);
+}
+
 static void register_sam_flag_predicate_function(duckdb_connection connection,
                                                  const char *name,
                                                  uint16_t mask) {
@@ -1207,6 +1361,7 @@ static void register_seq_kmers_function(duckdb_connection connection) {
     duckdb_table_function_add_parameter(tf, varchar_type);
     duckdb_table_function_add_parameter(tf, bigint_type);
     duckdb_table_function_add_named_parameter(tf, "canonical", bool_type);
+    duckdb_table_function_add_named_parameter(tf, "output", varchar_type);
 
     duckdb_table_function_set_bind(tf, seq_kmers_bind);
     duckdb_table_function_set_init(tf, seq_kmers_init);
@@ -1221,6 +1376,7 @@ static void register_seq_kmers_function(duckdb_connection connection) {
 }
 
 void register_kmer_udf_functions(duckdb_connection connection) {
+    seq_kernels_init();
     register_seq_revcomp_function(connection);
     register_seq_canonical_function(connection);
     register_seq_hash_2bit_function(connection);
@@ -1228,6 +1384,7 @@ void register_kmer_udf_functions(duckdb_connection connection) {
     register_seq_decode_4bit_function(connection);
     register_seq_gc_content_function(connection);
     register_seq_kmers_function(connection);
+    register_seq_kmers_list_functions(connection);
     register_cigar_metric_function(connection, "cigar_has_soft_clip", CIGAR_METRIC_HAS_SOFT_CLIP, DUCKDB_TYPE_BOOLEAN);
     register_cigar_metric_function(connection, "cigar_has_hard_clip", CIGAR_METRIC_HAS_HARD_CLIP, DUCKDB_TYPE_BOOLEAN);
     register_cigar_metric_function(connection, "cigar_left_soft_clip", CIGAR_METRIC_LEFT_SOFT_CLIP, DUCKDB_TYPE_BIGINT);
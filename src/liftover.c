@@ -0,0 +1,910 @@
+/**
+ * DuckHTS chain-file liftover.
+ *
+ * read_chain(path)
+ *   -> one row per ungapped block of a UCSC chain file (plain or gzipped),
+ *      with target coordinates on the + strand.
+ *
+ * liftover(chrom, start, end, chain_path)
+ *   -> STRUCT(chrom, start, end, strand, mapped_fraction, n_chains), or NULL
+ *      when no base of the 0-based, half-open interval maps.
+ *
+ * liftover_bed(path, chain_path, min_match := 0.95, keep_unmapped := FALSE)
+ *   -> BED intervals lifted to the target assembly.
+ *
+ * A chain file is parsed once per process into a cgranges index of its
+ * blocks on the source contigs, cached by path and reloaded when its mtime or
+ * size changes. An interval is lifted through every block it overlaps: the
+ * blocks are grouped by chain, and the chain covering the most bases (then
+ * the higher score) wins, as with UCSC liftOver. The result spans the lifted
+ * blocks of that chain, mapped_fraction is its share of the input bases and
+ * n_chains the number of chains hit, so multi-mapping intervals can be
+ * filtered. Chains on the - strand are reported in + strand coordinates.
+ * Zero-length intervals are lifted as the base at start and stay zero-length.
+ */
+
+#include "duckdb_extension.h"
+DUCKDB_EXTENSION_EXTERN
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <htslib/hts.h>
+#include <htslib/khash.h>
+#include <htslib/kstring.h>
+
+#include "cgranges.h"
+#include "include/file_cache.h"
+#include "include/vector_access.h"
+
+/* Exported by cgranges.c but not declared in its header: the overlap query
+ * by contig id, which saves a name lookup per row. */
+int64_t cr_overlap_int(const cgranges_t *cr, int32_t ctg_id, int32_t st, int32_t en, int64_t **b_, int64_t *m_b_);
+
+KHASH_MAP_INIT_STR(lift_name, int32_t)
+
+typedef struct {
+    int64_t id;
+    int64_t score;
+    int32_t from_name;
+    int32_t to_name;
+    int64_t to_size;
+    char strand;            /* strand of the target side; the source is always + */
+} lift_chain_t;
+
+typedef struct {
+    int32_t chain;
+    int32_t from_start;
+    int32_t from_end;
+    int64_t to_start;       /* on the chain's target strand */
+} lift_block_t;
+
+/* Immutable chain index shared by all calls on the same file. */
+typedef struct {
+    file_cache_entry_t base;
+    lift_chain_t *chains;
+    int32_t n_chains, m_chains;
+    lift_block_t *blocks;   /* file order; cgranges labels index into it */
+    int64_t n_blocks, m_blocks;
+    char **names;
+    int32_t n_names, m_names;
+    khash_t(lift_name) *name_ids;
+    cgranges_t *cr;
+    uint8_t *solo;          /* per cgranges interval: overlaps no other block */
+} lift_index_t;
+
+/* Outcome of lifting one interval. */
+typedef struct {
+    int32_t chain;          /* winning chain, -1 when nothing maps */
+    int64_t start;
+    int64_t end;
+    char strand;
+    double mapped_fraction;
+    int32_t n_chains;
+} lift_result_t;
+
+typedef struct {
+    int32_t chain;
+    int64_t mapped;
+    int64_t lo, hi;         /* lifted span on the chain's target strand */
+} lift_agg_t;
+
+/* Per-thread query state. last_hit remembers a block that overlaps no other
+ * block, so sorted input stays inside it without querying the index. */
+typedef struct {
+    int64_t *hits;
+    int64_t m_hits;
+    lift_agg_t *agg;
+    int32_t m_agg;
+    int64_t last_hit;
+} lift_scratch_t;
+
+static void lift_index_free(file_cache_entry_t *entry) {
+    lift_index_t *ix = (lift_index_t *)entry;
+    if (ix->cr) cr_destroy(ix->cr);
+    if (ix->name_ids) kh_destroy(lift_name, ix->name_ids);
+    for (int32_t i = 0; i < ix->n_names; i++) free(ix->names[i]);
+    free(ix->names);
+    free(ix->chains);
+    free(ix->blocks);
+    free(ix->solo);
+    free(ix->base.path);
+    free(ix);
+}
+
+static file_cache_t lift_cache = FILE_CACHE_INIT(lift_index_free);
+
+static int32_t lift_name_id(lift_index_t *ix, const char *name) {
+    khint_t k = kh_get(lift_name, ix->name_ids, name);
+    if (k != kh_end(ix->name_ids)) return kh_val(ix->name_ids, k);
+    if (ix->n_names == ix->m_names) {
+        ix->m_names = ix->m_names ? ix->m_names * 2 : 64;
+        ix->names = (char **)realloc(ix->names, sizeof(char *) * (size_t)ix->m_names);
+    }
+    char *copy = strdup(name);
+    ix->names[ix->n_names] = copy;
+    int absent;
+    k = kh_put(lift_name, ix->name_ids, copy, &absent);
+    kh_val(ix->name_ids, k) = ix->n_names;
+    return ix->n_names++;
+}
+
+/* Split a chain file line on spaces/tabs in place; returns the field count. */
+static int lift_split(char *s, char **fields, int max_fields) {
+    int n = 0;
+    while (*s && n < max_fields) {
+        while (*s == ' ' || *s == '\t') s++;
+        if (!*s) break;
+        fields[n++] = s;
+        while (*s && *s != ' ' && *s != '\t') s++;
+        if (*s) *s++ = '\0';
+    }
+    return n;
+}
+
+static int lift_parse_int(const char *s, int64_t *out) {
+    char *end = NULL;
+    long long v = strtoll(s, &end, 10);
+    if (end == s || *end != '\0') return 0;
+    *out = (int64_t)v;
+    return 1;
+}
+
+/* Cache loader; arg is the calling function's name for messages. */
+static file_cache_entry_t *lift_index_load(const char *path, void *arg, char *err, size_t err_len) {
+    const char *fname = (const char *)arg;
+    htsFile *fp = hts_open(path, "r");
+    if (!fp) {
+        snprintf(err, err_len, "%s: failed to open chain file: %s", fname, path);
+        return NULL;
+    }
+
+    lift_index_t *ix = (lift_index_t *)calloc(1, sizeof(lift_index_t));
+    ix->base.path = strdup(path);
+    ix->name_ids = kh_init(lift_name);
+    ix->cr = cr_init();
+
+    kstring_t line = {0, 0, NULL};
+    int64_t lineno = 0;
+    int in_chain = 0;
+    int64_t t_pos = 0, q_pos = 0, t_end = 0, q_end = 0;
+    const char *bad = NULL;
+    char *fields[16];
+
+    while (hts_getline(fp, '\n', &line) >= 0) {
+        lineno++;
+        if (line.l > 0 && line.s[line.l - 1] == '\r') line.s[--line.l] = '\0';
+        int nf = lift_split(line.s, fields, 16);
+        if (nf == 0 || fields[0][0] == '#') continue;
+
+        if (strcmp(fields[0], "chain") == 0) {
+            if (in_chain) {
+                bad = "chain ended without a final block";
+                break;
+            }
+            int64_t v[13] = {0};
+            if (nf < 12 || !lift_parse_int(fields[1], &v[1]) || !lift_parse_int(fields[3], &v[3]) ||
+                !lift_parse_int(fields[5], &v[5]) || !lift_parse_int(fields[6], &v[6]) ||
+                !lift_parse_int(fields[8], &v[8]) || !lift_parse_int(fields[10], &v[10]) ||
+                !lift_parse_int(fields[11], &v[11]) || (nf > 12 && !lift_parse_int(fields[12], &v[12]))) {
+                bad = "malformed chain header";
+                break;
+            }
+            if (strcmp(fields[4], "+") != 0 || (strcmp(fields[9], "+") != 0 && strcmp(fields[9], "-") != 0)) {
+                bad = "unsupported chain strand";
+                break;
+            }
+            if (v[5] < 0 || v[6] > INT32_MAX || v[5] > v[6] || v[10] < 0 || v[10] > v[11] || v[11] > v[8]) {
+                bad = "chain coordinates out of range";
+                break;
+            }
+            if (ix->n_chains == ix->m_chains) {
+                ix->m_chains = ix->m_chains ? ix->m_chains * 2 : 256;
+                ix->chains = (lift_chain_t *)realloc(ix->chains, sizeof(lift_chain_t) * (size_t)ix->m_chains);
+            }
+            lift_chain_t *c = &ix->chains[ix->n_chains++];
+            c->id = nf > 12 ? v[12] : ix->n_chains;
+            c->score = v[1];
+            c->from_name = lift_name_id(ix, fields[2]);
+            c->to_name = lift_name_id(ix, fields[7]);
+            c->to_size = v[8];
+            c->strand = fields[9][0];
+            t_pos = v[5];
+            t_end = v[6];
+            q_pos = v[10];
+            q_end = v[11];
+            in_chain = 1;
+            continue;
+        }
+
+        int64_t size = 0, dt = 0, dq = 0;
+        if (!in_chain || (nf != 1 && nf != 3) || !lift_parse_int(fields[0], &size) ||
+            (nf == 3 && (!lift_parse_int(fields[1], &dt) || !lift_parse_int(fields[2], &dq))) ||
+            size < 0 || dt < 0 || dq < 0) {
+            bad = "malformed alignment block";
+            break;
+        }
+        if (t_pos + size > t_end || q_pos + size > q_end) {
+            bad = "alignment block runs past the chain end";
+            break;
+        }
+        if (size > 0) {
+            if (ix->n_blocks == ix->m_blocks) {
+                ix->m_blocks = ix->m_blocks ? ix->m_blocks * 2 : 4096;
+                ix->blocks = (lift_block_t *)realloc(ix->blocks, sizeof(lift_block_t) * (size_t)ix->m_blocks);
+            }
+            if (ix->n_blocks >= INT32_MAX) {
+                bad = "too many alignment blocks";
+                break;
+            }
+            lift_block_t *b = &ix->blocks[ix->n_blocks];
+            b->chain = ix->n_chains - 1;
+            b->from_start = (int32_t)t_pos;
+            b->from_end = (int32_t)(t_pos + size);
+            b->to_start = q_pos;
+            cr_add(ix->cr, ix->names[ix->chains[b->chain].from_name], b->from_start, b->from_end,
+                   (int32_t)ix->n_blocks);
+            ix->n_blocks++;
+        }
+        t_pos += size + dt;
+        q_pos += size + dq;
+        if (nf == 1) in_chain = 0;
+    }
+    if (!bad && in_chain) bad = "chain ended without a final block";
+    free(line.s);
+    hts_close(fp);
+    if (bad) {
+        snprintf(err, err_len, "%s: %s at line %lld of %s", fname, bad, (long long)lineno, path);
+        lift_index_free(&ix->base);
+        return NULL;
+    }
+
+    cr_index(ix->cr);
+
+    /* Intervals are sorted by start within each contig, so a block overlaps
+     * a later one exactly when the next start is before its end, and an
+     * earlier one when the running max end passes its start. */
+    ix->solo = (uint8_t *)malloc((size_t)(ix->cr->n_r > 0 ? ix->cr->n_r : 1));
+    for (int32_t k = 0; k < ix->cr->n_ctg; k++) {
+        int64_t off = ix->cr->ctg[k].off, n = ix->cr->ctg[k].n;
+        int32_t max_end = INT32_MIN;
+        for (int64_t i = off; i < off + n; i++) {
+            int solo = max_end <= cr_start(ix->cr, i);
+            if (i + 1 < off + n && cr_start(ix->cr, i + 1) < cr_end(ix->cr, i)) solo = 0;
+            ix->solo[i] = (uint8_t)solo;
+            if (cr_end(ix->cr, i) > max_end) max_end = cr_end(ix->cr, i);
+        }
+    }
+    return &ix->base;
+}
+
+/* Take a reference to the cached index for path, (re)loading it when the
+ * file is new or its mtime/size changed. */
+static lift_index_t *lift_acquire(const char *fname, const char *path, char *err, size_t err_len) {
+    return (lift_index_t *)file_cache_acquire(&lift_cache, path, lift_index_load, (void *)fname, err, err_len);
+}
+
+static void lift_release(lift_index_t *ix) {
+    if (ix) file_cache_release(&lift_cache, &ix->base);
+}
+
+static void lift_scratch_free(lift_scratch_t *sc) {
+    free(sc->hits);
+    free(sc->agg);
+    memset(sc, 0, sizeof(*sc));
+    sc->last_hit = -1;
+}
+
+/* Lift [start, end) on source contig ctg (a cgranges contig id). */
+static void lift_interval(const lift_index_t *ix, int32_t ctg, int64_t start, int64_t end,
+                          lift_scratch_t *sc, lift_result_t *res) {
+    res->chain = -1;
+    res->n_chains = 0;
+    res->mapped_fraction = 0.0;
+    if (ctg < 0 || start < 0 || end < start || start >= INT32_MAX) return;
+    int64_t qs = start, qe = end > start ? end : start + 1;
+    if (qe > INT32_MAX) qe = INT32_MAX;
+
+    const cgranges_t *cr = ix->cr;
+    int64_t n_hits;
+    if (sc->last_hit >= 0 && ix->solo[sc->last_hit] && cr->ctg[ctg].off <= sc->last_hit &&
+        sc->last_hit < cr->ctg[ctg].off + cr->ctg[ctg].n &&
+        cr_start(cr, sc->last_hit) <= qs && qe <= cr_end(cr, sc->last_hit)) {
+        n_hits = 1;
+        if (sc->m_hits == 0) {
+            sc->m_hits = 16;
+            sc->hits = (int64_t *)malloc(sizeof(int64_t) * (size_t)sc->m_hits);
+        }
+        sc->hits[0] = sc->last_hit;
+    } else {
+        n_hits = cr_overlap_int(cr, ctg, (int32_t)qs, (int32_t)qe, &sc->hits, &sc->m_hits);
+        sc->last_hit = n_hits == 1 ? sc->hits[0] : -1;
+    }
+    if (n_hits <= 0) return;
+
+    int32_t n_agg = 0;
+    for (int64_t h = 0; h < n_hits; h++) {
+        int64_t i = sc->hits[h];
+        const lift_block_t *b = &ix->blocks[cr_label(cr, i)];
+        int64_t os = qs > b->from_start ? qs : b->from_start;
+        int64_t oe = qe < b->from_end ? qe : b->from_end;
+        if (oe <= os) continue;
+        int64_t ts = b->to_start + (os - b->from_start);
+        int64_t te = ts + (oe - os);
+        int32_t a = 0;
+        while (a < n_agg && sc->agg[a].chain != b->chain) a++;
+        if (a == n_agg) {
+            if (n_agg == sc->m_agg) {
+                sc->m_agg = sc->m_agg ? sc->m_agg * 2 : 8;
+                sc->agg = (lift_agg_t *)realloc(sc->agg, sizeof(lift_agg_t) * (size_t)sc->m_agg);
+            }
+            sc->agg[n_agg].chain = b->chain;
+            sc->agg[n_agg].mapped = 0;
+            sc->agg[n_agg].lo = ts;
+            sc->agg[n_agg].hi = te;
+            n_agg++;
+        }
+        lift_agg_t *g = &sc->agg[a];
+        g->mapped += oe - os;
+        if (ts < g->lo) g->lo = ts;
+        if (te > g->hi) g->hi = te;
+    }
+    if (n_agg == 0) return;
+
+    int32_t best = 0;
+    for (int32_t a = 1; a < n_agg; a++) {
+        const lift_agg_t *g = &sc->agg[a], *w = &sc->agg[best];
+        if (g->mapped > w->mapped ||
+            (g->mapped == w->mapped && ix->chains[g->chain].score > ix->chains[w->chain].score) ||
+            (g->mapped == w->mapped && ix->chains[g->chain].score == ix->chains[w->chain].score &&
+             g->chain < w->chain)) {
+            best = a;
+        }
+    }
+    const lift_agg_t *g = &sc->agg[best];
+    const lift_chain_t *c = &ix->chains[g->chain];
+    res->chain = g->chain;
+    res->strand = c->strand;
+    res->n_chains = n_agg;
+    res->mapped_fraction = (double)g->mapped / (double)(qe - qs);
+    if (c->strand == '-') {
+        res->start = c->to_size - g->hi;
+        res->end = c->to_size - g->lo;
+    } else {
+        res->start = g->lo;
+        res->end = g->hi;
+    }
+    if (end == start) {
+        if (c->strand == '-') res->start = res->end;
+        else res->end = res->start;
+    }
+}
+
+static void set_row_null(duckdb_vector vec, idx_t row) {
+    duckdb_vector_ensure_validity_writable(vec);
+    duckdb_validity_set_row_invalid(duckdb_vector_get_validity(vec), row);
+}
+
+static const char *lift_strand_text(char strand) {
+    return strand == '-' ? "-" : "+";
+}
+
+/* ================================================================
+ * liftover
+ * ================================================================ */
+
+enum {
+    LIFT_FIELD_CHROM = 0,
+    LIFT_FIELD_START,
+    LIFT_FIELD_END,
+    LIFT_FIELD_STRAND,
+    LIFT_FIELD_MAPPED_FRACTION,
+    LIFT_FIELD_N_CHAINS,
+    LIFT_NFIELDS
+};
+
+static const char *LIFT_FIELD_NAMES[LIFT_NFIELDS] = {
+    "chrom", "start", "end", "strand", "mapped_fraction", "n_chains"
+};
+
+/* Rows are lifted against the index of the current chain path, and the
+ * source contig is looked up once per run of equal chroms. */
+static void liftover_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output) {
+    idx_t n_rows = duckdb_data_chunk_get_size(input);
+    duckdb_vector chrom_vec = duckdb_data_chunk_get_vector(input, 0);
+    duckdb_vector start_vec = duckdb_data_chunk_get_vector(input, 1);
+    duckdb_vector end_vec = duckdb_data_chunk_get_vector(input, 2);
+    duckdb_vector path_vec = duckdb_data_chunk_get_vector(input, 3);
+    const int64_t *starts = (const int64_t *)duckdb_vector_get_data(start_vec);
+    const int64_t *ends = (const int64_t *)duckdb_vector_get_data(end_vec);
+
+    duckdb_vector fields[LIFT_NFIELDS];
+    for (int f = 0; f < LIFT_NFIELDS; f++) fields[f] = duckdb_struct_vector_get_child(output, (idx_t)f);
+    int64_t *out_start = (int64_t *)duckdb_vector_get_data(fields[LIFT_FIELD_START]);
+    int64_t *out_end = (int64_t *)duckdb_vector_get_data(fields[LIFT_FIELD_END]);
+    double *out_frac = (double *)duckdb_vector_get_data(fields[LIFT_FIELD_MAPPED_FRACTION]);
+    int32_t *out_n = (int32_t *)duckdb_vector_get_data(fields[LIFT_FIELD_N_CHAINS]);
+    uint64_t *validity[LIFT_NFIELDS + 1] = {NULL};   /* output, then fields; made writable on first NULL */
+
+    lift_index_t *ix = NULL;
+    lift_scratch_t sc;
+    memset(&sc, 0, sizeof(sc));
+    sc.last_hit = -1;
+    kstring_t path = {0, 0, NULL};
+    kstring_t chrom = {0, 0, NULL};
+    int have_chrom = 0;
+    int32_t ctg = -1;
+    char err[512];
+
+    for (idx_t row = 0; row < n_rows; row++) {
+        lift_result_t res;
+        res.chain = -1;
+        if (row_is_valid(chrom_vec, row) && row_is_valid(start_vec, row) &&
+            row_is_valid(end_vec, row) && row_is_valid(path_vec, row)) {
+            idx_t len;
+            const char *s = get_string_at(path_vec, row, &len);
+            if (!ix || path.l != len || memcmp(path.s, s, len) != 0) {
+                lift_release(ix);
+                path.l = 0;
+                kputsn(s, len, &path);
+                ix = lift_acquire("liftover", path.s, err, sizeof(err));
+                if (!ix) {
+                    duckdb_scalar_function_set_error(info, err);
+                    break;
+                }
+                have_chrom = 0;
+                sc.last_hit = -1;
+            }
+            s = get_string_at(chrom_vec, row, &len);
+            if (!have_chrom || chrom.l != len || memcmp(chrom.s, s, len) != 0) {
+                chrom.l = 0;
+                kputsn(s, len, &chrom);
+                ctg = cr_get_ctg(ix->cr, chrom.s);
+                have_chrom = 1;
+            }
+            lift_interval(ix, ctg, starts[row], ends[row], &sc, &res);
+        }
+
+        if (res.chain < 0) {
+            if (!validity[0]) {
+                duckdb_vector_ensure_validity_writable(output);
+                validity[0] = duckdb_vector_get_validity(output);
+                for (int f = 0; f < LIFT_NFIELDS; f++) {
+                    duckdb_vector_ensure_validity_writable(fields[f]);
+                    validity[f + 1] = duckdb_vector_get_validity(fields[f]);
+                }
+            }
+            for (int f = 0; f <= LIFT_NFIELDS; f++) duckdb_validity_set_row_invalid(validity[f], row);
+            continue;
+        }
+        const lift_chain_t *c = &ix->chains[res.chain];
+        duckdb_vector_assign_string_element(fields[LIFT_FIELD_CHROM], row, ix->names[c->to_name]);
+        out_start[row] = res.start;
+        out_end[row] = res.end;
+        duckdb_vector_assign_string_element(fields[LIFT_FIELD_STRAND], row, lift_strand_text(res.strand));
+        out_frac[row] = res.mapped_fraction;
+        out_n[row] = res.n_chains;
+    }
+
+    lift_release(ix);
+    lift_scratch_free(&sc);
+    free(path.s);
+    free(chrom.s);
+}
+
+static void register_liftover_scalar(duckdb_connection connection) {
+    duckdb_scalar_function fn = duckdb_create_scalar_function();
+    duckdb_scalar_function_set_name(fn, "liftover");
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_logical_type double_type = duckdb_create_logical_type(DUCKDB_TYPE_DOUBLE);
+    duckdb_logical_type int_type = duckdb_create_logical_type(DUCKDB_TYPE_INTEGER);
+    duckdb_logical_type field_types[LIFT_NFIELDS] = {varchar_type, bigint_type, bigint_type,
+                                                     varchar_type, double_type, int_type};
+    duckdb_logical_type struct_type = duckdb_create_struct_type(field_types, LIFT_FIELD_NAMES, LIFT_NFIELDS);
+
+    duckdb_scalar_function_add_parameter(fn, varchar_type);
+    duckdb_scalar_function_add_parameter(fn, bigint_type);
+    duckdb_scalar_function_add_parameter(fn, bigint_type);
+    duckdb_scalar_function_add_parameter(fn, varchar_type);
+    duckdb_scalar_function_set_return_type(fn, struct_type);
+    duckdb_scalar_function_set_function(fn, liftover_scalar);
+
+    duckdb_register_scalar_function(connection, fn);
+
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_logical_type(&double_type);
+    duckdb_destroy_logical_type(&int_type);
+    duckdb_destroy_logical_type(&struct_type);
+    duckdb_destroy_scalar_function(&fn);
+}
+
+/* ================================================================
+ * read_chain / liftover_bed
+ * ================================================================ */
+
+enum {
+    CHAIN_COL_CHAIN_ID = 0,
+    CHAIN_COL_SCORE,
+    CHAIN_COL_FROM_CHROM,
+    CHAIN_COL_FROM_START,
+    CHAIN_COL_FROM_END,
+    CHAIN_COL_TO_CHROM,
+    CHAIN_COL_TO_START,
+    CHAIN_COL_TO_END,
+    CHAIN_COL_STRAND,
+    CHAIN_NCOLS
+};
+
+enum {
+    LBED_COL_CHROM = 0,
+    LBED_COL_START,
+    LBED_COL_END,
+    LBED_COL_NAME,
+    LBED_COL_STRAND,
+    LBED_COL_SOURCE_CHROM,
+    LBED_COL_SOURCE_START,
+    LBED_COL_SOURCE_END,
+    LBED_COL_MAPPED_FRACTION,
+    LBED_COL_N_CHAINS,
+    LBED_NCOLS
+};
+
+typedef struct {
+    char *path;             /* BED input (liftover_bed only) */
+    char *chain_path;
+    double min_match;
+    int keep_unmapped;
+} lift_bind_data_t;
+
+typedef struct {
+    lift_index_t *ix;
+    htsFile *fp;
+    kstring_t line;
+    int64_t pos;            /* read_chain: next block */
+    lift_scratch_t sc;
+    kstring_t chrom;
+    int32_t ctg;
+    int finished;
+    idx_t *column_ids;
+    idx_t n_projected_cols;
+} lift_init_data_t;
+
+static void destroy_lift_bind(void *data) {
+    lift_bind_data_t *bind = (lift_bind_data_t *)data;
+    if (!bind) return;
+    free(bind->path);
+    free(bind->chain_path);
+    free(bind);
+}
+
+static void destroy_lift_init(void *data) {
+    lift_init_data_t *init = (lift_init_data_t *)data;
+    if (!init) return;
+    lift_release(init->ix);
+    if (init->fp) hts_close(init->fp);
+    free(init->line.s);
+    free(init->chrom.s);
+    lift_scratch_free(&init->sc);
+    free(init->column_ids);
+    free(init);
+}
+
+static char *lift_string_param(duckdb_bind_info info, int idx) {
+    duckdb_value val = duckdb_bind_get_parameter(info, idx);
+    char *s = duckdb_is_null_value(val) ? NULL : duckdb_get_varchar(val);
+    duckdb_destroy_value(&val);
+    char *out = (s && s[0]) ? strdup(s) : NULL;
+    if (s) duckdb_free(s);
+    return out;
+}
+
+static void read_chain_bind(duckdb_bind_info info) {
+    lift_bind_data_t *bind = (lift_bind_data_t *)calloc(1, sizeof(lift_bind_data_t));
+    if (!bind) {
+        duckdb_bind_set_error(info, "Out of memory");
+        return;
+    }
+    bind->chain_path = lift_string_param(info, 0);
+    if (!bind->chain_path) {
+        duckdb_bind_set_error(info, "read_chain requires a chain file path");
+        destroy_lift_bind(bind);
+        return;
+    }
+    htsFile *fp = hts_open(bind->chain_path, "r");
+    if (!fp) {
+        char err[512];
+        snprintf(err, sizeof(err), "read_chain: failed to open chain file: %s", bind->chain_path);
+        duckdb_bind_set_error(info, err);
+        destroy_lift_bind(bind);
+        return;
+    }
+    hts_close(fp);
+
+    static const char *col_names[CHAIN_NCOLS] = {"chain_id", "score", "from_chrom", "from_start", "from_end",
+                                                 "to_chrom", "to_start", "to_end", "strand"};
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    for (int c = 0; c < CHAIN_NCOLS; c++) {
+        int is_text = c == CHAIN_COL_FROM_CHROM || c == CHAIN_COL_TO_CHROM || c == CHAIN_COL_STRAND;
+        duckdb_bind_add_result_column(info, col_names[c], is_text ? varchar_type : bigint_type);
+    }
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+
+    duckdb_bind_set_bind_data(info, bind, destroy_lift_bind);
+}
+
+static void liftover_bed_bind(duckdb_bind_info info) {
+    char err[512];
+    lift_bind_data_t *bind = (lift_bind_data_t *)calloc(1, sizeof(lift_bind_data_t));
+    if (!bind) {
+        duckdb_bind_set_error(info, "Out of memory");
+        return;
+    }
+    bind->path = lift_string_param(info, 0);
+    bind->chain_path = lift_string_param(info, 1);
+    bind->min_match = 0.95;
+    if (!bind->path || !bind->chain_path) {
+        duckdb_bind_set_error(info, "liftover_bed requires a BED file path and a chain file path");
+        destroy_lift_bind(bind);
+        return;
+    }
+
+    duckdb_value val = duckdb_bind_get_named_parameter(info, "min_match");
+    if (val && !duckdb_is_null_value(val)) bind->min_match = duckdb_get_double(val);
+    if (val) duckdb_destroy_value(&val);
+    if (!(bind->min_match >= 0.0 && bind->min_match <= 1.0)) {
+        duckdb_bind_set_error(info, "liftover_bed: min_match must be between 0 and 1");
+        destroy_lift_bind(bind);
+        return;
+    }
+    val = duckdb_bind_get_named_parameter(info, "keep_unmapped");
+    if (val && !duckdb_is_null_value(val)) bind->keep_unmapped = duckdb_get_bool(val);
+    if (val) duckdb_destroy_value(&val);
+
+    const char *paths[2] = {bind->path, bind->chain_path};
+    for (int i = 0; i < 2; i++) {
+        htsFile *fp = hts_open(paths[i], "r");
+        if (!fp) {
+            snprintf(err, sizeof(err), "liftover_bed: failed to open %s: %s", i ? "chain file" : "file", paths[i]);
+            duckdb_bind_set_error(info, err);
+            destroy_lift_bind(bind);
+            return;
+        }
+        hts_close(fp);
+    }
+
+    static const char *col_names[LBED_NCOLS] = {"chrom", "start", "end", "name", "strand", "source_chrom",
+                                                "source_start", "source_end", "mapped_fraction", "n_chains"};
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_logical_type double_type = duckdb_create_logical_type(DUCKDB_TYPE_DOUBLE);
+    duckdb_logical_type int_type = duckdb_create_logical_type(DUCKDB_TYPE_INTEGER);
+    for (int c = 0; c < LBED_NCOLS; c++) {
+        duckdb_logical_type type = bigint_type;
+        if (c == LBED_COL_CHROM || c == LBED_COL_NAME || c == LBED_COL_STRAND || c == LBED_COL_SOURCE_CHROM) {
+            type = varchar_type;
+        } else if (c == LBED_COL_MAPPED_FRACTION) {
+            type = double_type;
+        } else if (c == LBED_COL_N_CHAINS) {
+            type = int_type;
+        }
+        duckdb_bind_add_result_column(info, col_names[c], type);
+    }
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_logical_type(&double_type);
+    duckdb_destroy_logical_type(&int_type);
+
+    duckdb_bind_set_bind_data(info, bind, destroy_lift_bind);
+}
+
+static void lift_init(duckdb_init_info info, const char *fname) {
+    lift_bind_data_t *bind = (lift_bind_data_t *)duckdb_init_get_bind_data(info);
+    lift_init_data_t *init = (lift_init_data_t *)calloc(1, sizeof(lift_init_data_t));
+    char err[512];
+    if (!init) {
+        duckdb_init_set_error(info, "Out of memory");
+        return;
+    }
+    init->sc.last_hit = -1;
+    init->ctg = -1;
+    init->ix = lift_acquire(fname, bind->chain_path, err, sizeof(err));
+    if (!init->ix) {
+        duckdb_init_set_error(info, err);
+        destroy_lift_init(init);
+        return;
+    }
+    if (bind->path) {
+        init->fp = hts_open(bind->path, "r");
+        if (!init->fp) {
+            snprintf(err, sizeof(err), "%s: failed to open file: %s", fname, bind->path);
+            duckdb_init_set_error(info, err);
+            destroy_lift_init(init);
+            return;
+        }
+    }
+    init->n_projected_cols = duckdb_init_get_column_count(info);
+    init->column_ids = (idx_t *)malloc(sizeof(idx_t) * (init->n_projected_cols ? init->n_projected_cols : 1));
+    for (idx_t i = 0; i < init->n_projected_cols; i++) {
+        init->column_ids[i] = duckdb_init_get_column_index(info, i);
+    }
+    duckdb_init_set_init_data(info, init, destroy_lift_init);
+}
+
+static void read_chain_init(duckdb_init_info info) { lift_init(info, "read_chain"); }
+static void liftover_bed_init(duckdb_init_info info) { lift_init(info, "liftover_bed"); }
+
+static void read_chain_scan(duckdb_function_info info, duckdb_data_chunk output) {
+    lift_init_data_t *init = (lift_init_data_t *)duckdb_function_get_init_data(info);
+    const lift_index_t *ix = init->ix;
+    idx_t capacity = duckdb_vector_size();
+    idx_t row = 0;
+
+    for (; row < capacity && init->pos < ix->n_blocks; row++, init->pos++) {
+        const lift_block_t *b = &ix->blocks[init->pos];
+        const lift_chain_t *c = &ix->chains[b->chain];
+        int64_t len = b->from_end - b->from_start;
+        int64_t to_start = c->strand == '-' ? c->to_size - (b->to_start + len) : b->to_start;
+        for (idx_t col = 0; col < init->n_projected_cols; col++) {
+            duckdb_vector vec = duckdb_data_chunk_get_vector(output, col);
+            int64_t *data = (int64_t *)duckdb_vector_get_data(vec);
+            switch ((int)init->column_ids[col]) {
+                case CHAIN_COL_CHAIN_ID: data[row] = c->id; break;
+                case CHAIN_COL_SCORE: data[row] = c->score; break;
+                case CHAIN_COL_FROM_CHROM: duckdb_vector_assign_string_element(vec, row, ix->names[c->from_name]); break;
+                case CHAIN_COL_FROM_START: data[row] = b->from_start; break;
+                case CHAIN_COL_FROM_END: data[row] = b->from_end; break;
+                case CHAIN_COL_TO_CHROM: duckdb_vector_assign_string_element(vec, row, ix->names[c->to_name]); break;
+                case CHAIN_COL_TO_START: data[row] = to_start; break;
+                case CHAIN_COL_TO_END: data[row] = to_start + len; break;
+                case CHAIN_COL_STRAND: duckdb_vector_assign_string_element(vec, row, lift_strand_text(c->strand)); break;
+                default: break;
+            }
+        }
+    }
+    duckdb_data_chunk_set_size(output, row);
+}
+
+static bool lift_is_meta_bed_line(const char *s) {
+    return s[0] == '#' || strncmp(s, "track", 5) == 0 || strncmp(s, "browser", 7) == 0;
+}
+
+static void liftover_bed_scan(duckdb_function_info info, duckdb_data_chunk output) {
+    lift_bind_data_t *bind = (lift_bind_data_t *)duckdb_function_get_bind_data(info);
+    lift_init_data_t *init = (lift_init_data_t *)duckdb_function_get_init_data(info);
+    const lift_index_t *ix = init->ix;
+    idx_t capacity = duckdb_vector_size();
+    idx_t row = 0;
+    char err[512];
+
+    while (row < capacity && !init->finished) {
+        if (hts_getline(init->fp, '\n', &init->line) < 0) {
+            init->finished = 1;
+            break;
+        }
+        if (init->line.l > 0 && init->line.s[init->line.l - 1] == '\r') init->line.s[--init->line.l] = '\0';
+        if (init->line.l == 0 || lift_is_meta_bed_line(init->line.s)) continue;
+
+        /* chrom, start, end, [name, score, strand]; later columns are ignored */
+        char *fields[6] = {0};
+        int nf = 0;
+        char *p = init->line.s;
+        while (nf < 6) {
+            fields[nf++] = p;
+            p = strchr(p, '\t');
+            if (!p) break;
+            *p++ = '\0';
+        }
+        int64_t start = 0, end = 0;
+        if (nf < 3 || !lift_parse_int(fields[1], &start) || !lift_parse_int(fields[2], &end) || start < 0 ||
+            end < start) {
+            snprintf(err, sizeof(err), "liftover_bed: malformed BED line in %s: %.200s", bind->path, init->line.s);
+            duckdb_function_set_error(info, err);
+            return;
+        }
+
+        if (!init->chrom.s || strcmp(init->chrom.s, fields[0]) != 0) {
+            init->chrom.l = 0;
+            kputs(fields[0], &init->chrom);
+            init->ctg = cr_get_ctg(ix->cr, init->chrom.s);
+        }
+        lift_result_t res;
+        lift_interval(ix, init->ctg, start, end, &init->sc, &res);
+        int mapped = res.chain >= 0 && res.mapped_fraction >= bind->min_match;
+        if (!mapped && !bind->keep_unmapped) continue;
+
+        /* The lifted strand is the input strand composed with the chain's */
+        char strand = mapped ? res.strand : 0;
+        if (mapped && nf >= 6 && (fields[5][0] == '+' || fields[5][0] == '-') && fields[5][1] == '\0') {
+            strand = fields[5][0] == res.strand ? '+' : '-';
+        }
+
+        for (idx_t col = 0; col < init->n_projected_cols; col++) {
+            duckdb_vector vec = duckdb_data_chunk_get_vector(output, col);
+            switch ((int)init->column_ids[col]) {
+                case LBED_COL_CHROM:
+                    if (mapped) duckdb_vector_assign_string_element(vec, row, ix->names[ix->chains[res.chain].to_name]);
+                    else set_row_null(vec, row);
+                    break;
+                case LBED_COL_START:
+                    if (mapped) ((int64_t *)duckdb_vector_get_data(vec))[row] = res.start;
+                    else set_row_null(vec, row);
+                    break;
+                case LBED_COL_END:
+                    if (mapped) ((int64_t *)duckdb_vector_get_data(vec))[row] = res.end;
+                    else set_row_null(vec, row);
+                    break;
+                case LBED_COL_NAME:
+                    if (nf >= 4) duckdb_vector_assign_string_element(vec, row, fields[3]);
+                    else set_row_null(vec, row);
+                    break;
+                case LBED_COL_STRAND:
+                    if (mapped) duckdb_vector_assign_string_element(vec, row, lift_strand_text(strand));
+                    else set_row_null(vec, row);
+                    break;
+                case LBED_COL_SOURCE_CHROM: duckdb_vector_assign_string_element(vec, row, fields[0]); break;
+                case LBED_COL_SOURCE_START: ((int64_t *)duckdb_vector_get_data(vec))[row] = start; break;
+                case LBED_COL_SOURCE_END: ((int64_t *)duckdb_vector_get_data(vec))[row] = end; break;
+                case LBED_COL_MAPPED_FRACTION:
+                    ((double *)duckdb_vector_get_data(vec))[row] = res.chain >= 0 ? res.mapped_fraction : 0.0;
+                    break;
+                case LBED_COL_N_CHAINS: ((int32_t *)duckdb_vector_get_data(vec))[row] = res.n_chains; break;
+                default: break;
+            }
+        }
+        row++;
+    }
+    duckdb_data_chunk_set_size(output, row);
+}
+
+static void register_read_chain_function(duckdb_connection connection) {
+    duckdb_table_function tf = duckdb_create_table_function();
+    duckdb_table_function_set_name(tf, "read_chain");
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_destroy_logical_type(&varchar_type);
+
+    duckdb_table_function_set_bind(tf, read_chain_bind);
+    duckdb_table_function_set_init(tf, read_chain_init);
+    duckdb_table_function_set_function(tf, read_chain_scan);
+    duckdb_table_function_supports_projection_pushdown(tf, true);
+    duckdb_register_table_function(connection, tf);
+    duckdb_destroy_table_function(&tf);
+}
+
+static void register_liftover_bed_function(duckdb_connection connection) {
+    duckdb_table_function tf = duckdb_create_table_function();
+    duckdb_table_function_set_name(tf, "liftover_bed");
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type double_type = duckdb_create_logical_type(DUCKDB_TYPE_DOUBLE);
+    duckdb_logical_type bool_type = duckdb_create_logical_type(DUCKDB_TYPE_BOOLEAN);
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "min_match", double_type);
+    duckdb_table_function_add_named_parameter(tf, "keep_unmapped", bool_type);
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&double_type);
+    duckdb_destroy_logical_type(&bool_type);
+
+    duckdb_table_function_set_bind(tf, liftover_bed_bind);
+    duckdb_table_function_set_init(tf, liftover_bed_init);
+    duckdb_table_function_set_function(tf, liftover_bed_scan);
+    duckdb_table_function_supports_projection_pushdown(tf, true);
+    duckdb_register_table_function(connection, tf);
+    duckdb_destroy_table_function(&tf);
+}
+
+void register_liftover_functions(duckdb_connection connection) {
+    register_read_chain_function(connection);
+    register_liftover_scalar(connection);
+    register_liftover_bed_function(connection);
+}
@@ -0,0 +1,386 @@
+/**
+ * DuckHTS MinHash sketches (Mash-style bottom-s sketches).
+ *
+ * minhash_sketch(seq[, k[, size]])
+ *   -> BLOB holding the `size` smallest distinct hashes of the group's
+ *      canonical k-mers (k defaults to 21, at most 32; size to 1000).
+ *
+ * sketch_jaccard(a, b)
+ *   -> DOUBLE Jaccard estimate: of the s smallest hashes of the union
+ *      (s = the smaller sketch size), the fraction present in both.
+ *
+ * sketch_containment(a, b)
+ *   -> DOUBLE estimate of the fraction of a's k-mers contained in b: a's
+ *      hashes found in b, over a's hashes no larger than b's largest when
+ *      b is full (beyond that b cannot tell).
+ *
+ * K-mers come from the rolling 2-bit encoder in seq_kernels.h and are hashed
+ * with seq_kmer_mix64, so k-mers spanning a non-ACGT base are skipped. The
+ * aggregate state keeps a candidate buffer of up to 2 * size hashes below
+ * the current size-th smallest; when it fills, it is sorted, deduplicated
+ * and cut back to size, so each k-mer costs one compare in the common case
+ * and the result does not depend on how DuckDB splits or combines groups.
+ *
+ * Sketch BLOB layout (little-endian):
+ *   magic[4] "DHMH", uint8 version (1), uint8 k, uint16 reserved,
+ *   uint32 size, uint32 n, then n sorted uint64 hashes.
+ */
+
+#include "duckdb_extension.h"
+DUCKDB_EXTENSION_EXTERN
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "include/seq_kernels.h"
+#include "include/vector_access.h"
+
+#define MINHASH_MAGIC "DHMH"
+#define MINHASH_VERSION 1
+#define MINHASH_HEADER_LEN 16
+#define MINHASH_DEFAULT_K 21
+#define MINHASH_DEFAULT_SIZE 1000
+#define MINHASH_MAX_K 32
+#define MINHASH_MAX_SIZE 1000000
+
+typedef struct {
+    uint64_t *hashes; /* candidates below threshold, unsorted between compactions */
+    uint32_t n;
+    uint32_t cap;
+    uint32_t size;
+    int32_t k; /* 0 until the first row is seen */
+    uint64_t threshold; /* size-th smallest kept hash, or UINT64_MAX */
+} minhash_state_t;
+
+typedef struct {
+    uint8_t k;
+    uint32_t size;
+    uint32_t n;
+    const uint8_t *data;
+} minhash_view_t;
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Sort, deduplicate and keep the `size` smallest candidates. */
+static void minhash_compact(minhash_state_t *s) {
+    if (s->n == 0) return;
+    qsort(s->hashes, s->n, sizeof(uint64_t), compare_u64);
+    uint32_t m = 1;
+    for (uint32_t i = 1; i < s->n && m < s->size; i++) {
+        if (s->hashes[i] != s->hashes[m - 1]) s->hashes[m++] = s->hashes[i];
+    }
+    s->n = m;
+    if (m == s->size) s->threshold = s->hashes[m - 1];
+}
+
+/* The buffer holds 2 * size, and compaction leaves at most size. */
+static inline void minhash_add(minhash_state_t *s, uint64_t h) {
+    if (h >= s->threshold) return;
+    if (s->n == s->cap) {
+        minhash_compact(s);
+        if (h >= s->threshold) return;
+    }
+    s->hashes[s->n++] = h;
+}
+
+static idx_t minhash_state_size(duckdb_function_info info) {
+    (void)info;
+    return sizeof(minhash_state_t);
+}
+
+static void minhash_state_init(duckdb_function_info info, duckdb_aggregate_state state) {
+    (void)info;
+    minhash_state_t *s = (minhash_state_t *)state;
+    memset(s, 0, sizeof(*s));
+    s->threshold = UINT64_MAX;
+}
+
+static void minhash_state_destroy(duckdb_aggregate_state *states, idx_t count) {
+    for (idx_t i = 0; i < count; i++) {
+        minhash_state_t *s = (minhash_state_t *)states[i];
+        free(s->hashes);
+        s->hashes = NULL;
+    }
+}
+
+/* Adopt the group's k and size on first use; later rows must match. The
+ * buffer is capped at 2 * size so compaction stays amortised O(log size). */
+static int minhash_configure(duckdb_function_info info, minhash_state_t *s, int64_t k, int64_t size) {
+    char err[128];
+    if (k < 1 || k > MINHASH_MAX_K) {
+        snprintf(err, sizeof(err), "minhash_sketch: k must be between 1 and %d", MINHASH_MAX_K);
+        duckdb_aggregate_function_set_error(info, err);
+        return -1;
+    }
+    if (size < 1 || size > MINHASH_MAX_SIZE) {
+        snprintf(err, sizeof(err), "minhash_sketch: size must be between 1 and %d", MINHASH_MAX_SIZE);
+        duckdb_aggregate_function_set_error(info, err);
+        return -1;
+    }
+    if (s->k == 0) {
+        s->k = (int32_t)k;
+        s->size = (uint32_t)size;
+        return 0;
+    }
+    if (s->k != (int32_t)k || s->size != (uint32_t)size) {
+        duckdb_aggregate_function_set_error(info, "minhash_sketch: k and size must be constant within a group");
+        return -1;
+    }
+    return 0;
+}
+
+static int minhash_reserve(minhash_state_t *s) {
+    uint32_t want = s->size * 2;
+    if (s->cap >= want) return 0;
+    uint64_t *grown = (uint64_t *)realloc(s->hashes, (size_t)want * sizeof(uint64_t));
+    if (!grown) return -1;
+    s->hashes = grown;
+    s->cap = want;
+    return 0;
+}
+
+static void minhash_update(duckdb_function_info info, duckdb_data_chunk input, duckdb_aggregate_state *states) {
+    idx_t n_rows = duckdb_data_chunk_get_size(input);
+    idx_t n_cols = duckdb_data_chunk_get_column_count(input);
+    duckdb_vector seq_vec = duckdb_data_chunk_get_vector(input, 0);
+    duckdb_vector k_vec = n_cols > 1 ? duckdb_data_chunk_get_vector(input, 1) : NULL;
+    duckdb_vector size_vec = n_cols > 2 ? duckdb_data_chunk_get_vector(input, 2) : NULL;
+    duckdb_string_t *seqs = (duckdb_string_t *)duckdb_vector_get_data(seq_vec);
+    const int64_t *ks = k_vec ? (const int64_t *)duckdb_vector_get_data(k_vec) : NULL;
+    const int64_t *sizes = size_vec ? (const int64_t *)duckdb_vector_get_data(size_vec) : NULL;
+
+    for (idx_t row = 0; row < n_rows; row++) {
+        if (!row_is_valid(seq_vec, row) || (k_vec && !row_is_valid(k_vec, row)) || (size_vec && !row_is_valid(size_vec, row))) {
+            continue;
+        }
+        minhash_state_t *s = (minhash_state_t *)states[row];
+        if (minhash_configure(info, s, ks ? ks[row] : MINHASH_DEFAULT_K,
+                              sizes ? sizes[row] : MINHASH_DEFAULT_SIZE) < 0) {
+            return;
+        }
+        if (minhash_reserve(s) < 0) goto oom;
+
+        uint32_t len = duckdb_string_t_length(seqs[row]);
+        const unsigned char *seq = (const unsigned char *)duckdb_string_t_data(&seqs[row]);
+        seq_kmer_roller_t roller;
+        seq_kmer_roller_init(&roller, (unsigned)s->k);
+        for (uint32_t i = 0; i < len; i++) {
+            if (!seq_kmer_roller_push(&roller, seq[i])) continue;
+            uint64_t code = seq_kmer_roller_rev_first(&roller) ? roller.rev.lo : roller.fwd.lo;
+            minhash_add(s, seq_kmer_mix64(code));
+        }
+    }
+    return;
+
+oom:
+    duckdb_aggregate_function_set_error(info, "minhash_sketch: out of memory");
+}
+
+static void minhash_combine(duckdb_function_info info, duckdb_aggregate_state *source,
+                            duckdb_aggregate_state *target, idx_t count) {
+    for (idx_t i = 0; i < count; i++) {
+        minhash_state_t *src = (minhash_state_t *)source[i];
+        minhash_state_t *dst = (minhash_state_t *)target[i];
+        if (src->k == 0) continue;
+        if (minhash_configure(info, dst, src->k, src->size) < 0) return;
+        if (minhash_reserve(dst) < 0) goto oom;
+        for (uint32_t j = 0; j < src->n; j++) minhash_add(dst, src->hashes[j]);
+    }
+    return;
+
+oom:
+    duckdb_aggregate_function_set_error(info, "minhash_sketch: out of memory");
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    return (uint64_t)get_u32(p) | (uint64_t)get_u32(p + 4) << 32;
+}
+
+static void minhash_finalize(duckdb_function_info info, duckdb_aggregate_state *source, duckdb_vector result,
+                             idx_t count, idx_t offset) {
+    for (idx_t i = 0; i < count; i++) {
+        minhash_state_t *s = (minhash_state_t *)source[i];
+        if (s->k == 0) {
+            duckdb_vector_ensure_validity_writable(result);
+            duckdb_validity_set_row_invalid(duckdb_vector_get_validity(result), offset + i);
+            continue;
+        }
+        minhash_compact(s);
+        size_t len = MINHASH_HEADER_LEN + (size_t)s->n * 8;
+        uint8_t *blob = (uint8_t *)malloc(len);
+        if (!blob) {
+            duckdb_aggregate_function_set_error(info, "minhash_sketch: out of memory");
+            return;
+        }
+        memcpy(blob, MINHASH_MAGIC, 4);
+        blob[4] = MINHASH_VERSION;
+        blob[5] = (uint8_t)s->k;
+        blob[6] = blob[7] = 0;
+        put_u32(blob + 8, s->size);
+        put_u32(blob + 12, s->n);
+        for (uint32_t j = 0; j < s->n; j++) put_u64(blob + MINHASH_HEADER_LEN + 8 * (size_t)j, s->hashes[j]);
+        duckdb_vector_assign_string_element_len(result, offset + i, (const char *)blob, len);
+        free(blob);
+    }
+}
+
+static int minhash_parse(duckdb_string_t *str, minhash_view_t *out) {
+    uint32_t len = duckdb_string_t_length(*str);
+    const uint8_t *p = (const uint8_t *)duckdb_string_t_data(str);
+    if (len < MINHASH_HEADER_LEN || memcmp(p, MINHASH_MAGIC, 4) != 0 || p[4] != MINHASH_VERSION) return -1;
+    out->k = p[5];
+    out->size = get_u32(p + 8);
+    out->n = get_u32(p + 12);
+    out->data = p + MINHASH_HEADER_LEN;
+    if ((uint64_t)len != MINHASH_HEADER_LEN + (uint64_t)out->n * 8 || out->n > out->size) return -1;
+    return 0;
+}
+
+/* Walk both sorted sketches once. Jaccard stops after the s smallest union
+ * hashes; containment counts a's hashes in b, up to b's largest when b is
+ * full. Returns -1 when the estimate is undefined (empty sketch). */
+static double minhash_compare(const minhash_view_t *a, const minhash_view_t *b, int containment) {
+    uint32_t i = 0, j = 0, shared = 0, total = 0;
+    if (containment) {
+        uint64_t limit = b->n == b->size && b->n > 0 ? get_u64(b->data + 8 * (size_t)(b->n - 1)) : UINT64_MAX;
+        while (i < a->n) {
+            uint64_t x = get_u64(a->data + 8 * (size_t)i);
+            if (x > limit) break;
+            while (j < b->n && get_u64(b->data + 8 * (size_t)j) < x) j++;
+            if (j < b->n && get_u64(b->data + 8 * (size_t)j) == x) shared++;
+            total++;
+            i++;
+        }
+    } else {
+        uint32_t s = a->size < b->size ? a->size : b->size;
+        while (total < s && (i < a->n || j < b->n)) {
+            uint64_t x = i < a->n ? get_u64(a->data + 8 * (size_t)i) : UINT64_MAX;
+            uint64_t y = j < b->n ? get_u64(b->data + 8 * (size_t)j) : UINT64_MAX;
+            if (i < a->n && j < b->n && x == y) {
+                shared++;
+                i++;
+                j++;
+            } else if (j >= b->n || (i < a->n && x < y)) {
+                i++;
+            } else {
+                j++;
+            }
+            total++;
+        }
+    }
+    return total ? (double)shared / (double)total : -1.0;
+}
+
+static void sketch_compare_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output,
+                                  int containment) {
+    const char *fname = containment ? "sketch_containment" : "sketch_jaccard";
+    idx_t n_rows = duckdb_data_chunk_get_size(input);
+    duckdb_vector a_vec = duckdb_data_chunk_get_vector(input, 0);
+    duckdb_vector b_vec = duckdb_data_chunk_get_vector(input, 1);
+    duckdb_string_t *as = (duckdb_string_t *)duckdb_vector_get_data(a_vec);
+    duckdb_string_t *bs = (duckdb_string_t *)duckdb_vector_get_data(b_vec);
+    double *out = (double *)duckdb_vector_get_data(output);
+    char err[160];
+
+    for (idx_t row = 0; row < n_rows; row++) {
+        minhash_view_t a, b;
+        if (!row_is_valid(a_vec, row) || !row_is_valid(b_vec, row)) {
+            duckdb_vector_ensure_validity_writable(output);
+            duckdb_validity_set_row_invalid(duckdb_vector_get_validity(output), row);
+            continue;
+        }
+        if (minhash_parse(&as[row], &a) < 0 || minhash_parse(&bs[row], &b) < 0) {
+            snprintf(err, sizeof(err), "%s: argument is not a minhash_sketch() BLOB", fname);
+            duckdb_scalar_function_set_error(info, err);
+            return;
+        }
+        if (a.k != b.k) {
+            snprintf(err, sizeof(err), "%s: sketches use different k (%u and %u)", fname, a.k, b.k);
+            duckdb_scalar_function_set_error(info, err);
+            return;
+        }
+        double v = minhash_compare(&a, &b, containment);
+        if (v < 0) {
+            duckdb_vector_ensure_validity_writable(output);
+            duckdb_validity_set_row_invalid(duckdb_vector_get_validity(output), row);
+            continue;
+        }
+        out[row] = v;
+    }
+}
+
+static void sketch_jaccard_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output) {
+    sketch_compare_scalar(info, input, output, 0);
+}
+
+static void sketch_containment_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output) {
+    sketch_compare_scalar(info, input, output, 1);
+}
+
+static void register_minhash_sketch_function(duckdb_connection connection) {
+    duckdb_aggregate_function_set set = duckdb_create_aggregate_function_set("minhash_sketch");
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_logical_type blob_type = duckdb_create_logical_type(DUCKDB_TYPE_BLOB);
+
+    for (int n_args = 1; n_args <= 3; n_args++) {
+        duckdb_aggregate_function fn = duckdb_create_aggregate_function();
+        duckdb_aggregate_function_set_name(fn, "minhash_sketch");
+        duckdb_aggregate_function_add_parameter(fn, varchar_type);
+        for (int a = 1; a < n_args; a++) duckdb_aggregate_function_add_parameter(fn, bigint_type);
+        duckdb_aggregate_function_set_return_type(fn, blob_type);
+        duckdb_aggregate_function_set_functions(fn, minhash_state_size, minhash_state_init, minhash_update,
+                                                minhash_combine, minhash_finalize);
+        duckdb_aggregate_function_set_destructor(fn, minhash_state_destroy);
+        duckdb_add_aggregate_function_to_set(set, fn);
+        duckdb_destroy_aggregate_function(&fn);
+    }
+    duckdb_register_aggregate_function_set(connection, set);
+
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_logical_type(&blob_type);
+    duckdb_destroy_aggregate_function_set(&set);
+}
+
+static void register_sketch_compare_function(duckdb_connection connection, const char *name,
+                                             duckdb_scalar_function_t fn_ptr) {
+    duckdb_scalar_function fn = duckdb_create_scalar_function();
+    duckdb_scalar_function_set_name(fn, name);
+
+    duckdb_logical_type blob_type = duckdb_create_logical_type(DUCKDB_TYPE_BLOB);
+    duckdb_logical_type double_type = duckdb_create_logical_type(DUCKDB_TYPE_DOUBLE);
+    duckdb_scalar_function_add_parameter(fn, blob_type);
+    duckdb_scalar_function_add_parameter(fn, blob_type);
+    duckdb_scalar_function_set_return_type(fn, double_type);
+    duckdb_scalar_function_set_function(fn, fn_ptr);
+
+    duckdb_register_scalar_function(connection, fn);
+
+    duckdb_destroy_logical_type(&blob_type);
+    duckdb_destroy_logical_type(&double_type);
+    duckdb_destroy_scalar_function(&fn);
+}
+
+void register_minhash_functions(duckdb_connection connection) {
+    register_minhash_sketch_function(connection);
+    register_sketch_compare_function(connection, "sketch_jaccard", sketch_jaccard_scalar);
+    register_sketch_compare_function(connection, "sketch_containment", sketch_containment_scalar);
+}
@@ -0,0 +1,417 @@
+/**
+ * DuckHTS minimizer and open-syncmer extraction.
+ *
+ * seq_minimizers(sequence, k, w, syncmer := NULL)
+ *   -> table (pos BIGINT, hash UBIGINT, strand VARCHAR)
+ *
+ * seq_minimizer_list(sequence, k, w[, syncmer])
+ *   -> STRUCT(pos BIGINT, hash UBIGINT, strand VARCHAR)[] per row, for
+ *      sequence columns (unnest next to the read key).
+ *
+ * K-mers (k <= 32) come from the rolling 2-bit encoder in seq_kernels.h;
+ * hash is seq_kmer_mix64 of the canonical code and strand is '+' when the
+ * forward k-mer is canonical, else '-'. pos is the 1-based k-mer start.
+ *
+ * (w,k)-minimizers: the smallest-hash k-mer of every window of w
+ * consecutive k-mers (leftmost on ties), reported once per run of windows
+ * sharing it. A monotone deque of candidates (hashes increasing from front
+ * to back) gives the window minimum in O(1) amortised per base. Windows
+ * never span a non-ACGT base: the deque restarts after one.
+ *
+ * With syncmer := s (1 <= s <= k), w is ignored and the open syncmers are
+ * reported instead: k-mers whose smallest canonical s-mer is their first
+ * one, found with the same deque sliding over s-mer hashes.
+ */
+
+#include "duckdb_extension.h"
+DUCKDB_EXTENSION_EXTERN
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "include/seq_kernels.h"
+#include "include/vector_access.h"
+
+#define MZ_MAX_K 32
+#define MZ_MAX_W 65536
+
+typedef struct {
+    int64_t pos; /* 0-based k-mer (or s-mer) start */
+    uint64_t hash;
+    char strand;
+} mz_hit_t;
+
+typedef struct {
+    mz_hit_t *items;
+    size_t n;
+    size_t cap;
+} mz_hits_t;
+
+/* Ring-buffer deque of window candidates; the capacity is a power of two
+ * no smaller than the window so indices wrap with a mask. */
+typedef struct {
+    mz_hit_t *items;
+    size_t mask;
+    size_t head;
+    size_t n;
+} mz_deque_t;
+
+typedef struct {
+    unsigned k;
+    unsigned w;
+    unsigned s; /* 0 for minimizers */
+} mz_params_t;
+
+static int mz_hits_push(mz_hits_t *hits, mz_hit_t hit) {
+    if (hits->n == hits->cap) {
+        size_t new_cap = hits->cap ? hits->cap * 2 : 64;
+        mz_hit_t *grown = (mz_hit_t *)realloc(hits->items, new_cap * sizeof(mz_hit_t));
+        if (!grown) return -1;
+        hits->items = grown;
+        hits->cap = new_cap;
+    }
+    hits->items[hits->n++] = hit;
+    return 0;
+}
+
+static inline mz_hit_t *mz_deque_at(mz_deque_t *dq, size_t i) { return &dq->items[(dq->head + i) & dq->mask]; }
+
+/* Slide the window to end at hit.pos: drop the candidate that left it from
+ * the front (positions advance by one, so at most one) and every larger
+ * hash from the back, then append. */
+static inline void mz_deque_push(mz_deque_t *dq, mz_hit_t hit, int64_t window) {
+    if (dq->n > 0 && dq->items[dq->head].pos <= hit.pos - window) {
+        dq->head = (dq->head + 1) & dq->mask;
+        dq->n--;
+    }
+    while (dq->n > 0 && mz_deque_at(dq, dq->n - 1)->hash > hit.hash) dq->n--;
+    *mz_deque_at(dq, dq->n) = hit;
+    dq->n++;
+}
+
+static inline mz_hit_t mz_roller_hit(const seq_kmer_roller_t *r, int64_t start) {
+    mz_hit_t hit;
+    int rev = seq_kmer_roller_rev_first(r);
+    hit.pos = start;
+    hit.hash = seq_kmer_mix64(rev ? r->rev.lo : r->fwd.lo);
+    hit.strand = rev ? '-' : '+';
+    return hit;
+}
+
+/* Append the minimizers (or open syncmers) of seq to out. Returns 0, or -1
+ * when out of memory. */
+static int mz_collect(const char *seq, size_t len, const mz_params_t *p, mz_hits_t *out) {
+    unsigned sub = p->s ? p->s : p->k;             /* unit slid through the deque */
+    int64_t window = p->s ? p->k - p->s + 1 : p->w; /* units per window */
+    mz_deque_t dq = {NULL, 0, 0, 0};
+    seq_kmer_roller_t kmer, unit;
+    int64_t run = 0, last_pos = -1;
+    size_t cap = 1;
+
+    while (cap < (size_t)window) cap <<= 1;
+    dq.mask = cap - 1;
+    dq.items = (mz_hit_t *)malloc(cap * sizeof(mz_hit_t));
+    if (!dq.items) return -1;
+    seq_kmer_roller_init(&kmer, p->k);
+    seq_kmer_roller_init(&unit, sub);
+
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)seq[i];
+        /* Minimizers slide k-mers themselves; only syncmers need both. */
+        int kmer_done = p->s ? seq_kmer_roller_push(&kmer, c) : 0;
+        if (!seq_kmer_roller_push(&unit, c)) {
+            if (unit.run == 0) {
+                dq.n = 0;
+                run = 0;
+            }
+            continue;
+        }
+        mz_deque_push(&dq, mz_roller_hit(&unit, (int64_t)(i + 1 - sub)), window);
+        if (++run < window) continue;
+
+        if (p->s) {
+            /* The k-mer ends at the same base as the last s-mer of its window. */
+            int64_t start = (int64_t)(i + 1 - p->k);
+            if (kmer_done && mz_deque_at(&dq, 0)->pos == start && mz_hits_push(out, mz_roller_hit(&kmer, start)) < 0)
+                goto oom;
+        } else {
+            mz_hit_t *min = mz_deque_at(&dq, 0);
+            if (min->pos != last_pos) {
+                if (mz_hits_push(out, *min) < 0) goto oom;
+                last_pos = min->pos;
+            }
+        }
+    }
+    free(dq.items);
+    return 0;
+
+oom:
+    free(dq.items);
+    return -1;
+}
+
+static const char *mz_check_params(int64_t k, int64_t w, int64_t s) {
+    if (k < 1 || k > MZ_MAX_K) return "k must be between 1 and 32";
+    if (s == 0 && (w < 1 || w > MZ_MAX_W)) return "w must be between 1 and 65536";
+    if (s < 0 || s > k) return "syncmer must be between 1 and k";
+    return NULL;
+}
+
+static void mz_write_hits(const mz_hits_t *hits, size_t first, idx_t count, duckdb_vector pos_vec,
+                          duckdb_vector hash_vec, duckdb_vector strand_vec, idx_t row) {
+    int64_t *pos = pos_vec ? (int64_t *)duckdb_vector_get_data(pos_vec) : NULL;
+    uint64_t *hash = hash_vec ? (uint64_t *)duckdb_vector_get_data(hash_vec) : NULL;
+    for (idx_t i = 0; i < count; i++) {
+        const mz_hit_t *hit = &hits->items[first + i];
+        if (pos) pos[row + i] = hit->pos + 1;
+        if (hash) hash[row + i] = hit->hash;
+        if (strand_vec) duckdb_vector_assign_string_element_len(strand_vec, row + i, &hit->strand, 1);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/* seq_minimizers table function                                              */
+/* ------------------------------------------------------------------------- */
+
+typedef struct {
+    char *sequence;
+    mz_params_t params;
+} mz_bind_t;
+
+typedef struct {
+    mz_hits_t hits;
+    size_t next;
+    idx_t column_count;
+    idx_t *column_ids;
+} mz_init_t;
+
+static void mz_destroy_bind(void *data) {
+    mz_bind_t *bind = (mz_bind_t *)data;
+    if (!bind) return;
+    if (bind->sequence) duckdb_free(bind->sequence);
+    duckdb_free(bind);
+}
+
+static void mz_destroy_init(void *data) {
+    mz_init_t *init = (mz_init_t *)data;
+    if (!init) return;
+    free(init->hits.items);
+    if (init->column_ids) duckdb_free(init->column_ids);
+    duckdb_free(init);
+}
+
+static void mz_add_result_columns(duckdb_bind_info info) {
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_logical_type ubigint_type = duckdb_create_logical_type(DUCKDB_TYPE_UBIGINT);
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_bind_add_result_column(info, "pos", bigint_type);
+    duckdb_bind_add_result_column(info, "hash", ubigint_type);
+    duckdb_bind_add_result_column(info, "strand", varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_logical_type(&ubigint_type);
+    duckdb_destroy_logical_type(&varchar_type);
+}
+
+static void mz_bind(duckdb_bind_info info) {
+    duckdb_value seq_val = duckdb_bind_get_parameter(info, 0);
+    duckdb_value k_val = duckdb_bind_get_parameter(info, 1);
+    duckdb_value w_val = duckdb_bind_get_parameter(info, 2);
+    duckdb_value s_val = duckdb_bind_get_named_parameter(info, "syncmer");
+    int null_arg = !seq_val || duckdb_is_null_value(seq_val) || !k_val || duckdb_is_null_value(k_val) || !w_val ||
+                   duckdb_is_null_value(w_val);
+    char *sequence = null_arg ? NULL : duckdb_get_varchar(seq_val);
+    int64_t k = null_arg ? 0 : duckdb_get_int64(k_val);
+    int64_t w = null_arg ? 0 : duckdb_get_int64(w_val);
+    int64_t s = s_val && !duckdb_is_null_value(s_val) ? duckdb_get_int64(s_val) : 0;
+    if (s_val && !duckdb_is_null_value(s_val) && s == 0) s = -1;
+
+    if (seq_val) duckdb_destroy_value(&seq_val);
+    if (k_val) duckdb_destroy_value(&k_val);
+    if (w_val) duckdb_destroy_value(&w_val);
+    if (s_val) duckdb_destroy_value(&s_val);
+
+    if (null_arg) {
+        duckdb_bind_set_error(info, "seq_minimizers: sequence, k and w must not be NULL");
+        return;
+    }
+    if (!sequence) {
+        duckdb_bind_set_error(info, "seq_minimizers: failed to read sequence");
+        return;
+    }
+    const char *problem = mz_check_params(k, w, s);
+    if (problem) {
+        char err[128];
+        snprintf(err, sizeof(err), "seq_minimizers: %s", problem);
+        duckdb_bind_set_error(info, err);
+        duckdb_free(sequence);
+        return;
+    }
+
+    mz_bind_t *bind = (mz_bind_t *)duckdb_malloc(sizeof(mz_bind_t));
+    if (!bind) {
+        duckdb_bind_set_error(info, "seq_minimizers: out of memory");
+        duckdb_free(sequence);
+        return;
+    }
+    bind->sequence = sequence;
+    bind->params.k = (unsigned)k;
+    bind->params.w = (unsigned)w;
+    bind->params.s = (unsigned)s;
+
+    mz_add_result_columns(info);
+    duckdb_bind_set_bind_data(info, bind, mz_destroy_bind);
+}
+
+static void mz_init(duckdb_init_info info) {
+    mz_bind_t *bind = (mz_bind_t *)duckdb_init_get_bind_data(info);
+    mz_init_t *init = (mz_init_t *)duckdb_malloc(sizeof(mz_init_t));
+    if (!init) {
+        duckdb_init_set_error(info, "seq_minimizers: out of memory");
+        return;
+    }
+    memset(init, 0, sizeof(*init));
+    init->column_count = duckdb_init_get_column_count(info);
+    init->column_ids = (idx_t *)duckdb_malloc(sizeof(idx_t) * (init->column_count ? init->column_count : 1));
+    if (!init->column_ids || mz_collect(bind->sequence, strlen(bind->sequence), &bind->params, &init->hits) < 0) {
+        mz_destroy_init(init);
+        duckdb_init_set_error(info, "seq_minimizers: out of memory");
+        return;
+    }
+    for (idx_t i = 0; i < init->column_count; i++) init->column_ids[i] = duckdb_init_get_column_index(info, i);
+    duckdb_init_set_max_threads(info, 1);
+    duckdb_init_set_init_data(info, init, mz_destroy_init);
+}
+
+static void mz_scan(duckdb_function_info info, duckdb_data_chunk output) {
+    mz_init_t *init = (mz_init_t *)duckdb_function_get_init_data(info);
+    idx_t emit = (idx_t)(init->hits.n - init->next);
+    if (emit > duckdb_vector_size()) emit = duckdb_vector_size();
+
+    duckdb_vector cols[3] = {NULL, NULL, NULL};
+    for (idx_t i = 0; i < init->column_count; i++) {
+        if (init->column_ids[i] < 3) cols[init->column_ids[i]] = duckdb_data_chunk_get_vector(output, i);
+    }
+    mz_write_hits(&init->hits, init->next, emit, cols[0], cols[1], cols[2], 0);
+    init->next += emit;
+    duckdb_data_chunk_set_size(output, emit);
+}
+
+/* ------------------------------------------------------------------------- */
+/* seq_minimizer_list scalar                                                  */
+/* ------------------------------------------------------------------------- */
+
+static void mz_list_scalar(duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output) {
+    idx_t n_rows = duckdb_data_chunk_get_size(input);
+    idx_t n_cols = duckdb_data_chunk_get_column_count(input);
+    duckdb_vector vecs[4] = {duckdb_data_chunk_get_vector(input, 0), duckdb_data_chunk_get_vector(input, 1),
+                             duckdb_data_chunk_get_vector(input, 2),
+                             n_cols > 3 ? duckdb_data_chunk_get_vector(input, 3) : NULL};
+    duckdb_string_t *seqs = (duckdb_string_t *)duckdb_vector_get_data(vecs[0]);
+    const int64_t *ks = (const int64_t *)duckdb_vector_get_data(vecs[1]);
+    const int64_t *ws = (const int64_t *)duckdb_vector_get_data(vecs[2]);
+    const int64_t *ss = n_cols > 3 ? (const int64_t *)duckdb_vector_get_data(vecs[3]) : NULL;
+    duckdb_list_entry *entries = (duckdb_list_entry *)duckdb_vector_get_data(output);
+    duckdb_vector child = duckdb_list_vector_get_child(output);
+    idx_t child_off = duckdb_list_vector_get_size(output);
+    mz_hits_t hits = {NULL, 0, 0};
+    char err[128];
+
+    for (idx_t row = 0; row < n_rows; row++) {
+        entries[row].offset = child_off;
+        entries[row].length = 0;
+        int valid = 1;
+        for (idx_t c = 0; c < n_cols; c++) valid = valid && row_is_valid(vecs[c], row);
+        if (!valid) {
+            duckdb_vector_ensure_validity_writable(output);
+            duckdb_validity_set_row_invalid(duckdb_vector_get_validity(output), row);
+            continue;
+        }
+        int64_t s = ss ? (ss[row] == 0 ? -1 : ss[row]) : 0;
+        const char *problem = mz_check_params(ks[row], ws[row], s);
+        if (problem) {
+            snprintf(err, sizeof(err), "seq_minimizer_list: %s", problem);
+            duckdb_scalar_function_set_error(info, err);
+            break;
+        }
+        mz_params_t params = {(unsigned)ks[row], (unsigned)ws[row], (unsigned)s};
+        hits.n = 0;
+        if (mz_collect(duckdb_string_t_data(&seqs[row]), duckdb_string_t_length(seqs[row]), &params, &hits) < 0 ||
+            duckdb_list_vector_reserve(output, child_off + hits.n) != DuckDBSuccess ||
+            duckdb_list_vector_set_size(output, child_off + hits.n) != DuckDBSuccess) {
+            duckdb_scalar_function_set_error(info, "seq_minimizer_list: out of memory");
+            break;
+        }
+        /* Reserving may move the child buffers; fetch them after growing. */
+        mz_write_hits(&hits, 0, (idx_t)hits.n, duckdb_struct_vector_get_child(child, 0),
+                      duckdb_struct_vector_get_child(child, 1), duckdb_struct_vector_get_child(child, 2), child_off);
+        entries[row].length = hits.n;
+        child_off += hits.n;
+    }
+    free(hits.items);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Registration                                                               */
+/* ------------------------------------------------------------------------- */
+
+static void register_seq_minimizers_function(duckdb_connection connection) {
+    duckdb_table_function tf = duckdb_create_table_function();
+    duckdb_table_function_set_name(tf, "seq_minimizers");
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_table_function_add_parameter(tf, bigint_type);
+    duckdb_table_function_add_parameter(tf, bigint_type);
+    duckdb_table_function_add_named_parameter(tf, "syncmer", bigint_type);
+
+    duckdb_table_function_set_bind(tf, mz_bind);
+    duckdb_table_function_set_init(tf, mz_init);
+    duckdb_table_function_set_function(tf, mz_scan);
+    duckdb_table_function_supports_projection_pushdown(tf, true);
+
+    duckdb_register_table_function(connection, tf);
+
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_table_function(&tf);
+}
+
+static void register_seq_minimizer_list_function(duckdb_connection connection) {
+    duckdb_scalar_function_set set = duckdb_create_scalar_function_set("seq_minimizer_list");
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_logical_type ubigint_type = duckdb_create_logical_type(DUCKDB_TYPE_UBIGINT);
+    duckdb_logical_type members[3] = {bigint_type, ubigint_type, varchar_type};
+    const char *names[3] = {"pos", "hash", "strand"};
+    duckdb_logical_type struct_type = duckdb_create_struct_type(members, names, 3);
+    duckdb_logical_type list_type = duckdb_create_list_type(struct_type);
+
+    for (int with_syncmer = 0; with_syncmer <= 1; with_syncmer++) {
+        duckdb_scalar_function fn = duckdb_create_scalar_function();
+        duckdb_scalar_function_set_name(fn, "seq_minimizer_list");
+        duckdb_scalar_function_add_parameter(fn, varchar_type);
+        duckdb_scalar_function_add_parameter(fn, bigint_type);
+        duckdb_scalar_function_add_parameter(fn, bigint_type);
+        if (with_syncmer) duckdb_scalar_function_add_parameter(fn, bigint_type);
+        duckdb_scalar_function_set_return_type(fn, list_type);
+        duckdb_scalar_function_set_function(fn, mz_list_scalar);
+        duckdb_add_scalar_function_to_set(set, fn);
+        duckdb_destroy_scalar_function(&fn);
+    }
+    duckdb_register_scalar_function_set(connection, set);
+
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_logical_type(&ubigint_type);
+    duckdb_destroy_logical_type(&struct_type);
+    duckdb_destroy_logical_type(&list_type);
+    duckdb_destroy_scalar_function_set(&set);
+}
+
+void register_minimizer_functions(duckdb_connection connection) {
+    register_seq_minimizers_function(connection);
+    register_seq_minimizer_list_function(connection);
+}
@@ -0,0 +1,580 @@
+/**
+ * DuckHTS reference sources: indexed FASTA via faidx, or memory-mapped UCSC
+ * .2bit files shared process-wide. See include/ref_source.h.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <fcntl.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <htslib/faidx.h>
+#include <htslib/hts.h>
+#include <htslib/khash.h>
+
+#include "include/file_cache.h"
+#include "include/file_offset.h"
+#include "include/ref_source.h"
+
+KHASH_MAP_INIT_STR(refname, int)
+
+#define TWOBIT_SIGNATURE 0x1A412743u
+#define TWOBIT_SIGNATURE_SWAPPED 0x4327411Au
+
+/* ================================================================
+ * .2bit files
+ * ================================================================ */
+
+typedef struct {
+    char *name;
+    hts_pos_t len;
+    uint32_t n_blocks;
+    const uint8_t *n_starts;
+    const uint8_t *n_sizes;
+    uint32_t n_masks;
+    const uint8_t *mask_starts;
+    const uint8_t *mask_sizes;
+    const uint8_t *dna;
+} twobit_seq_t;
+
+typedef struct {
+    file_cache_entry_t base;
+    const uint8_t *data;
+    size_t data_len;
+    int swap;
+    int n_seqs;
+    twobit_seq_t *seqs;
+    khash_t(refname) *names;
+} twobit_t;
+
+/* Four decoded bases per packed byte. */
+static char twobit_bases[256][4];
+static volatile int twobit_bases_ready = 0;
+
+static void twobit_init_bases(void) {
+    static const char code[4] = {'T', 'C', 'A', 'G'};
+    for (int b = 0; b < 256; b++) {
+        for (int k = 0; k < 4; k++) twobit_bases[b][k] = code[(b >> (6 - 2 * k)) & 3];
+    }
+    twobit_bases_ready = 1;
+}
+
+static inline uint32_t twobit_u32(const twobit_t *tb, const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    if (tb->swap) v = (v >> 24) | ((v >> 8) & 0xff00u) | ((v << 8) & 0xff0000u) | (v << 24);
+    return v;
+}
+
+static inline uint64_t twobit_u64(const twobit_t *tb, const uint8_t *p) {
+    uint64_t lo = twobit_u32(tb, tb->swap ? p + 4 : p);
+    uint64_t hi = twobit_u32(tb, tb->swap ? p : p + 4);
+    return lo | (hi << 32);
+}
+
+static void twobit_free(file_cache_entry_t *entry) {
+    twobit_t *tb = (twobit_t *)entry;
+    if (!tb) return;
+    if (tb->names) kh_destroy(refname, tb->names);
+    for (int i = 0; i < tb->n_seqs; i++) free(tb->seqs[i].name);
+    free(tb->seqs);
+    if (tb->data) {
+#ifdef _WIN32
+        free((void *)tb->data);
+#else
+        munmap((void *)tb->data, tb->data_len);
+#endif
+    }
+    free(tb->base.path);
+    free(tb);
+}
+
+static file_cache_t twobit_cache = FILE_CACHE_INIT(twobit_free);
+
+static int twobit_map(twobit_t *tb, const char *path, char *err, size_t err_len) {
+#ifdef _WIN32
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        snprintf(err, err_len, "failed to open .2bit file: %s", path);
+        return -1;
+    }
+    /* 64-bit offsets: long is 32 bits on Windows and genome .2bit files
+     * pass 2 GB */
+    int64_t n = -1;
+    if (file_seek64(fp, 0, SEEK_END) == 0) n = file_tell64(fp);
+    if (n > 0 && (uint64_t)n > SIZE_MAX) n = -1;
+    if (n > 0 && file_seek64(fp, 0, SEEK_SET) != 0) n = -1;
+    uint8_t *buf = n > 0 ? (uint8_t *)malloc((size_t)n) : NULL;
+    if (!buf || fread(buf, 1, (size_t)n, fp) != (size_t)n) {
+        free(buf);
+        fclose(fp);
+        snprintf(err, err_len, "failed to read .2bit file: %s", path);
+        return -1;
+    }
+    fclose(fp);
+    tb->data = buf;
+    tb->data_len = (size_t)n;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        snprintf(err, err_len, "failed to open .2bit file: %s", path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        snprintf(err, err_len, "failed to read .2bit file: %s", path);
+        return -1;
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        snprintf(err, err_len, "failed to map .2bit file: %s", path);
+        return -1;
+    }
+    tb->data = (const uint8_t *)p;
+    tb->data_len = (size_t)st.st_size;
+#endif
+    return 0;
+}
+
+/* Parse the header, index and per-sequence block tables. Block arrays and
+ * packed bases stay in the mapping. */
+static int twobit_parse(twobit_t *tb, char *err, size_t err_len) {
+    const uint8_t *d = tb->data;
+    size_t n = tb->data_len;
+    if (n < 16) goto truncated;
+    uint32_t sig;
+    memcpy(&sig, d, 4);
+    if (sig == TWOBIT_SIGNATURE) tb->swap = 0;
+    else if (sig == TWOBIT_SIGNATURE_SWAPPED) tb->swap = 1;
+    else {
+        snprintf(err, err_len, "not a .2bit file: %s", tb->base.path);
+        return -1;
+    }
+    uint32_t version = twobit_u32(tb, d + 4);
+    if (version > 1) {
+        snprintf(err, err_len, "unsupported .2bit version %u: %s", version, tb->base.path);
+        return -1;
+    }
+    tb->n_seqs = (int)twobit_u32(tb, d + 8);
+    tb->seqs = (twobit_seq_t *)calloc((size_t)(tb->n_seqs > 0 ? tb->n_seqs : 1), sizeof(twobit_seq_t));
+    tb->names = kh_init(refname);
+
+    size_t off = 16;
+    size_t off_width = version == 1 ? 8 : 4;
+    for (int i = 0; i < tb->n_seqs; i++) {
+        if (off + 1 > n) goto truncated;
+        size_t name_len = d[off++];
+        if (off + name_len + off_width > n) goto truncated;
+        twobit_seq_t *seq = &tb->seqs[i];
+        seq->name = (char *)malloc(name_len + 1);
+        memcpy(seq->name, d + off, name_len);
+        seq->name[name_len] = '\0';
+        off += name_len;
+        uint64_t rec = off_width == 8 ? twobit_u64(tb, d + off) : twobit_u32(tb, d + off);
+        off += off_width;
+
+        if (rec + 8 > n) goto truncated;
+        seq->len = twobit_u32(tb, d + rec);
+        seq->n_blocks = twobit_u32(tb, d + rec + 4);
+        rec += 8;
+        if (rec + (uint64_t)seq->n_blocks * 8 + 4 > n) goto truncated;
+        seq->n_starts = d + rec;
+        seq->n_sizes = d + rec + (size_t)seq->n_blocks * 4;
+        rec += (uint64_t)seq->n_blocks * 8;
+        seq->n_masks = twobit_u32(tb, d + rec);
+        rec += 4;
+        if (rec + (uint64_t)seq->n_masks * 8 + 4 + ((uint64_t)seq->len + 3) / 4 > n) goto truncated;
+        seq->mask_starts = d + rec;
+        seq->mask_sizes = d + rec + (size_t)seq->n_masks * 4;
+        rec += (uint64_t)seq->n_masks * 8 + 4;
+        seq->dna = d + rec;
+
+        int absent;
+        khint_t k = kh_put(refname, tb->names, seq->name, &absent);
+        if (absent) kh_value(tb->names, k) = i;
+    }
+    return 0;
+
+truncated:
+    snprintf(err, err_len, "truncated .2bit file: %s", tb->base.path);
+    return -1;
+}
+
+static file_cache_entry_t *twobit_load(const char *path, void *arg, char *err, size_t err_len) {
+    (void)arg;
+    twobit_t *tb = (twobit_t *)calloc(1, sizeof(twobit_t));
+    tb->base.path = strdup(path);
+    if (twobit_map(tb, path, err, err_len) != 0 || twobit_parse(tb, err, err_len) != 0) {
+        twobit_free(&tb->base);
+        return NULL;
+    }
+    return &tb->base;
+}
+
+/* Take a reference to the shared mapping of path, (re)loading it when the
+ * file is new or its mtime/size changed. */
+static twobit_t *twobit_acquire(const char *path, char *err, size_t err_len) {
+    file_cache_spin_lock(&twobit_cache.lock);
+    if (!twobit_bases_ready) twobit_init_bases();
+    file_cache_spin_unlock(&twobit_cache.lock);
+    return (twobit_t *)file_cache_acquire(&twobit_cache, path, twobit_load, NULL, err, err_len);
+}
+
+static void twobit_release(twobit_t *tb) {
+    if (tb) file_cache_release(&twobit_cache, &tb->base);
+}
+
+/* First block whose end lies past pos, blocks being sorted by start. */
+static uint32_t twobit_first_block(const twobit_t *tb, const uint8_t *starts, const uint8_t *sizes, uint32_t n,
+                                   hts_pos_t pos) {
+    uint32_t lo = 0, hi = n;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if ((hts_pos_t)twobit_u32(tb, starts + (size_t)mid * 4) <= pos) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo > 0) {
+        uint32_t prev = lo - 1;
+        hts_pos_t end = (hts_pos_t)twobit_u32(tb, starts + (size_t)prev * 4) + twobit_u32(tb, sizes + (size_t)prev * 4);
+        if (end > pos) return prev;
+    }
+    return lo;
+}
+
+static void twobit_decode(const twobit_t *tb, int id, hts_pos_t beg, hts_pos_t end, char *out) {
+    const twobit_seq_t *seq = &tb->seqs[id];
+    const uint8_t *dna = seq->dna;
+    char *o = out;
+    hts_pos_t i = beg;
+    for (; i < end && (i & 3); i++) *o++ = twobit_bases[dna[i >> 2]][i & 3];
+    for (; i + 4 <= end; i += 4, o += 4) memcpy(o, twobit_bases[dna[i >> 2]], 4);
+    for (; i < end; i++) *o++ = twobit_bases[dna[i >> 2]][i & 3];
+
+    for (uint32_t k = twobit_first_block(tb, seq->n_starts, seq->n_sizes, seq->n_blocks, beg);
+         k < seq->n_blocks; k++) {
+        hts_pos_t s = twobit_u32(tb, seq->n_starts + (size_t)k * 4);
+        if (s >= end) break;
+        hts_pos_t e = s + twobit_u32(tb, seq->n_sizes + (size_t)k * 4);
+        if (s < beg) s = beg;
+        if (e > end) e = end;
+        if (e > s) memset(out + (s - beg), 'N', (size_t)(e - s));
+    }
+    for (uint32_t k = twobit_first_block(tb, seq->mask_starts, seq->mask_sizes, seq->n_masks, beg);
+         k < seq->n_masks; k++) {
+        hts_pos_t s = twobit_u32(tb, seq->mask_starts + (size_t)k * 4);
+        if (s >= end) break;
+        hts_pos_t e = s + twobit_u32(tb, seq->mask_sizes + (size_t)k * 4);
+        if (s < beg) s = beg;
+        if (e > end) e = end;
+        for (hts_pos_t j = s; j < e; j++) out[j - beg] |= 0x20;
+    }
+}
+
+/* ================================================================
+ * Reference sources
+ * ================================================================ */
+
+struct ref_source_s {
+    faidx_t *fai;
+    twobit_t *tb;
+    khash_t(refname) *fai_names;    /* name -> id for faidx sources */
+};
+
+int ref_source_is_2bit(const char *path) {
+    size_t len = path ? strlen(path) : 0;
+    return len > 5 && strcmp(path + len - 5, ".2bit") == 0;
+}
+
+ref_source_t *ref_source_open(const char *path, const char *index_path, char *err, size_t err_len) {
+    ref_source_t *ref = (ref_source_t *)calloc(1, sizeof(ref_source_t));
+    if (!ref) {
+        snprintf(err, err_len, "out of memory");
+        return NULL;
+    }
+    if (ref_source_is_2bit(path)) {
+        ref->tb = twobit_acquire(path, err, err_len);
+        if (!ref->tb) {
+            free(ref);
+            return NULL;
+        }
+        return ref;
+    }
+    ref->fai = fai_load3_format(path, index_path, NULL, 0, FAI_FASTA);
+    if (!ref->fai) {
+        snprintf(err, err_len, "failed to open FASTA index for %s", path);
+        free(ref);
+        return NULL;
+    }
+    ref->fai_names = kh_init(refname);
+    int n = faidx_nseq(ref->fai);
+    for (int i = 0; i < n; i++) {
+        int absent;
+        khint_t k = kh_put(refname, ref->fai_names, faidx_iseq(ref->fai, i), &absent);
+        if (absent) kh_value(ref->fai_names, k) = i;
+    }
+    return ref;
+}
+
+void ref_source_close(ref_source_t *ref) {
+    if (!ref) return;
+    if (ref->fai_names) kh_destroy(refname, ref->fai_names);
+    if (ref->fai) fai_destroy(ref->fai);
+    twobit_release(ref->tb);
+    free(ref);
+}
+
+int ref_source_nseq(const ref_source_t *ref) {
+    return ref->tb ? ref->tb->n_seqs : faidx_nseq(ref->fai);
+}
+
+const char *ref_source_iseq(const ref_source_t *ref, int id) {
+    return ref->tb ? ref->tb->seqs[id].name : faidx_iseq(ref->fai, id);
+}
+
+int ref_source_name2id(const ref_source_t *ref, const char *name) {
+    khash_t(refname) *names = ref->tb ? ref->tb->names : ref->fai_names;
+    khint_t k = kh_get(refname, names, name);
+    return k == kh_end(names) ? -1 : kh_value(names, k);
+}
+
+hts_pos_t ref_source_seq_len(const ref_source_t *ref, int id) {
+    return ref->tb ? ref->tb->seqs[id].len : faidx_seq_len64(ref->fai, faidx_iseq(ref->fai, id));
+}
+
+int ref_source_parse_region(const ref_source_t *ref, const char *region, int *id, hts_pos_t *beg, hts_pos_t *end) {
+    if (ref->fai) {
+        const char *rest = fai_parse_region(ref->fai, region, id, beg, end, 0);
+        if (!rest || *rest != '\0') return -1;
+        return fai_adjust_region(ref->fai, *id, beg, end) < 0 ? -1 : 0;
+    }
+    /* Whole names win over chr:beg-end parses, as in fai_parse_region. */
+    *id = ref_source_name2id(ref, region);
+    if (*id >= 0) {
+        *beg = 0;
+        *end = ref_source_seq_len(ref, *id);
+        return 0;
+    }
+    const char *colon = strrchr(region, ':');
+    if (!colon) return -1;
+    size_t name_len = (size_t)(colon - region);
+    char *name = (char *)malloc(name_len + 1);
+    if (!name) return -1;
+    memcpy(name, region, name_len);
+    name[name_len] = '\0';
+    *id = ref_source_name2id(ref, name);
+    free(name);
+    if (*id < 0) return -1;
+    hts_pos_t b = 0, e = HTS_POS_MAX;
+    if (!hts_parse_reg64(region, &b, &e)) return -1;
+    hts_pos_t len = ref_source_seq_len(ref, *id);
+    *beg = b < 0 ? 0 : b > len ? len : b;
+    *end = e > len ? len : e;
+    if (*end < *beg) *end = *beg;
+    return 0;
+}
+
+char *ref_source_fetch(ref_source_t *ref, int id, hts_pos_t beg, hts_pos_t end, hts_pos_t *len) {
+    hts_pos_t seq_len = ref_source_seq_len(ref, id);
+    if (beg < 0) beg = 0;
+    if (end > seq_len) end = seq_len;
+    if (end < beg) end = beg;
+    if (ref->tb) {
+        char *out = (char *)malloc((size_t)(end - beg) + 1);
+        if (!out) return NULL;
+        twobit_decode(ref->tb, id, beg, end, out);
+        out[end - beg] = '\0';
+        *len = end - beg;
+        return out;
+    }
+    if (end == beg) {
+        *len = 0;
+        return (char *)calloc(1, 1);
+    }
+    return faidx_fetch_seq64(ref->fai, faidx_iseq(ref->fai, id), beg, end - 1, len);
+}
+
+int ref_source_fetch_into(const ref_source_t *ref, int id, hts_pos_t beg, hts_pos_t end, char *out) {
+    if (!ref->tb) return -1;
+    twobit_decode(ref->tb, id, beg, end, out);
+    return 0;
+}
+
+/* ================================================================
+ * FASTA -> .2bit
+ * ================================================================ */
+
+/* Base codes for packing; anything but ACGT is stored as T under an N block. */
+static uint8_t twobit_pack_code(char c) {
+    switch (c) {
+        case 'C': case 'c': return 1;
+        case 'A': case 'a': return 2;
+        case 'G': case 'g': return 3;
+        default: return 0;
+    }
+}
+
+static int is_acgt(char c) {
+    switch (c) {
+        case 'A': case 'C': case 'G': case 'T':
+        case 'a': case 'c': case 'g': case 't':
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static int write_u32(FILE *fp, uint32_t v) {
+    return fwrite(&v, 4, 1, fp) == 1 ? 0 : -1;
+}
+
+/* Collect runs where pred holds as (start, size) pairs into starts/sizes. */
+static uint32_t collect_runs(const char *seq, hts_pos_t len, int want_n, uint32_t **starts, uint32_t **sizes) {
+    uint32_t n = 0, m = 0;
+    *starts = NULL;
+    *sizes = NULL;
+    hts_pos_t i = 0;
+    while (i < len) {
+        int hit = want_n ? !is_acgt(seq[i]) : (seq[i] >= 'a' && seq[i] <= 'z');
+        if (!hit) {
+            i++;
+            continue;
+        }
+        hts_pos_t j = i + 1;
+        while (j < len && (want_n ? !is_acgt(seq[j]) : (seq[j] >= 'a' && seq[j] <= 'z'))) j++;
+        if (n == m) {
+            m = m ? m * 2 : 64;
+            *starts = (uint32_t *)realloc(*starts, sizeof(uint32_t) * m);
+            *sizes = (uint32_t *)realloc(*sizes, sizeof(uint32_t) * m);
+        }
+        (*starts)[n] = (uint32_t)i;
+        (*sizes)[n] = (uint32_t)(j - i);
+        n++;
+        i = j;
+    }
+    return n;
+}
+
+static int write_twobit_record(FILE *fp, const char *seq, hts_pos_t len) {
+    uint32_t *n_starts, *n_sizes, *m_starts, *m_sizes;
+    uint32_t n_blocks = collect_runs(seq, len, 1, &n_starts, &n_sizes);
+    uint32_t n_masks = collect_runs(seq, len, 0, &m_starts, &m_sizes);
+    int ret = write_u32(fp, (uint32_t)len) | write_u32(fp, n_blocks);
+    if (n_blocks) {
+        ret |= fwrite(n_starts, 4, n_blocks, fp) == n_blocks ? 0 : -1;
+        ret |= fwrite(n_sizes, 4, n_blocks, fp) == n_blocks ? 0 : -1;
+    }
+    ret |= write_u32(fp, n_masks);
+    if (n_masks) {
+        ret |= fwrite(m_starts, 4, n_masks, fp) == n_masks ? 0 : -1;
+        ret |= fwrite(m_sizes, 4, n_masks, fp) == n_masks ? 0 : -1;
+    }
+    ret |= write_u32(fp, 0);
+    free(n_starts);
+    free(n_sizes);
+    free(m_starts);
+    free(m_sizes);
+
+    size_t packed_len = (size_t)((len + 3) / 4);
+    uint8_t *packed = (uint8_t *)malloc(packed_len > 0 ? packed_len : 1);
+    if (!packed) return -1;
+    for (size_t b = 0; b < packed_len; b++) {
+        uint8_t v = 0;
+        for (int k = 0; k < 4; k++) {
+            hts_pos_t i = (hts_pos_t)b * 4 + k;
+            v = (uint8_t)(v << 2) | (i < len ? twobit_pack_code(seq[i]) : 0);
+        }
+        packed[b] = v;
+    }
+    ret |= fwrite(packed, 1, packed_len, fp) == packed_len ? 0 : -1;
+    free(packed);
+    return ret;
+}
+
+int twobit_write_from_fasta(const char *fasta_path, const char *index_path, const char *out_path,
+                            int64_t *n_seqs, int64_t *n_bases, char *err, size_t err_len) {
+    faidx_t *fai = fai_load3_format(fasta_path, index_path, NULL, 0, FAI_FASTA);
+    if (!fai) {
+        snprintf(err, err_len, "requires a FASTA index (.fai); run fasta_index(path) first");
+        return -1;
+    }
+    int n = faidx_nseq(fai);
+    uint64_t total = 0, index_len = 0;
+    for (int i = 0; i < n; i++) {
+        const char *name = faidx_iseq(fai, i);
+        hts_pos_t len = faidx_seq_len64(fai, name);
+        if (strlen(name) > 255 || len < 0 || len > (hts_pos_t)UINT32_MAX) {
+            snprintf(err, err_len, "sequence %s cannot be stored in .2bit (name over 255 bytes or length over 4 Gb)",
+                     name);
+            fai_destroy(fai);
+            return -1;
+        }
+        total += (uint64_t)len;
+        index_len += 1 + strlen(name);
+    }
+    /* Offsets are 32-bit unless the packed bases alone could overflow them. */
+    uint32_t version = total / 4 > (uint64_t)INT32_MAX ? 1 : 0;
+    size_t off_width = version == 1 ? 8 : 4;
+    index_len += (uint64_t)n * off_width;
+
+    FILE *fp = fopen(out_path, "wb");
+    if (!fp) {
+        snprintf(err, err_len, "failed to open output file: %s", out_path);
+        fai_destroy(fai);
+        return -1;
+    }
+    int ret = write_u32(fp, TWOBIT_SIGNATURE) | write_u32(fp, version) | write_u32(fp, (uint32_t)n) | write_u32(fp, 0);
+    uint64_t *offsets = (uint64_t *)calloc((size_t)(n > 0 ? n : 1), sizeof(uint64_t));
+    /* Placeholder index, rewritten once the record offsets are known. */
+    if (file_seek64(fp, (int64_t)(16 + index_len), SEEK_SET) != 0) ret = -1;
+
+    for (int i = 0; i < n && ret == 0; i++) {
+        const char *name = faidx_iseq(fai, i);
+        hts_pos_t len = 0;
+        char *seq = faidx_fetch_seq64(fai, name, 0, faidx_seq_len64(fai, name) - 1, &len);
+        if (!seq && faidx_seq_len64(fai, name) > 0) {
+            snprintf(err, err_len, "failed to read sequence %s", name);
+            ret = -1;
+            break;
+        }
+        offsets[i] = (uint64_t)file_tell64(fp);
+        if (version == 0 && offsets[i] > UINT32_MAX) {
+            snprintf(err, err_len, "output exceeds 4 GB with 32-bit .2bit offsets");
+            free(seq);
+            ret = -1;
+            break;
+        }
+        if (write_twobit_record(fp, seq ? seq : "", seq ? len : 0) != 0) ret = -1;
+        *n_bases += seq ? len : 0;
+        free(seq);
+    }
+
+    if (ret == 0 && file_seek64(fp, 16, SEEK_SET) != 0) ret = -1;
+    for (int i = 0; i < n && ret == 0; i++) {
+        const char *name = faidx_iseq(fai, i);
+        uint8_t name_len = (uint8_t)strlen(name);
+        ret |= fwrite(&name_len, 1, 1, fp) == 1 ? 0 : -1;
+        ret |= fwrite(name, 1, name_len, fp) == name_len ? 0 : -1;
+        if (version == 1) ret |= fwrite(&offsets[i], 8, 1, fp) == 1 ? 0 : -1;
+        else ret |= write_u32(fp, (uint32_t)offsets[i]);
+    }
+    free(offsets);
+    if (fclose(fp) != 0) ret = -1;
+    fai_destroy(fai);
+    if (ret != 0) {
+        if (!err[0]) snprintf(err, err_len, "failed to write %s", out_path);
+        remove(out_path);
+        return -1;
+    }
+    *n_seqs = n;
+    return 0;
+}
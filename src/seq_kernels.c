@@ -0,0 +1,510 @@
+/**
+ * Vectorised nucleotide kernels for seq_revcomp, seq_canonical,
+ * seq_gc_content and fasta_nuc. See include/seq_kernels.h.
+ *
+ * The SIMD paths rely on the low nibble of A/C/G/T/N being 1/3/7/4/14 in
+ * both cases, so one byte shuffle indexed by (c & 0x0F) yields either the
+ * expected upper-case base (for validation against c & 0xDF) or its
+ * complement. Invalid slots hold 0xFF, which c & 0xDF can never equal.
+ */
+
+#include "include/seq_kernels.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SEQK_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define SEQK_NEON 1
+#include <arm_neon.h>
+#endif
+
+#define X 0xFF
+static const uint8_t SEQK_UPPER[256] = {
+    ['A'] = 'A', ['C'] = 'C', ['G'] = 'G', ['T'] = 'T', ['N'] = 'N',
+    ['a'] = 'A', ['c'] = 'C', ['g'] = 'G', ['t'] = 'T', ['n'] = 'N',
+};
+static const uint8_t SEQK_COMP[256] = {
+    ['A'] = 'T', ['C'] = 'G', ['G'] = 'C', ['T'] = 'A', ['N'] = 'N',
+    ['a'] = 'T', ['c'] = 'G', ['g'] = 'C', ['t'] = 'A', ['n'] = 'N',
+};
+/* 4 = valid, | 1 for G/C, | 2 for N. */
+static const uint8_t SEQK_GC_CLASS[256] = {
+    ['A'] = 4, ['C'] = 5, ['G'] = 5, ['T'] = 4, ['N'] = 6,
+    ['a'] = 4, ['c'] = 5, ['g'] = 5, ['t'] = 4, ['n'] = 6,
+};
+static const uint8_t SEQK_BASE_CLASS[256] = {
+    ['A'] = SEQ_BASE_A, ['C'] = SEQ_BASE_C, ['G'] = SEQ_BASE_G, ['T'] = SEQ_BASE_T, ['N'] = SEQ_BASE_N,
+    ['a'] = SEQ_BASE_A, ['c'] = SEQ_BASE_C, ['g'] = SEQ_BASE_G, ['t'] = SEQ_BASE_T, ['n'] = SEQ_BASE_N,
+};
+const uint8_t SEQ_2BIT_CODE[256] = {
+#define F4 4, 4, 4, 4
+#define F16 F4, F4, F4, F4
+    F16, F16, F16, F16,
+    4, 0, 4, 1, 4, 4, 4, 2, 4, 4, 4, 4, 4, 4, 4, 4, /* 0x40 */
+    4, 4, 4, 4, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, /* 0x50 */
+    4, 0, 4, 1, 4, 4, 4, 2, 4, 4, 4, 4, 4, 4, 4, 4, /* 0x60 */
+    4, 4, 4, 4, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, /* 0x70 */
+    F16, F16, F16, F16, F16, F16, F16, F16,
+#undef F16
+#undef F4
+};
+/* Indexed by low nibble: A=1, C=3, T=4, G=7, N=14. */
+static const uint8_t SEQK_NIBBLE_BASE[16] = {X, 'A', X, 'C', 'T', X, X, 'G', X, X, X, X, X, X, 'N', X};
+static const uint8_t SEQK_NIBBLE_COMP[16] = {X, 'T', X, 'G', 'A', X, X, 'C', X, X, X, X, X, X, 'N', X};
+#undef X
+
+typedef struct {
+    const char *name;
+    int (*revcomp)(const char *seq, size_t len, char *out);
+    int (*upper)(const char *seq, size_t len, char *out);
+    /* First i < (len + 1) / 2 with upper(seq[i]) != comp(seq[len - 1 - i]),
+     * or (len + 1) / 2 when the strands agree. Bytes are not validated. */
+    size_t (*mismatch)(const char *seq, size_t len);
+    int (*gc_count)(const char *seq, size_t len, size_t *gc, size_t *n);
+    /* Adds A/C/G/T/N counts; callers derive SEQ_BASE_OTHER from len. */
+    void (*base_count)(const char *seq, size_t len, size_t counts[SEQ_BASE_COUNT]);
+} seq_kernel_impl_t;
+
+/* ------------------------------------------------------------------------- */
+/* Scalar                                                                     */
+/* ------------------------------------------------------------------------- */
+
+static int revcomp_tail(const char *seq, size_t len, char *out, size_t from) {
+    for (size_t i = from; i < len; i++) {
+        uint8_t c = SEQK_COMP[(uint8_t)seq[len - 1 - i]];
+        if (!c) return -1;
+        out[i] = (char)c;
+    }
+    return 0;
+}
+
+static int upper_tail(const char *seq, size_t len, char *out, size_t from) {
+    for (size_t i = from; i < len; i++) {
+        uint8_t c = SEQK_UPPER[(uint8_t)seq[i]];
+        if (!c) return -1;
+        out[i] = (char)c;
+    }
+    return 0;
+}
+
+static size_t mismatch_tail(const char *seq, size_t len, size_t from) {
+    size_t half = (len + 1) / 2;
+    for (size_t i = from; i < half; i++) {
+        if (SEQK_UPPER[(uint8_t)seq[i]] != SEQK_COMP[(uint8_t)seq[len - 1 - i]]) return i;
+    }
+    return half;
+}
+
+static int gc_tail(const char *seq, size_t len, size_t from, size_t *gc, size_t *n) {
+    size_t n_gc = *gc, n_n = *n;
+    for (size_t i = from; i < len; i++) {
+        uint8_t cls = SEQK_GC_CLASS[(uint8_t)seq[i]];
+        if (!cls) return -1;
+        n_gc += cls & 1;
+        n_n += (cls >> 1) & 1;
+    }
+    *gc = n_gc;
+    *n = n_n;
+    return 0;
+}
+
+/* Four counter lanes keep consecutive bytes from serialising on the same
+ * counter. */
+static void base_tail(const char *seq, size_t len, size_t from, size_t counts[SEQ_BASE_COUNT]) {
+    size_t lane[4][SEQ_BASE_COUNT];
+    memset(lane, 0, sizeof(lane));
+    const uint8_t *s = (const uint8_t *)seq;
+    size_t i = from;
+    for (; i + 4 <= len; i += 4) {
+        lane[0][SEQK_BASE_CLASS[s[i]]]++;
+        lane[1][SEQK_BASE_CLASS[s[i + 1]]]++;
+        lane[2][SEQK_BASE_CLASS[s[i + 2]]]++;
+        lane[3][SEQK_BASE_CLASS[s[i + 3]]]++;
+    }
+    for (; i < len; i++) lane[0][SEQK_BASE_CLASS[s[i]]]++;
+    for (int b = SEQ_BASE_A; b < SEQ_BASE_COUNT; b++) counts[b] += lane[0][b] + lane[1][b] + lane[2][b] + lane[3][b];
+}
+
+static int revcomp_scalar(const char *seq, size_t len, char *out) { return revcomp_tail(seq, len, out, 0); }
+static int upper_scalar(const char *seq, size_t len, char *out) { return upper_tail(seq, len, out, 0); }
+static size_t mismatch_scalar(const char *seq, size_t len) { return mismatch_tail(seq, len, 0); }
+static int gc_scalar(const char *seq, size_t len, size_t *gc, size_t *n) {
+    *gc = *n = 0;
+    return gc_tail(seq, len, 0, gc, n);
+}
+static void base_scalar(const char *seq, size_t len, size_t counts[SEQ_BASE_COUNT]) { base_tail(seq, len, 0, counts); }
+
+/* ------------------------------------------------------------------------- */
+/* x86: SSE4.2 (16 bytes) and AVX2 (32 bytes)                                */
+/* ------------------------------------------------------------------------- */
+
+#ifdef SEQK_X86
+
+#define SSE_TARGET __attribute__((target("sse4.2,popcnt")))
+#define AVX_TARGET __attribute__((target("avx2,popcnt")))
+
+SSE_TARGET static inline __m128i sse_lut(const uint8_t *t) { return _mm_loadu_si128((const __m128i *)t); }
+
+SSE_TARGET static inline __m128i sse_reverse(__m128i v) {
+    return _mm_shuffle_epi8(v, _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+SSE_TARGET static int revcomp_sse_from(const char *seq, size_t len, char *out, size_t i) {
+    const __m128i base = sse_lut(SEQK_NIBBLE_BASE), comp = sse_lut(SEQK_NIBBLE_COMP);
+    const __m128i lo = _mm_set1_epi8(0x0F), up = _mm_set1_epi8((char)0xDF);
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(seq + len - 16 - i));
+        __m128i idx = _mm_and_si128(v, lo);
+        __m128i ok = _mm_cmpeq_epi8(_mm_shuffle_epi8(base, idx), _mm_and_si128(v, up));
+        if (_mm_movemask_epi8(ok) != 0xFFFF) return -1;
+        _mm_storeu_si128((__m128i *)(out + i), sse_reverse(_mm_shuffle_epi8(comp, idx)));
+    }
+    return revcomp_tail(seq, len, out, i);
+}
+
+SSE_TARGET static int upper_sse_from(const char *seq, size_t len, char *out, size_t i) {
+    const __m128i base = sse_lut(SEQK_NIBBLE_BASE);
+    const __m128i lo = _mm_set1_epi8(0x0F), up = _mm_set1_epi8((char)0xDF);
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(seq + i));
+        __m128i u = _mm_and_si128(v, up);
+        __m128i ok = _mm_cmpeq_epi8(_mm_shuffle_epi8(base, _mm_and_si128(v, lo)), u);
+        if (_mm_movemask_epi8(ok) != 0xFFFF) return -1;
+        _mm_storeu_si128((__m128i *)(out + i), u);
+    }
+    return upper_tail(seq, len, out, i);
+}
+
+SSE_TARGET static size_t mismatch_sse_from(const char *seq, size_t len, size_t i) {
+    const __m128i comp = sse_lut(SEQK_NIBBLE_COMP);
+    const __m128i lo = _mm_set1_epi8(0x0F), up = _mm_set1_epi8((char)0xDF);
+    size_t half = (len + 1) / 2;
+    for (; i + 16 <= half; i += 16) {
+        __m128i f = _mm_and_si128(_mm_loadu_si128((const __m128i *)(seq + i)), up);
+        __m128i b = _mm_loadu_si128((const __m128i *)(seq + len - 16 - i));
+        __m128i r = sse_reverse(_mm_shuffle_epi8(comp, _mm_and_si128(b, lo)));
+        unsigned diff = ~(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(f, r)) & 0xFFFFu;
+        if (diff) return i + (size_t)__builtin_ctz(diff);
+    }
+    return mismatch_tail(seq, len, i);
+}
+
+SSE_TARGET static int gc_sse_from(const char *seq, size_t len, size_t i, size_t *gc, size_t *n) {
+    const __m128i base = sse_lut(SEQK_NIBBLE_BASE);
+    const __m128i lo = _mm_set1_epi8(0x0F), up = _mm_set1_epi8((char)0xDF);
+    const __m128i vg = _mm_set1_epi8('G'), vc = _mm_set1_epi8('C'), vn = _mm_set1_epi8('N');
+    size_t n_gc = *gc, n_n = *n;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(seq + i));
+        __m128i u = _mm_and_si128(v, up);
+        __m128i ok = _mm_cmpeq_epi8(_mm_shuffle_epi8(base, _mm_and_si128(v, lo)), u);
+        if (_mm_movemask_epi8(ok) != 0xFFFF) return -1;
+        __m128i is_gc = _mm_or_si128(_mm_cmpeq_epi8(u, vg), _mm_cmpeq_epi8(u, vc));
+        n_gc += (size_t)_mm_popcnt_u32((unsigned)_mm_movemask_epi8(is_gc));
+        n_n += (size_t)_mm_popcnt_u32((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(u, vn)));
+    }
+    *gc = n_gc;
+    *n = n_n;
+    return gc_tail(seq, len, i, gc, n);
+}
+
+/* Only the two cases of a letter survive & 0xDF as that letter, so one
+ * compare per base counts both. */
+SSE_TARGET static void base_sse_from(const char *seq, size_t len, size_t i, size_t counts[SEQ_BASE_COUNT]) {
+    const __m128i up = _mm_set1_epi8((char)0xDF);
+    const __m128i va = _mm_set1_epi8('A'), vc = _mm_set1_epi8('C'), vg = _mm_set1_epi8('G');
+    const __m128i vt = _mm_set1_epi8('T'), vn = _mm_set1_epi8('N');
+    size_t n_a = 0, n_c = 0, n_g = 0, n_t = 0, n_n = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i u = _mm_and_si128(_mm_loadu_si128((const __m128i *)(seq + i)), up);
+        n_a += (size_t)_mm_popcnt_u32((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(u, va)));
+        n_c += (size_t)_mm_popcnt_u32((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(u, vc)));
+        n_g += (size_t)_mm_popcnt_u32((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(u, vg)));
+        n_t += (size_t)_mm_popcnt_u32((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(u, vt)));
+        n_n += (size_t)_mm_popcnt_u32((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(u, vn)));
+    }
+    counts[SEQ_BASE_A] += n_a;
+    counts[SEQ_BASE_C] += n_c;
+    counts[SEQ_BASE_G] += n_g;
+    counts[SEQ_BASE_T] += n_t;
+    counts[SEQ_BASE_N] += n_n;
+    base_tail(seq, len, i, counts);
+}
+
+SSE_TARGET static int revcomp_sse(const char *seq, size_t len, char *out) { return revcomp_sse_from(seq, len, out, 0); }
+SSE_TARGET static int upper_sse(const char *seq, size_t len, char *out) { return upper_sse_from(seq, len, out, 0); }
+SSE_TARGET static size_t mismatch_sse(const char *seq, size_t len) { return mismatch_sse_from(seq, len, 0); }
+SSE_TARGET static int gc_sse(const char *seq, size_t len, size_t *gc, size_t *n) {
+    *gc = *n = 0;
+    return gc_sse_from(seq, len, 0, gc, n);
+}
+SSE_TARGET static void base_sse(const char *seq, size_t len, size_t counts[SEQ_BASE_COUNT]) {
+    base_sse_from(seq, len, 0, counts);
+}
+
+/* The AVX2 loops hand their remainder to the SSE loops, which leave at most
+ * 15 bytes for the scalar tail. Clear the upper lanes first: mixing 256-bit
+ * state with legacy SSE encodings stalls on every transition. */
+
+AVX_TARGET static inline __m256i avx_lut(const uint8_t *t) {
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)t));
+}
+
+AVX_TARGET static inline __m256i avx_reverse(__m256i v) {
+    const __m256i rev = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                         15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    v = _mm256_shuffle_epi8(v, rev);
+    return _mm256_permute2x128_si256(v, v, 0x01);
+}
+
+AVX_TARGET static int revcomp_avx2(const char *seq, size_t len, char *out) {
+    const __m256i base = avx_lut(SEQK_NIBBLE_BASE), comp = avx_lut(SEQK_NIBBLE_COMP);
+    const __m256i lo = _mm256_set1_epi8(0x0F), up = _mm256_set1_epi8((char)0xDF);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(seq + len - 32 - i));
+        __m256i idx = _mm256_and_si256(v, lo);
+        __m256i ok = _mm256_cmpeq_epi8(_mm256_shuffle_epi8(base, idx), _mm256_and_si256(v, up));
+        if ((uint32_t)_mm256_movemask_epi8(ok) != 0xFFFFFFFFu) return -1;
+        _mm256_storeu_si256((__m256i *)(out + i), avx_reverse(_mm256_shuffle_epi8(comp, idx)));
+    }
+    _mm256_zeroupper();
+    return revcomp_sse_from(seq, len, out, i);
+}
+
+AVX_TARGET static int upper_avx2(const char *seq, size_t len, char *out) {
+    const __m256i base = avx_lut(SEQK_NIBBLE_BASE);
+    const __m256i lo = _mm256_set1_epi8(0x0F), up = _mm256_set1_epi8((char)0xDF);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(seq + i));
+        __m256i u = _mm256_and_si256(v, up);
+        __m256i ok = _mm256_cmpeq_epi8(_mm256_shuffle_epi8(base, _mm256_and_si256(v, lo)), u);
+        if ((uint32_t)_mm256_movemask_epi8(ok) != 0xFFFFFFFFu) return -1;
+        _mm256_storeu_si256((__m256i *)(out + i), u);
+    }
+    _mm256_zeroupper();
+    return upper_sse_from(seq, len, out, i);
+}
+
+AVX_TARGET static size_t mismatch_avx2(const char *seq, size_t len) {
+    const __m256i comp = avx_lut(SEQK_NIBBLE_COMP);
+    const __m256i lo = _mm256_set1_epi8(0x0F), up = _mm256_set1_epi8((char)0xDF);
+    size_t half = (len + 1) / 2, i = 0;
+    for (; i + 32 <= half; i += 32) {
+        __m256i f = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(seq + i)), up);
+        __m256i b = _mm256_loadu_si256((const __m256i *)(seq + len - 32 - i));
+        __m256i r = avx_reverse(_mm256_shuffle_epi8(comp, _mm256_and_si256(b, lo)));
+        uint32_t diff = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(f, r));
+        if (diff) return i + (size_t)__builtin_ctz(diff);
+    }
+    _mm256_zeroupper();
+    return mismatch_sse_from(seq, len, i);
+}
+
+AVX_TARGET static int gc_avx2(const char *seq, size_t len, size_t *gc, size_t *n) {
+    const __m256i base = avx_lut(SEQK_NIBBLE_BASE);
+    const __m256i lo = _mm256_set1_epi8(0x0F), up = _mm256_set1_epi8((char)0xDF);
+    const __m256i vg = _mm256_set1_epi8('G'), vc = _mm256_set1_epi8('C'), vn = _mm256_set1_epi8('N');
+    size_t n_gc = 0, n_n = 0, i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(seq + i));
+        __m256i u = _mm256_and_si256(v, up);
+        __m256i ok = _mm256_cmpeq_epi8(_mm256_shuffle_epi8(base, _mm256_and_si256(v, lo)), u);
+        if ((uint32_t)_mm256_movemask_epi8(ok) != 0xFFFFFFFFu) return -1;
+        __m256i is_gc = _mm256_or_si256(_mm256_cmpeq_epi8(u, vg), _mm256_cmpeq_epi8(u, vc));
+        n_gc += (size_t)_mm_popcnt_u32((uint32_t)_mm256_movemask_epi8(is_gc));
+        n_n += (size_t)_mm_popcnt_u32((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(u, vn)));
+    }
+    *gc = n_gc;
+    *n = n_n;
+    _mm256_zeroupper();
+    return gc_sse_from(seq, len, i, gc, n);
+}
+
+AVX_TARGET static void base_avx2(const char *seq, size_t len, size_t counts[SEQ_BASE_COUNT]) {
+    const __m256i up = _mm256_set1_epi8((char)0xDF);
+    const __m256i va = _mm256_set1_epi8('A'), vc = _mm256_set1_epi8('C'), vg = _mm256_set1_epi8('G');
+    const __m256i vt = _mm256_set1_epi8('T'), vn = _mm256_set1_epi8('N');
+    size_t n_a = 0, n_c = 0, n_g = 0, n_t = 0, n_n = 0, i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i u = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(seq + i)), up);
+        n_a += (size_t)_mm_popcnt_u32((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(u, va)));
+        n_c += (size_t)_mm_popcnt_u32((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(u, vc)));
+        n_g += (size_t)_mm_popcnt_u32((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(u, vg)));
+        n_t += (size_t)_mm_popcnt_u32((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(u, vt)));
+        n_n += (size_t)_mm_popcnt_u32((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(u, vn)));
+    }
+    counts[SEQ_BASE_A] += n_a;
+    counts[SEQ_BASE_C] += n_c;
+    counts[SEQ_BASE_G] += n_g;
+    counts[SEQ_BASE_T] += n_t;
+    counts[SEQ_BASE_N] += n_n;
+    _mm256_zeroupper();
+    base_sse_from(seq, len, i, counts);
+}
+
+#endif /* SEQK_X86 */
+
+/* ------------------------------------------------------------------------- */
+/* aarch64: NEON (16 bytes)                                                   */
+/* ------------------------------------------------------------------------- */
+
+#ifdef SEQK_NEON
+
+static inline uint8x16_t neon_reverse(uint8x16_t v) {
+    v = vrev64q_u8(v);
+    return vextq_u8(v, v, 8);
+}
+
+static int revcomp_neon(const char *seq, size_t len, char *out) {
+    const uint8x16_t base = vld1q_u8(SEQK_NIBBLE_BASE), comp = vld1q_u8(SEQK_NIBBLE_COMP);
+    const uint8x16_t lo = vdupq_n_u8(0x0F), up = vdupq_n_u8(0xDF);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t *)seq + len - 16 - i);
+        uint8x16_t idx = vandq_u8(v, lo);
+        if (vminvq_u8(vceqq_u8(vqtbl1q_u8(base, idx), vandq_u8(v, up))) != 0xFF) return -1;
+        vst1q_u8((uint8_t *)out + i, neon_reverse(vqtbl1q_u8(comp, idx)));
+    }
+    return revcomp_tail(seq, len, out, i);
+}
+
+static int upper_neon(const char *seq, size_t len, char *out) {
+    const uint8x16_t base = vld1q_u8(SEQK_NIBBLE_BASE);
+    const uint8x16_t lo = vdupq_n_u8(0x0F), up = vdupq_n_u8(0xDF);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t *)seq + i);
+        uint8x16_t u = vandq_u8(v, up);
+        if (vminvq_u8(vceqq_u8(vqtbl1q_u8(base, vandq_u8(v, lo)), u)) != 0xFF) return -1;
+        vst1q_u8((uint8_t *)out + i, u);
+    }
+    return upper_tail(seq, len, out, i);
+}
+
+static size_t mismatch_neon(const char *seq, size_t len) {
+    const uint8x16_t comp = vld1q_u8(SEQK_NIBBLE_COMP);
+    const uint8x16_t lo = vdupq_n_u8(0x0F), up = vdupq_n_u8(0xDF);
+    size_t half = (len + 1) / 2, i = 0;
+    for (; i + 16 <= half; i += 16) {
+        uint8x16_t f = vandq_u8(vld1q_u8((const uint8_t *)seq + i), up);
+        uint8x16_t b = vld1q_u8((const uint8_t *)seq + len - 16 - i);
+        uint8x16_t r = neon_reverse(vqtbl1q_u8(comp, vandq_u8(b, lo)));
+        if (vminvq_u8(vceqq_u8(f, r)) != 0xFF) break; /* locate within block below */
+    }
+    return mismatch_tail(seq, len, i);
+}
+
+static int gc_neon(const char *seq, size_t len, size_t *gc, size_t *n) {
+    const uint8x16_t base = vld1q_u8(SEQK_NIBBLE_BASE);
+    const uint8x16_t lo = vdupq_n_u8(0x0F), up = vdupq_n_u8(0xDF), one = vdupq_n_u8(1);
+    const uint8x16_t vg = vdupq_n_u8('G'), vc = vdupq_n_u8('C'), vn = vdupq_n_u8('N');
+    size_t n_gc = 0, n_n = 0, i = 0;
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t *)seq + i);
+        uint8x16_t u = vandq_u8(v, up);
+        if (vminvq_u8(vceqq_u8(vqtbl1q_u8(base, vandq_u8(v, lo)), u)) != 0xFF) return -1;
+        uint8x16_t is_gc = vorrq_u8(vceqq_u8(u, vg), vceqq_u8(u, vc));
+        n_gc += vaddvq_u8(vandq_u8(is_gc, one));
+        n_n += vaddvq_u8(vandq_u8(vceqq_u8(u, vn), one));
+    }
+    *gc = n_gc;
+    *n = n_n;
+    return gc_tail(seq, len, i, gc, n);
+}
+
+static void base_neon(const char *seq, size_t len, size_t counts[SEQ_BASE_COUNT]) {
+    const uint8x16_t up = vdupq_n_u8(0xDF), one = vdupq_n_u8(1);
+    const uint8x16_t va = vdupq_n_u8('A'), vc = vdupq_n_u8('C'), vg = vdupq_n_u8('G');
+    const uint8x16_t vt = vdupq_n_u8('T'), vn = vdupq_n_u8('N');
+    size_t n_a = 0, n_c = 0, n_g = 0, n_t = 0, n_n = 0, i = 0;
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t u = vandq_u8(vld1q_u8((const uint8_t *)seq + i), up);
+        n_a += vaddvq_u8(vandq_u8(vceqq_u8(u, va), one));
+        n_c += vaddvq_u8(vandq_u8(vceqq_u8(u, vc), one));
+        n_g += vaddvq_u8(vandq_u8(vceqq_u8(u, vg), one));
+        n_t += vaddvq_u8(vandq_u8(vceqq_u8(u, vt), one));
+        n_n += vaddvq_u8(vandq_u8(vceqq_u8(u, vn), one));
+    }
+    counts[SEQ_BASE_A] += n_a;
+    counts[SEQ_BASE_C] += n_c;
+    counts[SEQ_BASE_G] += n_g;
+    counts[SEQ_BASE_T] += n_t;
+    counts[SEQ_BASE_N] += n_n;
+    base_tail(seq, len, i, counts);
+}
+
+#endif /* SEQK_NEON */
+
+/* ------------------------------------------------------------------------- */
+/* Dispatch                                                                   */
+/* ------------------------------------------------------------------------- */
+
+static const seq_kernel_impl_t SEQK_IMPLS[] = {
+#ifdef SEQK_X86
+    {"avx2", revcomp_avx2, upper_avx2, mismatch_avx2, gc_avx2, base_avx2},
+    {"sse4.2", revcomp_sse, upper_sse, mismatch_sse, gc_sse, base_sse},
+#endif
+#ifdef SEQK_NEON
+    {"neon", revcomp_neon, upper_neon, mismatch_neon, gc_neon, base_neon},
+#endif
+    {"scalar", revcomp_scalar, upper_scalar, mismatch_scalar, gc_scalar, base_scalar},
+};
+
+static const seq_kernel_impl_t *seqk_active = &SEQK_IMPLS[sizeof(SEQK_IMPLS) / sizeof(SEQK_IMPLS[0]) - 1];
+
+static int seqk_supported(const seq_kernel_impl_t *impl) {
+#ifdef SEQK_X86
+    __builtin_cpu_init();
+    if (strcmp(impl->name, "avx2") == 0) return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+    if (strcmp(impl->name, "sse4.2") == 0) return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+#endif
+    (void)impl;
+    return 1;
+}
+
+void seq_kernels_init(void) {
+    for (size_t i = 0; i < sizeof(SEQK_IMPLS) / sizeof(SEQK_IMPLS[0]); i++) {
+        if (seqk_supported(&SEQK_IMPLS[i])) {
+            seqk_active = &SEQK_IMPLS[i];
+            return;
+        }
+    }
+}
+
+int seq_kernels_select(const char *name) {
+    for (size_t i = 0; i < sizeof(SEQK_IMPLS) / sizeof(SEQK_IMPLS[0]); i++) {
+        if (strcmp(SEQK_IMPLS[i].name, name) == 0 && seqk_supported(&SEQK_IMPLS[i])) {
+            seqk_active = &SEQK_IMPLS[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *seq_kernels_name(void) { return seqk_active->name; }
+
+int seq_revcomp_kernel(const char *seq, size_t len, char *out) { return seqk_active->revcomp(seq, len, out); }
+
+int seq_canonical_kernel(const char *seq, size_t len, char *out) {
+    size_t i = seqk_active->mismatch(seq, len);
+    int use_rev = i < (len + 1) / 2 && SEQK_COMP[(uint8_t)seq[len - 1 - i]] < SEQK_UPPER[(uint8_t)seq[i]];
+    return use_rev ? seqk_active->revcomp(seq, len, out) : seqk_active->upper(seq, len, out);
+}
+
+int seq_gc_count_kernel(const char *seq, size_t len, size_t *gc, size_t *n) {
+    return seqk_active->gc_count(seq, len, gc, n);
+}
+
+void seq_base_count_kernel(const char *seq, size_t len, size_t counts[SEQ_BASE_COUNT]) {
+    memset(counts, 0, sizeof(size_t) * SEQ_BASE_COUNT);
+    seqk_active->base_count(seq, len, counts);
+    counts[SEQ_BASE_OTHER] = len - counts[SEQ_BASE_A] - counts[SEQ_BASE_C] - counts[SEQ_BASE_G] - counts[SEQ_BASE_T] -
+                             counts[SEQ_BASE_N];
+}
@@ -15,6 +15,16 @@
  *   read_fasta(path) → (NAME VARCHAR, DESCRIPTION VARCHAR, SEQUENCE VARCHAR)
  *   read_fastq(path) → (NAME VARCHAR, DESCRIPTION VARCHAR, SEQUENCE VARCHAR, QUALITY VARCHAR)
  *
+ * read_fasta also accepts UCSC .2bit files, read through ref_source; regions
+ * go through ref_source for indexed FASTA as well.
+ *
+ * read_fasta(path, chunk_size := N, overlap := M) emits each record as
+ * windows of N bases stepping by N - M, with an extra START column (0-based
+ * offset of the window in its sequence). Plain FASTA is then parsed line by
+ * line, so memory is bounded by one window rather than one chromosome, and
+ * DESCRIPTION carries the header text after the name; regions and .2bit
+ * input have no header text and leave it NULL.
+ *
  * Note: htslib's FASTA/FASTQ reader stores the comment/description in
  * bam_get_l_aux(b) area as a "CO" aux tag when present.
  */
@@ -30,6 +40,9 @@ DUCKDB_EXTENSION_EXTERN
 #include <htslib/sam.h>
 #include <htslib/hts.h>
 #include <htslib/faidx.h>
+#include <htslib/kstring.h>
+
+#include "include/ref_source.h"
 
 /* ================================================================
  * Column indices
@@ -42,6 +55,7 @@ enum {
     SEQ_COL_QUALITY,  /* FASTQ only */
     SEQ_COL_MATE,     /* FASTQ paired/interleaved only */
     SEQ_COL_PAIR_ID,
+    SEQ_COL_START,    /* FASTA chunk_size only */
     SEQ_COL_MAX
 };
 
@@ -57,8 +71,13 @@ typedef struct {
     char **regions;
     unsigned int n_regions;
     int is_fastq;
+    int is_2bit;
     int interleaved;
     int paired;
+    int64_t chunk_size;  /* 0: whole records */
+    int64_t overlap;
+    int col_kinds[SEQ_COL_MAX];  /* SEQ_COL_* of each result column */
+    int n_cols;
 } seq_bind_data_t;
 
 /* ================================================================
@@ -78,7 +97,7 @@ typedef struct {
     int paired;
     int pending_mate;
     int interleaved_mate;
-    faidx_t *fai;
+    ref_source_t *ref;   /* region queries and .2bit input */
     unsigned int n_regions;
     unsigned int next_region_idx;
     char **regions;  /* reference to bind regions */
@@ -94,6 +113,22 @@ typedef struct {
     size_t qual_buf_cap;
     char *pair_buf;
     size_t pair_buf_cap;
+
+    /* chunk_size windows */
+    int64_t chunk_size;
+    int64_t chunk_step;
+    htsFile *chunk_fp;          /* streamed FASTA (no region, not .2bit) */
+    kstring_t chunk_line;
+    kstring_t chunk_name;
+    kstring_t chunk_desc;
+    kstring_t chunk_next_header;  /* header read while filling the window */
+    kstring_t chunk_buf;        /* bases from chunk_start onwards */
+    int64_t chunk_start;
+    int chunk_started;
+    int chunk_record_end;
+    int chunk_has_next;
+    int chunk_tid;              /* ref_source item in progress, -1 when none */
+    hts_pos_t chunk_end;
 } seq_init_data_t;
 
 /* ================================================================
@@ -122,11 +157,17 @@ static void destroy_seq_init(void *data) {
     if (init->rec) bam_destroy1(init->rec);
     if (init->hdr) sam_hdr_destroy(init->hdr);
     if (init->fp) sam_close(init->fp);
-    if (init->fai) fai_destroy(init->fai);
+    ref_source_close(init->ref);
     if (init->rec_mate) bam_destroy1(init->rec_mate);
     if (init->hdr_mate) sam_hdr_destroy(init->hdr_mate);
     if (init->fp_mate) sam_close(init->fp_mate);
     if (init->column_ids) duckdb_free(init->column_ids);
+    if (init->chunk_fp) hts_close(init->chunk_fp);
+    free(init->chunk_line.s);
+    free(init->chunk_name.s);
+    free(init->chunk_desc.s);
+    free(init->chunk_next_header.s);
+    free(init->chunk_buf.s);
     if (init->seq_buf) free(init->seq_buf);
     if (init->qual_buf) free(init->qual_buf);
     if (init->pair_buf) free(init->pair_buf);
@@ -245,30 +286,44 @@ static void seq_read_bind(duckdb_bind_info info, int is_fastq) {
         return;
     }
 
-    /* Verify the file opens and is the expected format */
-    samFile *fp = sam_open(file_path, "r");
-    if (!fp) {
+    /* .2bit is not an htslib format; validate it through ref_source */
+    int is_2bit = !is_fastq && ref_source_is_2bit(file_path);
+    if (is_2bit) {
         char err[512];
-        snprintf(err, sizeof(err), "Failed to open file: %s", file_path);
-        duckdb_bind_set_error(info, err);
-        duckdb_free(file_path);
-        return;
-    }
+        ref_source_t *ref = ref_source_open(file_path, NULL, err, sizeof(err));
+        if (!ref) {
+            duckdb_bind_set_error(info, err);
+            duckdb_free(file_path);
+            return;
+        }
+        ref_source_close(ref);
+    } else {
+        /* Verify the file opens and is the expected format */
+        samFile *fp = sam_open(file_path, "r");
+        if (!fp) {
+            char err[512];
+            snprintf(err, sizeof(err), "Failed to open file: %s", file_path);
+            duckdb_bind_set_error(info, err);
+            duckdb_free(file_path);
+            return;
+        }
 
-    /* Check format — sam_open auto-detects */
-    enum htsExactFormat fmt = hts_get_format(fp)->format;
-    if (is_fastq && fmt != fastq_format) {
-        /* Allow it but warn — htslib will still read it */
-    }
-    if (!is_fastq && fmt != fasta_format) {
-        /* Same — allow but it may not have quality */
+        /* Check format — sam_open auto-detects */
+        enum htsExactFormat fmt = hts_get_format(fp)->format;
+        if (is_fastq && fmt != fastq_format) {
+            /* Allow it but warn — htslib will still read it */
+        }
+        if (!is_fastq && fmt != fasta_format) {
+            /* Same — allow but it may not have quality */
+        }
+        sam_close(fp);
     }
-    sam_close(fp);
 
     seq_bind_data_t *bind = (seq_bind_data_t *)duckdb_malloc(sizeof(seq_bind_data_t));
     memset(bind, 0, sizeof(seq_bind_data_t));
     bind->file_path = file_path;
     bind->is_fastq = is_fastq;
+    bind->is_2bit = is_2bit;
 
     if (is_fastq) {
         duckdb_value mate_val = duckdb_bind_get_named_parameter(info, "mate_path");
@@ -302,6 +357,25 @@ static void seq_read_bind(duckdb_bind_info info, int is_fastq) {
             bind->index_path = duckdb_get_varchar(index_val);
         }
         if (index_val) duckdb_destroy_value(&index_val);
+
+        duckdb_value chunk_val = duckdb_bind_get_named_parameter(info, "chunk_size");
+        if (chunk_val && !duckdb_is_null_value(chunk_val)) bind->chunk_size = duckdb_get_int64(chunk_val);
+        if (chunk_val) duckdb_destroy_value(&chunk_val);
+
+        duckdb_value overlap_val = duckdb_bind_get_named_parameter(info, "overlap");
+        if (overlap_val && !duckdb_is_null_value(overlap_val)) bind->overlap = duckdb_get_int64(overlap_val);
+        if (overlap_val) duckdb_destroy_value(&overlap_val);
+
+        if (bind->chunk_size < 0 || (bind->overlap != 0 && bind->chunk_size == 0)) {
+            duckdb_bind_set_error(info, "read_fasta: chunk_size must be positive when set");
+            destroy_seq_bind(bind);
+            return;
+        }
+        if (bind->overlap < 0 || (bind->chunk_size > 0 && bind->overlap >= bind->chunk_size)) {
+            duckdb_bind_set_error(info, "read_fasta: overlap must be >= 0 and smaller than chunk_size");
+            destroy_seq_bind(bind);
+            return;
+        }
     }
 
     /* Define schema */
@@ -309,13 +383,25 @@ static void seq_read_bind(duckdb_bind_info info, int is_fastq) {
     duckdb_logical_type usmallint_type = duckdb_create_logical_type(DUCKDB_TYPE_USMALLINT);
 
     duckdb_bind_add_result_column(info, "NAME", varchar_type);
+    bind->col_kinds[bind->n_cols++] = SEQ_COL_NAME;
     duckdb_bind_add_result_column(info, "DESCRIPTION", varchar_type);
+    bind->col_kinds[bind->n_cols++] = SEQ_COL_DESCRIPTION;
     duckdb_bind_add_result_column(info, "SEQUENCE", varchar_type);
+    bind->col_kinds[bind->n_cols++] = SEQ_COL_SEQUENCE;
+    if (bind->chunk_size > 0) {
+        duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+        duckdb_bind_add_result_column(info, "START", bigint_type);
+        bind->col_kinds[bind->n_cols++] = SEQ_COL_START;
+        duckdb_destroy_logical_type(&bigint_type);
+    }
     if (is_fastq) {
         duckdb_bind_add_result_column(info, "QUALITY", varchar_type);
+        bind->col_kinds[bind->n_cols++] = SEQ_COL_QUALITY;
         if (bind->paired || bind->interleaved) {
             duckdb_bind_add_result_column(info, "MATE", usmallint_type);
+            bind->col_kinds[bind->n_cols++] = SEQ_COL_MATE;
             duckdb_bind_add_result_column(info, "PAIR_ID", varchar_type);
+            bind->col_kinds[bind->n_cols++] = SEQ_COL_PAIR_ID;
         }
     }
 
@@ -337,21 +423,32 @@ static void seq_read_init(duckdb_init_info info) {
     seq_init_data_t *init = (seq_init_data_t *)duckdb_malloc(sizeof(seq_init_data_t));
     memset(init, 0, sizeof(seq_init_data_t));
 
-    /* sam_open handles .gz / .bgzf transparently */
-    init->fp = sam_open(bind->file_path, "r");
-    if (!init->fp) {
-        duckdb_init_set_error(info, "Failed to open sequence file");
-        duckdb_free(init);
-        return;
-    }
+    /* .2bit input is read entirely through ref_source below; chunked plain
+     * FASTA is parsed line by line instead of through sam_read1 */
+    if (bind->chunk_size > 0 && !bind->is_2bit && bind->n_regions == 0) {
+        init->chunk_fp = hts_open(bind->file_path, "r");
+        if (!init->chunk_fp) {
+            duckdb_init_set_error(info, "Failed to open sequence file");
+            duckdb_free(init);
+            return;
+        }
+    } else if (!bind->is_2bit) {
+        /* sam_open handles .gz / .bgzf transparently */
+        init->fp = sam_open(bind->file_path, "r");
+        if (!init->fp) {
+            duckdb_init_set_error(info, "Failed to open sequence file");
+            duckdb_free(init);
+            return;
+        }
 
-    /* sam_hdr_read for FASTA/FASTQ returns a valid (possibly empty) header */
-    init->hdr = sam_hdr_read(init->fp);
-    if (!init->hdr) {
-        sam_close(init->fp); init->fp = NULL;
-        duckdb_init_set_error(info, "Failed to read header");
-        duckdb_free(init);
-        return;
+        /* sam_hdr_read for FASTA/FASTQ returns a valid (possibly empty) header */
+        init->hdr = sam_hdr_read(init->fp);
+        if (!init->hdr) {
+            sam_close(init->fp); init->fp = NULL;
+            duckdb_init_set_error(info, "Failed to read header");
+            duckdb_free(init);
+            return;
+        }
     }
 
     init->rec = bam_init1();
@@ -363,6 +460,9 @@ static void seq_read_init(duckdb_init_info info) {
     init->n_regions = bind->n_regions;
     init->next_region_idx = 0;
     init->regions = bind->regions;
+    init->chunk_size = bind->chunk_size;
+    init->chunk_step = bind->chunk_size - bind->overlap;
+    init->chunk_tid = -1;
 
     if (bind->paired) {
         init->fp_mate = sam_open(bind->mate_path, "r");
@@ -380,10 +480,12 @@ static void seq_read_init(duckdb_init_info info) {
         init->rec_mate = bam_init1();
     }
 
-    if (!bind->is_fastq && bind->n_regions > 0) {
-        init->fai = fai_load3_format(bind->file_path, bind->index_path, NULL, 0, FAI_FASTA);
-        if (!init->fai) {
-            duckdb_init_set_error(info, "read_fasta: region query requires a FASTA index (.fai); run fasta_index(path) first");
+    if (!bind->is_fastq && (bind->n_regions > 0 || bind->is_2bit)) {
+        char err[512];
+        init->ref = ref_source_open(bind->file_path, bind->index_path, err, sizeof(err));
+        if (!init->ref) {
+            duckdb_init_set_error(info, bind->is_2bit ? err
+                                                      : "read_fasta: region query requires a FASTA index (.fai); run fasta_index(path) first");
             destroy_seq_init(init);
             return;
         }
@@ -394,13 +496,133 @@ static void seq_read_init(duckdb_init_info info) {
     /* Projection pushdown */
     init->column_count = duckdb_init_get_column_count(info);
     init->column_ids = (idx_t *)duckdb_malloc(sizeof(idx_t) * init->column_count);
-    for (idx_t i = 0; i < init->column_count; i++)
-        init->column_ids[i] = duckdb_init_get_column_index(info, i);
+    for (idx_t i = 0; i < init->column_count; i++) {
+        idx_t col = duckdb_init_get_column_index(info, i);
+        /* Result positions differ between read_fasta and read_fastq */
+        init->column_ids[i] = col < (idx_t)bind->n_cols ? (idx_t)bind->col_kinds[col] : SEQ_COL_MAX;
+    }
 
     duckdb_init_set_max_threads(info, 1);
     duckdb_init_set_init_data(info, init, destroy_seq_init);
 }
 
+/* ================================================================
+ * Chunked FASTA (chunk_size := N)
+ * ================================================================ */
+
+/* Record name and description from a header line: text after '>' up to
+ * the first space, then the rest after the separating whitespace. */
+static void chunk_set_header(seq_init_data_t *init, const char *header, size_t len) {
+    size_t n = 1;
+    while (n < len && header[n] != ' ' && header[n] != '\t') n++;
+    init->chunk_name.l = 0;
+    kputsn(header + 1, n - 1, &init->chunk_name);
+    while (n < len && (header[n] == ' ' || header[n] == '\t')) n++;
+    init->chunk_desc.l = 0;
+    kputsn(header + n, len - n, &init->chunk_desc);
+}
+
+/* Append lines of the current record to the window until it holds more than
+ * chunk_size bases (so the emitted window is known not to be the last one)
+ * or the record ends. Returns -1 on a read error. */
+static int chunk_fill(seq_init_data_t *init) {
+    while (!init->chunk_record_end && (int64_t)init->chunk_buf.l <= init->chunk_size) {
+        int ret = hts_getline(init->chunk_fp, '\n', &init->chunk_line);
+        if (ret < -1) return -1;
+        if (ret == -1) {
+            init->chunk_record_end = 1;
+            break;
+        }
+        size_t len = init->chunk_line.l;
+        if (len > 0 && init->chunk_line.s[len - 1] == '\r') len--;
+        if (len > 0 && init->chunk_line.s[0] == '>') {
+            init->chunk_next_header.l = 0;
+            kputsn(init->chunk_line.s, len, &init->chunk_next_header);
+            init->chunk_has_next = 1;
+            init->chunk_record_end = 1;
+            break;
+        }
+        kputsn(init->chunk_line.s, len, &init->chunk_buf);
+    }
+    return 0;
+}
+
+/* Next window of a streamed FASTA: its bases are the first *len bytes of
+ * chunk_buf. Returns 1 for a window, 0 at end of input, -1 on error. */
+static int chunk_next_stream(seq_init_data_t *init, hts_pos_t *len) {
+    if (!init->chunk_started) {
+        /* Skip anything before the first header */
+        init->chunk_started = 1;
+        for (;;) {
+            int ret = hts_getline(init->chunk_fp, '\n', &init->chunk_line);
+            if (ret < -1) return -1;
+            if (ret == -1) return 0;
+            size_t l = init->chunk_line.l;
+            if (l > 0 && init->chunk_line.s[l - 1] == '\r') l--;
+            if (l > 0 && init->chunk_line.s[0] == '>') {
+                chunk_set_header(init, init->chunk_line.s, l);
+                break;
+            }
+        }
+    } else if (init->chunk_record_end && (int64_t)init->chunk_buf.l <= init->chunk_size) {
+        /* The last window of this record has been emitted */
+        if (!init->chunk_has_next) return 0;
+        chunk_set_header(init, init->chunk_next_header.s, init->chunk_next_header.l);
+        init->chunk_has_next = 0;
+        init->chunk_record_end = 0;
+        init->chunk_buf.l = 0;
+        init->chunk_start = 0;
+    } else {
+        size_t step = (size_t)init->chunk_step;
+        memmove(init->chunk_buf.s, init->chunk_buf.s + step, init->chunk_buf.l - step);
+        init->chunk_buf.l -= step;
+        init->chunk_start += init->chunk_step;
+    }
+    if (chunk_fill(init) != 0) return -1;
+    *len = (int64_t)init->chunk_buf.l < init->chunk_size ? (hts_pos_t)init->chunk_buf.l : init->chunk_size;
+    return 1;
+}
+
+/* Next window of a region or .2bit sequence, fetched through ref_source
+ * into *seq (caller frees). Returns 1, 0 when all items are done, or -1
+ * with msg filled. */
+static int chunk_next_ref(seq_init_data_t *init, const char **name, char **seq, hts_pos_t *len,
+                          char *msg, size_t msg_len) {
+    if (init->chunk_tid < 0) {
+        unsigned int n_items = init->n_regions > 0 ? init->n_regions : (unsigned int)ref_source_nseq(init->ref);
+        if (init->next_region_idx >= n_items) return 0;
+        hts_pos_t beg = 0, end = 0;
+        if (init->n_regions > 0) {
+            const char *region = init->regions[init->next_region_idx++];
+            if (ref_source_parse_region(init->ref, region, &init->chunk_tid, &beg, &end) != 0) {
+                snprintf(msg, msg_len, "read_fasta: invalid or missing region '%s'", region);
+                init->chunk_tid = -1;
+                return -1;
+            }
+        } else {
+            init->chunk_tid = (int)init->next_region_idx++;
+            end = ref_source_seq_len(init->ref, init->chunk_tid);
+        }
+        init->chunk_start = beg;
+        init->chunk_end = end;
+    } else {
+        init->chunk_start += init->chunk_step;
+    }
+
+    int tid = init->chunk_tid;
+    hts_pos_t end = init->chunk_start + init->chunk_size < init->chunk_end ? init->chunk_start + init->chunk_size
+                                                                           : init->chunk_end;
+    *name = ref_source_iseq(init->ref, tid);
+    *seq = ref_source_fetch(init->ref, tid, init->chunk_start, end, len);
+    if (!*seq) {
+        snprintf(msg, msg_len, "read_fasta: failed to fetch %s:%lld-%lld", *name, (long long)init->chunk_start + 1,
+                 (long long)end);
+        return -1;
+    }
+    if (end >= init->chunk_end) init->chunk_tid = -1;
+    return 1;
+}
+
 /* ================================================================
  * Scan
  *
@@ -422,14 +644,74 @@ static void seq_read_function(duckdb_function_info info, duckdb_data_chunk outpu
     idx_t row_count = 0;
 
     while (row_count < vector_size) {
-        if (init->fai && init->n_regions > 0) {
-            if (init->next_region_idx >= init->n_regions) {
+        if (init->chunk_size > 0) {
+            const char *name = NULL;
+            char *fetched = NULL;
+            hts_pos_t len = 0;
+            char msg[512] = {0};
+            int ret;
+            if (init->ref) {
+                ret = chunk_next_ref(init, &name, &fetched, &len, msg, sizeof(msg));
+            } else {
+                ret = chunk_next_stream(init, &len);
+                name = init->chunk_name.s;
+                if (ret < 0) snprintf(msg, sizeof(msg), "read_fasta: failed to read sequence file");
+            }
+            if (ret == 0) {
                 init->done = 1;
                 break;
             }
-            const char *region = init->regions[init->next_region_idx++];
-            hts_pos_t len = 0;
-            char *seq = fai_fetch64(init->fai, region, &len);
+            if (ret < 0) {
+                duckdb_function_set_error(info, msg);
+                init->done = 1;
+                duckdb_data_chunk_set_size(output, 0);
+                return;
+            }
+            const char *seq = init->ref ? fetched : init->chunk_buf.s;
+
+            for (idx_t i = 0; i < init->column_count; i++) {
+                idx_t col_id = init->column_ids[i];
+                duckdb_vector vec = duckdb_data_chunk_get_vector(output, i);
+                if (col_id == SEQ_COL_NAME) {
+                    duckdb_vector_assign_string_element(vec, row_count, name ? name : "");
+                } else if (col_id == SEQ_COL_DESCRIPTION) {
+                    /* Indexed and .2bit sources keep no header text */
+                    if (!init->ref && init->chunk_desc.l > 0) {
+                        duckdb_vector_assign_string_element_len(vec, row_count, init->chunk_desc.s,
+                                                                (idx_t)init->chunk_desc.l);
+                    } else {
+                        set_null(vec, row_count);
+                    }
+                } else if (col_id == SEQ_COL_SEQUENCE) {
+                    duckdb_vector_assign_string_element_len(vec, row_count, len > 0 ? seq : "", (idx_t)len);
+                } else if (col_id == SEQ_COL_START) {
+                    ((int64_t *)duckdb_vector_get_data(vec))[row_count] = init->chunk_start;
+                }
+            }
+            free(fetched);
+            row_count++;
+            continue;
+        }
+
+        if (init->ref) {
+            /* Each region in turn, or every sequence of a .2bit file */
+            unsigned int n_items = init->n_regions > 0 ? init->n_regions : (unsigned int)ref_source_nseq(init->ref);
+            if (init->next_region_idx >= n_items) {
+                init->done = 1;
+                break;
+            }
+            const char *region = NULL;
+            int tid = -1;
+            hts_pos_t beg = 0, end = 0, len = 0;
+            if (init->n_regions > 0) {
+                region = init->regions[init->next_region_idx++];
+                if (ref_source_parse_region(init->ref, region, &tid, &beg, &end) != 0) tid = -1;
+            } else {
+                tid = (int)init->next_region_idx++;
+                region = ref_source_iseq(init->ref, tid);
+                end = ref_source_seq_len(init->ref, tid);
+            }
+            char *seq = tid >= 0 ? ref_source_fetch(init->ref, tid, beg, end, &len) : NULL;
             if (!seq || len < 0) {
                 if (seq) free(seq);
                 char msg[512];
@@ -440,10 +722,8 @@ static void seq_read_function(duckdb_function_info info, duckdb_data_chunk outpu
                 return;
             }
 
-            const char *name = region;
-            size_t name_len = strlen(region);
-            const char *colon = strchr(region, ':');
-            if (colon) name_len = (size_t)(colon - region);
+            const char *name = ref_source_iseq(init->ref, tid);
+            size_t name_len = strlen(name);
             ensure_buf(&init->pair_buf, &init->pair_buf_cap, (int)name_len);
             if (!init->pair_buf) {
                 free(seq);
@@ -652,6 +932,11 @@ void register_read_fasta_function(duckdb_connection connection) {
     duckdb_table_function_add_named_parameter(tf, "index_path", varchar_type);
     duckdb_destroy_logical_type(&varchar_type);
 
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_table_function_add_named_parameter(tf, "chunk_size", bigint_type);
+    duckdb_table_function_add_named_parameter(tf, "overlap", bigint_type);
+    duckdb_destroy_logical_type(&bigint_type);
+
     duckdb_table_function_set_bind(tf, fasta_read_bind);
     duckdb_table_function_set_init(tf, seq_read_init);
     duckdb_table_function_set_function(tf, seq_read_function);
@@ -749,6 +1034,147 @@ void register_fasta_index_function(duckdb_connection connection) {
     duckdb_destroy_table_function(&tf);
 }
 
+/* ================================================================
+ * fasta_to_2bit
+ * ================================================================ */
+
+typedef struct {
+    char *output_path;
+    int64_t n_sequences;
+    int64_t n_bases;
+    int emitted;
+} fasta_to_2bit_bind_t;
+
+static void destroy_fasta_to_2bit_bind(void *data) {
+    fasta_to_2bit_bind_t *b = (fasta_to_2bit_bind_t *)data;
+    if (!b) return;
+    if (b->output_path) duckdb_free(b->output_path);
+    duckdb_free(b);
+}
+
+/* path with .gz and a .fa/.fasta/.fna suffix stripped, plus .2bit */
+static char *default_2bit_output_path(const char *path) {
+    static const char *suffixes[] = {".fa", ".fasta", ".fna", ".FA", ".FASTA", ".FNA"};
+    size_t len = strlen(path);
+    if (len > 3 && strcmp(path + len - 3, ".gz") == 0) len -= 3;
+    for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++) {
+        size_t n = strlen(suffixes[i]);
+        if (len > n && strncmp(path + len - n, suffixes[i], n) == 0) {
+            len -= n;
+            break;
+        }
+    }
+    char *out = (char *)duckdb_malloc(len + 6);
+    memcpy(out, path, len);
+    memcpy(out + len, ".2bit", 6);
+    return out;
+}
+
+static void fasta_to_2bit_bind(duckdb_bind_info info) {
+    duckdb_value path_val = duckdb_bind_get_parameter(info, 0);
+    char *file_path = duckdb_get_varchar(path_val);
+    duckdb_destroy_value(&path_val);
+    if (!file_path || strlen(file_path) == 0) {
+        duckdb_bind_set_error(info, "fasta_to_2bit requires a file path");
+        if (file_path) duckdb_free(file_path);
+        return;
+    }
+
+    char *output_path = NULL;
+    char *index_path = NULL;
+    int overwrite = 0;
+    duckdb_value val = duckdb_bind_get_named_parameter(info, "output_path");
+    if (val && !duckdb_is_null_value(val)) output_path = duckdb_get_varchar(val);
+    if (val) duckdb_destroy_value(&val);
+    val = duckdb_bind_get_named_parameter(info, "index_path");
+    if (val && !duckdb_is_null_value(val)) index_path = duckdb_get_varchar(val);
+    if (val) duckdb_destroy_value(&val);
+    val = duckdb_bind_get_named_parameter(info, "overwrite");
+    if (val && !duckdb_is_null_value(val)) overwrite = duckdb_get_bool(val) ? 1 : 0;
+    if (val) duckdb_destroy_value(&val);
+    if (!output_path) output_path = default_2bit_output_path(file_path);
+
+    char err[512] = {0};
+    char write_err[400] = {0};
+    FILE *existing = overwrite ? NULL : fopen(output_path, "rb");
+    int64_t n_sequences = 0, n_bases = 0;
+    if (existing) {
+        fclose(existing);
+        snprintf(err, sizeof(err), "fasta_to_2bit: output '%s' already exists (use overwrite := TRUE to replace)",
+                 output_path);
+    } else if (twobit_write_from_fasta(file_path, index_path, output_path, &n_sequences, &n_bases, write_err,
+                                       sizeof(write_err)) != 0) {
+        snprintf(err, sizeof(err), "fasta_to_2bit: %s", write_err);
+    }
+    duckdb_free(file_path);
+    if (index_path) duckdb_free(index_path);
+    if (err[0]) {
+        duckdb_bind_set_error(info, err);
+        duckdb_free(output_path);
+        return;
+    }
+
+    duckdb_logical_type bool_type = duckdb_create_logical_type(DUCKDB_TYPE_BOOLEAN);
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_bind_add_result_column(info, "success", bool_type);
+    duckdb_bind_add_result_column(info, "output_path", varchar_type);
+    duckdb_bind_add_result_column(info, "n_sequences", bigint_type);
+    duckdb_bind_add_result_column(info, "n_bases", bigint_type);
+    duckdb_destroy_logical_type(&bool_type);
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bigint_type);
+
+    fasta_to_2bit_bind_t *bind = (fasta_to_2bit_bind_t *)duckdb_malloc(sizeof(fasta_to_2bit_bind_t));
+    bind->output_path = output_path;
+    bind->n_sequences = n_sequences;
+    bind->n_bases = n_bases;
+    bind->emitted = 0;
+    duckdb_bind_set_bind_data(info, bind, destroy_fasta_to_2bit_bind);
+}
+
+static void fasta_to_2bit_init(duckdb_init_info info) {
+    fasta_to_2bit_bind_t *bind = (fasta_to_2bit_bind_t *)duckdb_init_get_bind_data(info);
+    bind->emitted = 0;
+}
+
+static void fasta_to_2bit_scan(duckdb_function_info info, duckdb_data_chunk output) {
+    fasta_to_2bit_bind_t *bind = (fasta_to_2bit_bind_t *)duckdb_function_get_bind_data(info);
+    if (bind->emitted) {
+        duckdb_data_chunk_set_size(output, 0);
+        return;
+    }
+    bool *success_data = (bool *)duckdb_vector_get_data(duckdb_data_chunk_get_vector(output, 0));
+    int64_t *n_seq_data = (int64_t *)duckdb_vector_get_data(duckdb_data_chunk_get_vector(output, 2));
+    int64_t *n_base_data = (int64_t *)duckdb_vector_get_data(duckdb_data_chunk_get_vector(output, 3));
+    success_data[0] = true;
+    duckdb_vector_assign_string_element(duckdb_data_chunk_get_vector(output, 1), 0, bind->output_path);
+    n_seq_data[0] = bind->n_sequences;
+    n_base_data[0] = bind->n_bases;
+    bind->emitted = 1;
+    duckdb_data_chunk_set_size(output, 1);
+}
+
+void register_fasta_to_2bit_function(duckdb_connection connection) {
+    duckdb_table_function tf = duckdb_create_table_function();
+    duckdb_table_function_set_name(tf, "fasta_to_2bit");
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bool_type = duckdb_create_logical_type(DUCKDB_TYPE_BOOLEAN);
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "output_path", varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "index_path", varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "overwrite", bool_type);
+    duckdb_destroy_logical_type(&varchar_type);
+    duckdb_destroy_logical_type(&bool_type);
+
+    duckdb_table_function_set_bind(tf, fasta_to_2bit_bind);
+    duckdb_table_function_set_init(tf, fasta_to_2bit_init);
+    duckdb_table_function_set_function(tf, fasta_to_2bit_scan);
+    duckdb_register_table_function(connection, tf);
+    duckdb_destroy_table_function(&tf);
+}
+
 void register_read_fastq_function(duckdb_connection connection) {
     duckdb_table_function tf = duckdb_create_table_function();
     duckdb_table_function_set_name(tf, "read_fastq");
@@ -23,12 +23,29 @@
  * tabix-indexed queries (e.g. region := 'chr1:1000-2000').
  * Without an index, the file is scanned sequentially.
  *
+ * read_gtf/read_gff also accept:
+ *   attributes := ['gene_id', ...]  one VARCHAR column per listed attribute,
+ *                                   filled from a single pass over column 9
+ *   feature := ['exon', 'CDS']      keep only these feature types; other lines
+ *                                   are rejected on column 3 before parsing
+ *
+ * gff_models(path, [region]) → one row per transcript with exon/CDS/UTR/intron
+ *                              span lists, resolved from GFF3 ID/Parent or GTF
+ *                              gene_id/transcript_id in a single pass
+ *
+ * annotate_consequence(vcf_path, gtf_path, [reference, flank])
+ *                            → per-allele, per-transcript consequence terms
+ *                              built on the gff_models loader
+ *
  * API reference: htslib tbx.h, hts_getline()
  */
 
 #include "duckdb_extension.h"
 DUCKDB_EXTENSION_EXTERN
 #include "include/vcf_types.h"
+#include "include/ref_source.h"
+#include "include/gff_name_index.h"
+#include "cgranges.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -36,10 +53,16 @@ DUCKDB_EXTENSION_EXTERN
 #include <stdbool.h>
 #include <math.h>
 #include <strings.h>
+#include <ctype.h>
 
 #include <htslib/hts.h>
 #include <htslib/tbx.h>
+#include <htslib/vcf.h>
 #include <htslib/kstring.h>
+#include <htslib/khash.h>
+
+/* Exported by cgranges.c but not declared in its header */
+int64_t cr_overlap_int(const cgranges_t *cr, int32_t ctg_id, int32_t st, int32_t en, int64_t **b_, int64_t *m_b_);
 
 /* ================================================================
  * Constants
@@ -48,6 +71,7 @@ DUCKDB_EXTENSION_EXTERN
 #define TABIX_BATCH_SIZE 2048
 #define TABIX_MAX_GENERIC_COLS 256
 #define TABIX_NUM_PARSE_BUF 128
+#define TABIX_MAX_ATTR_COLUMNS 256
 
 static inline void set_null(duckdb_vector vec, idx_t row) {
     duckdb_vector_ensure_validity_writable(vec);
@@ -94,6 +118,10 @@ enum {
     GXF_COL_COUNT
 };
 
+static const char *GXF_COL_NAMES[GXF_COL_COUNT] = {
+    "seqname", "source", "feature", "start", "end", "score", "strand", "frame", "attributes", "attributes_map",
+};
+
 /* Reader mode */
 typedef enum {
     TABIX_MODE_GENERIC = 0,
@@ -123,6 +151,13 @@ typedef struct {
     int  auto_detect;
     int  col_types_provided;
     int *col_types;
+    char **attr_names;     /* GTF/GFF: attributes extracted as columns */
+    int   *attr_name_lens;
+    int    n_attr_names;
+    int    attr_col_base;  /* logical index of the first attribute column */
+    char **features;       /* GTF/GFF: feature filter on column 3 */
+    int   *feature_lens;
+    int    n_features;
 } tabix_bind_data_t;
 
 static void tabix_bind_data_destroy(void *data) {
@@ -144,6 +179,12 @@ static void tabix_bind_data_destroy(void *data) {
             free(bd->header_names);
         }
         free(bd->col_types);
+        for (int i = 0; i < bd->n_attr_names; i++) free(bd->attr_names[i]);
+        free(bd->attr_names);
+        free(bd->attr_name_lens);
+        for (int i = 0; i < bd->n_features; i++) free(bd->features[i]);
+        free(bd->features);
+        free(bd->feature_lens);
         free(bd);
     }
 }
@@ -163,6 +204,12 @@ typedef struct {
     unsigned int next_region_idx;
     int        skip_remaining;
     int        skipped_header;
+    int        max_field;       /* highest file column any projected column reads */
+    int       *field_off;       /* per-line tab offsets, reused across lines */
+    int       *field_len;
+    int        n_fields;
+    idx_t     *attr_vec;        /* output vector per extracted attribute, or (idx_t)-1 */
+    int        n_attr_projected;
 } tabix_init_data_t;
 
 static void tabix_init_data_destroy(void *data) {
@@ -173,6 +220,9 @@ static void tabix_init_data_destroy(void *data) {
         if (id->fp)  hts_close(id->fp);
         free(id->line.s);
         free(id->column_ids);
+        free(id->field_off);
+        free(id->field_len);
+        free(id->attr_vec);
         free(id);
     }
 }
@@ -253,6 +303,26 @@ static const char *get_field(const char *s, int idx, int *len) {
     return NULL;
 }
 
+/* Split a line into tab-delimited spans once, stopping after field max_field.
+ * Offsets and lengths land in the caller's reusable arrays (max_field + 1
+ * entries). Returns the number of fields found. */
+static int split_fields(const char *s, size_t l, int max_field, int *off, int *len) {
+    const char *p = s;
+    const char *end = s + l;
+    int n = 0;
+    while (n <= max_field) {
+        const char *tab = (const char *)memchr(p, '\t', (size_t)(end - p));
+        off[n] = (int)(p - s);
+        if (!tab) {
+            len[n++] = (int)(end - p);
+            break;
+        }
+        len[n++] = (int)(tab - p);
+        p = tab + 1;
+    }
+    return n;
+}
+
 static void trim_span(const char **start, int *len) {
     const char *s = *start;
     int l = *len;
@@ -359,58 +429,78 @@ static int tabix_advance_region_iterator(tabix_init_data_t *id, tabix_bind_data_
     return 0;
 }
 
-static int count_gff_pairs(const char *s) {
-    int count = 0;
-    const char *p = s;
-    while (*p) {
-        while (*p == ';' || *p == ' ' || *p == '\t') p++;
-        if (!*p) break;
-        const char *key = p;
-        while (*p && *p != '=' && *p != ';') p++;
-        if (*p != '=') {
-            while (*p && *p != ';') p++;
-            continue;
+/* Advance *pp to the next key/value pair of a GFF3 (key=value) or GTF
+ * (key "value") attribute span ending at end. Keys and values are trimmed and
+ * GTF quotes stripped. Returns 0 when no pairs remain. */
+static int next_attr_pair(const char **pp, const char *end, bool is_gff,
+                          const char **key, int *key_len,
+                          const char **val, int *val_len) {
+    const char *p = *pp;
+    while (p < end) {
+        while (p < end && (*p == ';' || *p == ' ' || *p == '\t')) p++;
+        if (p >= end) break;
+
+        const char *k = p;
+        int klen = 0;
+        const char *v = NULL;
+        int vlen = 0;
+
+        if (is_gff) {
+            while (p < end && *p != '=' && *p != ';') p++;
+            if (p >= end || *p != '=') {
+                while (p < end && *p != ';') p++;
+                continue;
+            }
+            klen = (int)(p - k);
+            p++; /* '=' */
+            v = p;
+            while (p < end && *p != ';') p++;
+            vlen = (int)(p - v);
+        } else {
+            while (p < end && *p != ' ' && *p != '\t' && *p != ';') p++;
+            klen = (int)(p - k);
+            while (p < end && (*p == ' ' || *p == '\t')) p++;
+            if (p < end && *p == '"') {
+                p++;
+                v = p;
+                while (p < end && *p != '"') p++;
+                vlen = (int)(p - v);
+                if (p < end) p++;
+            } else {
+                v = p;
+                while (p < end && *p != ';') p++;
+                vlen = (int)(p - v);
+            }
+        }
+
+        trim_span(&k, &klen);
+        trim_span(&v, &vlen);
+        while (p < end && *p != ';') p++;
+        if (p < end) p++;
+        if (klen > 0) {
+            *pp = p;
+            *key = k;
+            *key_len = klen;
+            *val = v;
+            *val_len = vlen;
+            return 1;
         }
-        int key_len = (int)(p - key);
-        p++; /* skip '=' */
-        const char *val = p;
-        while (*p && *p != ';') p++;
-        int val_len = (int)(p - val);
-        trim_span(&key, &key_len);
-        trim_span(&val, &val_len);
-        if (key_len > 0) count++;
-        if (*p == ';') p++;
     }
-    return count;
+    *pp = p;
+    return 0;
 }
 
-static int count_gtf_pairs(const char *s) {
+static int count_attr_pairs(const char *s, const char *end, bool is_gff) {
+    const char *key, *val;
+    int key_len, val_len;
     int count = 0;
-    const char *p = s;
-    while (*p) {
-        while (*p == ';' || *p == ' ' || *p == '\t') p++;
-        if (!*p) break;
-        const char *key = p;
-        while (*p && *p != ' ' && *p != '\t' && *p != ';') p++;
-        int key_len = (int)(p - key);
-        while (*p == ' ' || *p == '\t') p++;
-        if (*p == '"') {
-            p++;
-            while (*p && *p != '"') p++;
-            if (*p == '"') p++;
-        } else {
-            while (*p && *p != ';') p++;
-        }
-        trim_span(&key, &key_len);
-        if (key_len > 0) count++;
-        while (*p && *p != ';') p++;
-        if (*p == ';') p++;
-    }
+    while (next_attr_pair(&s, end, is_gff, &key, &key_len, &val, &val_len)) count++;
     return count;
 }
 
-static void fill_attr_map(duckdb_vector vec, idx_t row, const char *s, bool is_gff) {
-    if (!s || s[0] == '\0' || (s[0] == '.' && s[1] == '\0')) {
+/* Parse the attribute column in place from its span within the line. */
+static void fill_attr_map(duckdb_vector vec, idx_t row, const char *s, int len, bool is_gff) {
+    if (!s || len <= 0 || (len == 1 && s[0] == '.')) {
         duckdb_vector_ensure_validity_writable(vec);
         uint64_t *validity = duckdb_vector_get_validity(vec);
         duckdb_validity_set_row_invalid(validity, row);
@@ -420,7 +510,8 @@ static void fill_attr_map(duckdb_vector vec, idx_t row, const char *s, bool is_g
         return;
     }
 
-    int pair_count = is_gff ? count_gff_pairs(s) : count_gtf_pairs(s);
+    const char *end = s + len;
+    int pair_count = count_attr_pairs(s, end, is_gff);
     duckdb_list_entry entry;
     entry.offset = duckdb_list_vector_get_size(vec);
     entry.length = pair_count;
@@ -439,58 +530,96 @@ static void fill_attr_map(duckdb_vector vec, idx_t row, const char *s, bool is_g
     duckdb_vector val_vec = duckdb_struct_vector_get_child(child, 1);
 
     const char *p = s;
+    const char *key, *val;
+    int key_len, val_len;
     int write_idx = 0;
-    while (*p && write_idx < pair_count) {
-        while (*p == ';' || *p == ' ' || *p == '\t') p++;
-        if (!*p) break;
+    while (write_idx < pair_count &&
+           next_attr_pair(&p, end, is_gff, &key, &key_len, &val, &val_len)) {
+        duckdb_vector_assign_string_element_len(key_vec, entry.offset + write_idx, key, key_len);
+        duckdb_vector_assign_string_element_len(val_vec, entry.offset + write_idx, val, val_len);
+        write_idx++;
+    }
 
-        const char *key = p;
-        int key_len = 0;
-        const char *val = NULL;
-        int val_len = 0;
+    entry.length = write_idx;
+    duckdb_list_entry *list_data = (duckdb_list_entry *)duckdb_vector_get_data(vec);
+    list_data[row] = entry;
+}
 
-        if (is_gff) {
-            while (*p && *p != '=' && *p != ';') p++;
-            if (*p != '=') {
-                while (*p && *p != ';') p++;
-                continue;
-            }
-            key_len = (int)(p - key);
-            p++; /* '=' */
-            val = p;
-            while (*p && *p != ';') p++;
-            val_len = (int)(p - val);
-        } else {
-            while (*p && *p != ' ' && *p != '\t' && *p != ';') p++;
-            key_len = (int)(p - key);
-            while (*p == ' ' || *p == '\t') p++;
-            if (*p == '"') {
-                p++;
-                val = p;
-                while (*p && *p != '"') p++;
-                val_len = (int)(p - val);
-                if (*p == '"') p++;
-            } else {
-                val = p;
-                while (*p && *p != ';') p++;
-                val_len = (int)(p - val);
-            }
+/* Fill the requested attribute columns for one row from a single pass over
+ * the attribute span. The first occurrence of a repeated key wins; attributes
+ * absent from the line are NULL. */
+static void fill_attr_columns(tabix_bind_data_t *bd, tabix_init_data_t *id, duckdb_vector *vectors,
+                              idx_t row, const char *s, int len) {
+    int remaining = id->n_attr_projected;
+    uint64_t seen[(TABIX_MAX_ATTR_COLUMNS + 63) / 64] = {0};
+    const char *p = s;
+    const char *end = s ? s + len : NULL;
+    const char *key, *val;
+    int key_len, val_len;
+    bool is_gff = bd->mode == TABIX_MODE_GFF;
+
+    while (p && remaining > 0 && next_attr_pair(&p, end, is_gff, &key, &key_len, &val, &val_len)) {
+        for (int a = 0; a < bd->n_attr_names; a++) {
+            if (id->attr_vec[a] == (idx_t)-1 || (seen[a / 64] >> (a % 64)) & 1) continue;
+            if (bd->attr_name_lens[a] != key_len || memcmp(bd->attr_names[a], key, (size_t)key_len) != 0) continue;
+            duckdb_vector_assign_string_element_len(vectors[id->attr_vec[a]], row, val, val_len);
+            seen[a / 64] |= (uint64_t)1 << (a % 64);
+            remaining--;
+            break;
         }
+    }
+    for (int a = 0; a < bd->n_attr_names && remaining > 0; a++) {
+        if (id->attr_vec[a] == (idx_t)-1 || (seen[a / 64] >> (a % 64)) & 1) continue;
+        set_null(vectors[id->attr_vec[a]], row);
+    }
+}
 
-        trim_span(&key, &key_len);
-        trim_span(&val, &val_len);
-        if (key_len > 0) {
-            duckdb_vector_assign_string_element_len(key_vec, entry.offset + write_idx, key, key_len);
-            duckdb_vector_assign_string_element_len(val_vec, entry.offset + write_idx, val, val_len);
-            write_idx++;
-        }
-        while (*p && *p != ';') p++;
-        if (*p == ';') p++;
+/* Cheap pre-parse filter: compare column 3 against the requested features. */
+static int feature_matches(const tabix_bind_data_t *bd, const char *line, size_t l) {
+    const char *end = line + l;
+    const char *p = line;
+    for (int i = 0; i < GXF_COL_FEATURE; i++) {
+        p = (const char *)memchr(p, '\t', (size_t)(end - p));
+        if (!p) return 0;
+        p++;
     }
+    const char *tab = (const char *)memchr(p, '\t', (size_t)(end - p));
+    int len = (int)((tab ? tab : end) - p);
+    for (int i = 0; i < bd->n_features; i++) {
+        if (bd->feature_lens[i] == len && memcmp(bd->features[i], p, (size_t)len) == 0) return 1;
+    }
+    return 0;
+}
 
-    entry.length = write_idx;
-    duckdb_list_entry *list_data = (duckdb_list_entry *)duckdb_vector_get_data(vec);
-    list_data[row] = entry;
+/* Read a LIST(VARCHAR) named parameter into a string array with lengths. */
+static int read_string_list_param(duckdb_bind_info info, const char *name,
+                                  char ***out, int **out_lens) {
+    *out = NULL;
+    *out_lens = NULL;
+    duckdb_value val = duckdb_bind_get_named_parameter(info, name);
+    if (!val) return 0;
+    int n = 0;
+    if (!duckdb_is_null_value(val)) {
+        idx_t size = duckdb_get_list_size(val);
+        if (size > 0) {
+            *out = (char **)malloc(sizeof(char *) * (size_t)size);
+            *out_lens = (int *)malloc(sizeof(int) * (size_t)size);
+            for (idx_t i = 0; i < size; i++) {
+                duckdb_value elem = duckdb_get_list_child(val, i);
+                char *str = duckdb_is_null_value(elem) ? NULL : duckdb_get_varchar(elem);
+                duckdb_destroy_value(&elem);
+                if (!str) continue;
+                if (str[0]) {
+                    (*out)[n] = strdup(str);
+                    (*out_lens)[n] = (int)strlen(str);
+                    n++;
+                }
+                duckdb_free(str);
+            }
+        }
+    }
+    duckdb_destroy_value(&val);
+    return n;
 }
 
 /* ================================================================
@@ -526,19 +655,30 @@ static void tabix_bind(duckdb_bind_info info, tabix_mode_t mode) {
         return;
     }
 
-    /* named param: region */
+    /* named param: region, with gene/transcript names resolved via annotation */
+    char *r = NULL;
     val = duckdb_bind_get_named_parameter(info, "region");
     if (val) {
         if (duckdb_get_type_id(duckdb_get_value_type(val)) == DUCKDB_TYPE_VARCHAR) {
-            const char *r = duckdb_get_varchar(val);
-            if (r && r[0]) {
-                bd->region = strdup(r);
-                parse_regions(bd->region, &bd->regions, &bd->n_regions);
-            }
-            duckdb_free((void *)r);
+            r = duckdb_get_varchar(val);
         }
         duckdb_destroy_value(&val);
     }
+    {
+        const char *names[] = {"read_tabix", "read_gtf", "read_gff"};
+        char msg[512];
+        if (gff_name_index_bind_regions(info, names[mode], &r, msg, sizeof(msg)) != 0) {
+            duckdb_bind_set_error(info, msg);
+            duckdb_free(r);
+            tabix_bind_data_destroy(bd);
+            return;
+        }
+    }
+    if (r && r[0]) {
+        bd->region = strdup(r);
+        parse_regions(bd->region, &bd->regions, &bd->n_regions);
+    }
+    duckdb_free(r);
 
     /* named param: explicit index path */
     val = duckdb_bind_get_named_parameter(info, "index_path");
@@ -561,18 +701,43 @@ static void tabix_bind(duckdb_bind_info info, tabix_mode_t mode) {
         }
         if (attr_map_val) duckdb_destroy_value(&attr_map_val);
 
+        bd->n_attr_names = read_string_list_param(info, "attributes", &bd->attr_names, &bd->attr_name_lens);
+        bd->n_features = read_string_list_param(info, "feature", &bd->features, &bd->feature_lens);
+        if (bd->n_attr_names > TABIX_MAX_ATTR_COLUMNS) {
+            duckdb_bind_set_error(info, "attributes: too many attribute columns requested");
+            tabix_bind_data_destroy(bd);
+            return;
+        }
+        /* Column names are case-insensitive, so compare that way */
+        for (int i = 0; i < bd->n_attr_names; i++) {
+            const char *clash = NULL;
+            for (int c = 0; c < GXF_COL_ATTRIBUTES_MAP + bd->include_attr_map && !clash; c++) {
+                if (strcasecmp(bd->attr_names[i], GXF_COL_NAMES[c]) == 0) clash = "clashes with a fixed column; read it from attributes_map instead";
+            }
+            for (int j = 0; j < i && !clash; j++) {
+                if (strcasecmp(bd->attr_names[i], bd->attr_names[j]) == 0) clash = "listed more than once";
+            }
+            if (clash) {
+                char msg[256];
+                snprintf(msg, sizeof(msg), "attributes: '%s' %s", bd->attr_names[i], clash);
+                duckdb_bind_set_error(info, msg);
+                tabix_bind_data_destroy(bd);
+                return;
+            }
+        }
+
         duckdb_logical_type gxf_varchar = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
         duckdb_logical_type gxf_bigint = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
         duckdb_logical_type gxf_double = duckdb_create_logical_type(DUCKDB_TYPE_DOUBLE);
-        duckdb_bind_add_result_column(info, "seqname", gxf_varchar);
-        duckdb_bind_add_result_column(info, "source", gxf_varchar);
-        duckdb_bind_add_result_column(info, "feature", gxf_varchar);
-        duckdb_bind_add_result_column(info, "start", gxf_bigint);
-        duckdb_bind_add_result_column(info, "end", gxf_bigint);
-        duckdb_bind_add_result_column(info, "score", gxf_double);
-        duckdb_bind_add_result_column(info, "strand", gxf_varchar);
-        duckdb_bind_add_result_column(info, "frame", gxf_varchar);
-        duckdb_bind_add_result_column(info, "attributes", gxf_varchar);
+        duckdb_bind_add_result_column(info, GXF_COL_NAMES[GXF_COL_SEQNAME], gxf_varchar);
+        duckdb_bind_add_result_column(info, GXF_COL_NAMES[GXF_COL_SOURCE], gxf_varchar);
+        duckdb_bind_add_result_column(info, GXF_COL_NAMES[GXF_COL_FEATURE], gxf_varchar);
+        duckdb_bind_add_result_column(info, GXF_COL_NAMES[GXF_COL_START], gxf_bigint);
+        duckdb_bind_add_result_column(info, GXF_COL_NAMES[GXF_COL_END], gxf_bigint);
+        duckdb_bind_add_result_column(info, GXF_COL_NAMES[GXF_COL_SCORE], gxf_double);
+        duckdb_bind_add_result_column(info, GXF_COL_NAMES[GXF_COL_STRAND], gxf_varchar);
+        duckdb_bind_add_result_column(info, GXF_COL_NAMES[GXF_COL_FRAME], gxf_varchar);
+        duckdb_bind_add_result_column(info, GXF_COL_NAMES[GXF_COL_ATTRIBUTES], gxf_varchar);
         duckdb_destroy_logical_type(&gxf_varchar);
         duckdb_destroy_logical_type(&gxf_bigint);
         duckdb_destroy_logical_type(&gxf_double);
@@ -580,11 +745,19 @@ static void tabix_bind(duckdb_bind_info info, tabix_mode_t mode) {
             duckdb_logical_type key_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
             duckdb_logical_type val_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
             duckdb_logical_type map_type = duckdb_create_map_type(key_type, val_type);
-            duckdb_bind_add_result_column(info, "attributes_map", map_type);
+            duckdb_bind_add_result_column(info, GXF_COL_NAMES[GXF_COL_ATTRIBUTES_MAP], map_type);
             duckdb_destroy_logical_type(&key_type);
             duckdb_destroy_logical_type(&val_type);
             duckdb_destroy_logical_type(&map_type);
         }
+        bd->attr_col_base = GXF_COL_ATTRIBUTES_MAP + bd->include_attr_map;
+        if (bd->n_attr_names > 0) {
+            duckdb_logical_type attr_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+            for (int i = 0; i < bd->n_attr_names; i++) {
+                duckdb_bind_add_result_column(info, bd->attr_names[i], attr_type);
+            }
+            duckdb_destroy_logical_type(&attr_type);
+        }
     } else {
         /* Optional header handling for generic tabix */
         val = duckdb_bind_get_named_parameter(info, "header");
@@ -842,6 +1015,33 @@ static void tabix_init(duckdb_init_info info) {
         id->column_ids = NULL;
     }
 
+    /* Lines are tokenized once per row, only as far as the last column read */
+    id->max_field = 0;
+    if (bd->n_attr_names > 0) {
+        id->attr_vec = (idx_t *)malloc(sizeof(idx_t) * (size_t)bd->n_attr_names);
+        for (int a = 0; a < bd->n_attr_names; a++) id->attr_vec[a] = (idx_t)-1;
+    }
+    for (idx_t i = 0; i < id->n_projected_cols; i++) {
+        int field = (int)id->column_ids[i];
+        if (bd->mode == TABIX_MODE_GTF || bd->mode == TABIX_MODE_GFF) {
+            if (bd->n_attr_names > 0 && field >= bd->attr_col_base) {
+                id->attr_vec[field - bd->attr_col_base] = i;
+                id->n_attr_projected++;
+                field = GXF_COL_ATTRIBUTES;
+            } else if (field == GXF_COL_ATTRIBUTES_MAP) {
+                field = GXF_COL_ATTRIBUTES;
+            }
+        }
+        if (field < bd->n_cols && field > id->max_field) id->max_field = field;
+    }
+    id->field_off = (int *)malloc(sizeof(int) * (size_t)(id->max_field + 1));
+    id->field_len = (int *)malloc(sizeof(int) * (size_t)(id->max_field + 1));
+    if (!id->field_off || !id->field_len) {
+        duckdb_init_set_error(info, "Out of memory");
+        tabix_init_data_destroy(id);
+        return;
+    }
+
     duckdb_init_set_init_data(info, id, tabix_init_data_destroy);
 }
 
@@ -904,39 +1104,45 @@ static void tabix_scan(duckdb_function_info info, duckdb_data_chunk output) {
             id->skipped_header = 1;
             continue;
         }
+        if (bd->n_features > 0 && !feature_matches(bd, id->line.s, id->line.l)) continue;
 
         if (chunk_col_count > 0) {
+        id->n_fields = split_fields(id->line.s, id->line.l, id->max_field,
+                                    id->field_off, id->field_len);
         if (bd->mode == TABIX_MODE_GTF || bd->mode == TABIX_MODE_GFF) {
+            if (id->n_attr_projected > 0) {
+                const char *fld = NULL;
+                int flen = 0;
+                if (GXF_COL_ATTRIBUTES < id->n_fields) {
+                    fld = id->line.s + id->field_off[GXF_COL_ATTRIBUTES];
+                    flen = id->field_len[GXF_COL_ATTRIBUTES];
+                }
+                fill_attr_columns(bd, id, vectors, row_count, fld, flen);
+            }
             /* Parse GTF/GFF columns with projection pushdown:
              * Vector index c maps to logical column id->column_ids[c],
              * which is the field index in the TSV line. */
             for (idx_t c = 0; c < chunk_col_count; c++) {
                 int logical_col = (int)id->column_ids[c];
+                if (bd->n_attr_names > 0 && logical_col >= bd->attr_col_base) continue;
                 if (logical_col == GXF_COL_ATTRIBUTES_MAP && bd->include_attr_map) {
                     const char *fld = NULL;
                     int flen = 0;
-                    fld = get_field(id->line.s, GXF_COL_ATTRIBUTES, &flen);
-                        char *tmp = NULL;
-                        if (fld && flen > 0) {
-                            tmp = (char *)malloc((size_t)flen + 1);
-                            if (!tmp) {
-                                duckdb_function_set_error(info, "tabix_scan: out of memory parsing attributes");
-                                id->finished = true;
-                                if (vectors) free(vectors);
-                                duckdb_data_chunk_set_size(output, 0);
-                                return;
-                            }
-                            memcpy(tmp, fld, (size_t)flen);
-                            tmp[flen] = '\0';
-                        }
-                        fill_attr_map(vectors[c], row_count, tmp ? tmp : ".", bd->mode == TABIX_MODE_GFF);
-                        if (tmp) free(tmp);
-                        continue;
+                    if (GXF_COL_ATTRIBUTES < id->n_fields) {
+                        fld = id->line.s + id->field_off[GXF_COL_ATTRIBUTES];
+                        flen = id->field_len[GXF_COL_ATTRIBUTES];
                     }
+                    fill_attr_map(vectors[c], row_count, fld, flen, bd->mode == TABIX_MODE_GFF);
+                    continue;
+                }
                 if (logical_col >= GXF_COL_COUNT - 1) continue;
 
                 int flen = 0;
-                const char *fld = get_field(id->line.s, logical_col, &flen);
+                const char *fld = NULL;
+                if (logical_col < id->n_fields) {
+                    fld = id->line.s + id->field_off[logical_col];
+                    flen = id->field_len[logical_col];
+                }
 
                 if (!fld || flen == 0 || (flen == 1 && fld[0] == '.')) {
                     /* Missing value */
@@ -995,7 +1201,11 @@ static void tabix_scan(duckdb_function_info info, duckdb_data_chunk output) {
                 int logical_col = (int)id->column_ids[c];
                 if (logical_col >= n_cols) continue;
                 int flen = 0;
-                const char *fld = get_field(id->line.s, logical_col, &flen);
+                const char *fld = NULL;
+                if (logical_col < id->n_fields) {
+                    fld = id->line.s + id->field_off[logical_col];
+                    flen = id->field_len[logical_col];
+                }
                 if (!fld || flen == 0 || (flen == 1 && fld[0] == '.')) {
                     set_null(vectors[c], row_count);
                     continue;
@@ -1044,6 +1254,10 @@ static duckdb_table_function create_tabix_tf(const char *name,
     duckdb_table_function_add_parameter(tf, varchar_type);
     duckdb_table_function_add_named_parameter(tf, "region", varchar_type);
     duckdb_table_function_add_named_parameter(tf, "index_path", varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "annotation", varchar_type);
+    duckdb_logical_type genes_type = duckdb_create_list_type(varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "genes", genes_type);
+    duckdb_destroy_logical_type(&genes_type);
     duckdb_destroy_logical_type(&varchar_type);
 
     duckdb_logical_type bool_type = duckdb_create_logical_type(DUCKDB_TYPE_BOOLEAN);
@@ -1067,6 +1281,10 @@ static duckdb_table_function create_tabix_tf(const char *name,
     duckdb_logical_type types_child = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
     duckdb_logical_type types_list = duckdb_create_list_type(types_child);
     duckdb_table_function_add_named_parameter(tf, "column_types", types_list);
+    if (bind_fn != read_tabix_bind) {
+        duckdb_table_function_add_named_parameter(tf, "attributes", types_list);
+        duckdb_table_function_add_named_parameter(tf, "feature", types_list);
+    }
     duckdb_destroy_logical_type(&types_child);
     duckdb_destroy_logical_type(&types_list);
 
@@ -1095,3 +1313,1699 @@ void register_read_gff_function(duckdb_connection connection) {
     duckdb_register_table_function(connection, tf);
     duckdb_destroy_table_function(&tf);
 }
+
+/* ================================================================
+ * gff_models  (transcript models resolved from GFF3 / GTF)
+ * ================================================================
+ *
+ * gff_models(path, [region, index_path]) streams an annotation once per work
+ * item and emits one row per transcript with its exons, CDS, derived UTRs and
+ * introns as LIST(STRUCT(start, end)) columns (1-based, closed, genomic
+ * order). GFF3 hierarchies are resolved through ID/Parent, GTF through
+ * gene_id/transcript_id. Work items are the index's contigs (or the
+ * requested regions), so indexed files are resolved in parallel; features of
+ * one transcript never span contigs.
+ */
+
+KHASH_MAP_INIT_STR(gffid, int)
+
+#define GFF_MODELS_MAX_THREADS 16
+
+enum {
+    GFFM_COL_SEQNAME = 0,
+    GFFM_COL_GENE_ID,
+    GFFM_COL_GENE_NAME,
+    GFFM_COL_GENE_BIOTYPE,
+    GFFM_COL_TRANSCRIPT_ID,
+    GFFM_COL_TRANSCRIPT_NAME,
+    GFFM_COL_TRANSCRIPT_BIOTYPE,
+    GFFM_COL_FEATURE,
+    GFFM_COL_STRAND,
+    GFFM_COL_START,
+    GFFM_COL_END,
+    GFFM_COL_CDS_START,
+    GFFM_COL_CDS_END,
+    GFFM_COL_EXONS,
+    GFFM_COL_CDS,
+    GFFM_COL_FIVE_PRIME_UTR,
+    GFFM_COL_THREE_PRIME_UTR,
+    GFFM_COL_INTRONS,
+    GFFM_COL_COUNT
+};
+
+typedef struct {
+    int64_t start;
+    int64_t end;
+} gff_span_t;
+
+typedef struct {
+    gff_span_t *v;
+    int n, m;
+} gff_span_vec_t;
+
+/* GFF3 feature carrying an ID (genes, transcripts) */
+typedef struct {
+    char *id;
+    char *parent;
+    char *name;
+    char *type;
+    char *biotype;
+    int64_t start, end;
+} gff_node_t;
+
+typedef struct {
+    char *id;
+    char *seqname;
+    char *gene_id;
+    char *gene_name;
+    char *gene_biotype;
+    char *name;
+    char *biotype;
+    char *feature;
+    char strand;
+    int64_t start, end;
+    gff_span_vec_t exons;
+    gff_span_vec_t cds;
+    gff_span_vec_t stop_codons;  /* GTF stop_codon lines (outside CDS there) */
+    int cds_phase;               /* frame of the 5'-most CDS piece */
+    int64_t cds_phase_pos;
+} gff_tx_t;
+
+typedef struct {
+    char *file_path;
+    char *index_path;
+    int is_gff3;
+    int use_index;
+    char **items;          /* contigs or regions; NULL entry = whole file */
+    int n_items;
+} gffm_bind_data_t;
+
+typedef struct {
+    volatile int next_item;
+} gffm_global_data_t;
+
+typedef struct {
+    htsFile *fp;
+    tbx_t *tbx;
+    kstring_t line;
+    gff_node_t *nodes;
+    int n_nodes, m_nodes;
+    khash_t(gffid) *node_hash;
+    gff_tx_t *txs;
+    int n_txs, m_txs;
+    khash_t(gffid) *tx_hash;
+    int emit_idx;
+    int finished;
+    idx_t *column_ids;
+    idx_t n_projected_cols;
+} gffm_local_data_t;
+
+static char *span_dup(const char *s, int len) {
+    char *out = (char *)malloc((size_t)len + 1);
+    if (!out) return NULL;
+    memcpy(out, s, (size_t)len);
+    out[len] = '\0';
+    return out;
+}
+
+static void span_push(gff_span_vec_t *vec, int64_t start, int64_t end) {
+    if (vec->n == vec->m) {
+        vec->m = vec->m ? vec->m * 2 : 8;
+        vec->v = (gff_span_t *)realloc(vec->v, sizeof(gff_span_t) * (size_t)vec->m);
+    }
+    vec->v[vec->n].start = start;
+    vec->v[vec->n].end = end;
+    vec->n++;
+}
+
+static int span_cmp(const void *a, const void *b) {
+    const gff_span_t *x = (const gff_span_t *)a;
+    const gff_span_t *y = (const gff_span_t *)b;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    if (x->end != y->end) return x->end < y->end ? -1 : 1;
+    return 0;
+}
+
+static void gffm_free_tx(gff_tx_t *t) {
+    free(t->id);
+    free(t->seqname);
+    free(t->gene_id);
+    free(t->gene_name);
+    free(t->gene_biotype);
+    free(t->name);
+    free(t->biotype);
+    free(t->feature);
+    free(t->exons.v);
+    free(t->cds.v);
+    free(t->stop_codons.v);
+}
+
+static void gffm_reset_models(gffm_local_data_t *local) {
+    for (int i = 0; i < local->n_nodes; i++) {
+        gff_node_t *n = &local->nodes[i];
+        free(n->id);
+        free(n->parent);
+        free(n->name);
+        free(n->type);
+        free(n->biotype);
+    }
+    for (int i = 0; i < local->n_txs; i++) gffm_free_tx(&local->txs[i]);
+    local->n_nodes = 0;
+    local->n_txs = 0;
+    local->emit_idx = 0;
+    if (local->node_hash) kh_clear(gffid, local->node_hash);
+    if (local->tx_hash) kh_clear(gffid, local->tx_hash);
+}
+
+static void gffm_bind_data_destroy(void *data) {
+    gffm_bind_data_t *bd = (gffm_bind_data_t *)data;
+    if (!bd) return;
+    free(bd->file_path);
+    free(bd->index_path);
+    for (int i = 0; i < bd->n_items; i++) free(bd->items[i]);
+    free(bd->items);
+    free(bd);
+}
+
+static void gffm_local_data_destroy(void *data) {
+    gffm_local_data_t *local = (gffm_local_data_t *)data;
+    if (!local) return;
+    gffm_reset_models(local);
+    free(local->nodes);
+    free(local->txs);
+    if (local->node_hash) kh_destroy(gffid, local->node_hash);
+    if (local->tx_hash) kh_destroy(gffid, local->tx_hash);
+    if (local->tbx) tbx_destroy(local->tbx);
+    if (local->fp) hts_close(local->fp);
+    free(local->line.s);
+    free(local->column_ids);
+    free(local);
+}
+
+/* Find or create the transcript keyed by id (span, not NUL-terminated). */
+static gff_tx_t *gffm_get_tx(gffm_local_data_t *local, const char *id, int id_len) {
+    char *key = span_dup(id, id_len);
+    if (!key) return NULL;
+    khint_t k = kh_get(gffid, local->tx_hash, key);
+    if (k != kh_end(local->tx_hash)) {
+        free(key);
+        return &local->txs[kh_val(local->tx_hash, k)];
+    }
+    if (local->n_txs == local->m_txs) {
+        local->m_txs = local->m_txs ? local->m_txs * 2 : 256;
+        local->txs = (gff_tx_t *)realloc(local->txs, sizeof(gff_tx_t) * (size_t)local->m_txs);
+    }
+    gff_tx_t *tx = &local->txs[local->n_txs];
+    memset(tx, 0, sizeof(*tx));
+    tx->id = key;
+    int absent = 0;
+    k = kh_put(gffid, local->tx_hash, tx->id, &absent);
+    kh_val(local->tx_hash, k) = local->n_txs++;
+    return tx;
+}
+
+static void set_once(char **dst, const char *s, int len) {
+    if (!*dst && s && len > 0) *dst = span_dup(s, len);
+}
+
+static int span_eq(const char *s, int len, const char *lit) {
+    return (int)strlen(lit) == len && memcmp(s, lit, (size_t)len) == 0;
+}
+
+static int is_biotype_key(const char *key, int key_len, int gene_level) {
+    if (gene_level) {
+        return span_eq(key, key_len, "gene_biotype") || span_eq(key, key_len, "gene_type");
+    }
+    return span_eq(key, key_len, "transcript_biotype") || span_eq(key, key_len, "transcript_type");
+}
+
+/* Keep the frame of the 5'-most CDS piece; coding offsets count from it. */
+static void gffm_note_cds_phase(gff_tx_t *tx, int64_t start, int64_t end, const char *frame, int frame_len) {
+    int minus = tx->strand == '-';
+    int64_t pos = minus ? end : start;
+    if (tx->cds.n > 0 && (minus ? pos <= tx->cds_phase_pos : pos >= tx->cds_phase_pos)) return;
+    tx->cds_phase_pos = pos;
+    tx->cds_phase = frame_len == 1 && frame[0] >= '0' && frame[0] <= '2' ? frame[0] - '0' : 0;
+}
+
+static void gffm_add_span(gff_tx_t *tx, int kind, int64_t start, int64_t end, const char *frame, int frame_len) {
+    if (kind == 1) {
+        span_push(&tx->exons, start, end);
+    } else if (kind == 2) {
+        gffm_note_cds_phase(tx, start, end, frame, frame_len);
+        span_push(&tx->cds, start, end);
+    } else {
+        span_push(&tx->stop_codons, start, end);
+    }
+}
+
+static void gffm_process_line(const gffm_bind_data_t *bd, gffm_local_data_t *local) {
+    int off[GXF_COL_ATTRIBUTES + 1], len[GXF_COL_ATTRIBUTES + 1];
+    const char *s = local->line.s;
+    if (split_fields(s, local->line.l, GXF_COL_ATTRIBUTES, off, len) <= GXF_COL_ATTRIBUTES) return;
+
+    const char *type = s + off[GXF_COL_FEATURE];
+    int type_len = len[GXF_COL_FEATURE];
+    int64_t start = 0, end = 0;
+    if (!parse_int64_span(s + off[GXF_COL_START], len[GXF_COL_START], &start) ||
+        !parse_int64_span(s + off[GXF_COL_END], len[GXF_COL_END], &end)) {
+        return;
+    }
+    char strand = len[GXF_COL_STRAND] > 0 ? s[off[GXF_COL_STRAND]] : '.';
+    /* 1 exon, 2 CDS, 3 stop_codon, 0 anything else */
+    int kind = span_eq(type, type_len, "exon") ? 1 : span_eq(type, type_len, "CDS") ? 2
+             : span_eq(type, type_len, "stop_codon") ? 3 : 0;
+    const char *frame = s + off[GXF_COL_FRAME];
+    int frame_len = len[GXF_COL_FRAME];
+
+    const char *p = s + off[GXF_COL_ATTRIBUTES];
+    const char *attr_end = p + len[GXF_COL_ATTRIBUTES];
+    const char *key, *val;
+    int key_len, val_len;
+
+    if (bd->is_gff3) {
+        const char *id = NULL, *parent = NULL, *name = NULL, *biotype = NULL;
+        int id_len = 0, parent_len = 0, name_len = 0, biotype_len = 0;
+        while (next_attr_pair(&p, attr_end, true, &key, &key_len, &val, &val_len)) {
+            if (span_eq(key, key_len, "ID")) { id = val; id_len = val_len; }
+            else if (span_eq(key, key_len, "Parent")) { parent = val; parent_len = val_len; }
+            else if (span_eq(key, key_len, "Name")) { name = val; name_len = val_len; }
+            else if (!biotype && (span_eq(key, key_len, "biotype") || is_biotype_key(key, key_len, 0) ||
+                                  is_biotype_key(key, key_len, 1))) {
+                biotype = val;
+                biotype_len = val_len;
+            }
+        }
+        if (kind) {
+            /* Parent may list several transcripts separated by ',' */
+            const char *pp = parent;
+            const char *pend = parent ? parent + parent_len : NULL;
+            while (pp && pp < pend) {
+                const char *comma = (const char *)memchr(pp, ',', (size_t)(pend - pp));
+                int plen = (int)((comma ? comma : pend) - pp);
+                if (plen > 0) {
+                    gff_tx_t *tx = gffm_get_tx(local, pp, plen);
+                    if (tx) {
+                        set_once(&tx->seqname, s + off[GXF_COL_SEQNAME], len[GXF_COL_SEQNAME]);
+                        if (!tx->strand) tx->strand = strand;
+                        gffm_add_span(tx, kind, start, end, frame, frame_len);
+                    }
+                }
+                pp = comma ? comma + 1 : pend;
+            }
+        } else if (id && id_len > 0) {
+            if (local->n_nodes == local->m_nodes) {
+                local->m_nodes = local->m_nodes ? local->m_nodes * 2 : 256;
+                local->nodes = (gff_node_t *)realloc(local->nodes, sizeof(gff_node_t) * (size_t)local->m_nodes);
+            }
+            gff_node_t *node = &local->nodes[local->n_nodes];
+            memset(node, 0, sizeof(*node));
+            node->id = span_dup(id, id_len);
+            int absent = 0;
+            khint_t k = kh_put(gffid, local->node_hash, node->id, &absent);
+            if (!absent) {
+                /* Duplicate ID (multi-line feature): keep the first */
+                free(node->id);
+                return;
+            }
+            kh_val(local->node_hash, k) = local->n_nodes++;
+            if (parent && parent_len > 0) {
+                const char *comma = (const char *)memchr(parent, ',', (size_t)parent_len);
+                node->parent = span_dup(parent, comma ? (int)(comma - parent) : parent_len);
+            }
+            set_once(&node->name, name, name_len);
+            set_once(&node->type, type, type_len);
+            set_once(&node->biotype, biotype, biotype_len);
+            node->start = start;
+            node->end = end;
+        }
+        return;
+    }
+
+    /* GTF: every line carries its gene_id / transcript_id */
+    const char *tx_id = NULL;
+    int tx_id_len = 0;
+    const char *attr_start = p;
+    while (next_attr_pair(&p, attr_end, false, &key, &key_len, &val, &val_len)) {
+        if (span_eq(key, key_len, "transcript_id")) {
+            tx_id = val;
+            tx_id_len = val_len;
+            break;
+        }
+    }
+    if (!tx_id || tx_id_len == 0) return;
+    gff_tx_t *tx = gffm_get_tx(local, tx_id, tx_id_len);
+    if (!tx) return;
+    set_once(&tx->seqname, s + off[GXF_COL_SEQNAME], len[GXF_COL_SEQNAME]);
+    if (!tx->strand) tx->strand = strand;
+    p = attr_start;
+    while (next_attr_pair(&p, attr_end, false, &key, &key_len, &val, &val_len)) {
+        if (span_eq(key, key_len, "gene_id")) set_once(&tx->gene_id, val, val_len);
+        else if (span_eq(key, key_len, "gene_name")) set_once(&tx->gene_name, val, val_len);
+        else if (span_eq(key, key_len, "transcript_name")) set_once(&tx->name, val, val_len);
+        else if (is_biotype_key(key, key_len, 1)) set_once(&tx->gene_biotype, val, val_len);
+        else if (is_biotype_key(key, key_len, 0)) set_once(&tx->biotype, val, val_len);
+    }
+    if (span_eq(type, type_len, "transcript")) {
+        set_once(&tx->feature, type, type_len);
+        tx->start = start;
+        tx->end = end;
+    } else if (kind) {
+        gffm_add_span(tx, kind, start, end, frame, frame_len);
+    }
+}
+
+static const gff_node_t *gffm_find_node(const gffm_local_data_t *local, const char *id) {
+    if (!id) return NULL;
+    khint_t k = kh_get(gffid, local->node_hash, id);
+    return k == kh_end(local->node_hash) ? NULL : &local->nodes[kh_val(local->node_hash, k)];
+}
+
+static int tx_cmp(const void *a, const void *b) {
+    const gff_tx_t *x = (const gff_tx_t *)a;
+    const gff_tx_t *y = (const gff_tx_t *)b;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    if (x->end != y->end) return x->end < y->end ? -1 : 1;
+    return strcmp(x->id, y->id);
+}
+
+/* Merge GTF stop_codon pieces into the CDS, which GTF leaves out of it, so
+ * CDS bounds and UTRs match the same annotation in GFF3. */
+static void gffm_merge_stop_codons(gff_tx_t *tx) {
+    if (tx->stop_codons.n == 0 || tx->cds.n == 0) return;
+    for (int i = 0; i < tx->stop_codons.n; i++) {
+        span_push(&tx->cds, tx->stop_codons.v[i].start, tx->stop_codons.v[i].end);
+    }
+    qsort(tx->cds.v, (size_t)tx->cds.n, sizeof(gff_span_t), span_cmp);
+    int k = 0;
+    for (int i = 1; i < tx->cds.n; i++) {
+        if (tx->cds.v[i].start <= tx->cds.v[k].end + 1) {
+            if (tx->cds.v[i].end > tx->cds.v[k].end) tx->cds.v[k].end = tx->cds.v[i].end;
+        } else {
+            tx->cds.v[++k] = tx->cds.v[i];
+        }
+    }
+    tx->cds.n = k + 1;
+}
+
+/* Attach GFF3 transcript/gene nodes, fill bounds and sort for emission. */
+static void gffm_resolve(const gffm_bind_data_t *bd, gffm_local_data_t *local) {
+    for (int i = 0; i < local->n_txs; i++) {
+        gff_tx_t *tx = &local->txs[i];
+        if (bd->is_gff3) {
+            const gff_node_t *node = gffm_find_node(local, tx->id);
+            if (node) {
+                tx->start = node->start;
+                tx->end = node->end;
+                if (node->type) tx->feature = strdup(node->type);
+                if (node->name) tx->name = strdup(node->name);
+                if (node->biotype) tx->biotype = strdup(node->biotype);
+                const gff_node_t *gene = gffm_find_node(local, node->parent);
+                if (node->parent) tx->gene_id = strdup(node->parent);
+                if (gene && gene->name) tx->gene_name = strdup(gene->name);
+                if (gene && gene->biotype) tx->gene_biotype = strdup(gene->biotype);
+            }
+        }
+        if (tx->exons.n > 1) qsort(tx->exons.v, (size_t)tx->exons.n, sizeof(gff_span_t), span_cmp);
+        if (tx->cds.n > 1) qsort(tx->cds.v, (size_t)tx->cds.n, sizeof(gff_span_t), span_cmp);
+        gffm_merge_stop_codons(tx);
+        if (tx->start == 0 && tx->end == 0) {
+            /* No transcript line: bounds from the children */
+            gff_span_vec_t *vecs[2] = {&tx->exons, &tx->cds};
+            for (int v = 0; v < 2; v++) {
+                for (int j = 0; j < vecs[v]->n; j++) {
+                    if (tx->start == 0 || vecs[v]->v[j].start < tx->start) tx->start = vecs[v]->v[j].start;
+                    if (vecs[v]->v[j].end > tx->end) tx->end = vecs[v]->v[j].end;
+                }
+            }
+        }
+    }
+    if (local->n_txs > 1) {
+        /* Reorder; the hash indices are stale afterwards and no longer used */
+        qsort(local->txs, (size_t)local->n_txs, sizeof(gff_tx_t), tx_cmp);
+    }
+}
+
+/* Keep only transcripts overlapping [beg, end) (0-based, half-open). */
+static void gffm_filter_overlap(gffm_local_data_t *local, hts_pos_t beg, hts_pos_t end) {
+    int kept = 0;
+    for (int i = 0; i < local->n_txs; i++) {
+        gff_tx_t *tx = &local->txs[i];
+        if (tx->start <= end && tx->end > beg) {
+            if (kept != i) local->txs[kept] = *tx;
+            kept++;
+        } else {
+            gffm_free_tx(tx);
+        }
+    }
+    local->n_txs = kept;
+}
+
+/* Stream one work item into the model store. Returns 0 or -1 on error.
+ * A region item loads its whole contig so that transcripts crossing the
+ * region boundary keep all their exons, then drops the non-overlapping
+ * ones. */
+static int gffm_load_item(const gffm_bind_data_t *bd, gffm_local_data_t *local, const char *item) {
+    hts_itr_t *itr = NULL;
+    hts_pos_t beg = 0, end = HTS_POS_MAX;
+    if (item) {
+        int tid = -1;
+        if (!hts_parse_region(item, &tid, &beg, &end, (hts_name2id_f)tbx_name2id, local->tbx,
+                              HTS_PARSE_THOUSANDS_SEP) || tid < 0) {
+            return 0;  /* contig absent from the index */
+        }
+        itr = tbx_itr_queryi(local->tbx, tid, 0, HTS_POS_MAX);
+        if (!itr) return 0;
+    }
+    int ret;
+    while ((ret = itr ? tbx_itr_next(local->fp, local->tbx, itr, &local->line)
+                      : hts_getline(local->fp, '\n', &local->line)) >= 0) {
+        if (local->line.l == 0) continue;
+        if (local->line.s[0] == '#') {
+            if (!itr && strncmp(local->line.s, "##FASTA", 7) == 0) break;
+            continue;
+        }
+        gffm_process_line(bd, local);
+    }
+    if (itr) hts_itr_destroy(itr);
+    gffm_resolve(bd, local);
+    if (beg > 0 || end < HTS_POS_MAX) gffm_filter_overlap(local, beg, end);
+    return ret < -1 ? -1 : 0;
+}
+
+static int gffm_detect_gff3(const char *path) {
+    htsFile *fp = hts_open(path, "r");
+    if (!fp) return -1;
+    kstring_t line = {0, 0, NULL};
+    int is_gff3 = 1;
+    while (hts_getline(fp, '\n', &line) >= 0) {
+        if (line.l == 0) continue;
+        if (line.s[0] == '#') {
+            if (strncmp(line.s, "##gff-version", 13) == 0) break;
+            continue;
+        }
+        int off[GXF_COL_ATTRIBUTES + 1], len[GXF_COL_ATTRIBUTES + 1];
+        if (split_fields(line.s, line.l, GXF_COL_ATTRIBUTES, off, len) <= GXF_COL_ATTRIBUTES) continue;
+        /* GFF3 attributes are key=value; GTF ones are key "value" */
+        const char *attr = line.s + off[GXF_COL_ATTRIBUTES];
+        const char *eq = (const char *)memchr(attr, '=', (size_t)len[GXF_COL_ATTRIBUTES]);
+        const char *sp = (const char *)memchr(attr, ' ', (size_t)len[GXF_COL_ATTRIBUTES]);
+        is_gff3 = eq && (!sp || eq < sp);
+        break;
+    }
+    free(line.s);
+    hts_close(fp);
+    return is_gff3;
+}
+
+static void gffm_bind(duckdb_bind_info info) {
+    gffm_bind_data_t *bd = calloc(1, sizeof(gffm_bind_data_t));
+    if (!bd) {
+        duckdb_bind_set_error(info, "Out of memory");
+        return;
+    }
+
+    duckdb_value val = duckdb_bind_get_parameter(info, 0);
+    char *path = duckdb_get_varchar(val);
+    duckdb_destroy_value(&val);
+    if (path && path[0]) bd->file_path = strdup(path);
+    duckdb_free(path);
+    if (!bd->file_path) {
+        duckdb_bind_set_error(info, "gff_models requires a file path");
+        gffm_bind_data_destroy(bd);
+        return;
+    }
+
+    val = duckdb_bind_get_named_parameter(info, "index_path");
+    if (val) {
+        char *idx = duckdb_is_null_value(val) ? NULL : duckdb_get_varchar(val);
+        if (idx && idx[0]) bd->index_path = strdup(idx);
+        duckdb_free(idx);
+        duckdb_destroy_value(&val);
+    }
+
+    char *region = NULL;
+    val = duckdb_bind_get_named_parameter(info, "region");
+    if (val) {
+        char *r = duckdb_is_null_value(val) ? NULL : duckdb_get_varchar(val);
+        if (r && r[0]) region = strdup(r);
+        duckdb_free(r);
+        duckdb_destroy_value(&val);
+    }
+
+    bd->is_gff3 = gffm_detect_gff3(bd->file_path);
+    if (bd->is_gff3 < 0) {
+        char msg[512];
+        snprintf(msg, sizeof(msg), "Cannot open file: %s", bd->file_path);
+        duckdb_bind_set_error(info, msg);
+        free(region);
+        gffm_bind_data_destroy(bd);
+        return;
+    }
+
+    tbx_t *tbx = tbx_index_load3(bd->file_path, bd->index_path, HTS_IDX_SILENT_FAIL);
+    if (region) {
+        unsigned int n_regions = 0;
+        if (!tbx) {
+            char msg[512];
+            snprintf(msg, sizeof(msg), "Region query requested but no tabix index found for: %s", bd->file_path);
+            duckdb_bind_set_error(info, msg);
+            free(region);
+            gffm_bind_data_destroy(bd);
+            return;
+        }
+        parse_regions(region, &bd->items, &n_regions);
+        bd->n_items = (int)n_regions;
+        bd->use_index = 1;
+        if (n_regions > 1) {
+            vcf_emit_warning("gff_models resolves each region separately; transcripts overlapping several regions are returned once per region");
+        }
+    } else if (tbx) {
+        int n = 0;
+        const char **names = tbx_seqnames(tbx, &n);
+        bd->items = (char **)malloc(sizeof(char *) * (size_t)(n > 0 ? n : 1));
+        for (int i = 0; i < n; i++) bd->items[i] = strdup(names[i]);
+        bd->n_items = n;
+        bd->use_index = 1;
+        free(names);
+    } else {
+        bd->items = (char **)malloc(sizeof(char *));
+        bd->items[0] = NULL;
+        bd->n_items = 1;
+    }
+    if (tbx) tbx_destroy(tbx);
+    free(region);
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_logical_type span_members[2] = {bigint_type, bigint_type};
+    const char *span_names[2] = {"start", "end"};
+    duckdb_logical_type span_type = duckdb_create_struct_type(span_members, span_names, 2);
+    duckdb_logical_type span_list = duckdb_create_list_type(span_type);
+
+    duckdb_bind_add_result_column(info, "seqname", varchar_type);
+    duckdb_bind_add_result_column(info, "gene_id", varchar_type);
+    duckdb_bind_add_result_column(info, "gene_name", varchar_type);
+    duckdb_bind_add_result_column(info, "gene_biotype", varchar_type);
+    duckdb_bind_add_result_column(info, "transcript_id", varchar_type);
+    duckdb_bind_add_result_column(info, "transcript_name", varchar_type);
+    duckdb_bind_add_result_column(info, "transcript_biotype", varchar_type);
+    duckdb_bind_add_result_column(info, "feature", varchar_type);
+    duckdb_bind_add_result_column(info, "strand", varchar_type);
+    duckdb_bind_add_result_column(info, "start", bigint_type);
+    duckdb_bind_add_result_column(info, "end", bigint_type);
+    duckdb_bind_add_result_column(info, "cds_start", bigint_type);
+    duckdb_bind_add_result_column(info, "cds_end", bigint_type);
+    duckdb_bind_add_result_column(info, "exons", span_list);
+    duckdb_bind_add_result_column(info, "cds", span_list);
+    duckdb_bind_add_result_column(info, "five_prime_utr", span_list);
+    duckdb_bind_add_result_column(info, "three_prime_utr", span_list);
+    duckdb_bind_add_result_column(info, "introns", span_list);
+
+    duckdb_destroy_logical_type(&span_list);
+    duckdb_destroy_logical_type(&span_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_logical_type(&varchar_type);
+
+    duckdb_bind_set_bind_data(info, bd, gffm_bind_data_destroy);
+}
+
+static void gffm_global_init(duckdb_init_info info) {
+    gffm_bind_data_t *bd = (gffm_bind_data_t *)duckdb_init_get_bind_data(info);
+    gffm_global_data_t *global = calloc(1, sizeof(gffm_global_data_t));
+    if (!global) {
+        duckdb_init_set_error(info, "Out of memory");
+        return;
+    }
+    idx_t max_threads = (idx_t)bd->n_items;
+    if (max_threads > GFF_MODELS_MAX_THREADS) max_threads = GFF_MODELS_MAX_THREADS;
+    if (max_threads < 1) max_threads = 1;
+    duckdb_init_set_max_threads(info, max_threads);
+    duckdb_init_set_init_data(info, global, free);
+}
+
+static void gffm_local_init(duckdb_init_info info) {
+    gffm_bind_data_t *bd = (gffm_bind_data_t *)duckdb_init_get_bind_data(info);
+    gffm_local_data_t *local = calloc(1, sizeof(gffm_local_data_t));
+    if (!local) {
+        duckdb_init_set_error(info, "Out of memory");
+        return;
+    }
+    local->fp = hts_open(bd->file_path, "r");
+    if (local->fp && bd->use_index) {
+        local->tbx = tbx_index_load3(bd->file_path, bd->index_path, HTS_IDX_SILENT_FAIL);
+    }
+    if (!local->fp || (bd->use_index && !local->tbx)) {
+        char msg[512];
+        snprintf(msg, sizeof(msg), "Cannot open file: %s", bd->file_path);
+        duckdb_init_set_error(info, msg);
+        gffm_local_data_destroy(local);
+        return;
+    }
+    local->node_hash = kh_init(gffid);
+    local->tx_hash = kh_init(gffid);
+
+    local->n_projected_cols = duckdb_init_get_column_count(info);
+    local->column_ids = (idx_t *)malloc(sizeof(idx_t) * (local->n_projected_cols ? local->n_projected_cols : 1));
+    for (idx_t i = 0; i < local->n_projected_cols; i++) {
+        local->column_ids[i] = duckdb_init_get_column_index(info, i);
+    }
+    duckdb_init_set_init_data(info, local, gffm_local_data_destroy);
+}
+
+static void write_opt_string(duckdb_vector vec, idx_t row, const char *s) {
+    if (s) duckdb_vector_assign_string_element(vec, row, s);
+    else set_null(vec, row);
+}
+
+/* Append spans to a LIST(STRUCT(start, end)) vector; empty lists stay []. */
+static void write_span_list(duckdb_vector vec, idx_t row, const gff_span_t *spans, int n) {
+    duckdb_list_entry entry;
+    entry.offset = duckdb_list_vector_get_size(vec);
+    entry.length = (uint64_t)n;
+    if (n > 0) {
+        duckdb_list_vector_reserve(vec, entry.offset + entry.length);
+        duckdb_list_vector_set_size(vec, entry.offset + entry.length);
+        duckdb_vector child = duckdb_list_vector_get_child(vec);
+        int64_t *starts = (int64_t *)duckdb_vector_get_data(duckdb_struct_vector_get_child(child, 0));
+        int64_t *ends = (int64_t *)duckdb_vector_get_data(duckdb_struct_vector_get_child(child, 1));
+        for (int i = 0; i < n; i++) {
+            starts[entry.offset + i] = spans[i].start;
+            ends[entry.offset + i] = spans[i].end;
+        }
+    }
+    ((duckdb_list_entry *)duckdb_vector_get_data(vec))[row] = entry;
+}
+
+/* Derive UTR pieces (exon parts outside the CDS extent) and introns. */
+static void gffm_derive(const gff_tx_t *tx, gff_span_vec_t *left, gff_span_vec_t *right,
+                        gff_span_vec_t *introns) {
+    left->n = right->n = introns->n = 0;
+    for (int i = 0; i + 1 < tx->exons.n; i++) {
+        if (tx->exons.v[i + 1].start > tx->exons.v[i].end + 1) {
+            span_push(introns, tx->exons.v[i].end + 1, tx->exons.v[i + 1].start - 1);
+        }
+    }
+    if (tx->cds.n == 0) return;
+    int64_t cds_start = tx->cds.v[0].start;
+    int64_t cds_end = tx->cds.v[tx->cds.n - 1].end;
+    for (int i = 1; i < tx->cds.n; i++) {
+        if (tx->cds.v[i].end > cds_end) cds_end = tx->cds.v[i].end;
+    }
+    for (int i = 0; i < tx->exons.n; i++) {
+        const gff_span_t *e = &tx->exons.v[i];
+        if (e->start < cds_start) span_push(left, e->start, e->end < cds_start ? e->end : cds_start - 1);
+        if (e->end > cds_end) span_push(right, e->start > cds_end ? e->start : cds_end + 1, e->end);
+    }
+}
+
+static void gffm_scan(duckdb_function_info info, duckdb_data_chunk output) {
+    gffm_bind_data_t *bd = (gffm_bind_data_t *)duckdb_function_get_bind_data(info);
+    gffm_global_data_t *global = (gffm_global_data_t *)duckdb_function_get_init_data(info);
+    gffm_local_data_t *local = (gffm_local_data_t *)duckdb_function_get_local_init_data(info);
+    gff_span_vec_t left = {0}, right = {0}, introns = {0};
+    idx_t row_count = 0;
+    idx_t capacity = duckdb_vector_size();
+
+    while (row_count < capacity && !local->finished) {
+        if (local->emit_idx >= local->n_txs) {
+            gffm_reset_models(local);
+            int item = __sync_fetch_and_add(&global->next_item, 1);
+            if (item >= bd->n_items) {
+                local->finished = 1;
+                break;
+            }
+            if (gffm_load_item(bd, local, bd->items[item]) != 0) {
+                duckdb_function_set_error(info, "gff_models: error reading annotation file");
+                local->finished = 1;
+                break;
+            }
+            continue;
+        }
+
+        const gff_tx_t *tx = &local->txs[local->emit_idx++];
+        gffm_derive(tx, &left, &right, &introns);
+        int minus = tx->strand == '-';
+        for (idx_t c = 0; c < local->n_projected_cols; c++) {
+            duckdb_vector vec = duckdb_data_chunk_get_vector(output, c);
+            switch (local->column_ids[c]) {
+                case GFFM_COL_SEQNAME: write_opt_string(vec, row_count, tx->seqname); break;
+                case GFFM_COL_GENE_ID: write_opt_string(vec, row_count, tx->gene_id); break;
+                case GFFM_COL_GENE_NAME: write_opt_string(vec, row_count, tx->gene_name); break;
+                case GFFM_COL_GENE_BIOTYPE: write_opt_string(vec, row_count, tx->gene_biotype); break;
+                case GFFM_COL_TRANSCRIPT_ID: write_opt_string(vec, row_count, tx->id); break;
+                case GFFM_COL_TRANSCRIPT_NAME: write_opt_string(vec, row_count, tx->name); break;
+                case GFFM_COL_TRANSCRIPT_BIOTYPE: write_opt_string(vec, row_count, tx->biotype); break;
+                case GFFM_COL_FEATURE: write_opt_string(vec, row_count, tx->feature); break;
+                case GFFM_COL_STRAND: {
+                    char strand[2] = {tx->strand ? tx->strand : '.', '\0'};
+                    duckdb_vector_assign_string_element(vec, row_count, strand);
+                    break;
+                }
+                case GFFM_COL_START:
+                    ((int64_t *)duckdb_vector_get_data(vec))[row_count] = tx->start;
+                    break;
+                case GFFM_COL_END:
+                    ((int64_t *)duckdb_vector_get_data(vec))[row_count] = tx->end;
+                    break;
+                case GFFM_COL_CDS_START:
+                case GFFM_COL_CDS_END:
+                    if (tx->cds.n == 0) {
+                        set_null(vec, row_count);
+                    } else {
+                        int64_t v = tx->cds.v[0].start;
+                        if (local->column_ids[c] == GFFM_COL_CDS_END) {
+                            v = tx->cds.v[0].end;
+                            for (int i = 1; i < tx->cds.n; i++) {
+                                if (tx->cds.v[i].end > v) v = tx->cds.v[i].end;
+                            }
+                        }
+                        ((int64_t *)duckdb_vector_get_data(vec))[row_count] = v;
+                    }
+                    break;
+                case GFFM_COL_EXONS: write_span_list(vec, row_count, tx->exons.v, tx->exons.n); break;
+                case GFFM_COL_CDS: write_span_list(vec, row_count, tx->cds.v, tx->cds.n); break;
+                case GFFM_COL_FIVE_PRIME_UTR:
+                    if (minus) write_span_list(vec, row_count, right.v, right.n);
+                    else write_span_list(vec, row_count, left.v, left.n);
+                    break;
+                case GFFM_COL_THREE_PRIME_UTR:
+                    if (minus) write_span_list(vec, row_count, left.v, left.n);
+                    else write_span_list(vec, row_count, right.v, right.n);
+                    break;
+                case GFFM_COL_INTRONS: write_span_list(vec, row_count, introns.v, introns.n); break;
+                default: break;
+            }
+        }
+        row_count++;
+    }
+
+    free(left.v);
+    free(right.v);
+    free(introns.v);
+    duckdb_data_chunk_set_size(output, row_count);
+}
+
+void register_gff_models_function(duckdb_connection connection) {
+    duckdb_table_function tf = duckdb_create_table_function();
+    duckdb_table_function_set_name(tf, "gff_models");
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "region", varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "index_path", varchar_type);
+    duckdb_destroy_logical_type(&varchar_type);
+
+    duckdb_table_function_set_bind(tf, gffm_bind);
+    duckdb_table_function_set_init(tf, gffm_global_init);
+    duckdb_table_function_set_local_init(tf, gffm_local_init);
+    duckdb_table_function_set_function(tf, gffm_scan);
+    duckdb_table_function_supports_projection_pushdown(tf, true);
+    duckdb_register_table_function(connection, tf);
+    duckdb_destroy_table_function(&tf);
+}
+
+/* ================================================================
+ * annotate_consequence
+ * ================================================================
+ *
+ * annotate_consequence(vcf_path, gtf_path, [reference, flank]) classifies
+ * every ALT allele against the transcript models of a GTF/GFF3 file and
+ * returns one row per (allele, transcript) pair, or one intergenic row when
+ * no transcript lies within flank bases.
+ *
+ * The models are built once (gffm loader above) into a cgranges index over
+ * the transcript bounds widened by flank. Variant records are then streamed
+ * in parallel, one VCF contig per work item when the file is indexed. Each
+ * thread opens its own reader and reference handle; coding SNVs/MNVs are
+ * translated with the standard codon table from a cached reference window.
+ *
+ * Alleles are trimmed of their shared prefix and suffix first, so [vs, ve)
+ * is the changed reference span (vs == ve for insertions, which sit between
+ * bases vs-1 and vs). Terms follow Sequence Ontology names and VEP severity;
+ * without a reference, coding SNVs/MNVs are coding_sequence_variant.
+ */
+
+#define CSQ_MAX_THREADS 16
+#define CSQ_DEFAULT_FLANK 5000
+#define CSQ_REF_WINDOW 65536
+#define CSQ_MAX_CODONS 16      /* longer MNVs are reported as coding_sequence_variant */
+
+enum {
+    CSQ_COL_CHROM = 0,
+    CSQ_COL_POS,
+    CSQ_COL_ID,
+    CSQ_COL_REF,
+    CSQ_COL_ALT,
+    CSQ_COL_GENE_ID,
+    CSQ_COL_GENE_NAME,
+    CSQ_COL_TRANSCRIPT_ID,
+    CSQ_COL_TRANSCRIPT_BIOTYPE,
+    CSQ_COL_STRAND,
+    CSQ_COL_CONSEQUENCE,
+    CSQ_COL_CONSEQUENCES,
+    CSQ_COL_IMPACT,
+    CSQ_COL_CDS_POSITION,
+    CSQ_COL_PROTEIN_POSITION,
+    CSQ_COL_CODONS,
+    CSQ_COL_AMINO_ACIDS,
+    CSQ_COL_COUNT
+};
+
+/* Most severe first; bit i of a term mask is csq_terms[i] */
+enum {
+    CSQ_SPLICE_ACCEPTOR = 0,
+    CSQ_SPLICE_DONOR,
+    CSQ_STOP_GAINED,
+    CSQ_FRAMESHIFT,
+    CSQ_STOP_LOST,
+    CSQ_START_LOST,
+    CSQ_INFRAME_INSERTION,
+    CSQ_INFRAME_DELETION,
+    CSQ_MISSENSE,
+    CSQ_SPLICE_REGION,
+    CSQ_INCOMPLETE_TERMINAL_CODON,
+    CSQ_START_RETAINED,
+    CSQ_STOP_RETAINED,
+    CSQ_SYNONYMOUS,
+    CSQ_CODING_SEQUENCE,
+    CSQ_FIVE_PRIME_UTR,
+    CSQ_THREE_PRIME_UTR,
+    CSQ_NC_TRANSCRIPT_EXON,
+    CSQ_INTRON,
+    CSQ_NC_TRANSCRIPT,
+    CSQ_UPSTREAM,
+    CSQ_DOWNSTREAM,
+    CSQ_INTERGENIC,
+    CSQ_N_TERMS
+};
+
+static const char *const csq_terms[CSQ_N_TERMS] = {
+    "splice_acceptor_variant", "splice_donor_variant", "stop_gained", "frameshift_variant",
+    "stop_lost", "start_lost", "inframe_insertion", "inframe_deletion", "missense_variant",
+    "splice_region_variant", "incomplete_terminal_codon_variant", "start_retained_variant",
+    "stop_retained_variant", "synonymous_variant", "coding_sequence_variant",
+    "5_prime_UTR_variant", "3_prime_UTR_variant", "non_coding_transcript_exon_variant",
+    "intron_variant", "non_coding_transcript_variant", "upstream_gene_variant",
+    "downstream_gene_variant", "intergenic_variant"
+};
+
+/* Standard genetic code, codons indexed in TCAG order */
+static const char csq_codon_table[65] =
+    "FFLLSSSSYY**CC*WLLLLPPPPHHQQRRRRIIIMTTTTNNKKSSRRVVVVAAAADDEEGGGG";
+
+typedef struct {
+    char *vcf_path;
+    char *gtf_path;
+    char *ref_path;
+    int is_gff3;
+    int64_t flank;
+    char **contigs;         /* VCF contigs of an indexed file; NULL entry = whole file */
+    int n_contigs;
+} csq_bind_data_t;
+
+typedef struct {
+    gffm_local_data_t *models;   /* owns the transcripts */
+    cgranges_t *cr;              /* transcript bounds +- flank, label = txs index */
+    volatile int next_item;
+} csq_global_data_t;
+
+typedef struct {
+    int allele;             /* index into rec->d.allele */
+    int tx;                 /* transcript index, -1 for intergenic */
+    uint32_t terms;
+    int64_t cds_pos;        /* 1-based; 0 = not coding */
+    int64_t prot_pos;
+    int codons;             /* offset into local->text, -1 = none */
+    int amino_acids;
+} csq_row_t;
+
+typedef struct {
+    htsFile *fp;
+    bcf_hdr_t *hdr;
+    tbx_t *tbx;
+    hts_idx_t *idx;
+    hts_itr_t *itr;
+    bcf1_t *rec;
+    kstring_t line;
+    int reading;            /* a work item is open */
+    ref_source_t *ref;
+    int rid;                /* rec->rid the lookups below belong to */
+    int ctg;                /* cgranges contig id, -1 when unannotated */
+    int ref_id;             /* reference sequence id, -1 when absent */
+    char *win;              /* reference window [win_beg, win_end) of ref_id */
+    hts_pos_t win_beg, win_end;
+    int64_t *hits;
+    int64_t m_hits;
+    csq_row_t *rows;
+    int n_rows, m_rows, emit_idx;
+    kstring_t text;
+    int finished;
+    idx_t *column_ids;
+    idx_t n_projected_cols;
+} csq_local_data_t;
+
+static void csq_bind_data_destroy(void *data) {
+    csq_bind_data_t *bd = (csq_bind_data_t *)data;
+    if (!bd) return;
+    free(bd->vcf_path);
+    free(bd->gtf_path);
+    free(bd->ref_path);
+    for (int i = 0; i < bd->n_contigs; i++) free(bd->contigs[i]);
+    free(bd->contigs);
+    free(bd);
+}
+
+static void csq_global_data_destroy(void *data) {
+    csq_global_data_t *global = (csq_global_data_t *)data;
+    if (!global) return;
+    if (global->models) gffm_local_data_destroy(global->models);
+    if (global->cr) cr_destroy(global->cr);
+    free(global);
+}
+
+static void csq_local_data_destroy(void *data) {
+    csq_local_data_t *local = (csq_local_data_t *)data;
+    if (!local) return;
+    if (local->itr) hts_itr_destroy(local->itr);
+    if (local->tbx) tbx_destroy(local->tbx);
+    if (local->idx) hts_idx_destroy(local->idx);
+    if (local->rec) bcf_destroy(local->rec);
+    if (local->hdr) bcf_hdr_destroy(local->hdr);
+    if (local->fp) hts_close(local->fp);
+    if (local->ref) ref_source_close(local->ref);
+    free(local->line.s);
+    free(local->win);
+    free(local->hits);
+    free(local->rows);
+    free(local->text.s);
+    free(local->column_ids);
+    free(local);
+}
+
+/* Does the changed span [vs, ve) touch the 0-based span [a, b)? An
+ * insertion (vs == ve) only counts when both flanking bases lie inside. */
+static int csq_hits(int64_t vs, int64_t ve, int64_t a, int64_t b) {
+    if (a >= b) return 0;
+    if (ve > vs) return vs < b && a < ve;
+    return a < vs && vs < b;
+}
+
+/* As csq_hits, but an insertion also counts when it sits on an edge. */
+static int csq_touches(int64_t vs, int64_t ve, int64_t a, int64_t b) {
+    if (ve > vs) return csq_hits(vs, ve, a, b);
+    return a < b && a <= vs && vs <= b;
+}
+
+/* 0-based CDS offset (transcript direction) of genomic base g, or -1. */
+static int64_t csq_cds_offset(const gff_tx_t *tx, int64_t g) {
+    int64_t off = 0;
+    if (tx->strand != '-') {
+        for (int i = 0; i < tx->cds.n; i++) {
+            int64_t s = tx->cds.v[i].start - 1, e = tx->cds.v[i].end;
+            if (g >= e) off += e - s;
+            else return g >= s ? off + g - s : -1;
+        }
+    } else {
+        for (int i = tx->cds.n - 1; i >= 0; i--) {
+            int64_t s = tx->cds.v[i].start - 1, e = tx->cds.v[i].end;
+            if (g < s) off += e - s;
+            else return g < e ? off + e - 1 - g : -1;
+        }
+    }
+    return -1;
+}
+
+/* Genomic base of CDS offset c, or -1 past the end of the CDS. */
+static int64_t csq_cds_genomic(const gff_tx_t *tx, int64_t c) {
+    if (tx->strand != '-') {
+        for (int i = 0; i < tx->cds.n; i++) {
+            int64_t s = tx->cds.v[i].start - 1, n = tx->cds.v[i].end - s;
+            if (c < n) return s + c;
+            c -= n;
+        }
+    } else {
+        for (int i = tx->cds.n - 1; i >= 0; i--) {
+            int64_t s = tx->cds.v[i].start - 1, n = tx->cds.v[i].end - s;
+            if (c < n) return tx->cds.v[i].end - 1 - c;
+            c -= n;
+        }
+    }
+    return -1;
+}
+
+/* Upper-case reference base at g on the current contig; 'N' when unknown. */
+static char csq_ref_base(csq_local_data_t *local, int64_t g) {
+    if (!local->ref || local->ref_id < 0 || g < 0) return 'N';
+    if (!local->win || g < local->win_beg || g >= local->win_end) {
+        free(local->win);
+        hts_pos_t beg = g > CSQ_REF_WINDOW / 4 ? g - CSQ_REF_WINDOW / 4 : 0;
+        hts_pos_t len = 0;
+        local->win = ref_source_fetch(local->ref, local->ref_id, beg, beg + CSQ_REF_WINDOW, &len);
+        local->win_beg = beg;
+        local->win_end = local->win ? beg + len : beg;
+        if (g >= local->win_end) return 'N';
+    }
+    return (char)toupper((unsigned char)local->win[g - local->win_beg]);
+}
+
+static char csq_complement(char b) {
+    switch (b) {
+        case 'A': return 'T';
+        case 'C': return 'G';
+        case 'G': return 'C';
+        case 'T': return 'A';
+        default: return 'N';
+    }
+}
+
+static char csq_translate(const char *codon) {
+    int idx = 0;
+    for (int i = 0; i < 3; i++) {
+        int v;
+        switch (codon[i]) {
+            case 'T': v = 0; break;
+            case 'C': v = 1; break;
+            case 'A': v = 2; break;
+            case 'G': v = 3; break;
+            default: return 'X';
+        }
+        idx = idx * 4 + v;
+    }
+    return csq_codon_table[idx];
+}
+
+/* Translate the codons around a coding SNV/MNV fully inside the CDS. */
+static void csq_classify_codons(csq_local_data_t *local, const gff_tx_t *tx, int64_t vs, int64_t ve,
+                                const char *alt, int64_t cmin, csq_row_t *row) {
+    int minus = tx->strand == '-';
+    int64_t phase = tx->cds_phase;
+    int64_t k0 = (cmin - phase) / 3;
+    int64_t k1 = (cmin + (ve - vs) - 1 - phase) / 3;
+    if (!local->ref || local->ref_id < 0 || k1 - k0 >= CSQ_MAX_CODONS) {
+        row->terms |= 1u << CSQ_CODING_SEQUENCE;
+        return;
+    }
+    int n = (int)(k1 - k0 + 1) * 3;
+    char ref_codons[CSQ_MAX_CODONS * 3 + 1], alt_codons[CSQ_MAX_CODONS * 3 + 1];
+    int64_t c0 = phase + 3 * k0;
+    for (int i = 0; i < n; i++) {
+        int64_t g = csq_cds_genomic(tx, c0 + i);
+        if (g < 0) {
+            row->terms |= (1u << CSQ_INCOMPLETE_TERMINAL_CODON) | (1u << CSQ_CODING_SEQUENCE);
+            return;
+        }
+        char b = csq_ref_base(local, g);
+        ref_codons[i] = minus ? csq_complement(b) : b;
+    }
+    memcpy(alt_codons, ref_codons, (size_t)n);
+    for (int64_t g = vs; g < ve; g++) {
+        char b = (char)toupper((unsigned char)alt[g - vs]);
+        alt_codons[csq_cds_offset(tx, g) - c0] = minus ? csq_complement(b) : b;
+    }
+    ref_codons[n] = alt_codons[n] = '\0';
+
+    char ref_aa[CSQ_MAX_CODONS + 1], alt_aa[CSQ_MAX_CODONS + 1];
+    int n_aa = n / 3, ref_stop = 0, alt_stop = 0, unknown = 0;
+    for (int i = 0; i < n_aa; i++) {
+        ref_aa[i] = csq_translate(ref_codons + 3 * i);
+        alt_aa[i] = csq_translate(alt_codons + 3 * i);
+        ref_stop |= ref_aa[i] == '*';
+        alt_stop |= alt_aa[i] == '*';
+        unknown |= ref_aa[i] == 'X' || alt_aa[i] == 'X';
+    }
+    ref_aa[n_aa] = alt_aa[n_aa] = '\0';
+    if (unknown) {
+        row->terms |= 1u << CSQ_CODING_SEQUENCE;
+        return;
+    }
+    int same = strcmp(ref_aa, alt_aa) == 0;
+    int at_start = k0 == 0 && phase == 0 && ref_aa[0] == 'M';
+    if (ref_stop && !alt_stop) row->terms |= 1u << CSQ_STOP_LOST;
+    else if (alt_stop && !same && !ref_stop) row->terms |= 1u << CSQ_STOP_GAINED;
+    else if (at_start && alt_aa[0] != 'M') row->terms |= 1u << CSQ_START_LOST;
+    else if (same && ref_stop) row->terms |= 1u << CSQ_STOP_RETAINED;
+    else if (same && at_start) row->terms |= 1u << CSQ_START_RETAINED;
+    else if (same) row->terms |= 1u << CSQ_SYNONYMOUS;
+    else row->terms |= 1u << CSQ_MISSENSE;
+
+    /* VEP style: changed bases upper case, the rest of the codon lower case */
+    row->codons = (int)local->text.l;
+    for (int pass = 0; pass < 2; pass++) {
+        const char *cod = pass ? alt_codons : ref_codons;
+        if (pass) kputc('/', &local->text);
+        for (int i = 0; i < n; i++) {
+            kputc(ref_codons[i] == alt_codons[i] ? (char)tolower((unsigned char)cod[i]) : cod[i], &local->text);
+        }
+    }
+    kputc('\0', &local->text);
+    row->amino_acids = (int)local->text.l;
+    kputs(ref_aa, &local->text);
+    if (!same) {
+        kputc('/', &local->text);
+        kputs(alt_aa, &local->text);
+    }
+    kputc('\0', &local->text);
+}
+
+/* Classify the change [vs, ve) -> alt (alt_len bases) against one
+ * transcript. Leaves row->terms 0 when the transcript is out of range. */
+static void csq_classify(csq_local_data_t *local, const gff_tx_t *tx, int64_t flank, int64_t vs, int64_t ve,
+                         const char *alt, int64_t alt_len, csq_row_t *row) {
+    int minus = tx->strand == '-';
+    int64_t tx0 = tx->start - 1, tx1 = tx->end;
+    int64_t last = ve > vs ? ve : vs;   /* first base after the change */
+
+    if (!csq_hits(vs, ve, tx0, tx1)) {
+        int before = last <= tx0;
+        int64_t dist = before ? tx0 - last : vs - tx1;
+        if (dist <= flank) row->terms |= 1u << (before != minus ? CSQ_UPSTREAM : CSQ_DOWNSTREAM);
+        return;
+    }
+
+    const gff_span_vec_t *ex = tx->exons.n ? &tx->exons : &tx->cds;
+    int coding = tx->cds.n > 0;
+    int exonic = 0, intronic = 0;
+    for (int i = 0; i < ex->n; i++) {
+        int64_t a = ex->v[i].start - 1, b = ex->v[i].end;
+        exonic |= csq_hits(vs, ve, a, b);
+        if (i + 1 == ex->n) break;
+        /* Intron [ia, ib) up to the next exon */
+        int64_t ia = b, ib = ex->v[i + 1].start - 1;
+        if (ia >= ib) continue;
+        intronic |= csq_hits(vs, ve, ia, ib);
+        if (csq_hits(vs, ve, ia, ia + 2 < ib ? ia + 2 : ib)) {
+            row->terms |= 1u << (minus ? CSQ_SPLICE_ACCEPTOR : CSQ_SPLICE_DONOR);
+        }
+        if (csq_hits(vs, ve, ib - 2 > ia ? ib - 2 : ia, ib)) {
+            row->terms |= 1u << (minus ? CSQ_SPLICE_DONOR : CSQ_SPLICE_ACCEPTOR);
+        }
+        if (csq_touches(vs, ve, ia + 2, ia + 8 < ib ? ia + 8 : ib) ||
+            csq_touches(vs, ve, ib - 8 > ia ? ib - 8 : ia, ib - 2) ||
+            csq_touches(vs, ve, a > b - 3 ? a : b - 3, b) ||
+            csq_touches(vs, ve, ex->v[i + 1].start - 1,
+                        ex->v[i + 1].start + 2 < ex->v[i + 1].end ? ex->v[i + 1].start + 2 : ex->v[i + 1].end)) {
+            row->terms |= 1u << CSQ_SPLICE_REGION;
+        }
+    }
+    if (!exonic) intronic = 1;
+    if (intronic) row->terms |= 1u << CSQ_INTRON;
+    if (!coding) {
+        row->terms |= 1u << (exonic ? CSQ_NC_TRANSCRIPT_EXON : CSQ_NC_TRANSCRIPT);
+        if (exonic && intronic) row->terms |= 1u << CSQ_NC_TRANSCRIPT;
+        return;
+    }
+    if (!exonic) return;
+
+    int64_t cds_lo = tx->cds.v[0].start - 1, cds_hi = tx->cds.v[tx->cds.n - 1].end;
+    int cds_hit = 0;
+    for (int i = 0; i < tx->cds.n; i++) cds_hit |= csq_hits(vs, ve, tx->cds.v[i].start - 1, tx->cds.v[i].end);
+    if (!cds_hit) {
+        int left = last <= cds_lo;
+        if (left || vs >= cds_hi) row->terms |= 1u << (left != minus ? CSQ_FIVE_PRIME_UTR : CSQ_THREE_PRIME_UTR);
+        else row->terms |= 1u << CSQ_CODING_SEQUENCE;  /* exon between CDS pieces */
+        return;
+    }
+
+    /* Entirely inside the CDS: the first and last changed (or flanking)
+     * bases map to offsets exactly the span length apart */
+    int64_t g_lo = ve > vs ? vs : vs - 1;
+    int64_t g_hi = ve > vs ? ve - 1 : vs;
+    int64_t o_lo = csq_cds_offset(tx, g_lo), o_hi = csq_cds_offset(tx, g_hi);
+    int64_t cmin = minus ? o_hi : o_lo;
+    if (o_lo < 0 || o_hi < 0 || (minus ? o_lo - o_hi : o_hi - o_lo) != g_hi - g_lo) {
+        row->terms |= 1u << CSQ_CODING_SEQUENCE;
+        if (vs < cds_lo || last > cds_hi) {
+            row->terms |= 1u << ((vs < cds_lo) != minus ? CSQ_FIVE_PRIME_UTR : CSQ_THREE_PRIME_UTR);
+        }
+        return;
+    }
+    row->cds_pos = cmin + 1;
+    if (cmin >= tx->cds_phase) row->prot_pos = (cmin - tx->cds_phase) / 3 + 1;
+
+    int64_t ref_len = ve - vs;
+    if (alt_len != ref_len) {
+        int64_t diff = alt_len - ref_len;
+        if (diff % 3 != 0) row->terms |= 1u << CSQ_FRAMESHIFT;
+        else row->terms |= 1u << (diff > 0 ? CSQ_INFRAME_INSERTION : CSQ_INFRAME_DELETION);
+        return;
+    }
+    if (cmin < tx->cds_phase) {
+        row->terms |= 1u << CSQ_CODING_SEQUENCE;
+        return;
+    }
+    csq_classify_codons(local, tx, vs, ve, alt, cmin, row);
+}
+
+static csq_row_t *csq_push_row(csq_local_data_t *local, int allele, int tx) {
+    if (local->n_rows == local->m_rows) {
+        local->m_rows = local->m_rows ? local->m_rows * 2 : 16;
+        local->rows = (csq_row_t *)realloc(local->rows, sizeof(csq_row_t) * (size_t)local->m_rows);
+    }
+    csq_row_t *row = &local->rows[local->n_rows++];
+    memset(row, 0, sizeof(*row));
+    row->allele = allele;
+    row->tx = tx;
+    row->codons = row->amino_acids = -1;
+    return row;
+}
+
+/* Fill local->rows with the annotations of the current record. */
+static void csq_annotate_record(const csq_bind_data_t *bd, const csq_global_data_t *global,
+                                csq_local_data_t *local) {
+    bcf1_t *rec = local->rec;
+    local->n_rows = local->emit_idx = 0;
+    local->text.l = 0;
+    if (rec->rid != local->rid) {
+        const char *chrom = bcf_seqname_safe(local->hdr, rec);
+        local->rid = rec->rid;
+        local->ctg = cr_get_ctg(global->cr, chrom);
+        int ref_id = local->ref ? ref_source_name2id(local->ref, chrom) : -1;
+        if (ref_id != local->ref_id) {
+            free(local->win);
+            local->win = NULL;
+            local->ref_id = ref_id;
+        }
+    }
+
+    const char *ref = rec->d.allele[0];
+    int64_t ref_len = (int64_t)strlen(ref);
+    for (int a = 1; a < rec->n_allele; a++) {
+        const char *alt = rec->d.allele[a];
+        if (alt[0] == '<' || alt[0] == '*' || alt[0] == '.' || strpbrk(alt, "[]")) continue;
+        int64_t alt_len = (int64_t)strlen(alt);
+        int64_t p = 0, sfx = 0;
+        while (p < ref_len && p < alt_len && toupper((unsigned char)ref[p]) == toupper((unsigned char)alt[p])) p++;
+        while (sfx < ref_len - p && sfx < alt_len - p &&
+               toupper((unsigned char)ref[ref_len - 1 - sfx]) == toupper((unsigned char)alt[alt_len - 1 - sfx])) {
+            sfx++;
+        }
+        if (p == ref_len && p == alt_len) continue;  /* ALT equals REF */
+        int64_t vs = rec->pos + p, ve = rec->pos + ref_len - sfx;
+        const char *change = alt + p;
+        int64_t change_len = alt_len - p - sfx;
+
+        int first = local->n_rows;
+        int64_t n_hits = 0;
+        if (local->ctg >= 0) {
+            int64_t qs = ve > vs ? vs : vs - 1, qe = ve > vs ? ve : vs + 1;
+            if (qs < 0) qs = 0;
+            n_hits = cr_overlap_int(global->cr, local->ctg, (int32_t)qs, (int32_t)qe, &local->hits, &local->m_hits);
+        }
+        for (int64_t h = 0; h < n_hits; h++) {
+            int tx_idx = (int)cr_label(global->cr, local->hits[h]);
+            csq_row_t *row = csq_push_row(local, a, tx_idx);
+            csq_classify(local, &global->models->txs[tx_idx], bd->flank, vs, ve, change, change_len, row);
+            if (row->terms == 0) local->n_rows--;
+        }
+        if (local->n_rows == first) {
+            csq_push_row(local, a, -1)->terms = 1u << CSQ_INTERGENIC;
+        } else if (local->n_rows - first > 1) {
+            /* Same order whichever way cgranges returned the hits */
+            for (int i = first + 1; i < local->n_rows; i++) {
+                csq_row_t tmp = local->rows[i];
+                int j = i;
+                while (j > first && local->rows[j - 1].tx > tmp.tx) {
+                    local->rows[j] = local->rows[j - 1];
+                    j--;
+                }
+                local->rows[j] = tmp;
+            }
+        }
+    }
+}
+
+/* Next VCF record, claiming work items as needed. Returns 1, 0 at the end, -1 on error. */
+static int csq_next_record(const csq_bind_data_t *bd, csq_global_data_t *global, csq_local_data_t *local) {
+    for (;;) {
+        if (!local->reading) {
+            int item = __sync_fetch_and_add(&global->next_item, 1);
+            if (item >= bd->n_contigs) return 0;
+            if (bd->contigs[item]) {
+                if (local->itr) hts_itr_destroy(local->itr);
+                local->itr = NULL;
+                if (local->tbx) {
+                    int tid = tbx_name2id(local->tbx, bd->contigs[item]);
+                    if (tid >= 0) local->itr = tbx_itr_queryi(local->tbx, tid, 0, HTS_POS_MAX);
+                } else {
+                    int tid = bcf_hdr_name2id(local->hdr, bd->contigs[item]);
+                    if (tid >= 0) local->itr = bcf_itr_queryi(local->idx, tid, 0, HTS_POS_MAX);
+                }
+                if (!local->itr) continue;
+            }
+            local->reading = 1;
+        }
+        int ret;
+        if (local->itr && local->tbx) {
+            ret = tbx_itr_next(local->fp, local->tbx, local->itr, &local->line);
+            if (ret >= 0 && vcf_parse1(&local->line, local->hdr, local->rec) < 0) return -1;
+        } else {
+            ret = local->itr ? bcf_itr_next(local->fp, local->itr, local->rec)
+                             : bcf_read(local->fp, local->hdr, local->rec);
+        }
+        if (ret < -1) return -1;
+        if (ret < 0) {
+            local->reading = 0;
+            continue;
+        }
+        bcf_unpack(local->rec, BCF_UN_STR);
+        return 1;
+    }
+}
+
+static void csq_bind(duckdb_bind_info info) {
+    csq_bind_data_t *bd = calloc(1, sizeof(csq_bind_data_t));
+    if (!bd) {
+        duckdb_bind_set_error(info, "Out of memory");
+        return;
+    }
+    bd->flank = CSQ_DEFAULT_FLANK;
+    char msg[512];
+
+    for (idx_t p = 0; p < 2; p++) {
+        duckdb_value val = duckdb_bind_get_parameter(info, p);
+        char *s = duckdb_is_null_value(val) ? NULL : duckdb_get_varchar(val);
+        duckdb_destroy_value(&val);
+        if (s && s[0]) {
+            if (p == 0) bd->vcf_path = strdup(s);
+            else bd->gtf_path = strdup(s);
+        }
+        duckdb_free(s);
+    }
+    if (!bd->vcf_path || !bd->gtf_path) {
+        duckdb_bind_set_error(info, "annotate_consequence requires a VCF/BCF path and a GTF/GFF3 path");
+        csq_bind_data_destroy(bd);
+        return;
+    }
+
+    duckdb_value val = duckdb_bind_get_named_parameter(info, "reference");
+    if (val) {
+        char *s = duckdb_is_null_value(val) ? NULL : duckdb_get_varchar(val);
+        if (s && s[0]) bd->ref_path = strdup(s);
+        duckdb_free(s);
+        duckdb_destroy_value(&val);
+    }
+    val = duckdb_bind_get_named_parameter(info, "flank");
+    if (val) {
+        if (!duckdb_is_null_value(val)) bd->flank = duckdb_get_int64(val);
+        duckdb_destroy_value(&val);
+        if (bd->flank < 0) {
+            duckdb_bind_set_error(info, "annotate_consequence: flank must be >= 0");
+            csq_bind_data_destroy(bd);
+            return;
+        }
+    }
+
+    bd->is_gff3 = gffm_detect_gff3(bd->gtf_path);
+    if (bd->is_gff3 < 0) {
+        snprintf(msg, sizeof(msg), "Cannot open file: %s", bd->gtf_path);
+        duckdb_bind_set_error(info, msg);
+        csq_bind_data_destroy(bd);
+        return;
+    }
+    if (bd->ref_path) {
+        ref_source_t *ref = ref_source_open(bd->ref_path, NULL, msg, sizeof(msg));
+        if (!ref) {
+            duckdb_bind_set_error(info, msg);
+            csq_bind_data_destroy(bd);
+            return;
+        }
+        ref_source_close(ref);
+    }
+
+    /* Indexed VCF/BCF: one work item per contig; otherwise one pass */
+    htsFile *fp = hts_open(bd->vcf_path, "r");
+    bcf_hdr_t *hdr = fp ? bcf_hdr_read(fp) : NULL;
+    if (!hdr) {
+        snprintf(msg, sizeof(msg), "annotate_consequence: failed to read VCF/BCF header: %s", bd->vcf_path);
+        duckdb_bind_set_error(info, msg);
+        if (fp) hts_close(fp);
+        csq_bind_data_destroy(bd);
+        return;
+    }
+    int n = 0;
+    const char **names = NULL;
+    if (hts_get_format(fp)->format == vcf) {
+        tbx_t *tbx = tbx_index_load3(bd->vcf_path, NULL, HTS_IDX_SILENT_FAIL);
+        if (tbx) {
+            names = tbx_seqnames(tbx, &n);
+            bd->contigs = (char **)calloc((size_t)(n > 0 ? n : 1), sizeof(char *));
+            for (int i = 0; i < n; i++) bd->contigs[i] = strdup(names[i]);
+            tbx_destroy(tbx);
+        }
+    } else {
+        hts_idx_t *idx = bcf_index_load3(bd->vcf_path, NULL, HTS_IDX_SILENT_FAIL);
+        if (idx) {
+            names = bcf_index_seqnames(idx, hdr, &n);
+            bd->contigs = (char **)calloc((size_t)(n > 0 ? n : 1), sizeof(char *));
+            for (int i = 0; i < n; i++) bd->contigs[i] = strdup(names[i]);
+            hts_idx_destroy(idx);
+        }
+    }
+    free(names);
+    bcf_hdr_destroy(hdr);
+    hts_close(fp);
+    if (bd->contigs) {
+        bd->n_contigs = n;
+    } else {
+        bd->contigs = (char **)malloc(sizeof(char *));
+        bd->contigs[0] = NULL;
+        bd->n_contigs = 1;
+    }
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_logical_type list_type = duckdb_create_list_type(varchar_type);
+    duckdb_bind_add_result_column(info, "chrom", varchar_type);
+    duckdb_bind_add_result_column(info, "pos", bigint_type);
+    duckdb_bind_add_result_column(info, "id", varchar_type);
+    duckdb_bind_add_result_column(info, "ref", varchar_type);
+    duckdb_bind_add_result_column(info, "alt", varchar_type);
+    duckdb_bind_add_result_column(info, "gene_id", varchar_type);
+    duckdb_bind_add_result_column(info, "gene_name", varchar_type);
+    duckdb_bind_add_result_column(info, "transcript_id", varchar_type);
+    duckdb_bind_add_result_column(info, "transcript_biotype", varchar_type);
+    duckdb_bind_add_result_column(info, "strand", varchar_type);
+    duckdb_bind_add_result_column(info, "consequence", varchar_type);
+    duckdb_bind_add_result_column(info, "consequences", list_type);
+    duckdb_bind_add_result_column(info, "impact", varchar_type);
+    duckdb_bind_add_result_column(info, "cds_position", bigint_type);
+    duckdb_bind_add_result_column(info, "protein_position", bigint_type);
+    duckdb_bind_add_result_column(info, "codons", varchar_type);
+    duckdb_bind_add_result_column(info, "amino_acids", varchar_type);
+    duckdb_destroy_logical_type(&list_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_logical_type(&varchar_type);
+
+    duckdb_bind_set_bind_data(info, bd, csq_bind_data_destroy);
+}
+
+static void csq_global_init(duckdb_init_info info) {
+    csq_bind_data_t *bd = (csq_bind_data_t *)duckdb_init_get_bind_data(info);
+    csq_global_data_t *global = calloc(1, sizeof(csq_global_data_t));
+    gffm_local_data_t *models = calloc(1, sizeof(gffm_local_data_t));
+    if (!global || !models) {
+        free(global);
+        free(models);
+        duckdb_init_set_error(info, "Out of memory");
+        return;
+    }
+    global->models = models;
+    models->fp = hts_open(bd->gtf_path, "r");
+    models->node_hash = kh_init(gffid);
+    models->tx_hash = kh_init(gffid);
+    gffm_bind_data_t gbd;
+    memset(&gbd, 0, sizeof(gbd));
+    gbd.file_path = bd->gtf_path;
+    gbd.is_gff3 = bd->is_gff3;
+    if (!models->fp || gffm_load_item(&gbd, models, NULL) != 0) {
+        char msg[512];
+        snprintf(msg, sizeof(msg), "annotate_consequence: error reading annotation file: %s", bd->gtf_path);
+        duckdb_init_set_error(info, msg);
+        csq_global_data_destroy(global);
+        return;
+    }
+
+    global->cr = cr_init();
+    for (int i = 0; i < models->n_txs; i++) {
+        gff_tx_t *tx = &models->txs[i];
+        if (!tx->seqname || tx->end < tx->start) continue;
+        int64_t st = tx->start - 1 - bd->flank, en = tx->end + bd->flank;
+        if (st < 0) st = 0;
+        if (en > INT32_MAX) en = INT32_MAX;
+        cr_add(global->cr, tx->seqname, (int32_t)st, (int32_t)en, i);
+    }
+    cr_index(global->cr);
+
+    idx_t max_threads = (idx_t)bd->n_contigs;
+    if (max_threads > CSQ_MAX_THREADS) max_threads = CSQ_MAX_THREADS;
+    if (max_threads < 1) max_threads = 1;
+    duckdb_init_set_max_threads(info, max_threads);
+    duckdb_init_set_init_data(info, global, csq_global_data_destroy);
+}
+
+static void csq_local_init(duckdb_init_info info) {
+    csq_bind_data_t *bd = (csq_bind_data_t *)duckdb_init_get_bind_data(info);
+    csq_local_data_t *local = calloc(1, sizeof(csq_local_data_t));
+    if (!local) {
+        duckdb_init_set_error(info, "Out of memory");
+        return;
+    }
+    local->rid = -1;
+    local->ctg = -1;
+    local->ref_id = -1;
+    char msg[512];
+    local->fp = hts_open(bd->vcf_path, "r");
+    local->hdr = local->fp ? bcf_hdr_read(local->fp) : NULL;
+    local->rec = bcf_init();
+    if (local->hdr && bd->contigs[0]) {
+        if (hts_get_format(local->fp)->format == vcf) {
+            local->tbx = tbx_index_load3(bd->vcf_path, NULL, HTS_IDX_SILENT_FAIL);
+        } else {
+            local->idx = bcf_index_load3(bd->vcf_path, NULL, HTS_IDX_SILENT_FAIL);
+        }
+    }
+    if (!local->hdr || (bd->contigs[0] && !local->tbx && !local->idx)) {
+        snprintf(msg, sizeof(msg), "Cannot open file: %s", bd->vcf_path);
+        duckdb_init_set_error(info, msg);
+        csq_local_data_destroy(local);
+        return;
+    }
+    if (bd->ref_path) {
+        local->ref = ref_source_open(bd->ref_path, NULL, msg, sizeof(msg));
+        if (!local->ref) {
+            duckdb_init_set_error(info, msg);
+            csq_local_data_destroy(local);
+            return;
+        }
+    }
+
+    local->n_projected_cols = duckdb_init_get_column_count(info);
+    local->column_ids = (idx_t *)malloc(sizeof(idx_t) * (local->n_projected_cols ? local->n_projected_cols : 1));
+    for (idx_t i = 0; i < local->n_projected_cols; i++) {
+        local->column_ids[i] = duckdb_init_get_column_index(info, i);
+    }
+    duckdb_init_set_init_data(info, local, csq_local_data_destroy);
+}
+
+static const char *csq_impact(int worst) {
+    if (worst <= CSQ_START_LOST) return "HIGH";
+    if (worst <= CSQ_MISSENSE) return "MODERATE";
+    if (worst <= CSQ_SYNONYMOUS) return "LOW";
+    return "MODIFIER";
+}
+
+static void csq_write_terms(duckdb_vector vec, idx_t row, uint32_t terms) {
+    duckdb_list_entry entry;
+    entry.offset = duckdb_list_vector_get_size(vec);
+    entry.length = 0;
+    for (int t = 0; t < CSQ_N_TERMS; t++) entry.length += (terms >> t) & 1u;
+    duckdb_list_vector_reserve(vec, entry.offset + entry.length);
+    duckdb_list_vector_set_size(vec, entry.offset + entry.length);
+    duckdb_vector child = duckdb_list_vector_get_child(vec);
+    idx_t k = entry.offset;
+    for (int t = 0; t < CSQ_N_TERMS; t++) {
+        if (terms & (1u << t)) duckdb_vector_assign_string_element(child, k++, csq_terms[t]);
+    }
+    ((duckdb_list_entry *)duckdb_vector_get_data(vec))[row] = entry;
+}
+
+static void csq_scan(duckdb_function_info info, duckdb_data_chunk output) {
+    csq_bind_data_t *bd = (csq_bind_data_t *)duckdb_function_get_bind_data(info);
+    csq_global_data_t *global = (csq_global_data_t *)duckdb_function_get_init_data(info);
+    csq_local_data_t *local = (csq_local_data_t *)duckdb_function_get_local_init_data(info);
+    idx_t row_count = 0;
+    idx_t capacity = duckdb_vector_size();
+
+    while (row_count < capacity && !local->finished) {
+        if (local->emit_idx >= local->n_rows) {
+            int ret = csq_next_record(bd, global, local);
+            if (ret < 0) {
+                duckdb_function_set_error(info, "annotate_consequence: error reading VCF/BCF file");
+                local->finished = 1;
+                break;
+            }
+            if (ret == 0) {
+                local->finished = 1;
+                break;
+            }
+            csq_annotate_record(bd, global, local);
+            continue;
+        }
+
+        const csq_row_t *r = &local->rows[local->emit_idx++];
+        const bcf1_t *rec = local->rec;
+        const gff_tx_t *tx = r->tx >= 0 ? &global->models->txs[r->tx] : NULL;
+        int worst = 0;
+        while (!(r->terms & (1u << worst))) worst++;
+        for (idx_t c = 0; c < local->n_projected_cols; c++) {
+            duckdb_vector vec = duckdb_data_chunk_get_vector(output, c);
+            switch (local->column_ids[c]) {
+                case CSQ_COL_CHROM:
+                    duckdb_vector_assign_string_element(vec, row_count, bcf_seqname_safe(local->hdr, rec));
+                    break;
+                case CSQ_COL_POS:
+                    ((int64_t *)duckdb_vector_get_data(vec))[row_count] = rec->pos + 1;
+                    break;
+                case CSQ_COL_ID:
+                    write_opt_string(vec, row_count, strcmp(rec->d.id, ".") == 0 ? NULL : rec->d.id);
+                    break;
+                case CSQ_COL_REF: duckdb_vector_assign_string_element(vec, row_count, rec->d.allele[0]); break;
+                case CSQ_COL_ALT: duckdb_vector_assign_string_element(vec, row_count, rec->d.allele[r->allele]); break;
+                case CSQ_COL_GENE_ID: write_opt_string(vec, row_count, tx ? tx->gene_id : NULL); break;
+                case CSQ_COL_GENE_NAME: write_opt_string(vec, row_count, tx ? tx->gene_name : NULL); break;
+                case CSQ_COL_TRANSCRIPT_ID: write_opt_string(vec, row_count, tx ? tx->id : NULL); break;
+                case CSQ_COL_TRANSCRIPT_BIOTYPE: write_opt_string(vec, row_count, tx ? tx->biotype : NULL); break;
+                case CSQ_COL_STRAND:
+                    if (tx) {
+                        char strand[2] = {tx->strand ? tx->strand : '.', '\0'};
+                        duckdb_vector_assign_string_element(vec, row_count, strand);
+                    } else {
+                        set_null(vec, row_count);
+                    }
+                    break;
+                case CSQ_COL_CONSEQUENCE: duckdb_vector_assign_string_element(vec, row_count, csq_terms[worst]); break;
+                case CSQ_COL_CONSEQUENCES: csq_write_terms(vec, row_count, r->terms); break;
+                case CSQ_COL_IMPACT: duckdb_vector_assign_string_element(vec, row_count, csq_impact(worst)); break;
+                case CSQ_COL_CDS_POSITION:
+                case CSQ_COL_PROTEIN_POSITION: {
+                    int64_t v = local->column_ids[c] == CSQ_COL_CDS_POSITION ? r->cds_pos : r->prot_pos;
+                    if (v > 0) ((int64_t *)duckdb_vector_get_data(vec))[row_count] = v;
+                    else set_null(vec, row_count);
+                    break;
+                }
+                case CSQ_COL_CODONS:
+                    write_opt_string(vec, row_count, r->codons >= 0 ? local->text.s + r->codons : NULL);
+                    break;
+                case CSQ_COL_AMINO_ACIDS:
+                    write_opt_string(vec, row_count, r->amino_acids >= 0 ? local->text.s + r->amino_acids : NULL);
+                    break;
+                default: break;
+            }
+        }
+        row_count++;
+    }
+    duckdb_data_chunk_set_size(output, row_count);
+}
+
+void register_annotate_consequence_function(duckdb_connection connection) {
+    duckdb_table_function tf = duckdb_create_table_function();
+    duckdb_table_function_set_name(tf, "annotate_consequence");
+
+    duckdb_logical_type varchar_type = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_logical_type bigint_type = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_table_function_add_parameter(tf, varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "reference", varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "flank", bigint_type);
+    duckdb_destroy_logical_type(&bigint_type);
+    duckdb_destroy_logical_type(&varchar_type);
+
+    duckdb_table_function_set_bind(tf, csq_bind);
+    duckdb_table_function_set_init(tf, csq_global_init);
+    duckdb_table_function_set_local_init(tf, csq_local_init);
+    duckdb_table_function_set_function(tf, csq_scan);
+    duckdb_table_function_supports_projection_pushdown(tf, true);
+    duckdb_register_table_function(connection, tf);
+    duckdb_destroy_table_function(&tf);
+}